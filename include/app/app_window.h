@@ -61,6 +61,7 @@ public:
   bool Create(HINSTANCE instance);
   void Show(int cmd_show);
   bool OpenRegFileTab(const std::wstring& path);
+  bool OpenRecoveredHiveTab(const std::wstring& hive_path);
   bool TranslateAccelerator(const MSG& msg);
   void UpdateThemePresets(const std::vector<ThemePreset>& presets, const std::wstring& active_name, bool apply_now);
 
@@ -144,6 +145,7 @@ private:
   void StartDefaultParseThread(DefaultParseSession* session);
   void StopDefaultParseSessions();
   void StopRegFileParseSessions();
+  void StopOfflineLoad();
   static void StartTraceDialogLoad(HWND hwnd, void* context);
   static void StartDefaultDialogLoad(HWND hwnd, void* context);
   void UpdateAddressBar(RegistryNode* node);
@@ -169,6 +171,7 @@ private:
   bool SwitchToOfflineRegistry();
   bool SaveOfflineRegistry();
   bool LoadOfflineRegistryFromPath(const std::wstring& path, bool open_new_tab);
+  void UpdateOfflineTabText();
   void ApplyRegistryRoots(const std::vector<RegistryRootEntry>& roots);
   std::wstring TreeRootLabel() const;
   void SelectDefaultTreeItem();
@@ -185,6 +188,7 @@ private:
   bool IsSearchTabIndex(int index) const;
   bool IsRegFileTabIndex(int index) const;
   bool IsRegFileTabSelected() const;
+  bool IsReadOnlyTabSelected() const;
   int SearchIndexFromTab(int index) const;
   int FindFirstSearchTabIndex() const;
   int FindFirstRegistryTabIndex() const;
@@ -304,9 +308,10 @@ private:
   bool RemoveTraceByLabel(const std::wstring& label);
   bool HasActiveTraces() const;
   bool AddDefaultFromFile(const std::wstring& label, const std::wstring& path, bool show_error = true, bool prompt_for_selection = false, bool update_ui = true);
+  bool OpenParsedFileTab(const std::wstring& path, const std::wstring& label, const std::wstring& hive_path);
   bool SaveRegFileTab(int tab_index);
   bool ExportRegFileTab(int tab_index, const std::wstring& path);
-  bool BuildRegFileContent(const TabEntry& entry, std::wstring* out) const;
+  bool WriteRegFileTab(const TabEntry& entry, const std::wstring& path, std::wstring* error) const;
   void ReleaseRegFileRoots(TabEntry* entry);
   bool RemoveDefaultByPath(const std::wstring& path);
   bool RemoveDefaultByLabel(const std::wstring& label);
@@ -315,6 +320,8 @@ private:
   void LoadTreeState();
   void StartTreeStateWorker();
   void StopTreeStateWorker();
+  void StartSearchIndexWorker();
+  void StopSearchIndexWorker();
   void MarkTreeStateDirty();
   void SaveTreeStateFile(const std::wstring& selected, const std::vector<std::wstring>& expanded) const;
   void CaptureTreeState(std::wstring* selected_path, std::vector<std::wstring>* expanded_paths) const;
@@ -511,6 +518,9 @@ private:
   bool clear_history_on_exit_ = false;
   bool save_tabs_ = true;
   bool clear_tabs_on_exit_ = false;
+  uint32_t offline_memory_mb_ = 256;
+  bool offline_hive_index_ = true;
+  bool search_index_ = false;
   bool hive_list_loaded_ = false;
   std::vector<ThemePreset> theme_presets_;
   std::wstring active_theme_preset_;
@@ -567,6 +577,7 @@ private:
     std::vector<RegFileRoot> reg_file_roots;
     bool reg_file_dirty = false;
     bool reg_file_loading = false;
+    bool reg_file_read_only = false;
   };
 
   struct PendingSearchResult {
@@ -629,6 +640,7 @@ private:
   uint64_t search_start_tick_ = 0;
   uint64_t search_duration_ms_ = 0;
   bool search_duration_valid_ = false;
+  std::atomic<uint64_t> search_index_age_{0};
   std::thread search_thread_;
   bool search_running_ = false;
   uint64_t search_generation_ = 0;
@@ -690,9 +702,23 @@ private:
   struct RegFileParseSession {
     std::wstring source_path;
     std::wstring source_lower;
+    std::wstring hive_path;
     std::thread thread;
     std::atomic_bool cancel{false};
   };
+  struct OfflineLoadSession {
+    uint64_t generation = 0;
+    std::vector<std::wstring> paths;
+    std::vector<std::wstring> labels;
+    size_t base = 0;
+    std::vector<size_t> order;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> next{0};
+    std::atomic_bool cancel{false};
+    size_t pending = 0;
+    std::wstring errors;
+    std::wstring warnings;
+  };
   struct TraceDialogStartContext {
     MainWindow* window = nullptr;
     TraceParseSession* session = nullptr;
@@ -727,6 +753,10 @@ private:
   std::mutex value_list_mutex_;
   std::condition_variable value_list_cv_;
   std::thread value_list_thread_;
+  std::mutex search_index_mutex_;
+  std::condition_variable search_index_cv_;
+  std::thread search_index_thread_;
+  std::atomic_bool search_index_stop_{false};
   bool value_list_stop_ = false;
   bool value_list_pending_ = false;
   std::unique_ptr<ValueListTask> value_list_task_;
@@ -739,6 +769,8 @@ private:
   std::atomic_bool default_load_running_{false};
   std::unordered_map<std::wstring, std::unique_ptr<DefaultParseSession>> default_parse_sessions_;
   std::unordered_map<std::wstring, std::unique_ptr<RegFileParseSession>> reg_file_parse_sessions_;
+  std::unique_ptr<OfflineLoadSession> offline_load_;
+  uint64_t offline_load_generation_ = 0;
   uint64_t last_trace_refresh_tick_ = 0;
   uint64_t last_default_refresh_tick_ = 0;
   std::unordered_map<std::wstring, CommentEntry> value_comments_;
@@ -29,6 +29,7 @@ constexpr int kFileSaveOfflineHive = 2007;
 constexpr int kFileImportComments = 2008;
 constexpr int kFileExportComments = 2009;
 constexpr int kFileSave = 2017;
+constexpr int kFileRecoverDeleted = 2018;
 
 constexpr int kNewKey = 2010;
 constexpr int kNewString = 2011;
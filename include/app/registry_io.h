@@ -21,12 +21,15 @@
 #include <string>
 #include <vector>
 
+#include "registry/registry_provider.h"
+
 namespace regkit {
 
 bool ImportRegFile(HWND owner, std::wstring* error);
 bool ImportRegFileFromPath(const std::wstring& path, std::wstring* error);
-bool ExportRegFile(HWND owner, const std::wstring& key_path, std::wstring* error);
-bool ExportRegFileSelection(HWND owner, const std::wstring& base_key_path, const std::vector<std::wstring>& value_names, const std::vector<std::wstring>& subkey_names, std::wstring* error);
+bool ExportRegFile(HWND owner, const RegistryNode& node, std::wstring* error);
+bool ExportRegFileSelection(HWND owner, const RegistryNode& node, const std::vector<std::wstring>& value_names, const std::vector<std::wstring>& subkey_names, std::wstring* error);
+bool ExportRegSnapshot(const std::vector<RegistryNode>& nodes, const std::wstring& path, std::wstring* error);
 bool LoadHive(HWND owner, HKEY root, std::wstring* error);
 bool UnloadHive(HWND owner, HKEY root, const std::wstring& subkey, std::wstring* error);
 
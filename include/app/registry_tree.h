@@ -38,12 +38,14 @@ public:
   void SetRootLabel(const std::wstring& label);
 
   void PopulateRoots(const std::vector<RegistryRootEntry>& roots);
+  void AppendRoot(const RegistryRootEntry& root_entry, HKEY before = nullptr);
   RegistryNode* NodeFromItem(HTREEITEM item);
   void OnItemExpanding(const NMTREEVIEWW* info);
   RegistryNode* OnSelectionChanged(const NMTREEVIEWW* info);
 
 private:
   RegistryNode* StoreNode(std::unique_ptr<RegistryNode> node);
+  void InsertRoot(const RegistryRootEntry& root_entry, HKEY before = nullptr);
   void AddChildren(HTREEITEM parent, RegistryNode* node);
   void AddDummyChildIfNeeded(HTREEITEM parent, RegistryNode* node);
 
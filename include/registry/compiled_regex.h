@@ -0,0 +1,77 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace regkit {
+
+struct RegexMatch {
+  size_t start = 0;
+  size_t length = 0;
+};
+
+struct RegexClass {
+  std::vector<std::pair<wchar_t, wchar_t>> ranges;
+  uint8_t kinds = 0;
+  bool negated = false;
+  uint64_t ascii[2] = {};
+};
+
+struct RegexInst {
+  enum class Op : uint8_t { kChar, kAny, kClass, kSplit, kJump, kLineStart, kLineEnd, kWordBoundary, kNotWordBoundary, kMatch };
+
+  Op op = Op::kMatch;
+  wchar_t ch = 0;
+  uint32_t x = 0;
+  uint32_t y = 0;
+};
+
+class CompiledRegex {
+public:
+  bool Compile(std::wstring_view pattern, bool match_case);
+  bool compiled() const { return compiled_; }
+  const std::wstring& required_literal() const { return literal_; }
+
+  bool Search(std::wstring_view text, RegexMatch* match) const;
+  bool MatchWhole(std::wstring_view text, RegexMatch* match) const;
+
+private:
+  bool Run(std::wstring_view text, bool whole, RegexMatch* match) const;
+  bool Consumes(const RegexInst& inst, wchar_t ch) const;
+  bool MayStart(wchar_t ch) const;
+  size_t FindLiteral(std::wstring_view text) const;
+
+  std::vector<RegexInst> program_;
+  std::vector<RegexClass> classes_;
+  std::wstring literal_;
+  bool exact_ = false;
+  bool anchored_ = false;
+  bool match_case_ = true;
+  bool compiled_ = false;
+  bool first_filter_ = false;
+  bool first_other_ = false;
+  uint64_t first_ascii_[2] = {};
+};
+
+} // namespace regkit
@@ -0,0 +1,62 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "registry/hive_reader.h"
+
+namespace regkit {
+
+struct CarvedValue {
+  uint32_t cell = 0;
+  std::wstring name;
+  uint32_t type = 0;
+  uint32_t data_size = 0;
+  std::vector<uint8_t> data;
+  bool data_recovered = false;
+};
+
+struct CarvedKey {
+  uint32_t cell = 0;
+  std::wstring name;
+  uint64_t last_write = 0;
+  uint32_t parent = 0;
+  uint32_t value_count = 0;
+  std::vector<uint32_t> values;
+};
+
+struct CarvedSecurity {
+  uint32_t cell = 0;
+  std::vector<uint8_t> descriptor;
+};
+
+struct HiveCarveResult {
+  std::vector<CarvedKey> keys;
+  std::vector<CarvedValue> values;
+  std::vector<CarvedSecurity> security;
+  std::vector<uint32_t> orphan_values;
+  uint64_t scanned_bytes = 0;
+};
+
+bool CarveHive(const HiveReader& reader, unsigned int thread_count, const std::atomic_bool* cancel, HiveCarveResult* result);
+bool IsLiveHiveCell(const HiveReader& reader, uint32_t offset);
+
+} // namespace regkit
@@ -0,0 +1,74 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "registry/hive_reader.h"
+
+namespace regkit {
+
+enum class HiveIssueKind : uint8_t {
+  kBaseBlock,
+  kHbinHeader,
+  kCellSize,
+  kKeyNode,
+  kSubkeyList,
+  kSubkeyOrder,
+  kValueList,
+  kValue,
+  kValueData,
+  kBigData,
+  kSecurity,
+  kClassName,
+};
+
+struct HiveIssue {
+  uint64_t offset = 0;
+  uint32_t cell = 0xFFFFFFFFu;
+  HiveIssueKind kind = HiveIssueKind::kBaseBlock;
+  const char* detail = "";
+};
+
+struct HiveCheckReport {
+  uint64_t file_size = 0;
+  uint32_t bins_size = 0;
+  uint32_t hbin_count = 0;
+  uint64_t cell_count = 0;
+  uint64_t key_count = 0;
+  uint64_t value_count = 0;
+  uint64_t security_count = 0;
+  bool dirty = false;
+  HiveRecoveryState recovery = HiveRecoveryState::kClean;
+  std::vector<HiveIssue> issues;
+
+  bool ok() const { return issues.empty(); }
+};
+
+const char* HiveIssueKindName(HiveIssueKind kind);
+bool CheckHiveImage(const uint8_t* data, uint64_t size, unsigned int thread_count, const std::atomic_bool* cancel, HiveCheckReport* report);
+bool CheckHiveFile(const std::filesystem::path& path, unsigned int thread_count, const std::atomic_bool* cancel, HiveCheckReport* report, std::wstring* error);
+void WriteHiveCheckJson(std::ostream& out, std::string_view source, const HiveCheckReport& report);
+void WriteHiveCheckErrorJson(std::ostream& out, std::string_view source, std::string_view error);
+
+} // namespace regkit
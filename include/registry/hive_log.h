@@ -0,0 +1,73 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "registry/mapped_file.h"
+
+namespace regkit {
+
+constexpr uint32_t kHiveBaseBlockChecksumOffset = 0x1FC;
+constexpr uint32_t kHiveLogBaseBlockSize = 512;
+
+uint64_t Marvin32(const uint8_t* data, size_t size, uint64_t seed);
+uint32_t HiveBaseBlockChecksum(const uint8_t* base);
+bool IsHiveBaseBlockValid(const uint8_t* base);
+bool IsHiveBaseBlockDirty(const uint8_t* base);
+
+struct HiveLogPage {
+  uint32_t offset = 0;
+  uint32_t size = 0;
+  const uint8_t* data = nullptr;
+};
+
+struct HiveLogEntry {
+  uint32_t sequence = 0;
+  uint32_t bins_size = 0;
+  std::vector<HiveLogPage> pages;
+};
+
+class HiveLog {
+public:
+  bool Open(const std::filesystem::path& path, std::wstring* error);
+  void Close();
+  bool is_open() const { return file_.is_open(); }
+
+  const uint8_t* base_block() const { return file_.data(); }
+  const std::vector<HiveLogEntry>& entries() const { return entries_; }
+
+private:
+  MappedFile file_;
+  std::vector<HiveLogEntry> entries_;
+};
+
+struct HiveRecoveryPlan {
+  const uint8_t* base_block = nullptr;
+  std::vector<const HiveLogEntry*> entries;
+  uint32_t bins_size = 0;
+  uint32_t sequence = 0;
+};
+
+bool PlanHiveRecovery(const uint8_t* primary_base, const std::vector<const HiveLog*>& logs, HiveRecoveryPlan* plan);
+void ApplyHiveRecovery(const HiveRecoveryPlan& plan, uint8_t* base, uint64_t capacity);
+
+} // namespace regkit
@@ -0,0 +1,136 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "registry/mapped_file.h"
+
+namespace regkit {
+
+struct HiveName {
+  const uint8_t* data = nullptr;
+  uint32_t bytes = 0;
+  bool compressed = false;
+
+  size_t length() const { return compressed ? bytes : bytes / 2; }
+  uint16_t at(size_t index) const;
+  std::wstring ToString() const;
+  void AppendTo(std::wstring* out) const;
+  bool EqualsInsensitive(std::wstring_view text) const;
+};
+
+struct HiveKeyInfo {
+  uint16_t flags = 0;
+  uint64_t last_write = 0;
+  uint32_t parent = 0;
+  uint32_t subkey_count = 0;
+  uint32_t value_count = 0;
+};
+
+enum class HiveRecoveryState : uint8_t {
+  kClean,
+  kReplayed,
+  kDirtyNoLogs,
+  kReplayFailed,
+};
+
+struct HiveBin {
+  uint32_t offset = 0;
+  uint32_t size = 0;
+};
+
+struct HiveValue {
+  uint32_t cell = 0;
+  HiveName name;
+  uint32_t type = 0;
+  uint32_t data_size = 0;
+};
+
+class HivePathCache {
+public:
+  bool Find(std::wstring_view path, uint32_t* cell) const;
+  void Insert(std::wstring_view path, uint32_t cell);
+
+private:
+  struct Hash {
+    using is_transparent = void;
+    size_t operator()(std::wstring_view text) const { return std::hash<std::wstring_view>()(text); }
+  };
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::wstring, uint32_t, Hash, std::equal_to<>> cells_;
+};
+
+class HiveReader {
+public:
+  static constexpr uint32_t kNoCell = 0xFFFFFFFFu;
+
+  bool Open(const std::filesystem::path& path, std::wstring* error);
+  void Close();
+  bool is_open() const { return bins_ != nullptr; }
+
+  uint32_t root_cell() const { return root_cell_; }
+  uint32_t minor_version() const { return minor_version_; }
+  HiveRecoveryState recovery_state() const { return recovery_state_; }
+  bool replayed_logs() const { return recovery_state_ == HiveRecoveryState::kReplayed; }
+  const uint8_t* base_block() const { return bins_ ? bins_ - 4096 : nullptr; }
+  const uint8_t* bins() const { return bins_; }
+  uint32_t bins_size() const { return bins_size_; }
+  void set_mapping_budget(uint64_t bytes) { mapping_budget_ = bytes; }
+  MappedFileStats mapping_stats() const { return file_.stats(); }
+
+  std::vector<HiveBin> Bins() const;
+  bool FindKey(std::wstring_view path, uint32_t* cell) const;
+  bool FindSubkey(uint32_t parent, std::wstring_view name, uint32_t* cell) const;
+  bool QueryKey(uint32_t cell, HiveKeyInfo* info) const;
+  HiveName KeyName(uint32_t cell) const;
+  bool EnumSubkeys(uint32_t cell, const std::function<bool(uint32_t child)>& callback) const;
+  bool EnumValues(uint32_t cell, const std::function<bool(const HiveValue& value)>& callback) const;
+  bool ReadValue(uint32_t offset, HiveValue* value) const;
+  bool FindValue(uint32_t cell, std::wstring_view name, HiveValue* value) const;
+  bool ValueData(const HiveValue& value, std::vector<uint8_t>* scratch, const uint8_t** data, uint32_t* size) const;
+  const uint8_t* Cell(uint32_t offset, uint32_t* size) const;
+  void Touch(uint32_t offset, uint32_t size) const;
+
+private:
+  const uint8_t* KeyNode(uint32_t offset) const;
+  bool EnumSubkeyList(uint32_t list, const std::function<bool(uint32_t child)>& callback, int depth) const;
+  bool FindInSubkeyList(uint32_t list, std::wstring_view name, bool hashed, uint32_t hash, uint32_t* cell, int depth) const;
+  void ReplayLogs(const std::filesystem::path& path);
+
+  MappedFile file_;
+  std::vector<uint8_t> recovered_;
+  HiveRecoveryState recovery_state_ = HiveRecoveryState::kClean;
+  const uint8_t* bins_ = nullptr;
+  uint32_t bins_size_ = 0;
+  uint32_t root_cell_ = kNoCell;
+  uint32_t minor_version_ = 0;
+  uint64_t mapping_budget_ = 0;
+  std::unique_ptr<HivePathCache> path_cache_;
+};
+
+} // namespace regkit
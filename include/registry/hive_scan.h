@@ -0,0 +1,96 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "registry/hive_reader.h"
+#include "registry/mapped_file.h"
+
+namespace regkit {
+
+struct HiveScanKey {
+  uint32_t cell = HiveReader::kNoCell;
+  HiveName name;
+  std::u16string_view lower_name;
+  HiveKeyInfo info;
+  std::span<const uint32_t> values;
+  std::wstring_view path;
+};
+
+using HiveScanCallback = std::function<bool(const HiveScanKey& key)>;
+
+class HiveScanner {
+public:
+  explicit HiveScanner(const HiveReader& reader) : reader_(reader) {}
+
+  bool Index(unsigned int thread_count, const std::atomic_bool* cancel);
+  bool Attach(std::shared_ptr<const HiveScanner> index);
+  bool LoadIndex(const std::filesystem::path& index_path, const std::filesystem::path& hive_path);
+  bool SaveIndex(const std::filesystem::path& index_path, const std::filesystem::path& hive_path) const;
+  bool FindKey(std::wstring_view path, uint32_t* cell) const;
+  size_t Select(uint32_t start_cell);
+  bool Scan(unsigned int thread_count, const std::atomic_bool* cancel, const HiveScanCallback& callback) const;
+
+  size_t key_count() const { return table_.size(); }
+  size_t selected_count() const { return selected_.size(); }
+
+private:
+  static constexpr uint32_t kNoIndex = 0xFFFFFFFFu;
+
+  struct KeyEntry {
+    uint32_t cell = 0;
+    uint32_t parent_cell = HiveReader::kNoCell;
+    uint32_t parent = kNoIndex;
+    uint32_t name_offset = 0;
+    uint32_t value_begin = 0;
+    uint32_t value_count = 0;
+  };
+
+  static_assert(sizeof(KeyEntry) == 24);
+
+  void Reset();
+  bool BuildTables(unsigned int thread_count, const std::atomic_bool* cancel);
+  uint32_t FindIndex(uint32_t cell) const;
+  uint32_t FindChild(uint32_t parent, std::u16string_view lower_name) const;
+  std::u16string_view LowerName(uint32_t index) const;
+
+  const HiveReader& reader_;
+  std::vector<KeyEntry> keys_;
+  std::u16string names_;
+  std::vector<uint32_t> values_;
+  std::vector<uint32_t> lookup_;
+  MappedFile index_;
+  std::shared_ptr<const HiveScanner> shared_;
+  std::span<const KeyEntry> table_;
+  std::u16string_view name_pool_;
+  std::span<const uint32_t> value_table_;
+  std::span<const uint32_t> lookup_table_;
+  std::vector<uint32_t> selected_;
+  uint32_t start_index_ = kNoIndex;
+};
+
+} // namespace regkit
@@ -0,0 +1,77 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace regkit {
+
+struct MappedFileStats {
+  uint64_t window_size = 0;
+  uint64_t budget_bytes = 0;
+  uint64_t resident_bytes = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+};
+
+class MappedFile {
+public:
+  static constexpr uint32_t kDefaultWindowSize = 1024 * 1024;
+
+  MappedFile() noexcept;
+  ~MappedFile();
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool Open(const std::filesystem::path& path, std::wstring* error, bool copy_on_write = false);
+  void Close() noexcept;
+
+  bool is_open() const noexcept { return data_ != nullptr; }
+  const uint8_t* data() const noexcept { return data_; }
+  uint8_t* mutable_data() const noexcept { return copy_on_write_ ? data_ : nullptr; }
+  uint64_t size() const noexcept { return size_; }
+
+  bool SetResidencyBudget(uint64_t budget_bytes, uint32_t window_size = kDefaultWindowSize);
+  void Touch(uint64_t offset, uint64_t size) const noexcept;
+  MappedFileStats stats() const noexcept;
+
+private:
+  struct WindowState;
+
+  void Fault(WindowState* state, uint64_t window) const noexcept;
+  bool Release(uint64_t offset, uint64_t size) const noexcept;
+
+  uint8_t* data_ = nullptr;
+  uint64_t size_ = 0;
+  bool copy_on_write_ = false;
+  std::unique_ptr<WindowState> windows_;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+};
+
+} // namespace regkit
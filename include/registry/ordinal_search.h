@@ -0,0 +1,58 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace regkit {
+
+wchar_t UpcaseOrdinal(wchar_t ch);
+bool EqualsOrdinalInsensitive(std::wstring_view left, std::wstring_view right);
+size_t FindOrdinalInsensitive(std::wstring_view text, std::wstring_view needle);
+
+class OrdinalFinder {
+public:
+  OrdinalFinder() = default;
+  explicit OrdinalFinder(std::wstring_view needle) { Reset(needle); }
+
+  void Reset(std::wstring_view needle);
+  bool empty() const { return upper_.empty(); }
+  size_t size() const { return upper_.size(); }
+
+  size_t Find(std::wstring_view text) const;
+  bool Contains(std::wstring_view text) const { return Find(text) != std::wstring_view::npos; }
+  bool Equals(std::wstring_view text) const;
+
+private:
+  static constexpr size_t kMaxAliases = 4;
+
+  bool Verify(const wchar_t* text) const;
+
+  const uint16_t* units_ = nullptr;
+  std::wstring upper_;
+  wchar_t first_[kMaxAliases] = {};
+  wchar_t last_[kMaxAliases] = {};
+  uint8_t first_count_ = 0;
+  uint8_t last_count_ = 0;
+  bool vector_ = false;
+};
+
+} // namespace regkit
@@ -0,0 +1,59 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace regkit {
+
+struct PatternHit {
+  size_t start = 0;
+  size_t length = 0;
+  uint32_t pattern = 0;
+};
+
+class PatternSet {
+public:
+  static constexpr uint32_t kNoPattern = 0xFFFFFFFFu;
+
+  bool Build(const std::vector<std::wstring>& patterns, bool match_case);
+  bool empty() const { return transitions_.empty(); }
+
+  bool Find(std::wstring_view text, PatternHit* hit) const;
+  bool MatchWhole(std::wstring_view text, PatternHit* hit) const;
+
+private:
+  uint32_t ClassOf(wchar_t ch) const;
+  uint32_t FoldedClass(wchar_t unit) const;
+
+  std::vector<uint32_t> transitions_;
+  std::vector<uint32_t> outputs_;
+  std::vector<uint32_t> lengths_;
+  std::vector<std::pair<wchar_t, uint32_t>> wide_classes_;
+  uint32_t ascii_classes_[128] = {};
+  size_t class_count_ = 0;
+  size_t max_length_ = 0;
+  bool match_case_ = true;
+};
+
+} // namespace regkit
@@ -0,0 +1,102 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "registry/reg_file_tokenizer.h"
+#include "registry/virtual_hive.h"
+
+namespace regkit {
+
+struct RegFileSection {
+  uint32_t key = 0;
+  RegFileRange range;
+};
+
+struct RegFileStamp {
+  uint64_t size = 0;
+  int64_t write_time = 0;
+
+  bool operator==(const RegFileStamp&) const = default;
+};
+
+bool StampRegFile(const std::filesystem::path& path, RegFileStamp* stamp);
+
+class RegFileIndex;
+
+struct RegFileSaveRoot {
+  std::wstring name;
+  const VirtualHive* hive = nullptr;
+  RegFileIndex* index = nullptr;
+};
+
+class RegFileIndex {
+public:
+  static constexpr uint64_t kCacheBytes = 64 * 1024 * 1024;
+  static constexpr uint64_t kCopyChunkBytes = 4 * 1024 * 1024;
+
+  RegFileIndex(std::filesystem::path path, RegFileStamp stamp, std::vector<RegFileSection> sections);
+
+  std::shared_ptr<const VirtualHive> Load(uint32_t key);
+  bool Adopt(uint32_t key, VirtualHive* hive);
+  void MarkMoved(uint32_t key);
+
+  static bool Save(const std::filesystem::path& target, const std::vector<RegFileSaveRoot>& roots, std::wstring* error);
+
+private:
+  struct CachedKey {
+    std::shared_ptr<const VirtualHive> values;
+    std::list<uint32_t>::iterator use;
+    uint64_t bytes = 0;
+  };
+
+  struct SavePlan;
+
+  void IndexByKey();
+  std::pair<const uint32_t*, const uint32_t*> FindSections(uint32_t key) const;
+  bool Decode(const uint32_t* begin, const uint32_t* end, VirtualHive* hive, uint32_t key);
+  bool Unchanged();
+  void Evict(uint32_t key);
+  void Plan(const RegFileSaveRoot& root, SavePlan* plan) const;
+
+  std::filesystem::path path_;
+  RegFileStamp stamp_;
+  bool stale_ = false;
+  std::vector<RegFileSection> sections_;
+  std::vector<uint32_t> by_key_;
+  std::unordered_set<uint32_t> adopted_;
+  std::unordered_set<uint32_t> dirty_;
+  std::unordered_set<uint32_t> moved_;
+  std::mutex mutex_;
+  RegFileReader reader_;
+  bool reader_open_ = false;
+  std::list<uint32_t> recent_;
+  std::unordered_map<uint32_t, CachedKey> cache_;
+  uint64_t cached_bytes_ = 0;
+};
+
+} // namespace regkit
@@ -0,0 +1,95 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "registry/mapped_file.h"
+
+namespace regkit {
+
+enum class RegFileTokenKind {
+  kKey,
+  kDeleteKey,
+  kValue,
+  kDeleteValue,
+};
+
+struct RegFileToken {
+  RegFileTokenKind kind = RegFileTokenKind::kKey;
+  std::wstring_view key;
+  std::wstring_view name;
+  std::wstring_view data;
+};
+
+class RegFileTokenizer {
+public:
+  explicit RegFileTokenizer(std::wstring_view text) : text_(text) {}
+
+  bool Next(RegFileToken* token);
+  size_t position() const { return position_; }
+
+private:
+  std::wstring_view NextLine();
+
+  std::wstring_view text_;
+  size_t position_ = 0;
+};
+
+struct RegFileRange {
+  uint64_t begin = 0;
+  uint64_t end = 0;
+};
+
+class RegFileReader {
+public:
+  static constexpr uint64_t kChunkBytes = 4 * 1024 * 1024;
+
+  bool Open(const std::filesystem::path& path, std::wstring* error);
+  void Close();
+  bool Next(RegFileToken* token);
+  bool NextSection(RegFileToken* token, RegFileRange* section);
+  std::vector<RegFileRange> SplitSections(size_t count) const;
+  bool Seek(const RegFileRange& range);
+
+  bool utf16() const { return utf16_; }
+  uint64_t size() const { return file_.size(); }
+  uint64_t position() const { return offset_; }
+
+private:
+  bool Fill();
+
+  MappedFile file_;
+  RegFileTokenizer tokenizer_{std::wstring_view()};
+  std::wstring chunk_;
+  uint64_t text_begin_ = 0;
+  uint64_t text_end_ = 0;
+  uint64_t offset_ = 0;
+  uint64_t end_ = 0;
+  bool utf16_ = false;
+};
+
+bool DecodeRegFileText(const uint8_t* data, size_t size, std::wstring* out, bool* utf16);
+bool UnescapeRegFileString(std::wstring_view text, std::wstring* out);
+bool ParseRegFileValueData(std::wstring_view data, uint32_t* type, std::vector<uint8_t>* out, std::wstring* scratch);
+
+} // namespace regkit
@@ -0,0 +1,64 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace regkit {
+
+class RegFileWriter {
+public:
+  static constexpr size_t kBufferUnits = 64 * 1024;
+
+  bool Open(const std::filesystem::path& path, std::wstring* error);
+  bool OpenRaw(const std::filesystem::path& path, bool utf16, std::wstring* error);
+  bool Close(std::wstring* error);
+  bool ok() const { return ok_; }
+  uint64_t Tell();
+
+  void BeginKey(std::wstring_view path);
+  void BeginSection(std::wstring_view path);
+  void NewLine();
+  void WriteValue(std::wstring_view name, uint32_t type, const uint8_t* data, size_t size);
+  void WriteRaw(const uint8_t* data, size_t size);
+
+private:
+  char16_t* Reserve(size_t units);
+  void Put(wchar_t ch);
+  void Append(std::wstring_view text);
+  size_t AppendEscaped(std::wstring_view text);
+  void AppendEscapedUnits(const uint8_t* data, size_t units);
+  void AppendHex(const uint8_t* data, size_t size, size_t column);
+  void Flush();
+
+  std::ofstream file_;
+  std::unique_ptr<char16_t[]> buffer_;
+  std::string encoded_;
+  size_t used_ = 0;
+  uint64_t written_ = 0;
+  bool utf16_ = true;
+  bool framed_ = true;
+  bool ok_ = false;
+};
+
+} // namespace regkit
@@ -0,0 +1,128 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "registry/hive_reader.h"
+#include "registry/mapped_file.h"
+#include "registry/virtual_hive.h"
+
+namespace regkit {
+
+inline constexpr wchar_t kRegSnapshotExtension[] = L".rksnap";
+
+struct RegSnapshotValue {
+  HiveName name;
+  uint32_t type = 0;
+  const uint8_t* data = nullptr;
+  uint32_t size = 0;
+};
+
+class RegSnapshot {
+public:
+  static constexpr uint32_t kNoKey = 0xFFFFFFFFu;
+  static constexpr uint32_t kVersion = 1;
+
+  bool Open(const std::filesystem::path& path, std::wstring* error);
+  void Close();
+  bool is_open() const { return file_.is_open(); }
+  MappedFileStats mapping_stats() const { return file_.stats(); }
+
+  uint32_t root() const { return 0; }
+  uint32_t KeyCount() const { return key_count_; }
+  HiveName KeyName(uint32_t key) const;
+  uint64_t LastWrite(uint32_t key) const;
+  uint32_t SubkeyCount(uint32_t key) const;
+  uint32_t Subkey(uint32_t key, uint32_t index) const;
+  uint32_t FindSubkey(uint32_t key, std::wstring_view name) const;
+  uint32_t FindKey(uint32_t key, std::wstring_view path) const;
+
+  uint32_t ValueCount(uint32_t key) const;
+  RegSnapshotValue Value(uint32_t key, uint32_t index) const;
+  bool FindValue(uint32_t key, std::wstring_view name, RegSnapshotValue* value) const;
+
+private:
+  const uint8_t* Key(uint32_t key) const { return key < key_count_ ? keys_ + static_cast<size_t>(key) * 32 : nullptr; }
+  HiveName Name(uint32_t name) const;
+
+  MappedFile file_;
+  const uint8_t* keys_ = nullptr;
+  const uint8_t* links_ = nullptr;
+  const uint8_t* values_ = nullptr;
+  const uint8_t* names_ = nullptr;
+  const uint8_t* pool_ = nullptr;
+  const uint8_t* blobs_ = nullptr;
+  uint32_t key_count_ = 0;
+  uint32_t link_count_ = 0;
+  uint32_t value_count_ = 0;
+  uint32_t name_count_ = 0;
+  uint64_t pool_size_ = 0;
+  uint64_t blob_size_ = 0;
+};
+
+class RegSnapshotWriter {
+public:
+  bool Open(const std::filesystem::path& path, std::wstring* error);
+  bool Close(std::wstring* error);
+  bool ok() const { return ok_; }
+
+  void BeginKey(std::wstring_view path);
+  void SetLastWrite(uint64_t time);
+  void WriteValue(std::wstring_view name, uint32_t type, const uint8_t* data, size_t size);
+
+private:
+  struct PendingValue {
+    uint32_t key = 0;
+    uint32_t name = 0;
+    uint32_t type = 0;
+    uint32_t size = 0;
+    uint64_t data = 0;
+  };
+
+  struct NameHash {
+    using is_transparent = void;
+    size_t operator()(std::wstring_view text) const { return std::hash<std::wstring_view>()(text); }
+  };
+
+  uint32_t Intern(std::wstring_view name);
+  int CompareNames(uint32_t left, uint32_t right) const;
+  void Write(const void* data, size_t size);
+
+  std::ofstream file_;
+  VirtualHive keys_;
+  uint32_t current_ = 0;
+  std::vector<uint64_t> last_write_;
+  std::vector<PendingValue> values_;
+  std::unordered_map<std::wstring, uint32_t, NameHash, std::equal_to<>> name_ids_;
+  std::vector<uint64_t> names_;
+  std::vector<uint8_t> pool_;
+  uint64_t offset_ = 0;
+  uint64_t blob_size_ = 0;
+  bool ok_ = false;
+};
+
+} // namespace regkit
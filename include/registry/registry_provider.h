@@ -18,14 +18,24 @@
 
 #include <windows.h>
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "registry/reg_file_index.h"
+#include "registry/reg_snapshot.h"
+#include "registry/virtual_hive.h"
+
 namespace regkit {
 
+class HiveReader;
+class HiveScanner;
+enum class HiveRecoveryState : uint8_t;
+struct MappedFileStats;
+
 struct RegistryNode {
   HKEY root = nullptr;
   std::wstring subkey;
@@ -67,21 +77,13 @@ struct KeyInfo {
 
 class RegistryProvider {
 public:
-  struct VirtualRegistryValue {
-    std::wstring name;
-    DWORD type = REG_NONE;
-    std::vector<BYTE> data;
-  };
-
-  struct VirtualRegistryKey {
-    std::wstring name;
-    std::unordered_map<std::wstring, VirtualRegistryValue> values;
-    std::unordered_map<std::wstring, std::unique_ptr<VirtualRegistryKey>> children;
-  };
-
   struct VirtualRegistryData {
     std::wstring root_name;
-    std::unique_ptr<VirtualRegistryKey> root;
+    VirtualHive hive;
+    std::shared_ptr<RegFileIndex> source;
+    std::shared_ptr<const RegSnapshot> snapshot;
+    uint32_t snapshot_key = 0;
+    bool read_only = false;
   };
 
   static std::vector<RegistryRootEntry> DefaultRoots(bool include_extra = false);
@@ -109,6 +111,14 @@ public:
   static bool OpenOfflineHive(const std::wstring& path, HKEY* root, std::wstring* error);
   static bool SaveOfflineHive(HKEY root, const std::wstring& path, std::wstring* error);
   static bool CloseOfflineHive(HKEY root, std::wstring* error);
+  static std::shared_ptr<const HiveReader> OfflineHiveReader(const RegistryNode& node, uint32_t* cell);
+  static bool OfflineHiveMappingStats(HKEY root, MappedFileStats* stats);
+  static HiveRecoveryState OfflineHiveRecovery(HKEY root);
+  static void SetOfflineMemoryBudget(uint64_t bytes);
+  static bool OfflineHiveIndexPaths(const RegistryNode& node, std::wstring* hive_path, std::wstring* index_path);
+  static std::shared_ptr<const HiveScanner> OfflineHiveIndex(HKEY root);
+  static bool IndexOfflineHive(HKEY root, unsigned int thread_count, const std::atomic_bool* cancel);
+  static void SetOfflineHiveIndexing(bool enabled);
   static void SetOfflineRoot(HKEY root);
   static void SetOfflineRoots(const std::vector<HKEY>& roots);
   static HKEY RegisterVirtualRoot(const std::wstring& root_name, const std::shared_ptr<VirtualRegistryData>& data);
@@ -28,6 +28,7 @@ namespace regkit {
 
 struct SearchCriteria {
   std::wstring query;
+  std::vector<std::wstring> queries;
   bool search_keys = true;
   bool search_values = true;
   bool search_data = true;
@@ -70,10 +71,14 @@ struct SearchResult {
   SearchMatchField match_field = SearchMatchField::kNone;
   int match_start = -1;
   int match_length = 0;
+  int pattern_index = -1;
+  std::wstring pattern;
 };
 
 using SearchProgressCallback = std::function<void(uint64_t searched, uint64_t total)>;
 
-bool SearchRegistryStreaming(const SearchCriteria& criteria, std::atomic_bool* cancel_flag, const std::function<bool(const SearchResult&)>& callback, const SearchProgressCallback& progress, bool stop_on_first);
+void SetSearchIndexing(bool enabled);
+bool RefreshSearchIndex(HKEY root, const std::atomic_bool* cancel);
+bool SearchRegistryStreaming(const SearchCriteria& criteria, std::atomic_bool* cancel_flag, const std::function<bool(const SearchResult&)>& callback, const SearchProgressCallback& progress, bool stop_on_first, uint64_t* index_age = nullptr);
 
 } // namespace regkit
@@ -0,0 +1,88 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "registry/mapped_file.h"
+
+namespace regkit {
+
+inline constexpr wchar_t kTrigramIndexExtension[] = L".rktri";
+
+void CollectTrigrams(std::wstring_view text, std::vector<uint32_t>* trigrams);
+
+class TrigramIndex {
+public:
+  static constexpr uint32_t kVersion = 1;
+
+  bool Open(const std::filesystem::path& path, std::wstring* error);
+  void Close();
+  bool is_open() const { return file_.is_open(); }
+
+  uint64_t stamp() const { return stamp_; }
+  uint32_t key_count() const { return key_count_; }
+  std::wstring KeyPath(uint32_t key) const;
+  bool Candidates(std::wstring_view literal, std::vector<uint32_t>* keys) const;
+
+private:
+  bool Postings(uint32_t trigram, std::vector<uint32_t>* keys) const;
+
+  MappedFile file_;
+  const uint8_t* trigrams_ = nullptr;
+  const uint8_t* paths_ = nullptr;
+  const uint8_t* units_ = nullptr;
+  const uint8_t* postings_ = nullptr;
+  const uint8_t* always_ = nullptr;
+  uint64_t stamp_ = 0;
+  uint64_t unit_count_ = 0;
+  uint64_t posting_size_ = 0;
+  uint32_t key_count_ = 0;
+  uint32_t trigram_count_ = 0;
+  uint32_t always_count_ = 0;
+};
+
+class TrigramIndexWriter {
+public:
+  static constexpr size_t kMaxKeyTrigrams = 4096;
+
+  void AddKey(std::wstring_view path, std::vector<uint32_t>* trigrams);
+  bool Save(const std::filesystem::path& path, uint64_t stamp, std::wstring* error) const;
+  uint32_t key_count() const { return key_count_; }
+
+private:
+  struct Posting {
+    uint32_t count = 0;
+    uint32_t last = 0;
+    std::vector<uint8_t> bytes;
+  };
+
+  std::unordered_map<uint32_t, Posting> postings_;
+  std::u16string units_;
+  std::vector<uint64_t> paths_;
+  std::vector<uint32_t> always_;
+  uint32_t key_count_ = 0;
+};
+
+} // namespace regkit
@@ -0,0 +1,111 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace regkit {
+
+struct VirtualHiveValue {
+  std::wstring_view name;
+  uint32_t type = 0;
+  const uint8_t* data = nullptr;
+  uint32_t size = 0;
+};
+
+class VirtualHive {
+public:
+  static constexpr uint32_t kNoKey = 0xFFFFFFFFu;
+
+  VirtualHive();
+
+  uint32_t root() const { return 0; }
+
+  std::wstring_view KeyName(uint32_t key) const;
+  uint32_t KeyCount() const { return static_cast<uint32_t>(keys_.size()); }
+  uint32_t SubkeyCount(uint32_t key) const { return keys_[key].child_count; }
+  uint32_t Subkey(uint32_t key, uint32_t index) const { return links_[keys_[key].children + index]; }
+  uint32_t FindSubkey(uint32_t key, std::wstring_view name) const;
+  uint32_t FindKey(std::wstring_view path) const;
+  uint32_t CreateSubkey(uint32_t key, std::wstring_view name);
+  uint32_t CreateKey(std::wstring_view path);
+  bool DeleteSubkey(uint32_t key, std::wstring_view name);
+  bool RenameSubkey(uint32_t key, std::wstring_view old_name, std::wstring_view new_name);
+
+  uint32_t ValueCount(uint32_t key) const { return keys_[key].value_count; }
+  VirtualHiveValue Value(uint32_t key, uint32_t index) const;
+  bool FindValue(uint32_t key, std::wstring_view name, VirtualHiveValue* value) const;
+  void SetValue(uint32_t key, std::wstring_view name, uint32_t type, const uint8_t* data, size_t size);
+  bool DeleteValue(uint32_t key, std::wstring_view name);
+  bool RenameValue(uint32_t key, std::wstring_view old_name, std::wstring_view new_name);
+
+  void Merge(const VirtualHive& source, std::vector<uint32_t>* remap = nullptr);
+  void Compact(std::vector<uint32_t>* remap = nullptr);
+
+private:
+  struct KeyRecord {
+    uint32_t name = 0;
+    uint32_t children = 0;
+    uint32_t child_count = 0;
+    uint32_t child_capacity = 0;
+    uint32_t values = 0;
+    uint32_t value_count = 0;
+    uint32_t value_capacity = 0;
+  };
+
+  struct ValueRecord {
+    uint64_t data = 0;
+    uint32_t name = 0;
+    uint32_t type = 0;
+    uint32_t size = 0;
+  };
+
+  struct CreatedKey {
+    size_t end = 0;
+    uint32_t key = 0;
+  };
+
+  struct NameRecord {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+    uint32_t hash = 0;
+  };
+
+  std::wstring_view Name(uint32_t name) const { return std::wstring_view(name_pool_.data() + names_[name].offset, names_[name].length); }
+  uint32_t Intern(std::wstring_view name);
+  void GrowNameSlots();
+  void ForgetCreatedPath();
+  size_t LowerSubkey(uint32_t key, std::wstring_view name, bool* found) const;
+  size_t LowerValue(uint32_t key, std::wstring_view name, bool* found) const;
+  void MergeKey(uint32_t target, const VirtualHive& source, uint32_t key, std::vector<uint32_t>* remap);
+
+  std::vector<KeyRecord> keys_;
+  std::vector<uint32_t> links_;
+  std::vector<ValueRecord> values_;
+  std::vector<uint8_t> blobs_;
+  std::vector<NameRecord> names_;
+  std::vector<uint32_t> name_slots_;
+  std::wstring name_pool_;
+  std::wstring created_path_;
+  std::vector<CreatedKey> created_keys_;
+};
+
+} // namespace regkit
@@ -0,0 +1,180 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace regkit {
+
+template <typename Task>
+class WorkStealingScheduler {
+public:
+  using Body = std::function<void(unsigned int worker, Task& task, std::vector<Task>* children)>;
+
+  static constexpr size_t kStealBatch = 32;
+
+  explicit WorkStealingScheduler(unsigned int worker_count) : worker_count_(std::max(1u, worker_count)), lanes_(std::make_unique<Lane[]>(worker_count_)) {}
+
+  unsigned int worker_count() const { return worker_count_; }
+  bool stopped() const { return stopped_.load(); }
+  uint64_t pending() const { return pending_.load(); }
+
+  void Seed(Task task) {
+    Lane& lane = lanes_[seeded_++ % worker_count_];
+    lane.tasks.push_back(std::move(task));
+    pending_.fetch_add(1);
+    queued_.fetch_add(1);
+  }
+
+  void Stop() {
+    stopped_.store(true);
+    Wake();
+  }
+
+  void Run(const Body& body, const std::function<void()>& thread_init = {}) {
+    std::vector<std::thread> threads;
+    threads.reserve(worker_count_);
+    for (unsigned int i = 0; i < worker_count_; ++i) {
+      threads.emplace_back([this, i, &body, &thread_init]() {
+        if (thread_init) {
+          thread_init();
+        }
+        Task task;
+        std::vector<Task> children;
+        while (Next(i, &task)) {
+          children.clear();
+          body(i, task, &children);
+          if (!children.empty() && !stopped()) {
+            Push(i, &children);
+          }
+          if (pending_.fetch_sub(1) == 1) {
+            Wake();
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+private:
+  struct alignas(64) Lane {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void Push(unsigned int worker, std::vector<Task>* tasks) {
+    size_t count = tasks->size();
+    pending_.fetch_add(count);
+    {
+      Lane& lane = lanes_[worker];
+      std::lock_guard<std::mutex> lock(lane.mutex);
+      for (auto& task : *tasks) {
+        lane.tasks.push_back(std::move(task));
+      }
+    }
+    queued_.fetch_add(count);
+    if (sleepers_.load() > 0) {
+      Wake();
+    }
+  }
+
+  bool PopLocal(unsigned int worker, Task* task) {
+    Lane& lane = lanes_[worker];
+    std::lock_guard<std::mutex> lock(lane.mutex);
+    if (lane.tasks.empty()) {
+      return false;
+    }
+    *task = std::move(lane.tasks.back());
+    lane.tasks.pop_back();
+    queued_.fetch_sub(1);
+    return true;
+  }
+
+  bool Steal(unsigned int worker, Task* task) {
+    std::vector<Task> stolen;
+    for (unsigned int offset = 1; offset < worker_count_ && stolen.empty(); ++offset) {
+      Lane& victim = lanes_[(worker + offset) % worker_count_];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      size_t count = std::min(kStealBatch, (victim.tasks.size() + 1) / 2);
+      for (size_t i = 0; i < count; ++i) {
+        stolen.push_back(std::move(victim.tasks.front()));
+        victim.tasks.pop_front();
+      }
+    }
+    if (stolen.empty()) {
+      return false;
+    }
+    *task = std::move(stolen.front());
+    queued_.fetch_sub(1);
+    if (stolen.size() > 1) {
+      Lane& lane = lanes_[worker];
+      std::lock_guard<std::mutex> lock(lane.mutex);
+      for (size_t i = 1; i < stolen.size(); ++i) {
+        lane.tasks.push_back(std::move(stolen[i]));
+      }
+    }
+    return true;
+  }
+
+  bool Next(unsigned int worker, Task* task) {
+    for (;;) {
+      if (stopped()) {
+        return false;
+      }
+      if (PopLocal(worker, task) || Steal(worker, task)) {
+        return true;
+      }
+      if (pending_.load() == 0) {
+        return false;
+      }
+      uint32_t seen = signal_.load();
+      sleepers_.fetch_add(1);
+      if (queued_.load() == 0 && pending_.load() != 0 && !stopped()) {
+        signal_.wait(seen);
+      }
+      sleepers_.fetch_sub(1);
+    }
+  }
+
+  void Wake() {
+    signal_.fetch_add(1);
+    signal_.notify_all();
+  }
+
+  unsigned int worker_count_ = 1;
+  std::unique_ptr<Lane[]> lanes_;
+  size_t seeded_ = 0;
+  std::atomic<uint64_t> pending_{0};
+  std::atomic<uint64_t> queued_{0};
+  std::atomic<uint32_t> signal_{0};
+  std::atomic<uint32_t> sleepers_{0};
+  std::atomic_bool stopped_{false};
+};
+
+} // namespace regkit
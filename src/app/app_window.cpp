@@ -45,6 +45,13 @@
 #include "app/registry_security.h"
 #include "app/ui_helpers.h"
 #include "app/value_dialogs.h"
+#include "registry/compiled_regex.h"
+#include "registry/hive_carver.h"
+#include "registry/ordinal_search.h"
+#include "registry/reg_file_index.h"
+#include "registry/reg_file_tokenizer.h"
+#include "registry/reg_file_writer.h"
+#include "registry/reg_snapshot.h"
 #include "registry/registry_provider.h"
 #include "resource.h"
 #include "win32/icon_resources.h"
@@ -102,10 +109,12 @@ constexpr DWORD kSearchResultsMaxMs = 15;
 constexpr DWORD kSearchResultsRefreshMs = 1000;
 constexpr DWORD kSearchProgressUiMs = 500;
 constexpr size_t kSearchQueueBatch = 128;
+constexpr size_t kSearchPatternColumn = 6;
 constexpr UINT kValueListReadyMessage = WM_APP + 30;
 constexpr UINT kTraceParseBatchMessage = WM_APP + 31;
 constexpr UINT kDefaultParseBatchMessage = WM_APP + 32;
 constexpr UINT kRegFileLoadReadyMessage = WM_APP + 33;
+constexpr UINT kOfflineHiveReadyMessage = WM_APP + 34;
 constexpr UINT_PTR kAddressSubclassId = 1;
 constexpr UINT_PTR kTabSubclassId = 2;
 constexpr UINT_PTR kHeaderSubclassId = 3;
@@ -150,6 +159,7 @@ constexpr int kValueColSize = 5;
 constexpr int kValueColDate = 6;
 constexpr int kValueColDetails = 7;
 constexpr int kValueColComment = 8;
+constexpr uint64_t kParallelRegFileBytes = 16ull * 1024 * 1024;
 
 struct TraceParseBatch {
   std::wstring source_lower;
@@ -852,6 +862,15 @@ bool HasRegExtension(const std::wstring& path) {
   return _wcsicmp(ext.c_str(), L".reg") == 0;
 }
 
+bool HasSnapshotExtension(const std::wstring& path) {
+  size_t dot = path.find_last_of(L'.');
+  if (dot == std::wstring::npos) {
+    return false;
+  }
+  std::wstring ext = path.substr(dot);
+  return _wcsicmp(ext.c_str(), kRegSnapshotExtension) == 0;
+}
+
 std::wstring EnsureRegExtension(std::wstring path) {
   if (path.empty() || HasRegExtension(path)) {
     return path;
@@ -1038,181 +1057,12 @@ std::wstring ToLower(const std::wstring& text) {
   return out;
 }
 
-bool ReadRegFileText(const std::wstring& path, std::wstring* out) {
-  if (!out) {
-    return false;
-  }
-  out->clear();
-  std::string buffer;
-  if (!ReadFileBinary(path, &buffer)) {
-    return false;
-  }
-  if (buffer.size() >= 2 && static_cast<unsigned char>(buffer[0]) == 0xFF && static_cast<unsigned char>(buffer[1]) == 0xFE) {
-    size_t wchar_count = (buffer.size() - 2) / sizeof(wchar_t);
-    out->assign(reinterpret_cast<const wchar_t*>(buffer.data() + 2), wchar_count);
-    return !out->empty();
-  }
-  if (buffer.size() >= 3 && static_cast<unsigned char>(buffer[0]) == 0xEF && static_cast<unsigned char>(buffer[1]) == 0xBB && static_cast<unsigned char>(buffer[2]) == 0xBF) {
-    buffer.erase(0, 3);
-  }
-  *out = util::Utf8ToWide(buffer);
-  return !out->empty();
-}
-
-bool ParseQuotedString(const std::wstring& text, std::wstring* out, size_t* end_pos) {
-  if (!out || text.empty() || text.front() != L'"') {
-    return false;
-  }
-  out->clear();
-  bool escape = false;
-  for (size_t i = 1; i < text.size(); ++i) {
-    wchar_t ch = text[i];
-    if (escape) {
-      switch (ch) {
-      case L'\\':
-        out->push_back(L'\\');
-        break;
-      case L'"':
-        out->push_back(L'"');
-        break;
-      case L'n':
-        out->push_back(L'\n');
-        break;
-      case L'r':
-        out->push_back(L'\r');
-        break;
-      case L't':
-        out->push_back(L'\t');
-        break;
-      case L'0':
-        out->push_back(L'\0');
-        break;
-      default:
-        out->push_back(ch);
-        break;
-      }
-      escape = false;
-      continue;
-    }
-    if (ch == L'\\') {
-      escape = true;
-      continue;
-    }
-    if (ch == L'"') {
-      if (end_pos) {
-        *end_pos = i + 1;
-      }
-      return true;
-    }
-    out->push_back(ch);
-  }
-  return false;
-}
-
-bool ParseHexBytes(const std::wstring& text, std::vector<BYTE>* out) {
-  if (!out) {
-    return false;
-  }
-  out->clear();
-  int nibble = -1;
-  for (wchar_t ch : text) {
-    if (iswxdigit(ch)) {
-      int value = 0;
-      if (ch >= L'0' && ch <= L'9') {
-        value = ch - L'0';
-      } else if (ch >= L'a' && ch <= L'f') {
-        value = 10 + (ch - L'a');
-      } else if (ch >= L'A' && ch <= L'F') {
-        value = 10 + (ch - L'A');
-      }
-      if (nibble < 0) {
-        nibble = value;
-      } else {
-        out->push_back(static_cast<BYTE>((nibble << 4) | value));
-        nibble = -1;
-      }
-    }
-  }
-  return nibble < 0;
-}
-
 std::vector<BYTE> StringToRegData(const std::wstring& text) {
   std::vector<BYTE> data((text.size() + 1) * sizeof(wchar_t));
   memcpy(data.data(), text.c_str(), data.size());
   return data;
 }
 
-bool DecodeRegString(const std::vector<BYTE>& data, std::wstring* out) {
-  if (!out) {
-    return false;
-  }
-  out->clear();
-  if (data.empty()) {
-    return true;
-  }
-  if (data.size() % sizeof(wchar_t) != 0) {
-    return false;
-  }
-  size_t wchar_count = data.size() / sizeof(wchar_t);
-  const wchar_t* raw = reinterpret_cast<const wchar_t*>(data.data());
-  std::wstring text(raw, wchar_count);
-  while (!text.empty() && text.back() == L'\0') {
-    text.pop_back();
-  }
-  if (text.find(L'\0') != std::wstring::npos) {
-    return false;
-  }
-  *out = std::move(text);
-  return true;
-}
-
-std::wstring EscapeRegString(const std::wstring& text) {
-  std::wstring out;
-  out.reserve(text.size());
-  for (wchar_t ch : text) {
-    switch (ch) {
-    case L'\\':
-      out.append(L"\\\\");
-      break;
-    case L'"':
-      out.append(L"\\\"");
-      break;
-    case L'\n':
-      out.append(L"\\n");
-      break;
-    case L'\r':
-      out.append(L"\\r");
-      break;
-    case L'\t':
-      out.append(L"\\t");
-      break;
-    case L'\0':
-      out.append(L"\\0");
-      break;
-    default:
-      out.push_back(ch);
-      break;
-    }
-  }
-  return out;
-}
-
-std::wstring FormatHexBytes(const std::vector<BYTE>& data) {
-  std::wstring out;
-  if (!data.empty()) {
-    out.reserve(data.size() * 3);
-  }
-  for (size_t i = 0; i < data.size(); ++i) {
-    if (i > 0) {
-      out.push_back(L',');
-    }
-    wchar_t buffer[4] = {};
-    swprintf_s(buffer, L"%02x", data[i]);
-    out.append(buffer);
-  }
-  return out;
-}
-
 DWORD RegTypeCode(DWORD type) {
   DWORD base = RegistryProvider::NormalizeValueType(type);
   switch (base) {
@@ -1245,56 +1095,10 @@ DWORD RegTypeCode(DWORD type) {
   }
 }
 
-std::wstring FormatRegValueData(DWORD type, const std::vector<BYTE>& data) {
-  DWORD base = RegistryProvider::NormalizeValueType(type);
-  if (base == REG_SZ) {
-    std::wstring text;
-    if (DecodeRegString(data, &text)) {
-      return L"\"" + EscapeRegString(text) + L"\"";
-    }
-  }
-  if (base == REG_DWORD && data.size() >= sizeof(DWORD)) {
-    DWORD value = 0;
-    memcpy(&value, data.data(), sizeof(DWORD));
-    wchar_t buffer[16] = {};
-    swprintf_s(buffer, L"dword:%08x", value);
-    return buffer;
-  }
-  std::wstring hex = FormatHexBytes(data);
-  if (base == REG_BINARY && type == REG_BINARY) {
-    return L"hex:" + hex;
-  }
-  DWORD code = RegTypeCode(type);
-  wchar_t type_buffer[16] = {};
-  swprintf_s(type_buffer, L"%x", code);
-  return L"hex(" + std::wstring(type_buffer) + L"):" + hex;
-}
-
-bool WriteRegFileText(const std::wstring& path, const std::wstring& text) {
-  HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
-  if (file == INVALID_HANDLE_VALUE) {
-    return false;
-  }
-  const wchar_t bom = 0xFEFF;
-  DWORD written = 0;
-  if (!WriteFile(file, &bom, static_cast<DWORD>(sizeof(bom)), &written, nullptr)) {
-    CloseHandle(file);
-    return false;
-  }
-  if (!text.empty()) {
-    DWORD bytes = static_cast<DWORD>(text.size() * sizeof(wchar_t));
-    if (!WriteFile(file, text.data(), bytes, &written, nullptr)) {
-      CloseHandle(file);
-      return false;
-    }
-  }
-  CloseHandle(file);
-  return true;
-}
-
 struct ParsedRegFileRoot {
   std::wstring name;
   std::shared_ptr<RegistryProvider::VirtualRegistryData> data;
+  std::vector<RegFileSection> sections;
 };
 
 struct RegFileParsePayload {
@@ -1305,29 +1109,63 @@ struct RegFileParsePayload {
   bool cancelled = false;
 };
 
-RegistryProvider::VirtualRegistryKey* EnsureVirtualKey(RegistryProvider::VirtualRegistryKey* root, const std::wstring& subkey) {
-  if (!root) {
-    return nullptr;
-  }
-  if (subkey.empty()) {
-    return root;
+struct OfflineHiveReadyPayload {
+  uint64_t generation = 0;
+  size_t index = 0;
+  HKEY root = nullptr;
+  std::wstring path;
+  std::wstring label;
+  std::wstring error;
+  std::wstring warning;
+};
+
+bool IndexRegFileRange(const std::wstring& path, const RegFileRange& range, std::vector<ParsedRegFileRoot>* roots, const std::atomic_bool* cancel) {
+  RegFileReader reader;
+  if (!reader.Open(path, nullptr) || !reader.Seek(range)) {
+    return false;
   }
-  auto parts = SplitPath(subkey);
-  RegistryProvider::VirtualRegistryKey* current = root;
-  for (const auto& part : parts) {
-    std::wstring lower = ToLower(part);
-    auto it = current->children.find(lower);
-    if (it == current->children.end()) {
-      auto child = std::make_unique<RegistryProvider::VirtualRegistryKey>();
-      child->name = part;
-      it = current->children.emplace(lower, std::move(child)).first;
+
+  std::unordered_map<std::wstring, size_t> root_lookup;
+  auto ensure_root = [&](const std::wstring& root_name) -> ParsedRegFileRoot* {
+    std::wstring lower = ToLower(root_name);
+    auto it = root_lookup.find(lower);
+    if (it != root_lookup.end()) {
+      return &roots->at(it->second);
+    }
+    ParsedRegFileRoot root;
+    root.name = root_name;
+    root.data = std::make_shared<RegistryProvider::VirtualRegistryData>();
+    root.data->root_name = root_name;
+    roots->push_back(std::move(root));
+    root_lookup.emplace(lower, roots->size() - 1);
+    return &roots->back();
+  };
+
+  RegFileToken token;
+  RegFileRange section;
+  while (reader.NextSection(&token, &section)) {
+    if (cancel && cancel->load()) {
+      return false;
+    }
+    if (token.kind != RegFileTokenKind::kKey) {
+      continue;
+    }
+    std::wstring key(token.key);
+    std::wstring normalized = NormalizeTraceKeyPathBasic(key);
+    std::wstring key_path = normalized.empty() ? key : normalized;
+    size_t slash = key_path.find(L'\\');
+    std::wstring root_name = (slash == std::wstring::npos) ? key_path : key_path.substr(0, slash);
+    std::wstring subkey = (slash == std::wstring::npos) ? L"" : key_path.substr(slash + 1);
+    if (root_name.empty()) {
+      continue;
     }
-    current = it->second.get();
+    ParsedRegFileRoot* root = ensure_root(root_name);
+    root->sections.push_back({root->data->hive.CreateKey(subkey), section});
   }
-  return current;
+  return true;
 }
 
-bool ParseRegFileToVirtualRoots(const std::wstring& path, std::vector<ParsedRegFileRoot>* roots, std::wstring* error, const std::atomic_bool* cancel, bool* cancelled) {
+bool IndexRegFileToVirtualRoots(const std::wstring& path, std::vector<ParsedRegFileRoot>* roots, std::wstring* error, const std::atomic_bool* cancel, bool* cancelled) {
   if (!roots) {
     return false;
   }
@@ -1347,217 +1185,77 @@ bool ParseRegFileToVirtualRoots(const std::wstring& path, std::vector<ParsedRegF
   if (is_cancelled()) {
     return false;
   }
-  std::wstring content;
-  if (!ReadRegFileText(path, &content)) {
+  RegFileStamp stamp;
+  RegFileReader reader;
+  if (!StampRegFile(path, &stamp) || !reader.Open(path, nullptr)) {
     if (error) {
       *error = L"Failed to read registry file.";
     }
     return false;
   }
+  unsigned int worker_count = reader.size() < kParallelRegFileBytes ? 1u : std::max(1u, std::thread::hardware_concurrency());
+  std::vector<RegFileRange> ranges = reader.SplitSections(worker_count == 1 ? 1 : worker_count * 4);
+  reader.Close();
 
-  std::vector<std::wstring> lines;
-  std::wstring current;
-  size_t start = 0;
-  while (start < content.size()) {
-    if (is_cancelled()) {
-      return false;
-    }
-    size_t end = content.find(L'\n', start);
-    if (end == std::wstring::npos) {
-      end = content.size();
-    }
-    std::wstring line = content.substr(start, end - start);
-    if (!line.empty() && line.back() == L'\r') {
-      line.pop_back();
-    }
-    start = end + 1;
-    if (current.empty()) {
-      current = line;
-    } else {
-      current.append(line);
-    }
-    std::wstring trimmed_right = current;
-    while (!trimmed_right.empty() && (trimmed_right.back() == L' ' || trimmed_right.back() == L'\t')) {
-      trimmed_right.pop_back();
-    }
-    if (!trimmed_right.empty() && trimmed_right.back() == L'\\') {
-      trimmed_right.pop_back();
-      current = trimmed_right;
-      continue;
+  std::vector<std::vector<ParsedRegFileRoot>> parts(ranges.size());
+  std::atomic_size_t next_range = 0;
+  std::atomic_bool failed = false;
+  auto parse_ranges = [&]() {
+    for (;;) {
+      size_t index = next_range.fetch_add(1);
+      if (index >= ranges.size() || failed.load() || (cancel && cancel->load())) {
+        return;
+      }
+      if (!IndexRegFileRange(path, ranges[index], &parts[index], cancel)) {
+        failed.store(true);
+      }
     }
-    lines.push_back(current);
-    current.clear();
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < std::min<size_t>(worker_count, ranges.size()); ++i) {
+    workers.emplace_back(parse_ranges);
   }
-  if (!current.empty()) {
-    lines.push_back(current);
+  parse_ranges();
+  for (auto& worker : workers) {
+    worker.join();
   }
-
-  std::unordered_map<std::wstring, size_t> root_lookup;
-  auto ensure_root = [&](const std::wstring& root_name) -> RegistryProvider::VirtualRegistryData* {
-    std::wstring lower = ToLower(root_name);
-    auto it = root_lookup.find(lower);
-    if (it != root_lookup.end()) {
-      return roots->at(it->second).data.get();
+  if (is_cancelled()) {
+    return false;
+  }
+  if (failed.load()) {
+    if (error) {
+      *error = L"Failed to read registry file.";
     }
-    ParsedRegFileRoot root;
-    root.name = root_name;
-    root.data = std::make_shared<RegistryProvider::VirtualRegistryData>();
-    root.data->root_name = root_name;
-    root.data->root = std::make_unique<RegistryProvider::VirtualRegistryKey>();
-    root.data->root->name = root_name;
-    roots->push_back(std::move(root));
-    root_lookup.emplace(lower, roots->size() - 1);
-    return roots->back().data.get();
-  };
+    return false;
+  }
 
-  RegistryProvider::VirtualRegistryKey* current_key = nullptr;
-  for (const auto& raw : lines) {
-    if (is_cancelled()) {
-      return false;
-    }
-    std::wstring line = TrimWhitespace(raw);
-    if (line.empty()) {
-      continue;
-    }
-    if (line[0] == L';') {
-      continue;
-    }
-    if (StartsWithInsensitive(line, L"Windows Registry Editor") || StartsWithInsensitive(line, L"REGEDIT4")) {
-      continue;
-    }
-    if (line.front() == L'[' && line.back() == L']') {
-      std::wstring key = line.substr(1, line.size() - 2);
-      key = TrimWhitespace(key);
-      bool delete_key = !key.empty() && key.front() == L'-';
-      if (delete_key) {
-        current_key = nullptr;
-        continue;
-      }
-      std::wstring normalized = NormalizeTraceKeyPathBasic(key);
-      std::wstring key_path = normalized.empty() ? key : normalized;
-      size_t slash = key_path.find(L'\\');
-      std::wstring root_name = (slash == std::wstring::npos) ? key_path : key_path.substr(0, slash);
-      std::wstring subkey = (slash == std::wstring::npos) ? L"" : key_path.substr(slash + 1);
-      if (root_name.empty()) {
-        current_key = nullptr;
+  std::unordered_map<std::wstring, size_t> root_lookup;
+  std::vector<uint32_t> remap;
+  for (auto& part : parts) {
+    for (auto& root : part) {
+      std::wstring lower = ToLower(root.name);
+      auto it = root_lookup.find(lower);
+      if (it == root_lookup.end()) {
+        root_lookup.emplace(lower, roots->size());
+        roots->push_back(std::move(root));
         continue;
       }
-      RegistryProvider::VirtualRegistryData* data = ensure_root(root_name);
-      current_key = data ? EnsureVirtualKey(data->root.get(), subkey) : nullptr;
-      continue;
-    }
-
-    if (!current_key) {
-      continue;
-    }
-    size_t eq = line.find(L'=');
-    if (eq == std::wstring::npos) {
-      continue;
-    }
-    std::wstring name_part = TrimWhitespace(line.substr(0, eq));
-    std::wstring data_part = TrimWhitespace(line.substr(eq + 1));
-    if (name_part.empty() || data_part.empty()) {
-      continue;
-    }
-    if (data_part == L"-") {
-      continue;
-    }
-
-    std::wstring value_name;
-    if (name_part == L"@") {
-      value_name.clear();
-    } else if (name_part.front() == L'"') {
-      size_t end_pos = 0;
-      if (!ParseQuotedString(name_part, &value_name, &end_pos)) {
-        continue;
+      ParsedRegFileRoot& target = roots->at(it->second);
+      target.data->hive.Merge(root.data->hive, &remap);
+      for (auto& section : root.sections) {
+        section.key = remap[section.key];
+        target.sections.push_back(section);
       }
-    } else {
-      continue;
     }
-
-    DWORD type = REG_NONE;
-    std::vector<BYTE> data;
-    if (data_part.front() == L'"') {
-      std::wstring text;
-      size_t end_pos = 0;
-      if (!ParseQuotedString(data_part, &text, &end_pos)) {
-        continue;
-      }
-      type = REG_SZ;
-      data = StringToRegData(text);
-    } else if (StartsWithInsensitive(data_part, L"dword:")) {
-      std::wstring hex = TrimWhitespace(data_part.substr(6));
-      if (hex.empty()) {
-        continue;
-      }
-      DWORD number = static_cast<DWORD>(wcstoul(hex.c_str(), nullptr, 16));
-      type = REG_DWORD;
-      data.resize(sizeof(DWORD));
-      memcpy(data.data(), &number, sizeof(DWORD));
-    } else if (StartsWithInsensitive(data_part, L"hex")) {
-      type = REG_BINARY;
-      size_t colon = data_part.find(L':');
-      if (colon == std::wstring::npos) {
-        continue;
-      }
-      size_t open = data_part.find(L'(');
-      size_t close = data_part.find(L')');
-      if (open != std::wstring::npos && close != std::wstring::npos && close > open) {
-        std::wstring code = data_part.substr(open + 1, close - open - 1);
-        unsigned long parsed = wcstoul(code.c_str(), nullptr, 16);
-        switch (parsed) {
-        case 0x0:
-          type = REG_NONE;
-          break;
-        case 0x1:
-          type = REG_SZ;
-          break;
-        case 0x2:
-          type = REG_EXPAND_SZ;
-          break;
-        case 0x3:
-          type = REG_BINARY;
-          break;
-        case 0x4:
-          type = REG_DWORD;
-          break;
-        case 0x5:
-          type = REG_DWORD_BIG_ENDIAN;
-          break;
-        case 0x7:
-          type = REG_MULTI_SZ;
-          break;
-        case 0x8:
-          type = REG_RESOURCE_LIST;
-          break;
-        case 0x9:
-          type = REG_FULL_RESOURCE_DESCRIPTOR;
-          break;
-        case 0xA:
-          type = REG_RESOURCE_REQUIREMENTS_LIST;
-          break;
-        case 0xB:
-          type = REG_QWORD;
-          break;
-        default:
-          type = REG_BINARY;
-          break;
-        }
-      }
-      std::wstring hex = data_part.substr(colon + 1);
-      if (!ParseHexBytes(hex, &data)) {
-        continue;
-      }
-    } else {
-      continue;
+    part.clear();
+  }
+  for (auto& root : *roots) {
+    root.data->hive.Compact(&remap);
+    for (auto& section : root.sections) {
+      section.key = remap[section.key];
     }
-
-    RegistryProvider::VirtualRegistryValue value;
-    value.name = value_name;
-    value.type = type;
-    value.data = std::move(data);
-    std::wstring name_lower = ToLower(value_name);
-    current_key->values[name_lower] = std::move(value);
+    root.data->source = std::make_shared<RegFileIndex>(path, stamp, std::move(root.sections));
+    root.sections = {};
   }
   return true;
 }
@@ -1571,7 +1269,10 @@ struct TextMatch {
 class TextMatcher {
 public:
   TextMatcher(const std::wstring& query, bool use_regex, bool match_case, bool match_whole, bool* ok) : query_(query), use_regex_(use_regex), match_case_(match_case), match_whole_(match_whole) {
-    if (use_regex_) {
+    if (!use_regex_ && !match_case_) {
+      finder_.Reset(query_);
+    }
+    if (use_regex_ && !compiled_.Compile(query_, match_case_)) {
       try {
         auto flags = std::regex_constants::ECMAScript;
         if (!match_case_) {
@@ -1592,6 +1293,15 @@ public:
       return match;
     }
     if (use_regex_) {
+      RegexMatch compiled_match;
+      if (compiled_.compiled()) {
+        if (match_whole_ ? compiled_.MatchWhole(text, &compiled_match) : compiled_.Search(text, &compiled_match)) {
+          match.matched = true;
+          match.start = compiled_match.start;
+          match.length = compiled_match.length;
+        }
+        return match;
+      }
       std::wsmatch regex_match;
       if (match_whole_) {
         if (std::regex_match(text, regex_match, regex_)) {
@@ -1614,7 +1324,7 @@ public:
           match.start = 0;
           match.length = text.size();
         }
-      } else if (CompareStringOrdinal(text.c_str(), static_cast<int>(text.size()), query_.c_str(), static_cast<int>(query_.size()), TRUE) == CSTR_EQUAL) {
+      } else if (finder_.Equals(text)) {
         match.matched = true;
         match.start = 0;
         match.length = text.size();
@@ -1630,10 +1340,10 @@ public:
         match.length = query_.size();
       }
     } else {
-      int pos = FindStringOrdinal(FIND_FROMSTART, text.c_str(), static_cast<int>(text.size()), query_.c_str(), static_cast<int>(query_.size()), TRUE);
-      if (pos >= 0) {
+      size_t pos = finder_.Find(text);
+      if (pos != std::wstring_view::npos) {
         match.matched = true;
-        match.start = static_cast<size_t>(pos);
+        match.start = pos;
         match.length = query_.size();
       }
     }
@@ -1645,6 +1355,8 @@ private:
   bool use_regex_ = false;
   bool match_case_ = false;
   bool match_whole_ = false;
+  CompiledRegex compiled_;
+  OrdinalFinder finder_;
   std::wregex regex_;
 };
 
@@ -2377,6 +2089,174 @@ std::wstring FileBaseName(const std::wstring& path) {
   return name;
 }
 
+std::wstring DescribeHiveRecovery(HKEY root) {
+  switch (RegistryProvider::OfflineHiveRecovery(root)) {
+    case HiveRecoveryState::kDirtyNoLogs:
+      return L"The hive was not closed cleanly and no transaction logs were found. Recent changes may be missing.";
+    case HiveRecoveryState::kReplayFailed:
+      return L"The hive was not closed cleanly and its transaction logs could not be replayed. Recent changes may be missing.";
+    default:
+      return L"";
+  }
+}
+
+bool CarveHiveToVirtualRoots(const std::wstring& path, std::vector<ParsedRegFileRoot>* roots, std::wstring* error, const std::atomic_bool* cancel, bool* cancelled) {
+  if (!roots) {
+    return false;
+  }
+  roots->clear();
+  if (cancelled) {
+    *cancelled = false;
+  }
+  HiveReader reader;
+  if (!reader.Open(path, error)) {
+    return false;
+  }
+  HiveCarveResult carved;
+  if (!CarveHive(reader, std::max(1u, std::thread::hardware_concurrency()), cancel, &carved)) {
+    if (cancel && cancel->load()) {
+      if (cancelled) {
+        *cancelled = true;
+      }
+    } else if (error) {
+      *error = L"Failed to scan the hive for deleted entries.";
+    }
+    return false;
+  }
+
+  ParsedRegFileRoot parsed;
+  parsed.name = FileNameOnly(path) + L" (Deleted)";
+  parsed.data = std::make_shared<RegistryProvider::VirtualRegistryData>();
+  parsed.data->root_name = parsed.name;
+  parsed.data->read_only = true;
+  VirtualHive& hive = parsed.data->hive;
+
+  auto tagged = [](const std::wstring& name, uint32_t cell) -> std::wstring {
+    wchar_t suffix[16] = {};
+    swprintf_s(suffix, L" [%08X]", cell);
+    return name + suffix;
+  };
+  auto add_value = [&](uint32_t key, const CarvedValue& carved_value, const std::wstring& name) {
+    if (!carved_value.data_recovered) {
+      wchar_t suffix[64] = {};
+      swprintf_s(suffix, L" [unrecovered, type %u, %u bytes]", carved_value.type, carved_value.data_size);
+      hive.SetValue(key, (name.empty() ? std::wstring(L"(Default)") : name) + suffix, REG_NONE, nullptr, 0);
+      return;
+    }
+    hive.SetValue(key, name, carved_value.type, carved_value.data.data(), carved_value.data.size());
+  };
+  auto live_path = [&](uint32_t cell, std::wstring* out) -> bool {
+    std::vector<uint32_t> chain;
+    HiveKeyInfo info;
+    while (cell != reader.root_cell()) {
+      if (chain.size() >= 512 || !IsLiveHiveCell(reader, cell) || !reader.QueryKey(cell, &info)) {
+        return false;
+      }
+      chain.push_back(cell);
+      cell = info.parent;
+    }
+    out->clear();
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+      if (!out->empty()) {
+        out->push_back(L'\\');
+      }
+      reader.KeyName(*it).AppendTo(out);
+    }
+    return true;
+  };
+
+  std::unordered_map<uint32_t, size_t> key_lookup;
+  for (size_t i = 0; i < carved.keys.size(); ++i) {
+    key_lookup.emplace(carved.keys[i].cell, i);
+  }
+  std::vector<uint32_t> placed(carved.keys.size(), VirtualHive::kNoKey);
+  std::vector<uint8_t> visiting(carved.keys.size(), 0);
+  std::function<uint32_t(size_t)> place = [&](size_t index) -> uint32_t {
+    if (placed[index] != VirtualHive::kNoKey) {
+      return placed[index];
+    }
+    const CarvedKey& key = carved.keys[index];
+    visiting[index] = 1;
+    uint32_t parent = VirtualHive::kNoKey;
+    auto parent_it = key_lookup.find(key.parent);
+    std::wstring parent_path;
+    if (parent_it != key_lookup.end()) {
+      if (!visiting[parent_it->second]) {
+        parent = place(parent_it->second);
+      }
+    } else if (live_path(key.parent, &parent_path)) {
+      parent = hive.CreateKey(parent_path);
+    }
+    if (parent == VirtualHive::kNoKey) {
+      parent = hive.CreateKey(L"Orphaned Keys");
+    }
+    visiting[index] = 0;
+    uint32_t child = hive.CreateSubkey(parent, tagged(key.name, key.cell));
+    for (uint32_t value_index : key.values) {
+      add_value(child, carved.values[value_index], carved.values[value_index].name);
+    }
+    placed[index] = child;
+    return child;
+  };
+  for (size_t i = 0; i < carved.keys.size(); ++i) {
+    if (cancel && cancel->load()) {
+      if (cancelled) {
+        *cancelled = true;
+      }
+      return false;
+    }
+    place(i);
+  }
+
+  if (!carved.orphan_values.empty()) {
+    uint32_t orphans = hive.CreateKey(L"Orphaned Values");
+    for (uint32_t value_index : carved.orphan_values) {
+      const CarvedValue& value = carved.values[value_index];
+      add_value(orphans, value, tagged(value.name.empty() ? L"(Default)" : value.name, value.cell));
+    }
+  }
+  if (!carved.security.empty()) {
+    uint32_t security = hive.CreateKey(L"Security Descriptors");
+    for (const CarvedSecurity& entry : carved.security) {
+      wchar_t name[16] = {};
+      swprintf_s(name, L"%08X", entry.cell);
+      hive.SetValue(security, name, REG_BINARY, entry.descriptor.data(), entry.descriptor.size());
+    }
+  }
+  hive.Compact();
+  roots->push_back(std::move(parsed));
+  return true;
+}
+
+bool LoadSnapshotToVirtualRoots(const std::wstring& path, std::vector<ParsedRegFileRoot>* roots, std::wstring* error) {
+  if (!roots) {
+    return false;
+  }
+  roots->clear();
+  auto snapshot = std::make_shared<RegSnapshot>();
+  if (!snapshot->Open(path, error)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < snapshot->SubkeyCount(snapshot->root()); ++i) {
+    uint32_t key = snapshot->Subkey(snapshot->root(), i);
+    ParsedRegFileRoot parsed;
+    parsed.name = snapshot->KeyName(key).ToString();
+    if (parsed.name.empty()) {
+      continue;
+    }
+    parsed.data = std::make_shared<RegistryProvider::VirtualRegistryData>();
+    parsed.data->root_name = parsed.name;
+    parsed.data->snapshot = snapshot;
+    parsed.data->snapshot_key = key;
+    parsed.data->read_only = true;
+    roots->push_back(std::move(parsed));
+  }
+  if (roots->empty() && error) {
+    *error = L"No registry keys were found in the snapshot.";
+  }
+  return !roots->empty();
+}
+
 struct OfflineHiveCandidate {
   std::wstring path;
   std::wstring label;
@@ -3087,6 +2967,8 @@ int CompareSearchResult(const SearchResult& left, const SearchResult& right, int
     return CompareTextInsensitive(left.size_text, right.size_text);
   case 5:
     return CompareTextInsensitive(left.date_text, right.date_text);
+  case 6:
+    return CompareTextInsensitive(left.pattern, right.pattern);
   default:
     return CompareTextInsensitive(left.key_path, right.key_path);
   }
@@ -4189,7 +4071,7 @@ LRESULT MainWindow::HandleMessage(UINT message, WPARAM wparam, LPARAM lparam) {
         continue;
       }
       std::wstring path = buffer;
-      if (HasRegExtension(path)) {
+      if (HasRegExtension(path) || HasSnapshotExtension(path)) {
         reg_paths.push_back(path);
       } else if (offline_candidate.empty()) {
         offline_candidate = path;
@@ -4436,6 +4318,67 @@ LRESULT MainWindow::HandleMessage(UINT message, WPARAM wparam, LPARAM lparam) {
     UpdateValueListForNode(current_node_);
     return 0;
   }
+  case kOfflineHiveReadyMessage: {
+    auto* payload = reinterpret_cast<OfflineHiveReadyPayload*>(lparam);
+    if (!payload) {
+      return 0;
+    }
+    std::unique_ptr<OfflineHiveReadyPayload> owned(payload);
+    if (!offline_load_ || owned->generation != offline_load_->generation) {
+      if (owned->root) {
+        RegistryProvider::CloseOfflineHive(owned->root, nullptr);
+      }
+      return 0;
+    }
+    if (!owned->warning.empty()) {
+      offline_load_->warnings += owned->path + L": " + owned->warning + L"\n";
+    }
+    if (owned->root) {
+      std::vector<size_t>& order = offline_load_->order;
+      auto slot = std::upper_bound(order.begin(), order.end(), owned->index);
+      size_t position = std::min(offline_load_->base + static_cast<size_t>(slot - order.begin()), offline_roots_.size());
+      HKEY before = position < offline_roots_.size() ? offline_roots_[position] : nullptr;
+      order.insert(slot, owned->index);
+      offline_roots_.insert(offline_roots_.begin() + position, owned->root);
+      offline_root_labels_.insert(offline_root_labels_.begin() + position, owned->label);
+      offline_root_paths_.insert(offline_root_paths_.begin() + position, owned->path);
+      RegistryProvider::SetOfflineRoots(offline_roots_);
+      if (registry_mode_ == RegistryMode::kOffline) {
+        RegistryRootEntry root = {owned->root, owned->label, offline_root_name_ + L"\\" + owned->label, L""};
+        auto root_it = std::find_if(roots_.begin(), roots_.end(), [&](const RegistryRootEntry& entry) { return before && entry.root == before; });
+        roots_.insert(root_it, root);
+        tree_.AppendRoot(root, before);
+        if (roots_.size() == 1) {
+          SelectDefaultTreeItem();
+        }
+      }
+    } else {
+      offline_load_->errors += owned->path + L": " + owned->error + L"\n";
+    }
+    if (offline_load_->pending > 0) {
+      --offline_load_->pending;
+    }
+    if (offline_load_->pending == 0) {
+      std::wstring errors = std::move(offline_load_->errors);
+      std::wstring warnings = std::move(offline_load_->warnings);
+      StopOfflineLoad();
+      if (offline_roots_.size() == 1) {
+        offline_root_ = offline_roots_.front();
+        offline_mount_ = offline_root_labels_.front();
+      }
+      if (!errors.empty()) {
+        ui::ShowError(hwnd_, L"Some hives could not be opened:\n\n" + errors);
+      }
+      if (!warnings.empty()) {
+        ui::ShowWarning(hwnd_, warnings);
+      }
+    }
+    if (registry_mode_ == RegistryMode::kOffline) {
+      UpdateOfflineTabText();
+      UpdateStatus();
+    }
+    return 0;
+  }
   case kRegFileLoadReadyMessage: {
     auto* payload = reinterpret_cast<RegFileParsePayload*>(lparam);
     if (!payload) {
@@ -5379,6 +5322,9 @@ LRESULT MainWindow::HandleMessage(UINT message, WPARAM wparam, LPARAM lparam) {
           case 5:
             text = result->date_text.c_str();
             break;
+          case 6:
+            text = result->pattern.c_str();
+            break;
           default:
             text = L"";
             break;
@@ -5712,6 +5658,7 @@ bool MainWindow::OnCreate() {
   StartTreeStateWorker();
   MarkTreeStateDirty();
   StartValueListWorker();
+  StartSearchIndexWorker();
 
   ApplyViewVisibility();
   ApplyAlwaysOnTop();
@@ -5728,6 +5675,7 @@ void MainWindow::OnDestroy() {
   StopDefaultLoadWorker();
   StopValueListWorker();
   StopTreeStateWorker();
+  StopSearchIndexWorker();
   CancelSearch();
   for (auto& entry : tabs_) {
     if (entry.kind == TabEntry::Kind::kRegFile) {
@@ -7149,7 +7097,7 @@ void MainWindow::CreateSearchColumns() {
     return;
   }
   search_columns_ = {
-      {L"Path", 320, LVCFMT_LEFT}, {L"Value", 180, LVCFMT_LEFT}, {L"Type", 110, LVCFMT_LEFT}, {L"Data", 360, LVCFMT_LEFT}, {L"Size", 80, LVCFMT_RIGHT}, {L"Data Modified", 150, LVCFMT_LEFT},
+      {L"Path", 320, LVCFMT_LEFT}, {L"Value", 180, LVCFMT_LEFT}, {L"Type", 110, LVCFMT_LEFT}, {L"Data", 360, LVCFMT_LEFT}, {L"Size", 80, LVCFMT_RIGHT}, {L"Data Modified", 150, LVCFMT_LEFT}, {L"Pattern", 160, LVCFMT_LEFT},
   };
   search_column_widths_.clear();
   search_column_visible_.clear();
@@ -7157,7 +7105,7 @@ void MainWindow::CreateSearchColumns() {
   search_column_visible_.reserve(search_columns_.size());
   for (const auto& column : search_columns_) {
     search_column_widths_.push_back(column.width);
-    search_column_visible_.push_back(true);
+    search_column_visible_.push_back(search_column_visible_.size() != kSearchPatternColumn);
   }
   compare_columns_ = {
       {L"Path", 320, LVCFMT_LEFT},
@@ -7774,7 +7722,13 @@ void MainWindow::UpdateStatus() {
       }
     } else if (search_duration_valid_ && search_duration_ms_ > 0) {
       double seconds = static_cast<double>(search_duration_ms_) / 1000.0;
-      swprintf_s(buffer, L"Results: %llu (%.2fs)", count_value, seconds);
+      uint64_t index_age = search_index_age_.load();
+      if (index_age > 0) {
+        unsigned long long minutes = static_cast<unsigned long long>(index_age / (60ull * 10000000ull));
+        swprintf_s(buffer, L"Results: %llu (%.2fs, from search index %llu min old)", count_value, seconds, minutes);
+      } else {
+        swprintf_s(buffer, L"Results: %llu (%.2fs)", count_value, seconds);
+      }
     } else {
       swprintf_s(buffer, L"Results: %llu", count_value);
     }
@@ -7813,6 +7767,14 @@ void MainWindow::UpdateStatus() {
   values_text = buffer;
   swprintf_s(buffer, L"Selected: %d", selected);
   selected_text = buffer;
+  std::wstring mapping_text;
+  MappedFileStats mapping = {};
+  if (current_node_ && RegistryProvider::OfflineHiveMappingStats(current_node_->root, &mapping)) {
+    uint64_t touches = mapping.hits + mapping.misses;
+    double hit_rate = touches ? 100.0 * static_cast<double>(mapping.hits) / static_cast<double>(touches) : 100.0;
+    swprintf_s(buffer, L"Mapped: %.1f/%.0f MB (%.1f%% hits)", static_cast<double>(mapping.resident_bytes) / (1024.0 * 1024.0), static_cast<double>(mapping.budget_bytes) / (1024.0 * 1024.0), hit_rate);
+    mapping_text = buffer;
+  }
 
   HDC hdc = GetDC(status_bar_);
   HFONT old_font = nullptr;
@@ -7822,6 +7784,7 @@ void MainWindow::UpdateStatus() {
   int values_width = measure_text(hdc, values_text);
   int selected_width = measure_text(hdc, selected_text);
   int keys_width = measure_text(hdc, keys_text);
+  int mapping_width = measure_text(hdc, mapping_text);
   if (old_font) {
     SelectObject(hdc, old_font);
   }
@@ -7833,6 +7796,16 @@ void MainWindow::UpdateStatus() {
   int part2 = std::max(part3 - keys_width, 0);
   int part1 = std::max(part2 - selected_width, 0);
   int part0 = std::max(part1 - values_width, 0);
+  if (!mapping_text.empty()) {
+    int parts[5] = {std::max(part0 - mapping_width, 0), part0, part1, part2, part3};
+    SendMessageW(status_bar_, SB_SETPARTS, 5, reinterpret_cast<LPARAM>(parts));
+    SendMessageW(status_bar_, SB_SETTEXTW, 0, reinterpret_cast<LPARAM>(path_text.c_str()));
+    SendMessageW(status_bar_, SB_SETTEXTW, 1, reinterpret_cast<LPARAM>(mapping_text.c_str()));
+    SendMessageW(status_bar_, SB_SETTEXTW, 2, reinterpret_cast<LPARAM>(values_text.c_str()));
+    SendMessageW(status_bar_, SB_SETTEXTW, 3, reinterpret_cast<LPARAM>(selected_text.c_str()));
+    SendMessageW(status_bar_, SB_SETTEXTW, 4, reinterpret_cast<LPARAM>(keys_text.c_str()));
+    return;
+  }
   int parts[4] = {part0, part1, part2, part3};
   SendMessageW(status_bar_, SB_SETPARTS, 4, reinterpret_cast<LPARAM>(parts));
   SendMessageW(status_bar_, SB_SETTEXTW, 0, reinterpret_cast<LPARAM>(path_text.c_str()));
@@ -7857,6 +7830,14 @@ bool MainWindow::IsRegFileTabSelected() const {
   return IsRegFileTabIndex(index);
 }
 
+bool MainWindow::IsReadOnlyTabSelected() const {
+  if (!IsRegFileTabSelected()) {
+    return false;
+  }
+  int index = TabCtrl_GetCurSel(tab_);
+  return static_cast<size_t>(index) < tabs_.size() && tabs_[static_cast<size_t>(index)].reg_file_read_only;
+}
+
 bool MainWindow::IsCompareTabSelected() const {
   if (!tab_) {
     return false;
@@ -7969,7 +7950,7 @@ void MainWindow::UpdateSearchResultsView() {
     ApplySearchColumns(compare);
     force_redraw = true;
   }
-  int max_sort_col = compare ? 3 : 5;
+  int max_sort_col = compare ? 3 : static_cast<int>(kSearchPatternColumn);
   if (tab.sort_column > max_sort_col) {
     tab.sort_column = -1;
   }
@@ -8104,6 +8085,12 @@ void MainWindow::StartSearch(const SearchDialogResult& options) {
   CancelSearch();
 
   SearchCriteria criteria = options.criteria;
+  if (criteria.queries.size() > 1 && search_column_visible_.size() > kSearchPatternColumn && !search_column_visible_[kSearchPatternColumn]) {
+    search_column_visible_[kSearchPatternColumn] = true;
+    if (!compare_columns_active_) {
+      ApplySearchColumns(false);
+    }
+  }
   criteria.start_nodes = start_nodes;
   criteria.exclude_paths = options.exclude_paths;
 
@@ -8177,6 +8164,7 @@ void MainWindow::StartSearch(const SearchDialogResult& options) {
   search_start_tick_ = GetTickCount64();
   search_duration_ms_ = 0;
   search_duration_valid_ = false;
+  search_index_age_.store(0);
   search_running_ = true;
   search_generation_ += 1;
   uint64_t generation = search_generation_;
@@ -8368,6 +8356,7 @@ void MainWindow::StartSearch(const SearchDialogResult& options) {
           }
         }
       };
+      uint64_t index_age = 0;
       bool ok = SearchRegistryStreaming(
           criteria, &search_cancel_,
           [&](const SearchResult& result) -> bool {
@@ -8378,7 +8367,8 @@ void MainWindow::StartSearch(const SearchDialogResult& options) {
             queue_result(std::move(copy));
             return !should_stop();
           },
-          progress_cb, false);
+          progress_cb, false, &index_age);
+      search_index_age_.store(index_age);
       flush();
       if (!ok) {
         PostMessageW(hwnd_, kSearchFailedMessage, static_cast<WPARAM>(generation), 0);
@@ -8761,7 +8751,7 @@ void MainWindow::UpdateTabText(const std::wstring& text) {
 void MainWindow::MarkOfflineDirty() {
   if (IsRegFileTabSelected()) {
     int index = TabCtrl_GetCurSel(tab_);
-    if (index >= 0 && static_cast<size_t>(index) < tabs_.size() && IsRegFileTabIndex(index)) {
+    if (index >= 0 && static_cast<size_t>(index) < tabs_.size() && IsRegFileTabIndex(index) && !tabs_[static_cast<size_t>(index)].reg_file_read_only) {
       bool was_dirty = tabs_[static_cast<size_t>(index)].reg_file_dirty;
       tabs_[static_cast<size_t>(index)].reg_file_dirty = true;
       if (!was_dirty) {
@@ -9252,6 +9242,7 @@ bool MainWindow::UnloadOfflineRegistry(std::wstring* error) {
   if (error) {
     error->clear();
   }
+  StopOfflineLoad();
   if (offline_roots_.empty()) {
     return true;
   }
@@ -9474,7 +9465,7 @@ bool MainWindow::SwitchToOfflineRegistry() {
 }
 
 bool MainWindow::LoadOfflineRegistryFromPath(const std::wstring& path, bool open_new_tab) {
-  if (registry_mode_ == RegistryMode::kOffline && !offline_roots_.empty()) {
+  if (registry_mode_ == RegistryMode::kOffline && (!offline_roots_.empty() || offline_load_)) {
     std::wstring error;
     if (!UnloadOfflineRegistry(&error)) {
       if (!error.empty()) {
@@ -9511,6 +9502,7 @@ bool MainWindow::LoadOfflineRegistryFromPath(const std::wstring& path, bool open
   }
 
   std::wstring error;
+  std::wstring warnings;
   std::vector<HKEY> handles;
   std::vector<std::wstring> labels;
   std::vector<std::wstring> paths;
@@ -9527,15 +9519,7 @@ bool MainWindow::LoadOfflineRegistryFromPath(const std::wstring& path, bool open
       RegistryProvider::CloseOfflineHive(root, nullptr);
     }
   };
-  for (const auto& candidate : candidates) {
-    HKEY hive_handle = nullptr;
-    if (!RegistryProvider::OpenOfflineHive(candidate.path, &hive_handle, &error)) {
-      close_handles(&handles);
-      if (!error.empty()) {
-        ui::ShowError(hwnd_, error);
-      }
-      return false;
-    }
+  auto candidate_label = [](const OfflineHiveCandidate& candidate) {
     std::wstring label = TrimWhitespace(candidate.label);
     if (label.empty()) {
       label = TrimWhitespace(FileBaseName(candidate.path));
@@ -9543,11 +9527,30 @@ bool MainWindow::LoadOfflineRegistryFromPath(const std::wstring& path, bool open
         label = L"OfflineHive";
       }
     }
-    std::wstring path_name = offline_root_name_ + L"\\" + label;
-    roots.push_back({hive_handle, label, path_name, L""});
-    handles.push_back(hive_handle);
-    labels.push_back(label);
-    paths.push_back(candidate.path);
+    return label;
+  };
+  bool bulk = candidates.size() > 1;
+  if (!bulk) {
+    for (const auto& candidate : candidates) {
+      HKEY hive_handle = nullptr;
+      if (!RegistryProvider::OpenOfflineHive(candidate.path, &hive_handle, &error)) {
+        close_handles(&handles);
+        if (!error.empty()) {
+          ui::ShowError(hwnd_, error);
+        }
+        return false;
+      }
+      std::wstring note = DescribeHiveRecovery(hive_handle);
+      if (!note.empty()) {
+        warnings += candidate.path + L": " + note + L"\n";
+      }
+      std::wstring label = candidate_label(candidate);
+      std::wstring path_name = offline_root_name_ + L"\\" + label;
+      roots.push_back({hive_handle, label, path_name, L""});
+      handles.push_back(hive_handle);
+      labels.push_back(label);
+      paths.push_back(candidate.path);
+    }
   }
 
   if (tab_ && open_new_tab) {
@@ -9579,18 +9582,91 @@ bool MainWindow::LoadOfflineRegistryFromPath(const std::wstring& path, bool open
     offline_root_ = nullptr;
     offline_mount_.clear();
   }
-  RegistryProvider::SetOfflineRoots(offline_roots_);
+  RegistryProvider::SetOfflineRoots(offline_roots_);
+
+  UpdateOfflineTabText();
+  UpdateRegistryTabEntry(RegistryMode::kOffline, selection_path, L"");
+  ApplyRegistryRoots(roots);
+  if (!bulk) {
+    if (!warnings.empty()) {
+      ui::ShowWarning(hwnd_, warnings);
+    }
+    return true;
+  }
+
+  auto session = std::make_unique<OfflineLoadSession>();
+  session->generation = ++offline_load_generation_;
+  session->pending = candidates.size();
+  session->base = offline_roots_.size();
+  for (const auto& candidate : candidates) {
+    session->paths.push_back(candidate.path);
+    session->labels.push_back(candidate_label(candidate));
+  }
+  unsigned int worker_count = std::min<unsigned int>(std::max(1u, std::thread::hardware_concurrency()), static_cast<unsigned int>(candidates.size()));
+  HWND hwnd = hwnd_;
+  OfflineLoadSession* session_ptr = session.get();
+  for (unsigned int i = 0; i < worker_count; ++i) {
+    session->threads.emplace_back([session_ptr, hwnd]() {
+      SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+      for (;;) {
+        size_t index = session_ptr->next.fetch_add(1);
+        if (index >= session_ptr->paths.size() || session_ptr->cancel.load()) {
+          return;
+        }
+        auto payload = std::make_unique<OfflineHiveReadyPayload>();
+        payload->generation = session_ptr->generation;
+        payload->index = index;
+        payload->path = session_ptr->paths[index];
+        payload->label = session_ptr->labels[index];
+        HKEY handle = nullptr;
+        if (RegistryProvider::OpenOfflineHive(payload->path, &handle, &payload->error)) {
+          payload->root = handle;
+          payload->warning = DescribeHiveRecovery(handle);
+          RegistryProvider::IndexOfflineHive(handle, 1, &session_ptr->cancel);
+        } else if (payload->error.empty()) {
+          payload->error = L"Failed to open the hive.";
+        }
+        if (!hwnd || !IsWindow(hwnd) || !PostMessageW(hwnd, kOfflineHiveReadyMessage, 0, reinterpret_cast<LPARAM>(payload.get()))) {
+          if (payload->root) {
+            RegistryProvider::CloseOfflineHive(payload->root, nullptr);
+          }
+          continue;
+        }
+        payload.release();
+      }
+    });
+  }
+  offline_load_ = std::move(session);
+  UpdateStatus();
+  return true;
+}
 
+void MainWindow::UpdateOfflineTabText() {
   std::wstring tab_text = L"Offline Registry";
   if (offline_roots_.size() == 1 && !offline_root_name_.empty() && !offline_mount_.empty()) {
     tab_text = L"Offline Registry (" + offline_root_name_ + L"\\" + offline_mount_ + L")";
   } else if (!offline_root_name_.empty()) {
     tab_text = L"Offline Registry (" + offline_root_name_ + L")";
   }
+  if (offline_load_) {
+    wchar_t progress[64] = {};
+    swprintf_s(progress, L" - %llu/%llu", static_cast<unsigned long long>(offline_load_->paths.size() - offline_load_->pending), static_cast<unsigned long long>(offline_load_->paths.size()));
+    tab_text += progress;
+  }
   UpdateTabText(tab_text);
-  UpdateRegistryTabEntry(RegistryMode::kOffline, selection_path, L"");
-  ApplyRegistryRoots(roots);
-  return true;
+}
+
+void MainWindow::StopOfflineLoad() {
+  if (!offline_load_) {
+    return;
+  }
+  offline_load_->cancel.store(true);
+  for (auto& thread : offline_load_->threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+  offline_load_.reset();
 }
 
 bool MainWindow::SaveOfflineRegistry() {
@@ -9609,13 +9685,6 @@ bool MainWindow::SaveOfflineRegistry() {
         ui::ShowError(hwnd_, L"Failed to resolve offline hive path for saving.");
         return false;
       }
-      DWORD attrs = GetFileAttributesW(path.c_str());
-      if (attrs != INVALID_FILE_ATTRIBUTES) {
-        if (!DeleteFileW(path.c_str())) {
-          ui::ShowError(hwnd_, FormatWin32Error(GetLastError()));
-          return false;
-        }
-      }
       std::wstring error;
       if (!RegistryProvider::SaveOfflineHive(offline_roots_[i], path, &error)) {
         ui::ShowError(hwnd_, error.empty() ? L"Failed to save offline hive." : error);
@@ -9635,14 +9704,6 @@ bool MainWindow::SaveOfflineRegistry() {
     return false;
   }
 
-  DWORD attrs = GetFileAttributesW(path.c_str());
-  if (attrs != INVALID_FILE_ATTRIBUTES) {
-    if (!DeleteFileW(path.c_str())) {
-      ui::ShowError(hwnd_, FormatWin32Error(GetLastError()));
-      return false;
-    }
-  }
-
   std::wstring error;
   if (!RegistryProvider::SaveOfflineHive(offline_root_, path, &error)) {
     ui::ShowError(hwnd_, error.empty() ? L"Failed to save offline hive." : error);
@@ -9977,6 +10038,9 @@ bool MainWindow::ReadSearchResults(const std::wstring& path, std::vector<SearchR
       result.comment = UnescapeHistoryField(parts[9]);
       base_index = 10;
     }
+    if (parts.size() >= 15) {
+      result.pattern = UnescapeHistoryField(parts[14]);
+    }
     result.is_key = (_wtoi(parts[base_index].c_str()) != 0);
     int match_field = _wtoi(parts[base_index + 1].c_str());
     if (match_field < 0 || match_field > static_cast<int>(SearchMatchField::kData)) {
@@ -10032,6 +10096,10 @@ bool MainWindow::WriteSearchResults(const std::wstring& path, const std::vector<
     content.append(std::to_wstring(result.match_start));
     content.push_back(L'\t');
     content.append(std::to_wstring(result.match_length));
+    if (!result.pattern.empty()) {
+      content.push_back(L'\t');
+      content.append(EscapeHistoryField(result.pattern));
+    }
     content.push_back(L'\n');
   }
   std::string utf8 = util::WideToUtf8(content);
@@ -10753,6 +10821,12 @@ void MainWindow::LoadSettings() {
       save_tree_state_ = parse_bool(value);
     } else if (_wcsicmp(key.c_str(), L"save_tabs") == 0) {
       save_tabs_ = parse_bool(value);
+    } else if (_wcsicmp(key.c_str(), L"offline_hive_index") == 0) {
+      offline_hive_index_ = parse_bool(value);
+    } else if (_wcsicmp(key.c_str(), L"search_index") == 0) {
+      search_index_ = parse_bool(value);
+    } else if (_wcsicmp(key.c_str(), L"offline_memory_mb") == 0) {
+      offline_memory_mb_ = static_cast<uint32_t>(std::max(_wtoi(value.c_str()), 0));
     } else if (_wcsicmp(key.c_str(), L"window_x") == 0) {
       window_x_ = _wtoi(value.c_str());
       window_placement_loaded_ = true;
@@ -10888,6 +10962,9 @@ void MainWindow::LoadSettings() {
   if (font_size_set) {
     custom_font_.lfHeight = FontHeightFromPointSize(font_size);
   }
+  RegistryProvider::SetOfflineMemoryBudget(static_cast<uint64_t>(offline_memory_mb_) * 1024 * 1024);
+  RegistryProvider::SetOfflineHiveIndexing(offline_hive_index_);
+  SetSearchIndexing(search_index_);
   NormalizeRecentTraceList();
   NormalizeRecentDefaultList();
 }
@@ -10946,6 +11023,13 @@ void MainWindow::SaveSettings() const {
   content += save_tree_state_ ? L"1\n" : L"0\n";
   content += L"save_tabs=";
   content += save_tabs_ ? L"1\n" : L"0\n";
+  content += L"offline_hive_index=";
+  content += offline_hive_index_ ? L"1\n" : L"0\n";
+  content += L"search_index=";
+  content += search_index_ ? L"1\n" : L"0\n";
+  content += L"offline_memory_mb=";
+  content += std::to_wstring(offline_memory_mb_);
+  content.push_back(L'\n');
   content += L"always_run_as_admin=";
   content += always_run_as_admin_ ? L"1\n" : L"0\n";
   content += L"always_run_as_system=";
@@ -11199,6 +11283,40 @@ void MainWindow::StopTreeStateWorker() {
   }
 }
 
+void MainWindow::StartSearchIndexWorker() {
+  if (!search_index_ || search_index_thread_.joinable()) {
+    return;
+  }
+  search_index_stop_.store(false);
+  search_index_thread_ = std::thread([this]() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+    const HKEY roots[] = {HKEY_LOCAL_MACHINE, HKEY_CURRENT_USER, HKEY_USERS, HKEY_CLASSES_ROOT, HKEY_CURRENT_CONFIG};
+    for (;;) {
+      for (HKEY root : roots) {
+        if (search_index_stop_.load()) {
+          return;
+        }
+        RefreshSearchIndex(root, &search_index_stop_);
+      }
+      std::unique_lock<std::mutex> lock(search_index_mutex_);
+      if (search_index_cv_.wait_for(lock, std::chrono::minutes(5), [this]() { return search_index_stop_.load(); })) {
+        return;
+      }
+    }
+  });
+}
+
+void MainWindow::StopSearchIndexWorker() {
+  {
+    std::lock_guard<std::mutex> lock(search_index_mutex_);
+    search_index_stop_.store(true);
+  }
+  search_index_cv_.notify_one();
+  if (search_index_thread_.joinable()) {
+    search_index_thread_.join();
+  }
+}
+
 void MainWindow::StartValueListWorker() {
   if (value_list_thread_.joinable()) {
     return;
@@ -11789,186 +11907,56 @@ void MainWindow::StartDefaultParseThread(DefaultParseSession* session) {
       payload.release();
     };
 
-    std::wstring content;
-    if (!ReadRegFileText(source, &content)) {
+    RegFileReader reader;
+    if (!reader.Open(source, nullptr)) {
       post_batch(nullptr, true, L"Failed to read registry file.", false);
       return;
     }
-    if (content.empty()) {
-      post_batch(nullptr, true, L"Default file contains no usable entries.", false);
-      return;
-    }
-
     std::vector<KeyValueDialogEntry> entries;
     entries.reserve(kBatchSize);
     uint64_t last_post = GetTickCount64();
     std::wstring current_key;
     std::wstring current_display;
-    std::wstring current;
     bool saw_entry = false;
-
-    size_t start = 0;
-    while (start < content.size()) {
+    RegFileToken token;
+    std::wstring value_name;
+    std::wstring scratch;
+    std::vector<BYTE> data;
+    while (reader.Next(&token)) {
       if (session->cancel.load()) {
         post_batch(nullptr, true, L"", true);
         return;
       }
-      size_t end = content.find(L'\n', start);
-      if (end == std::wstring::npos) {
-        end = content.size();
-      }
-      std::wstring line = content.substr(start, end - start);
-      if (!line.empty() && line.back() == L'\r') {
-        line.pop_back();
-      }
-      start = end + 1;
-      if (current.empty()) {
-        current = line;
-      } else {
-        current.append(line);
-      }
-      std::wstring trimmed_right = current;
-      while (!trimmed_right.empty() && (trimmed_right.back() == L' ' || trimmed_right.back() == L'\t')) {
-        trimmed_right.pop_back();
-      }
-      if (!trimmed_right.empty() && trimmed_right.back() == L'\\') {
-        trimmed_right.pop_back();
-        current = trimmed_right;
-        continue;
-      }
-
-      std::wstring raw = TrimWhitespace(current);
-      current.clear();
-      if (raw.empty() || raw.front() == L';') {
+      if (token.kind == RegFileTokenKind::kDeleteKey) {
+        current_key.clear();
+        current_display.clear();
         continue;
       }
-
-      if (raw.front() == L'[' && raw.back() == L']') {
-        std::wstring key = raw.substr(1, raw.size() - 2);
-        key = TrimWhitespace(key);
-        bool delete_key = !key.empty() && key.front() == L'-';
-        if (delete_key) {
-          current_key.clear();
-          current_display.clear();
-          continue;
-        }
+      if (token.kind == RegFileTokenKind::kKey) {
+        std::wstring key(token.key);
         std::wstring normalized = NormalizeTraceKeyPathBasic(key);
         current_key = normalized.empty() ? key : normalized;
         current_display = NormalizeTraceSelectionPath(key);
         if (current_display.empty()) {
           current_display = current_key;
         }
-        if (!current_key.empty()) {
-          KeyValueDialogEntry entry;
-          entry.key_path = current_key;
-          entry.display_path = current_display;
-          entry.has_value = false;
-          entries.push_back(std::move(entry));
-          saw_entry = true;
-        }
-      } else {
         if (current_key.empty()) {
           continue;
         }
-        size_t eq = raw.find(L'=');
-        if (eq == std::wstring::npos) {
-          continue;
-        }
-        std::wstring name_part = TrimWhitespace(raw.substr(0, eq));
-        std::wstring data_part = TrimWhitespace(raw.substr(eq + 1));
-        if (name_part.empty() || data_part.empty() || data_part == L"-") {
-          continue;
-        }
-
-        std::wstring value_name;
-        if (name_part == L"@") {
-          value_name.clear();
-        } else if (name_part.front() == L'\"') {
-          size_t end_pos = 0;
-          if (!ParseQuotedString(name_part, &value_name, &end_pos)) {
-            continue;
-          }
-        } else {
+        KeyValueDialogEntry entry;
+        entry.key_path = current_key;
+        entry.display_path = current_display;
+        entry.has_value = false;
+        entries.push_back(std::move(entry));
+        saw_entry = true;
+      } else {
+        if (current_key.empty() || token.kind != RegFileTokenKind::kValue) {
           continue;
         }
-
-        DWORD type = REG_NONE;
-        std::vector<BYTE> data;
-        if (data_part.front() == L'\"') {
-          std::wstring text;
-          size_t end_pos = 0;
-          if (!ParseQuotedString(data_part, &text, &end_pos)) {
-            continue;
-          }
-          type = REG_SZ;
-          data = StringToRegData(text);
-        } else if (StartsWithInsensitive(data_part, L"dword:")) {
-          std::wstring hex = TrimWhitespace(data_part.substr(6));
-          if (hex.empty()) {
-            continue;
-          }
-          DWORD number = static_cast<DWORD>(wcstoul(hex.c_str(), nullptr, 16));
-          type = REG_DWORD;
-          data.resize(sizeof(DWORD));
-          memcpy(data.data(), &number, sizeof(DWORD));
-        } else if (StartsWithInsensitive(data_part, L"hex")) {
-          type = REG_BINARY;
-          size_t colon = data_part.find(L':');
-          if (colon == std::wstring::npos) {
-            continue;
-          }
-          size_t open = data_part.find(L'(');
-          size_t close = data_part.find(L')');
-          if (open != std::wstring::npos && close != std::wstring::npos && close > open) {
-            std::wstring code = data_part.substr(open + 1, close - open - 1);
-            unsigned long parsed = wcstoul(code.c_str(), nullptr, 16);
-            switch (parsed) {
-            case 0x0:
-              type = REG_NONE;
-              break;
-            case 0x1:
-              type = REG_SZ;
-              break;
-            case 0x2:
-              type = REG_EXPAND_SZ;
-              break;
-            case 0x3:
-              type = REG_BINARY;
-              break;
-            case 0x4:
-              type = REG_DWORD;
-              break;
-            case 0x5:
-              type = REG_DWORD_BIG_ENDIAN;
-              break;
-            case 0x7:
-              type = REG_MULTI_SZ;
-              break;
-            case 0x8:
-              type = REG_RESOURCE_LIST;
-              break;
-            case 0x9:
-              type = REG_FULL_RESOURCE_DESCRIPTOR;
-              break;
-            case 0xA:
-              type = REG_RESOURCE_REQUIREMENTS_LIST;
-              break;
-            case 0xB:
-              type = REG_QWORD;
-              break;
-            default:
-              type = REG_BINARY;
-              break;
-            }
-          }
-          std::wstring hex = data_part.substr(colon + 1);
-          if (!ParseHexBytes(hex, &data)) {
-            continue;
-          }
-        } else {
+        uint32_t type = REG_NONE;
+        if (!UnescapeRegFileString(token.name, &value_name) || !ParseRegFileValueData(token.data, &type, &data, &scratch)) {
           continue;
         }
-
         KeyValueDialogEntry entry;
         entry.key_path = current_key;
         entry.display_path = current_display;
@@ -14623,188 +14611,42 @@ bool MainWindow::ParseDefaultRegFile(const std::wstring& path, DefaultData* out,
     return false;
   }
   out->values_by_key.clear();
-  std::wstring content;
-  if (!ReadRegFileText(path, &content)) {
+  RegFileReader reader;
+  if (!reader.Open(path, nullptr)) {
     if (error) {
       *error = L"Failed to read registry file.";
     }
     return false;
   }
 
-  std::vector<std::wstring> lines;
-  std::wstring current;
-  size_t start = 0;
-  while (start < content.size()) {
-    size_t end = content.find(L'\n', start);
-    if (end == std::wstring::npos) {
-      end = content.size();
-    }
-    std::wstring line = content.substr(start, end - start);
-    if (!line.empty() && line.back() == L'\r') {
-      line.pop_back();
-    }
-    start = end + 1;
-    if (current.empty()) {
-      current = line;
-    } else {
-      current.append(line);
-    }
-    std::wstring trimmed_right = current;
-    while (!trimmed_right.empty() && (trimmed_right.back() == L' ' || trimmed_right.back() == L'\t')) {
-      trimmed_right.pop_back();
-    }
-    if (!trimmed_right.empty() && trimmed_right.back() == L'\\') {
-      trimmed_right.pop_back();
-      current = trimmed_right;
-      continue;
-    }
-    lines.push_back(current);
-    current.clear();
-  }
-  if (!current.empty()) {
-    lines.push_back(current);
-  }
-
-  std::wstring current_key;
-  for (const auto& raw : lines) {
-    std::wstring line = TrimWhitespace(raw);
-    if (line.empty()) {
-      continue;
-    }
-    if (line[0] == L';') {
+  RegFileToken token;
+  std::wstring value_name;
+  std::wstring scratch;
+  std::vector<BYTE> data;
+  DefaultKeyValues* current_values = nullptr;
+  while (reader.Next(&token)) {
+    if (token.kind == RegFileTokenKind::kDeleteKey) {
+      current_values = nullptr;
       continue;
     }
-    if (line.front() == L'[' && line.back() == L']') {
-      std::wstring key = line.substr(1, line.size() - 2);
-      key = TrimWhitespace(key);
-      bool delete_key = !key.empty() && key.front() == L'-';
-      if (delete_key) {
-        current_key.clear();
-        continue;
-      }
+    if (token.kind == RegFileTokenKind::kKey) {
+      std::wstring key(token.key);
       std::wstring normalized = NormalizeTraceKeyPathBasic(key);
-      current_key = normalized.empty() ? key : normalized;
-      if (!current_key.empty()) {
-        std::wstring key_lower = ToLower(current_key);
-        out->values_by_key.emplace(key_lower, DefaultKeyValues());
-      }
-      continue;
-    }
-    if (current_key.empty()) {
-      continue;
-    }
-    size_t eq = line.find(L'=');
-    if (eq == std::wstring::npos) {
-      continue;
-    }
-    std::wstring name_part = TrimWhitespace(line.substr(0, eq));
-    std::wstring data_part = TrimWhitespace(line.substr(eq + 1));
-    if (name_part.empty() || data_part.empty()) {
-      continue;
-    }
-    if (data_part == L"-") {
-      continue;
-    }
-
-    std::wstring value_name;
-    if (name_part == L"@") {
-      value_name.clear();
-    } else if (name_part.front() == L'"') {
-      size_t end_pos = 0;
-      if (!ParseQuotedString(name_part, &value_name, &end_pos)) {
-        continue;
-      }
-    } else {
+      std::wstring current_key = normalized.empty() ? key : normalized;
+      current_values = current_key.empty() ? nullptr : &out->values_by_key[ToLower(current_key)];
       continue;
     }
-
-    DWORD type = REG_NONE;
-    std::vector<BYTE> data;
-    if (data_part.front() == L'"') {
-      std::wstring text;
-      size_t end_pos = 0;
-      if (!ParseQuotedString(data_part, &text, &end_pos)) {
-        continue;
-      }
-      type = REG_SZ;
-      data = StringToRegData(text);
-    } else if (StartsWithInsensitive(data_part, L"dword:")) {
-      std::wstring hex = TrimWhitespace(data_part.substr(6));
-      if (hex.empty()) {
-        continue;
-      }
-      DWORD number = static_cast<DWORD>(wcstoul(hex.c_str(), nullptr, 16));
-      type = REG_DWORD;
-      data.resize(sizeof(DWORD));
-      memcpy(data.data(), &number, sizeof(DWORD));
-    } else if (StartsWithInsensitive(data_part, L"hex")) {
-      type = REG_BINARY;
-      size_t colon = data_part.find(L':');
-      if (colon == std::wstring::npos) {
-        continue;
-      }
-      size_t open = data_part.find(L'(');
-      size_t close = data_part.find(L')');
-      if (open != std::wstring::npos && close != std::wstring::npos && close > open) {
-        std::wstring code = data_part.substr(open + 1, close - open - 1);
-        unsigned long parsed = wcstoul(code.c_str(), nullptr, 16);
-        switch (parsed) {
-        case 0x0:
-          type = REG_NONE;
-          break;
-        case 0x1:
-          type = REG_SZ;
-          break;
-        case 0x2:
-          type = REG_EXPAND_SZ;
-          break;
-        case 0x3:
-          type = REG_BINARY;
-          break;
-        case 0x4:
-          type = REG_DWORD;
-          break;
-        case 0x5:
-          type = REG_DWORD_BIG_ENDIAN;
-          break;
-        case 0x7:
-          type = REG_MULTI_SZ;
-          break;
-        case 0x8:
-          type = REG_RESOURCE_LIST;
-          break;
-        case 0x9:
-          type = REG_FULL_RESOURCE_DESCRIPTOR;
-          break;
-        case 0xA:
-          type = REG_RESOURCE_REQUIREMENTS_LIST;
-          break;
-        case 0xB:
-          type = REG_QWORD;
-          break;
-        default:
-          type = REG_BINARY;
-          break;
-        }
-      }
-      std::wstring hex = data_part.substr(colon + 1);
-      if (!ParseHexBytes(hex, &data)) {
-        continue;
-      }
-    } else {
+    if (!current_values || token.kind != RegFileTokenKind::kValue) {
       continue;
     }
-
-    std::wstring key_lower = ToLower(current_key);
-    auto it = out->values_by_key.find(key_lower);
-    if (it == out->values_by_key.end()) {
+    uint32_t type = REG_NONE;
+    if (!UnescapeRegFileString(token.name, &value_name) || !ParseRegFileValueData(token.data, &type, &data, &scratch)) {
       continue;
     }
-    std::wstring name_lower = ToLower(value_name);
     DefaultValueEntry entry;
     entry.type = type;
     entry.data = RegistryProvider::FormatValueDataForDisplay(type, data.empty() ? nullptr : data.data(), static_cast<DWORD>(data.size()));
-    it->second.values[name_lower] = std::move(entry);
+    current_values->values[ToLower(value_name)] = std::move(entry);
   }
   if (out->values_by_key.empty()) {
     if (error) {
@@ -15308,15 +15150,12 @@ bool MainWindow::SaveRegFileTab(int tab_index) {
     return false;
   }
   TabEntry& entry = tabs_[static_cast<size_t>(tab_index)];
-  if (entry.reg_file_path.empty()) {
+  if (entry.reg_file_path.empty() || entry.reg_file_read_only) {
     return false;
   }
-  std::wstring content;
-  if (!BuildRegFileContent(entry, &content)) {
-    return false;
-  }
-  if (!WriteRegFileText(entry.reg_file_path, content)) {
-    ui::ShowError(hwnd_, L"Failed to save registry file.");
+  std::wstring error;
+  if (!WriteRegFileTab(entry, entry.reg_file_path, &error)) {
+    ui::ShowError(hwnd_, error.empty() ? L"Failed to save registry file." : error);
     return false;
   }
   if (entry.reg_file_dirty) {
@@ -15333,103 +15172,113 @@ bool MainWindow::ExportRegFileTab(int tab_index, const std::wstring& path) {
   if (path.empty()) {
     return false;
   }
-  std::wstring content;
-  if (!BuildRegFileContent(tabs_[static_cast<size_t>(tab_index)], &content)) {
-    return false;
+  if (HasSnapshotExtension(path)) {
+    std::vector<RegistryNode> nodes;
+    for (const auto& root : tabs_[static_cast<size_t>(tab_index)].reg_file_roots) {
+      if (!root.root) {
+        continue;
+      }
+      RegistryNode node;
+      node.root = root.root;
+      node.root_name = root.name;
+      nodes.push_back(std::move(node));
+    }
+    std::wstring error;
+    if (!ExportRegSnapshot(nodes, path, &error)) {
+      ui::ShowError(hwnd_, error.empty() ? L"Failed to export registry snapshot." : error);
+      return false;
+    }
+    return true;
   }
   std::wstring target = EnsureRegExtension(path);
-  if (!WriteRegFileText(target, content)) {
-    ui::ShowError(hwnd_, L"Failed to export registry file.");
+  std::wstring error;
+  if (!WriteRegFileTab(tabs_[static_cast<size_t>(tab_index)], target, &error)) {
+    ui::ShowError(hwnd_, error.empty() ? L"Failed to export registry file." : error);
     return false;
   }
   return true;
 }
 
-bool MainWindow::BuildRegFileContent(const TabEntry& entry, std::wstring* out) const {
-  if (!out) {
-    return false;
-  }
-  out->clear();
+bool MainWindow::WriteRegFileTab(const TabEntry& entry, const std::wstring& path, std::wstring* error) const {
   if (entry.kind != TabEntry::Kind::kRegFile) {
     return false;
   }
 
-  out->append(L"Windows Registry Editor Version 5.00\r\n");
-  std::function<void(const RegistryProvider::VirtualRegistryKey&, const std::wstring&)> append_key;
-  append_key = [&](const RegistryProvider::VirtualRegistryKey& key, const std::wstring& full_path) {
-    std::vector<const RegistryProvider::VirtualRegistryValue*> values;
-    values.reserve(key.values.size());
-    for (const auto& entry_value : key.values) {
-      values.push_back(&entry_value.second);
+  std::vector<RegFileSaveRoot> splice_roots;
+  for (const auto& root : entry.reg_file_roots) {
+    if (!root.data || !root.data->source) {
+      splice_roots.clear();
+      break;
     }
-    std::sort(values.begin(), values.end(), [](const RegistryProvider::VirtualRegistryValue* left, const RegistryProvider::VirtualRegistryValue* right) {
-      if (!left || !right) {
-        return left != nullptr;
-      }
-      bool left_default = left->name.empty();
-      bool right_default = right->name.empty();
-      if (left_default != right_default) {
-        return left_default;
-      }
-      return _wcsicmp(left->name.c_str(), right->name.c_str()) < 0;
-    });
+    splice_roots.push_back({root.name.empty() ? root.data->root_name : root.name, &root.data->hive, root.data->source.get()});
+  }
+  if (!splice_roots.empty()) {
+    return RegFileIndex::Save(path, splice_roots, error);
+  }
 
-    if (!values.empty()) {
-      out->append(L"\r\n");
-      out->append(L"[");
-      out->append(full_path);
-      out->append(L"]\r\n");
-      for (const auto* value : values) {
-        if (!value) {
-          continue;
-        }
-        if (value->name.empty()) {
-          out->append(L"@=");
-        } else {
-          out->append(L"\"");
-          out->append(EscapeRegString(value->name));
-          out->append(L"\"=");
-        }
-        out->append(FormatRegValueData(value->type, value->data));
-        out->append(L"\r\n");
+  RegFileWriter writer;
+  if (!writer.Open(path, nullptr)) {
+    return false;
+  }
+  std::wstring full_path;
+  std::function<void(const VirtualHive&, uint32_t)> append_key;
+  append_key = [&](const VirtualHive& hive, uint32_t key) {
+    if (hive.ValueCount(key) > 0) {
+      writer.BeginKey(full_path);
+      for (uint32_t i = 0; i < hive.ValueCount(key); ++i) {
+        VirtualHiveValue value = hive.Value(key, i);
+        writer.WriteValue(value.name, RegTypeCode(value.type), value.data, value.size);
       }
     }
-
-    std::vector<const RegistryProvider::VirtualRegistryKey*> children;
-    children.reserve(key.children.size());
-    for (const auto& child : key.children) {
-      if (child.second) {
-        children.push_back(child.second.get());
-      }
+    for (uint32_t i = 0; i < hive.SubkeyCount(key); ++i) {
+      uint32_t child = hive.Subkey(key, i);
+      size_t length = full_path.size();
+      full_path.push_back(L'\\');
+      full_path.append(hive.KeyName(child));
+      append_key(hive, child);
+      full_path.resize(length);
     }
-    std::sort(children.begin(), children.end(), [](const RegistryProvider::VirtualRegistryKey* left, const RegistryProvider::VirtualRegistryKey* right) {
-      if (!left || !right) {
-        return left != nullptr;
-      }
-      return _wcsicmp(left->name.c_str(), right->name.c_str()) < 0;
-    });
-    for (const auto* child : children) {
-      if (!child) {
+  };
+  std::function<void(const RegSnapshot&, uint32_t)> append_snapshot_key;
+  append_snapshot_key = [&](const RegSnapshot& snapshot, uint32_t key) {
+    if (snapshot.ValueCount(key) > 0) {
+      writer.BeginKey(full_path);
+      for (uint32_t i = 0; i < snapshot.ValueCount(key); ++i) {
+        RegSnapshotValue value = snapshot.Value(key, i);
+        writer.WriteValue(value.name.ToString(), RegTypeCode(value.type), value.data, value.size);
+      }
+    }
+    for (uint32_t i = 0; i < snapshot.SubkeyCount(key); ++i) {
+      uint32_t child = snapshot.Subkey(key, i);
+      if (child == RegSnapshot::kNoKey) {
         continue;
       }
-      append_key(*child, full_path + L"\\" + child->name);
+      size_t length = full_path.size();
+      full_path.push_back(L'\\');
+      snapshot.KeyName(child).AppendTo(&full_path);
+      append_snapshot_key(snapshot, child);
+      full_path.resize(length);
     }
   };
 
   for (const auto& root : entry.reg_file_roots) {
-    if (!root.data || !root.data->root) {
+    if (!root.data) {
       continue;
     }
-    std::wstring root_name = root.name;
-    if (root_name.empty()) {
-      root_name = root.data->root_name;
+    full_path = root.name;
+    if (full_path.empty()) {
+      full_path = root.data->root_name;
     }
-    if (root_name.empty()) {
+    if (full_path.empty()) {
       continue;
     }
-    append_key(*root.data->root, root_name);
+    if (root.data->snapshot) {
+      append_snapshot_key(*root.data->snapshot, root.data->snapshot_key);
+    } else {
+      append_key(root.data->hive, root.data->hive.root());
+    }
   }
-  return true;
+  return writer.Close(nullptr);
 }
 
 void MainWindow::ReleaseRegFileRoots(TabEntry* entry) {
@@ -15458,6 +15307,21 @@ bool MainWindow::OpenRegFileTab(const std::wstring& path) {
   if (label.empty()) {
     label = L"Registry File";
   }
+  return OpenParsedFileTab(path, label, std::wstring());
+}
+
+bool MainWindow::OpenRecoveredHiveTab(const std::wstring& hive_path) {
+  if (!tab_ || hive_path.empty()) {
+    return false;
+  }
+  if (!FileExists(hive_path)) {
+    ui::ShowError(hwnd_, L"Hive file not found.");
+    return false;
+  }
+  return OpenParsedFileTab(hive_path + L"::deleted", L"Deleted: " + FileNameOnly(hive_path), hive_path);
+}
+
+bool MainWindow::OpenParsedFileTab(const std::wstring& path, const std::wstring& label, const std::wstring& hive_path) {
   std::wstring path_lower = ToLower(path);
   auto start_parse = [&]() {
     if (reg_file_parse_sessions_.find(path_lower) != reg_file_parse_sessions_.end()) {
@@ -15466,6 +15330,7 @@ bool MainWindow::OpenRegFileTab(const std::wstring& path) {
     auto session = std::make_unique<RegFileParseSession>();
     session->source_path = path;
     session->source_lower = path_lower;
+    session->hive_path = hive_path;
     HWND hwnd = hwnd_;
     RegFileParseSession* session_ptr = session.get();
     session->thread = std::thread([this, session_ptr, hwnd]() {
@@ -15475,10 +15340,16 @@ bool MainWindow::OpenRegFileTab(const std::wstring& path) {
       std::wstring parse_error;
       std::vector<ParsedRegFileRoot> parsed_roots;
       bool cancelled = false;
-      if (!ParseRegFileToVirtualRoots(payload->source_path, &parsed_roots, &parse_error, &session_ptr->cancel, &cancelled)) {
-        if (!cancelled && parse_error.empty()) {
-          parse_error = L"Failed to read registry file.";
-        }
+      bool parsed = false;
+      if (!session_ptr->hive_path.empty()) {
+        parsed = CarveHiveToVirtualRoots(session_ptr->hive_path, &parsed_roots, &parse_error, &session_ptr->cancel, &cancelled);
+      } else if (HasSnapshotExtension(payload->source_path)) {
+        parsed = LoadSnapshotToVirtualRoots(payload->source_path, &parsed_roots, &parse_error);
+      } else {
+        parsed = IndexRegFileToVirtualRoots(payload->source_path, &parsed_roots, &parse_error, &session_ptr->cancel, &cancelled);
+      }
+      if (!parsed && !cancelled && parse_error.empty()) {
+        parse_error = L"Failed to read registry file.";
       }
       payload->roots = std::move(parsed_roots);
       payload->error = std::move(parse_error);
@@ -15524,6 +15395,7 @@ bool MainWindow::OpenRegFileTab(const std::wstring& path) {
   entry.reg_file_label = label;
   entry.reg_file_dirty = false;
   entry.reg_file_loading = true;
+  entry.reg_file_read_only = !hive_path.empty() || HasSnapshotExtension(path);
   tabs_.push_back(std::move(entry));
   UpdateTabWidth();
   TabCtrl_SetCurSel(tab_, index);
@@ -32,6 +32,7 @@
 #include "app/theme.h"
 #include "app/ui_helpers.h"
 #include "app/value_dialogs.h"
+#include "registry/reg_file_tokenizer.h"
 #include "registry/registry_provider.h"
 #include "registry/search_engine.h"
 #include "resource.h"
@@ -204,12 +205,6 @@ std::wstring LeafName(const RegistryNode& node) {
   return node.subkey.substr(pos + 1);
 }
 
-std::vector<BYTE> StringToRegData(const std::wstring& text) {
-  std::vector<BYTE> data((text.size() + 1) * sizeof(wchar_t));
-  memcpy(data.data(), text.c_str(), data.size());
-  return data;
-}
-
 bool SelectValueByName(ValueList& list, const std::wstring& name) {
   for (size_t i = 0; i < list.RowCount(); ++i) {
     const ListRow* row = list.RowAt(static_cast<int>(i));
@@ -659,309 +654,53 @@ void ApplyEditCustomBorder(HWND parent, int id) {
   SetWindowPos(ctrl, nullptr, 0, 0, 0, 0, SWP_NOZORDER | SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE | SWP_FRAMECHANGED);
 }
 
-bool ReadRegFileText(const std::wstring& path, std::wstring* out) {
-  if (!out) {
-    return false;
-  }
-  out->clear();
-  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
-  if (file == INVALID_HANDLE_VALUE) {
-    return false;
-  }
-  LARGE_INTEGER size = {};
-  if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || size.QuadPart > static_cast<LONGLONG>(32 * 1024 * 1024)) {
-    CloseHandle(file);
-    return false;
-  }
-  std::string buffer(static_cast<size_t>(size.QuadPart), '\0');
-  DWORD read = 0;
-  bool ok = ReadFile(file, buffer.data(), static_cast<DWORD>(buffer.size()), &read, nullptr) != 0;
-  CloseHandle(file);
-  if (!ok || read == 0) {
-    return false;
-  }
-  buffer.resize(read);
-  if (buffer.size() >= 2 && static_cast<unsigned char>(buffer[0]) == 0xFF && static_cast<unsigned char>(buffer[1]) == 0xFE) {
-    size_t wchar_count = (buffer.size() - 2) / sizeof(wchar_t);
-    out->assign(reinterpret_cast<const wchar_t*>(buffer.data() + 2), wchar_count);
-    return !out->empty();
-  }
-  if (buffer.size() >= 3 && static_cast<unsigned char>(buffer[0]) == 0xEF && static_cast<unsigned char>(buffer[1]) == 0xBB && static_cast<unsigned char>(buffer[2]) == 0xBF) {
-    buffer.erase(0, 3);
-  }
-  *out = util::Utf8ToWide(buffer);
-  return !out->empty();
-}
-
-bool ParseQuotedString(const std::wstring& text, std::wstring* out, size_t* end_pos) {
-  if (!out || text.empty() || text.front() != L'"') {
-    return false;
-  }
-  out->clear();
-  bool escape = false;
-  for (size_t i = 1; i < text.size(); ++i) {
-    wchar_t ch = text[i];
-    if (escape) {
-      switch (ch) {
-      case L'\\':
-        out->push_back(L'\\');
-        break;
-      case L'"':
-        out->push_back(L'"');
-        break;
-      case L'n':
-        out->push_back(L'\n');
-        break;
-      case L'r':
-        out->push_back(L'\r');
-        break;
-      case L't':
-        out->push_back(L'\t');
-        break;
-      case L'0':
-        out->push_back(L'\0');
-        break;
-      default:
-        out->push_back(ch);
-        break;
-      }
-      escape = false;
-      continue;
-    }
-    if (ch == L'\\') {
-      escape = true;
-      continue;
-    }
-    if (ch == L'"') {
-      if (end_pos) {
-        *end_pos = i + 1;
-      }
-      return true;
-    }
-    out->push_back(ch);
-  }
-  return false;
-}
-
-bool ParseHexBytes(const std::wstring& text, std::vector<BYTE>* out) {
-  if (!out) {
-    return false;
-  }
-  out->clear();
-  int nibble = -1;
-  for (wchar_t ch : text) {
-    if (iswxdigit(ch)) {
-      int value = 0;
-      if (ch >= L'0' && ch <= L'9') {
-        value = ch - L'0';
-      } else if (ch >= L'a' && ch <= L'f') {
-        value = 10 + (ch - L'a');
-      } else if (ch >= L'A' && ch <= L'F') {
-        value = 10 + (ch - L'A');
-      }
-      if (nibble < 0) {
-        nibble = value;
-      } else {
-        out->push_back(static_cast<BYTE>((nibble << 4) | value));
-        nibble = -1;
-      }
-    }
-  }
-  return nibble < 0;
-}
-
 bool ParseRegFile(const std::wstring& path, RegFileData* out, std::wstring* error) {
   if (!out) {
     return false;
   }
   out->keys.clear();
   out->key_order.clear();
-  std::wstring content;
-  if (!ReadRegFileText(path, &content)) {
+  RegFileReader reader;
+  if (!reader.Open(path, nullptr)) {
     if (error) {
       *error = L"Failed to read registry file.";
     }
     return false;
   }
 
-  std::vector<std::wstring> lines;
-  std::wstring current;
-  size_t start = 0;
-  while (start < content.size()) {
-    size_t end = content.find(L'\n', start);
-    if (end == std::wstring::npos) {
-      end = content.size();
-    }
-    std::wstring line = content.substr(start, end - start);
-    if (!line.empty() && line.back() == L'\r') {
-      line.pop_back();
-    }
-    start = end + 1;
-    if (current.empty()) {
-      current = line;
-    } else {
-      current.append(line);
-    }
-    std::wstring trimmed_right = current;
-    while (!trimmed_right.empty() && (trimmed_right.back() == L' ' || trimmed_right.back() == L'\t')) {
-      trimmed_right.pop_back();
-    }
-    if (!trimmed_right.empty() && trimmed_right.back() == L'\\') {
-      trimmed_right.pop_back();
-      current = trimmed_right;
-      continue;
-    }
-    lines.push_back(current);
-    current.clear();
-  }
-  if (!current.empty()) {
-    lines.push_back(current);
-  }
-
-  std::wstring current_key;
-  for (const auto& raw : lines) {
-    std::wstring line = TrimWhitespace(raw);
-    if (line.empty()) {
+  RegFileToken token;
+  std::wstring scratch;
+  RegFileKey* current_key = nullptr;
+  while (reader.Next(&token)) {
+    if (token.kind == RegFileTokenKind::kDeleteKey) {
+      current_key = nullptr;
       continue;
     }
-    if (line[0] == L';') {
-      continue;
-    }
-    if (line.front() == L'[' && line.back() == L']') {
-      std::wstring key = line.substr(1, line.size() - 2);
-      key = TrimWhitespace(key);
-      bool delete_key = !key.empty() && key.front() == L'-';
-      if (delete_key) {
-        current_key.clear();
+    if (token.kind == RegFileTokenKind::kKey) {
+      current_key = nullptr;
+      if (token.key.empty()) {
         continue;
       }
-      current_key = key;
-      if (!current_key.empty()) {
-        std::wstring key_lower = ToLower(current_key);
-        if (out->keys.find(key_lower) == out->keys.end()) {
-          RegFileKey entry;
-          entry.path = current_key;
-          out->keys.emplace(key_lower, std::move(entry));
-          out->key_order.push_back(current_key);
-        }
+      std::wstring key(token.key);
+      auto inserted = out->keys.try_emplace(ToLower(key));
+      if (inserted.second) {
+        inserted.first->second.path = key;
+        out->key_order.push_back(key);
       }
+      current_key = &inserted.first->second;
       continue;
     }
-    if (current_key.empty()) {
-      continue;
-    }
-    size_t eq = line.find(L'=');
-    if (eq == std::wstring::npos) {
-      continue;
-    }
-    std::wstring name_part = TrimWhitespace(line.substr(0, eq));
-    std::wstring data_part = TrimWhitespace(line.substr(eq + 1));
-    if (name_part.empty() || data_part.empty()) {
-      continue;
-    }
-    if (data_part == L"-") {
-      continue;
-    }
-
-    std::wstring value_name;
-    if (name_part == L"@") {
-      value_name.clear();
-    } else if (name_part.front() == L'"') {
-      size_t end_pos = 0;
-      if (!ParseQuotedString(name_part, &value_name, &end_pos)) {
-        continue;
-      }
-    } else {
+    if (!current_key || token.kind != RegFileTokenKind::kValue) {
       continue;
     }
-
     RegFileValue value;
-    value.name = value_name;
-    if (data_part.front() == L'"') {
-      std::wstring text;
-      size_t end_pos = 0;
-      if (!ParseQuotedString(data_part, &text, &end_pos)) {
-        continue;
-      }
-      value.type = REG_SZ;
-      value.data = StringToRegData(text);
-    } else if (StartsWithInsensitive(data_part, L"dword:")) {
-      std::wstring hex = TrimWhitespace(data_part.substr(6));
-      if (hex.empty()) {
-        continue;
-      }
-      DWORD number = static_cast<DWORD>(wcstoul(hex.c_str(), nullptr, 16));
-      value.type = REG_DWORD;
-      value.data.resize(sizeof(DWORD));
-      memcpy(value.data.data(), &number, sizeof(DWORD));
-    } else if (StartsWithInsensitive(data_part, L"hex")) {
-      DWORD type = REG_BINARY;
-      size_t colon = data_part.find(L':');
-      if (colon == std::wstring::npos) {
-        continue;
-      }
-      size_t open = data_part.find(L'(');
-      size_t close = data_part.find(L')');
-      if (open != std::wstring::npos && close != std::wstring::npos && close > open) {
-        std::wstring code = data_part.substr(open + 1, close - open - 1);
-        unsigned long parsed = wcstoul(code.c_str(), nullptr, 16);
-        switch (parsed) {
-        case 0x0:
-          type = REG_NONE;
-          break;
-        case 0x1:
-          type = REG_SZ;
-          break;
-        case 0x2:
-          type = REG_EXPAND_SZ;
-          break;
-        case 0x3:
-          type = REG_BINARY;
-          break;
-        case 0x4:
-          type = REG_DWORD;
-          break;
-        case 0x5:
-          type = REG_DWORD_BIG_ENDIAN;
-          break;
-        case 0x7:
-          type = REG_MULTI_SZ;
-          break;
-        case 0x8:
-          type = REG_RESOURCE_LIST;
-          break;
-        case 0x9:
-          type = REG_FULL_RESOURCE_DESCRIPTOR;
-          break;
-        case 0xA:
-          type = REG_RESOURCE_REQUIREMENTS_LIST;
-          break;
-        case 0xB:
-          type = REG_QWORD;
-          break;
-        default:
-          type = REG_BINARY;
-          break;
-        }
-      }
-      std::wstring hex = data_part.substr(colon + 1);
-      std::vector<BYTE> bytes;
-      if (!ParseHexBytes(hex, &bytes)) {
-        continue;
-      }
-      value.type = type;
-      value.data = std::move(bytes);
-    } else {
-      continue;
-    }
-
-    std::wstring key_lower = ToLower(current_key);
-    auto it = out->keys.find(key_lower);
-    if (it == out->keys.end()) {
+    uint32_t type = REG_NONE;
+    if (!UnescapeRegFileString(token.name, &value.name) || !ParseRegFileValueData(token.data, &type, &value.data, &scratch)) {
       continue;
     }
+    value.type = type;
     std::wstring name_lower = ToLower(value.name);
-    it->second.values[name_lower] = std::move(value);
+    current_key->values[name_lower] = std::move(value);
   }
   return true;
 }
@@ -1485,6 +1224,10 @@ std::wstring MainWindow::CommandTooltipText(int command_id) const {
 }
 
 bool MainWindow::EnsureWritable() {
+  if (IsReadOnlyTabSelected()) {
+    ui::ShowWarning(hwnd_, L"Recovered entries are read-only.");
+    return false;
+  }
   if (!read_only_) {
     return true;
   }
@@ -1495,7 +1238,7 @@ bool MainWindow::EnsureWritable() {
 void MainWindow::BuildMenus() {
   SyncReplaceRegeditState();
   menu_items_.clear();
-  bool can_modify = !read_only_;
+  bool can_modify = !read_only_ && !IsReadOnlyTabSelected();
   HMENU menu = CreateMenu();
   HMENU file_menu = CreatePopupMenu();
   auto append_menu = [&](HMENU target, UINT flags, int command, const wchar_t* text) {
@@ -1540,6 +1283,7 @@ void MainWindow::BuildMenus() {
   append_menu(file_menu, offline_flags, cmd::kRegistryOffline, L"Offline Registry...");
   UINT save_offline_flags = MF_STRING | ((registry_mode_ == RegistryMode::kOffline && !offline_mount_.empty()) ? 0 : MF_GRAYED);
   append_menu(file_menu, save_offline_flags, cmd::kFileSaveOfflineHive, L"Save Offline Hive...");
+  append_menu(file_menu, MF_STRING, cmd::kFileRecoverDeleted, L"Recover Deleted Entries...");
   AppendMenuW(file_menu, MF_SEPARATOR, 0, nullptr);
   UINT clear_flags = MF_STRING | (clear_history_on_exit_ ? MF_CHECKED : MF_UNCHECKED);
   append_menu(file_menu, clear_flags, cmd::kFileClearHistoryOnExit, L"Clear History on Exit");
@@ -1940,7 +1684,7 @@ bool MainWindow::HandleMenuCommand(int command_id) {
     if (IsRegFileTabSelected()) {
       int tab_index = TabCtrl_GetCurSel(tab_);
       std::wstring path;
-      if (!PromptSaveFilePath(hwnd_, L"Registry Files (*.reg)\0*.reg\0All Files (*.*)\0*.*\0\0", &path)) {
+      if (!PromptSaveFilePath(hwnd_, L"Registry Files (*.reg)\0*.reg\0Registry Snapshots (*.rksnap)\0*.rksnap\0All Files (*.*)\0*.*\0\0", &path)) {
         return true;
       }
       ExportRegFileTab(tab_index, path);
@@ -1983,16 +1727,14 @@ bool MainWindow::HandleMenuCommand(int command_id) {
         dedupe(&selected_values);
         dedupe(&selected_keys);
         std::wstring error;
-        std::wstring path = RegistryProvider::BuildPath(*current_node_);
-        if (!ExportRegFileSelection(hwnd_, path, selected_values, selected_keys, &error) && !error.empty()) {
+        if (!ExportRegFileSelection(hwnd_, *current_node_, selected_values, selected_keys, &error) && !error.empty()) {
           ui::ShowError(hwnd_, error);
         }
         return true;
       }
     }
     std::wstring error;
-    std::wstring path = RegistryProvider::BuildPath(*current_node_);
-    if (!ExportRegFile(hwnd_, path, &error) && !error.empty()) {
+    if (!ExportRegFile(hwnd_, *current_node_, &error) && !error.empty()) {
       ui::ShowError(hwnd_, error);
     }
     return true;
@@ -2062,6 +1804,13 @@ bool MainWindow::HandleMenuCommand(int command_id) {
   case cmd::kFileSaveOfflineHive:
     SaveOfflineRegistry();
     return true;
+  case cmd::kFileRecoverDeleted: {
+    std::wstring path;
+    if (PromptOpenFilePath(hwnd_, L"Hive Files (*.*)\0*.*\0\0", &path)) {
+      OpenRecoveredHiveTab(path);
+    }
+    return true;
+  }
   case cmd::kFileClearHistoryOnExit:
     clear_history_on_exit_ = !clear_history_on_exit_;
     SaveSettings();
@@ -4117,7 +3866,7 @@ void MainWindow::ShowTreeContextMenu(POINT screen_pt) {
   bool has_node = node != nullptr;
   bool can_rename = has_node && !node->subkey.empty();
   bool is_simulated = has_node && node->simulated;
-  bool can_modify = !read_only_;
+  bool can_modify = !read_only_ && !IsReadOnlyTabSelected();
   UINT edit_flags = MF_STRING | (has_node ? 0 : MF_GRAYED);
   UINT modify_flags = MF_STRING | ((has_node && can_modify) ? 0 : MF_GRAYED);
   UINT rename_flags = MF_STRING | ((can_rename && can_modify) ? 0 : MF_GRAYED);
@@ -18,6 +18,7 @@
 
 #include <cwchar>
 #include <cwctype>
+#include <type_traits>
 #include <unordered_set>
 #include <vector>
 
@@ -25,6 +26,8 @@
 #include <shellapi.h>
 
 #include "app/value_dialogs.h"
+#include "registry/reg_file_writer.h"
+#include "registry/reg_snapshot.h"
 #include "win32/win32_helpers.h"
 
 namespace regkit {
@@ -207,216 +210,6 @@ bool PromptSaveRegFile(HWND owner, const std::wstring& default_name, std::wstrin
   return true;
 }
 
-bool ReadFileBytes(const std::wstring& path, std::vector<BYTE>* out) {
-  if (!out) {
-    return false;
-  }
-  out->clear();
-  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
-  if (file == INVALID_HANDLE_VALUE) {
-    return false;
-  }
-  LARGE_INTEGER size = {};
-  if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
-    CloseHandle(file);
-    return false;
-  }
-  if (size.QuadPart > static_cast<LONGLONG>(64 * 1024 * 1024)) {
-    CloseHandle(file);
-    return false;
-  }
-  out->resize(static_cast<size_t>(size.QuadPart));
-  DWORD read = 0;
-  BOOL ok = ReadFile(file, out->data(), static_cast<DWORD>(out->size()), &read, nullptr);
-  CloseHandle(file);
-  if (!ok || read != out->size()) {
-    out->clear();
-    return false;
-  }
-  return true;
-}
-
-bool ReadRegFileText(const std::wstring& path, std::wstring* out, bool* utf16) {
-  if (!out) {
-    return false;
-  }
-  std::vector<BYTE> bytes;
-  if (!ReadFileBytes(path, &bytes)) {
-    return false;
-  }
-  bool is_utf16 = false;
-  if (bytes.size() >= 2 && bytes[0] == 0xFF && bytes[1] == 0xFE) {
-    is_utf16 = true;
-    size_t wchar_count = (bytes.size() - 2) / sizeof(wchar_t);
-    out->assign(reinterpret_cast<const wchar_t*>(bytes.data() + 2), wchar_count);
-  } else {
-    if (bytes.size() >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) {
-      std::string utf8(reinterpret_cast<const char*>(bytes.data() + 3), bytes.size() - 3);
-      *out = util::Utf8ToWide(utf8);
-    } else {
-      std::string utf8(reinterpret_cast<const char*>(bytes.data()), bytes.size());
-      *out = util::Utf8ToWide(utf8);
-    }
-  }
-  if (utf16) {
-    *utf16 = is_utf16;
-  }
-  return !out->empty();
-}
-
-bool WriteRegFileText(const std::wstring& path, const std::wstring& text, bool utf16) {
-  HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
-  if (file == INVALID_HANDLE_VALUE) {
-    return false;
-  }
-  DWORD written = 0;
-  if (utf16) {
-    const BYTE bom[2] = {0xFF, 0xFE};
-    WriteFile(file, bom, sizeof(bom), &written, nullptr);
-    const BYTE* data = reinterpret_cast<const BYTE*>(text.data());
-    DWORD bytes = static_cast<DWORD>(text.size() * sizeof(wchar_t));
-    BOOL ok = WriteFile(file, data, bytes, &written, nullptr);
-    CloseHandle(file);
-    return ok != 0;
-  }
-  std::string utf8 = util::WideToUtf8(text);
-  BOOL ok = WriteFile(file, utf8.data(), static_cast<DWORD>(utf8.size()), &written, nullptr);
-  CloseHandle(file);
-  return ok != 0;
-}
-
-bool FilterExportedRegFile(const std::wstring& source, const std::wstring& target, std::wstring* error) {
-  std::wstring content;
-  bool utf16 = false;
-  if (!ReadRegFileText(source, &content, &utf16)) {
-    if (error) {
-      *error = L"Failed to read exported registry file.";
-    }
-    return false;
-  }
-
-  std::wstring output;
-  output.reserve(content.size());
-  bool in_section = false;
-  bool wrote_section = false;
-
-  size_t start = 0;
-  while (start < content.size()) {
-    size_t end = content.find(L'\n', start);
-    if (end == std::wstring::npos) {
-      end = content.size();
-    }
-    std::wstring line = content.substr(start, end - start);
-    if (!line.empty() && line.back() == L'\r') {
-      line.pop_back();
-    }
-    start = end + 1;
-
-    if (!line.empty() && line.front() == L'[' && line.back() == L']') {
-      if (wrote_section) {
-        break;
-      }
-      wrote_section = true;
-      in_section = true;
-      output.append(line);
-      output.append(L"\r\n");
-      continue;
-    }
-
-    if (!wrote_section || in_section) {
-      output.append(line);
-      output.append(L"\r\n");
-    }
-  }
-
-  if (!WriteRegFileText(target, output, utf16)) {
-    if (error) {
-      *error = L"Failed to write exported registry file.";
-    }
-    return false;
-  }
-  return true;
-}
-
-bool FindFirstSection(const std::wstring& content, size_t* section_pos) {
-  if (section_pos) {
-    *section_pos = std::wstring::npos;
-  }
-  size_t pos = 0;
-  while (pos < content.size()) {
-    size_t end = content.find(L'\n', pos);
-    if (end == std::wstring::npos) {
-      end = content.size();
-    }
-    std::wstring line = content.substr(pos, end - pos);
-    if (!line.empty() && line.back() == L'\r') {
-      line.pop_back();
-    }
-    if (!line.empty() && line.front() == L'[' && line.back() == L']') {
-      if (section_pos) {
-        *section_pos = pos;
-      }
-      return true;
-    }
-    pos = end + 1;
-  }
-  return false;
-}
-
-bool AppendRegContent(const std::wstring& content, std::wstring* output) {
-  if (!output) {
-    return false;
-  }
-  if (output->empty()) {
-    output->append(content);
-    return true;
-  }
-  size_t section_pos = std::wstring::npos;
-  if (!FindFirstSection(content, &section_pos) || section_pos == std::wstring::npos) {
-    return true;
-  }
-  output->append(content.substr(section_pos));
-  return true;
-}
-
-bool ParseValueLine(const std::wstring& line, std::wstring* value_name) {
-  if (!value_name) {
-    return false;
-  }
-  value_name->clear();
-  if (line.empty()) {
-    return false;
-  }
-  if (line[0] == L'@') {
-    if (line.size() >= 2 && line[1] == L'=') {
-      return true;
-    }
-    return false;
-  }
-  if (line[0] != L'"') {
-    return false;
-  }
-  bool escape = false;
-  for (size_t i = 1; i < line.size(); ++i) {
-    wchar_t ch = line[i];
-    if (escape) {
-      value_name->push_back(ch);
-      escape = false;
-      continue;
-    }
-    if (ch == L'\\') {
-      escape = true;
-      continue;
-    }
-    if (ch == L'"') {
-      return true;
-    }
-    value_name->push_back(ch);
-  }
-  value_name->clear();
-  return false;
-}
-
 std::wstring ToLower(const std::wstring& text) {
   std::wstring out;
   out.reserve(text.size());
@@ -426,165 +219,79 @@ std::wstring ToLower(const std::wstring& text) {
   return out;
 }
 
-bool FilterRegFileValues(const std::wstring& content, const std::vector<std::wstring>& values, std::wstring* output, std::wstring* error) {
-  if (!output) {
-    return false;
-  }
-
-  std::unordered_set<std::wstring> wanted;
-  wanted.reserve(values.size());
-  for (const auto& value : values) {
-    wanted.insert(ToLower(value));
-  }
-
-  std::wstring out;
-  out.reserve(content.size());
-  bool in_section = false;
-  bool kept_value = false;
-  bool keep_continuation = false;
-  bool skip_continuation = false;
-
-  size_t pos = 0;
-  while (pos < content.size()) {
-    size_t end = content.find(L'\n', pos);
-    if (end == std::wstring::npos) {
-      end = content.size();
-    }
-    std::wstring line = content.substr(pos, end - pos);
-    if (!line.empty() && line.back() == L'\r') {
-      line.pop_back();
-    }
-    pos = end + 1;
-
-    if (!line.empty() && line.front() == L'[' && line.back() == L']') {
-      if (in_section) {
-        break;
-      }
-      in_section = true;
-      out.append(line);
-      out.append(L"\r\n");
-      continue;
-    }
-
-    if (!in_section) {
-      out.append(line);
-      out.append(L"\r\n");
-      continue;
-    }
-
-    if (keep_continuation) {
-      out.append(line);
-      out.append(L"\r\n");
-      if (line.empty() || line.back() != L'\\') {
-        keep_continuation = false;
-      }
-      continue;
-    }
-    if (skip_continuation) {
-      if (line.empty() || line.back() != L'\\') {
-        skip_continuation = false;
-      }
-      continue;
-    }
-
-    std::wstring value_name;
-    if (!ParseValueLine(line, &value_name)) {
-      continue;
-    }
-    std::wstring lower = ToLower(value_name);
-    if (wanted.find(lower) == wanted.end()) {
-      skip_continuation = !line.empty() && line.back() == L'\\';
-      continue;
-    }
-    out.append(line);
-    out.append(L"\r\n");
-    kept_value = true;
-    if (!line.empty() && line.back() == L'\\') {
-      keep_continuation = true;
-    }
-  }
-
-  if (!kept_value) {
-    if (error) {
-      *error = L"No selected values were found in the export.";
-    }
-    return false;
-  }
-  *output = std::move(out);
-  return true;
+std::wstring ExportKeyPath(const RegistryNode& node) {
+  std::wstring path = RegistryProvider::BuildPath(node);
+  std::wstring normalized = NormalizeExportKeyPath(path, nullptr);
+  return normalized.empty() ? path : normalized;
 }
 
-bool ExportKeyToContent(const std::wstring& key_path, bool include_subkeys, std::wstring* content, bool* utf16, std::wstring* error) {
-  if (!content) {
-    return false;
-  }
-  std::wstring normalized = NormalizeExportKeyPath(key_path, error);
-  if (normalized.empty()) {
-    return false;
-  }
+RegistryNode ExportChildNode(const RegistryNode& node, const std::wstring& name) {
+  RegistryNode child = node;
+  child.subkey = node.subkey.empty() ? name : node.subkey + L"\\" + name;
+  child.children_loaded = false;
+  return child;
+}
 
-  wchar_t temp_dir[MAX_PATH] = {};
-  if (!GetTempPathW(_countof(temp_dir), temp_dir)) {
-    if (error) {
-      *error = L"Failed to locate temp path.";
-    }
-    return false;
-  }
-  wchar_t temp_file[MAX_PATH] = {};
-  if (!GetTempFileNameW(temp_dir, L"reg", 0, temp_file)) {
-    if (error) {
-      *error = L"Failed to create temp file.";
-    }
-    return false;
-  }
-  std::wstring temp_path = temp_file;
+void StampKey(RegFileWriter*, const RegistryProvider::KeyEnumResult&) {}
 
-  std::wstring args = L"export \"" + normalized + L"\" \"" + temp_path + L"\" /y";
-  if (!RunRegCommand(args, nullptr, error)) {
-    DeleteFileW(temp_path.c_str());
-    return false;
+void StampKey(RegSnapshotWriter* writer, const RegistryProvider::KeyEnumResult& result) {
+  if (result.info_valid) {
+    writer->SetLastWrite((static_cast<uint64_t>(result.info.last_write.dwHighDateTime) << 32) | result.info.last_write.dwLowDateTime);
   }
+}
 
-  std::wstring read_path = temp_path;
-  std::wstring filtered_path;
-  if (!include_subkeys) {
-    wchar_t filtered_file[MAX_PATH] = {};
-    if (!GetTempFileNameW(temp_dir, L"reg", 0, filtered_file)) {
-      DeleteFileW(temp_path.c_str());
-      if (error) {
-        *error = L"Failed to create temp file.";
-      }
-      return false;
+template <typename Writer>
+bool ExportKeyTree(const RegistryNode& node, const std::wstring& key_path, bool include_subkeys, const std::unordered_set<std::wstring>* value_filter, size_t* values_written, Writer* writer) {
+  bool begun = false;
+  auto begin_key = [&]() {
+    if (!begun) {
+      writer->BeginKey(key_path);
+      begun = true;
     }
-    filtered_path = filtered_file;
-    if (!FilterExportedRegFile(temp_path, filtered_path, error)) {
-      DeleteFileW(temp_path.c_str());
-      DeleteFileW(filtered_path.c_str());
+  };
+  std::vector<std::wstring> subkeys;
+  RegistryProvider::KeyEnumResult key_info;
+  bool ok = RegistryProvider::EnumKeyStreaming(
+      node, true, true, include_subkeys, std::is_same_v<Writer, RegSnapshotWriter> ? &key_info : nullptr,
+      [&](const ValueInfo& info, const BYTE* data, DWORD data_size) {
+        if (value_filter && value_filter->find(ToLower(info.name)) == value_filter->end()) {
+          return true;
+        }
+        begin_key();
+        writer->WriteValue(info.name, info.type, data, data_size);
+        if (values_written) {
+          ++*values_written;
+        }
+        return writer->ok();
+      },
+      [&](const std::wstring& name) {
+        subkeys.push_back(name);
+        return true;
+      });
+  if (!ok || !writer->ok()) {
+    return false;
+  }
+  begin_key();
+  StampKey(writer, key_info);
+  for (const auto& name : subkeys) {
+    if (!ExportKeyTree(ExportChildNode(node, name), key_path + L"\\" + name, true, nullptr, nullptr, writer) && !writer->ok()) {
       return false;
     }
-    read_path = filtered_path;
-  }
-
-  bool is_utf16 = false;
-  if (!ReadRegFileText(read_path, content, &is_utf16)) {
-    if (error) {
-      *error = L"Failed to read exported registry file.";
-    }
-    DeleteFileW(temp_path.c_str());
-    if (!filtered_path.empty()) {
-      DeleteFileW(filtered_path.c_str());
-    }
-    return false;
   }
+  return true;
+}
 
-  DeleteFileW(temp_path.c_str());
-  if (!filtered_path.empty()) {
-    DeleteFileW(filtered_path.c_str());
+template <typename Writer>
+bool FinishExport(Writer* writer, const std::wstring& path, bool exported, const wchar_t* export_error, std::wstring* error) {
+  bool written = writer->Close(error);
+  if (written && exported) {
+    return true;
   }
-  if (utf16) {
-    *utf16 = is_utf16;
+  if (written && error) {
+    *error = export_error;
   }
-  return true;
+  DeleteFileW(path.c_str());
+  return false;
 }
 
 std::wstring EnsureRegExtension(std::wstring path) {
@@ -599,6 +306,25 @@ std::wstring EnsureRegExtension(std::wstring path) {
   return path;
 }
 
+bool HasSnapshotExtension(const std::wstring& path) {
+  size_t slash = path.find_last_of(L"\\/");
+  size_t dot = path.find_last_of(L'.');
+  if (dot == std::wstring::npos || (slash != std::wstring::npos && dot < slash)) {
+    return false;
+  }
+  return _wcsicmp(path.c_str() + dot, kRegSnapshotExtension) == 0;
+}
+
+template <typename Writer>
+bool ExportKeyFile(const RegistryNode& node, const std::wstring& path, bool include_subkeys, std::wstring* error) {
+  Writer writer;
+  if (!writer.Open(path, error)) {
+    return false;
+  }
+  bool exported = ExportKeyTree(node, ExportKeyPath(node), include_subkeys, nullptr, nullptr, &writer);
+  return FinishExport(&writer, path, exported, L"Failed to read registry key.", error);
+}
+
 } // namespace
 
 bool ImportRegFile(HWND owner, std::wstring* error) {
@@ -617,62 +343,26 @@ bool ImportRegFileFromPath(const std::wstring& path, std::wstring* error) {
   return RunRegCommand(args, nullptr, error);
 }
 
-bool ExportRegFile(HWND owner, const std::wstring& key_path, std::wstring* error) {
+bool ExportRegFile(HWND owner, const RegistryNode& node, std::wstring* error) {
   ExportOptions options;
   if (!PromptForExportOptions(owner, L"", &options)) {
     return false;
   }
   options.path = EnsureRegExtension(options.path);
 
-  std::wstring normalized = NormalizeExportKeyPath(key_path, error);
-  if (normalized.empty()) {
-    return false;
-  }
-
-  std::wstring target_path = options.path;
-  std::wstring temp_path;
-  if (!options.include_subkeys) {
-    wchar_t temp_dir[MAX_PATH] = {};
-    if (!GetTempPathW(_countof(temp_dir), temp_dir)) {
-      if (error) {
-        *error = L"Failed to locate temp path.";
-      }
-      return false;
-    }
-    wchar_t temp_file[MAX_PATH] = {};
-    if (!GetTempFileNameW(temp_dir, L"reg", 0, temp_file)) {
-      if (error) {
-        *error = L"Failed to create temp file.";
-      }
-      return false;
-    }
-    temp_path = temp_file;
-    target_path = temp_path;
-  }
-
-  std::wstring args = L"export \"" + normalized + L"\" \"" + target_path + L"\" /y";
-  if (!RunRegCommand(args, nullptr, error)) {
-    if (!temp_path.empty()) {
-      DeleteFileW(temp_path.c_str());
-    }
+  bool exported = HasSnapshotExtension(options.path) ? ExportKeyFile<RegSnapshotWriter>(node, options.path, options.include_subkeys, error)
+                                                     : ExportKeyFile<RegFileWriter>(node, options.path, options.include_subkeys, error);
+  if (!exported) {
     return false;
   }
 
-  if (!temp_path.empty()) {
-    if (!FilterExportedRegFile(temp_path, options.path, error)) {
-      DeleteFileW(temp_path.c_str());
-      return false;
-    }
-    DeleteFileW(temp_path.c_str());
-  }
-
   if (options.open_after) {
     ShellExecuteW(owner, L"open", options.path.c_str(), nullptr, nullptr, SW_SHOWNORMAL);
   }
   return true;
 }
 
-bool ExportRegFileSelection(HWND owner, const std::wstring& base_key_path, const std::vector<std::wstring>& value_names, const std::vector<std::wstring>& subkey_names, std::wstring* error) {
+bool ExportRegFileSelection(HWND owner, const RegistryNode& node, const std::vector<std::wstring>& value_names, const std::vector<std::wstring>& subkey_names, std::wstring* error) {
   if (value_names.empty() && subkey_names.empty()) {
     if (error) {
       *error = L"No data to export.";
@@ -695,62 +385,47 @@ bool ExportRegFileSelection(HWND owner, const std::wstring& base_key_path, const
   }
   path = EnsureRegExtension(path);
 
-  std::wstring output;
-  bool output_utf16 = false;
-  bool output_utf16_set = false;
-
-  auto append_content = [&](const std::wstring& content, bool utf16) -> bool {
-    if (!output_utf16_set) {
-      output_utf16 = utf16;
-      output_utf16_set = true;
-    }
-    return AppendRegContent(content, &output);
-  };
-
+  RegFileWriter writer;
+  if (!writer.Open(path, error)) {
+    return false;
+  }
+  std::wstring base_path = ExportKeyPath(node);
   if (!value_names.empty()) {
-    std::wstring content;
-    bool utf16 = false;
-    if (!ExportKeyToContent(base_key_path, false, &content, &utf16, error)) {
-      return false;
+    std::unordered_set<std::wstring> wanted;
+    for (const auto& value : value_names) {
+      wanted.insert(ToLower(value));
     }
-    std::wstring filtered;
-    if (!FilterRegFileValues(content, value_names, &filtered, error)) {
-      return false;
+    size_t written = 0;
+    bool exported = ExportKeyTree(node, base_path, false, &wanted, &written, &writer);
+    if (!exported || written == 0) {
+      return FinishExport(&writer, path, false, L"No selected values were found in the export.", error);
     }
-    append_content(filtered, utf16);
   }
 
   for (const auto& subkey : subkey_names) {
     if (subkey.empty()) {
       continue;
     }
-    std::wstring key_path = base_key_path;
-    if (!key_path.empty()) {
-      key_path += L"\\";
-    }
-    key_path += subkey;
-    std::wstring content;
-    bool utf16 = false;
-    if (!ExportKeyToContent(key_path, true, &content, &utf16, error)) {
-      return false;
+    if (!ExportKeyTree(ExportChildNode(node, subkey), base_path + L"\\" + subkey, true, nullptr, nullptr, &writer)) {
+      return FinishExport(&writer, path, false, L"Failed to read registry key.", error);
     }
-    append_content(content, utf16);
   }
+  return FinishExport(&writer, path, true, L"", error);
+}
 
-  if (output.empty()) {
-    if (error) {
-      *error = L"No data to export.";
-    }
+bool ExportRegSnapshot(const std::vector<RegistryNode>& nodes, const std::wstring& path, std::wstring* error) {
+  RegSnapshotWriter writer;
+  if (!writer.Open(path, error)) {
     return false;
   }
-
-  if (!WriteRegFileText(path, output, output_utf16)) {
-    if (error) {
-      *error = L"Failed to write exported registry file.";
+  bool exported = true;
+  for (const auto& node : nodes) {
+    if (!ExportKeyTree(node, ExportKeyPath(node), true, nullptr, nullptr, &writer)) {
+      exported = false;
+      break;
     }
-    return false;
   }
-  return true;
+  return FinishExport(&writer, path, exported, L"Failed to read registry key.", error);
 }
 
 bool LoadHive(HWND owner, HKEY root, std::wstring* error) {
@@ -126,43 +126,7 @@ void RegistryTree::PopulateRoots(const std::vector<RegistryRootEntry>& roots) {
   }
 
   for (const auto& root_entry : roots) {
-    auto node = std::make_unique<RegistryNode>();
-    node->root = root_entry.root;
-    node->subkey = root_entry.subkey_prefix;
-    node->root_name = root_entry.path_name;
-    RegistryNode* stored = StoreNode(std::move(node));
-
-    int icon_index = kFolderIconIndex;
-    if (icon_resolver_) {
-      icon_index = icon_resolver_(*stored);
-    }
-
-    if (root_entry.group == RegistryRootGroup::kReal && real_group_item_ && _wcsicmp(root_entry.display_name.c_str(), kRealGroupLabel) == 0 && root_entry.subkey_prefix.empty()) {
-      TVITEMW item = {};
-      item.mask = TVIF_PARAM | TVIF_IMAGE | TVIF_SELECTEDIMAGE;
-      item.hItem = real_group_item_;
-      item.lParam = reinterpret_cast<LPARAM>(stored);
-      item.iImage = icon_index;
-      item.iSelectedImage = icon_index;
-      TreeView_SetItem(hwnd_, &item);
-      AddDummyChildIfNeeded(real_group_item_, stored);
-      continue;
-    }
-
-    TVINSERTSTRUCTW root_item = {};
-    if (root_entry.group == RegistryRootGroup::kReal) {
-      root_item.hParent = real_group_item_ ? real_group_item_ : root_item_;
-    } else {
-      root_item.hParent = standard_group_item_ ? standard_group_item_ : root_item_;
-    }
-    root_item.hInsertAfter = TVI_LAST;
-    root_item.item.mask = TVIF_TEXT | TVIF_PARAM | TVIF_IMAGE | TVIF_SELECTEDIMAGE;
-    root_item.item.pszText = const_cast<wchar_t*>(root_entry.display_name.c_str());
-    root_item.item.lParam = reinterpret_cast<LPARAM>(stored);
-    root_item.item.iImage = icon_index;
-    root_item.item.iSelectedImage = icon_index;
-    HTREEITEM item = TreeView_InsertItem(hwnd_, &root_item);
-    AddDummyChildIfNeeded(item, stored);
+    InsertRoot(root_entry);
   }
 
   TreeView_Expand(hwnd_, root_item_, TVE_EXPAND);
@@ -174,6 +138,79 @@ void RegistryTree::PopulateRoots(const std::vector<RegistryRootEntry>& roots) {
   }
 }
 
+void RegistryTree::AppendRoot(const RegistryRootEntry& root_entry, HKEY before) {
+  if (!root_item_) {
+    return;
+  }
+  if (root_entry.group != RegistryRootGroup::kReal && !standard_group_item_) {
+    TVINSERTSTRUCTW standard_group = {};
+    standard_group.hParent = root_item_;
+    standard_group.hInsertAfter = TVI_FIRST;
+    standard_group.item.mask = TVIF_TEXT | TVIF_IMAGE | TVIF_SELECTEDIMAGE | TVIF_PARAM;
+    standard_group.item.pszText = const_cast<wchar_t*>(kStandardGroupLabel);
+    standard_group.item.iImage = kFolderIconIndex;
+    standard_group.item.iSelectedImage = kFolderIconIndex;
+    standard_group.item.lParam = 0;
+    standard_group_item_ = TreeView_InsertItem(hwnd_, &standard_group);
+  }
+  InsertRoot(root_entry, before);
+  TreeView_Expand(hwnd_, root_item_, TVE_EXPAND);
+  if (root_entry.group != RegistryRootGroup::kReal && standard_group_item_) {
+    TreeView_Expand(hwnd_, standard_group_item_, TVE_EXPAND);
+  }
+}
+
+void RegistryTree::InsertRoot(const RegistryRootEntry& root_entry, HKEY before) {
+  auto node = std::make_unique<RegistryNode>();
+  node->root = root_entry.root;
+  node->subkey = root_entry.subkey_prefix;
+  node->root_name = root_entry.path_name;
+  RegistryNode* stored = StoreNode(std::move(node));
+
+  int icon_index = kFolderIconIndex;
+  if (icon_resolver_) {
+    icon_index = icon_resolver_(*stored);
+  }
+
+  if (root_entry.group == RegistryRootGroup::kReal && real_group_item_ && _wcsicmp(root_entry.display_name.c_str(), kRealGroupLabel) == 0 && root_entry.subkey_prefix.empty()) {
+    TVITEMW item = {};
+    item.mask = TVIF_PARAM | TVIF_IMAGE | TVIF_SELECTEDIMAGE;
+    item.hItem = real_group_item_;
+    item.lParam = reinterpret_cast<LPARAM>(stored);
+    item.iImage = icon_index;
+    item.iSelectedImage = icon_index;
+    TreeView_SetItem(hwnd_, &item);
+    AddDummyChildIfNeeded(real_group_item_, stored);
+    return;
+  }
+
+  TVINSERTSTRUCTW root_item = {};
+  if (root_entry.group == RegistryRootGroup::kReal) {
+    root_item.hParent = real_group_item_ ? real_group_item_ : root_item_;
+  } else {
+    root_item.hParent = standard_group_item_ ? standard_group_item_ : root_item_;
+  }
+  root_item.hInsertAfter = TVI_LAST;
+  if (before) {
+    HTREEITEM previous = nullptr;
+    for (HTREEITEM child = TreeView_GetChild(hwnd_, root_item.hParent); child; child = TreeView_GetNextSibling(hwnd_, child)) {
+      RegistryNode* existing = NodeFromItem(child);
+      if (existing && existing->root == before) {
+        root_item.hInsertAfter = previous ? previous : TVI_FIRST;
+        break;
+      }
+      previous = child;
+    }
+  }
+  root_item.item.mask = TVIF_TEXT | TVIF_PARAM | TVIF_IMAGE | TVIF_SELECTEDIMAGE;
+  root_item.item.pszText = const_cast<wchar_t*>(root_entry.display_name.c_str());
+  root_item.item.lParam = reinterpret_cast<LPARAM>(stored);
+  root_item.item.iImage = icon_index;
+  root_item.item.iSelectedImage = icon_index;
+  HTREEITEM item = TreeView_InsertItem(hwnd_, &root_item);
+  AddDummyChildIfNeeded(item, stored);
+}
+
 RegistryNode* RegistryTree::NodeFromItem(HTREEITEM item) {
   if (!item) {
     return nullptr;
@@ -40,6 +40,7 @@ constexpr wchar_t kAppTitle[] = L"RegKit";
 enum ControlId {
   kFindLabel = 100,
   kFindCombo = 101,
+  kFindPatterns = 102,
   kWhereGroup = 110,
   kScopeTop = 111,
   kScopeKey = 112,
@@ -120,6 +121,7 @@ std::vector<DataTypeItem> BuildDataTypeItems() {
 struct SearchDialogState {
   HWND hwnd = nullptr;
   HWND find_combo = nullptr;
+  HWND find_patterns = nullptr;
   HWND scope_top = nullptr;
   HWND scope_key = nullptr;
   HWND scope_recursive = nullptr;
@@ -160,6 +162,7 @@ struct SearchDialogState {
   std::vector<std::wstring> root_names;
   std::vector<bool> root_selected;
   std::vector<DWORD> data_types;
+  std::vector<std::wstring> patterns;
   bool owner_restored = false;
 };
 
@@ -889,6 +892,37 @@ std::vector<std::wstring> SplitExcludePaths(const std::wstring& text) {
   return items;
 }
 
+std::vector<std::wstring> SplitPatternLines(const std::wstring& text) {
+  std::vector<std::wstring> items;
+  size_t start = 0;
+  while (start <= text.size()) {
+    size_t end = text.find(L'\n', start);
+    if (end == std::wstring::npos) {
+      end = text.size();
+    }
+    std::wstring line = text.substr(start, end - start);
+    if (!line.empty() && line.back() == L'\r') {
+      line.pop_back();
+    }
+    if (!line.empty()) {
+      items.push_back(std::move(line));
+    }
+    start = end + 1;
+  }
+  return items;
+}
+
+std::wstring JoinPatterns(const std::vector<std::wstring>& patterns) {
+  std::wstring out;
+  for (const auto& pattern : patterns) {
+    if (!out.empty()) {
+      out.append(L"; ");
+    }
+    out.append(pattern);
+  }
+  return out;
+}
+
 std::wstring JoinExcludePaths(const std::vector<std::wstring>& items) {
   std::wstring out;
   for (const auto& item : items) {
@@ -963,8 +997,9 @@ void LayoutDialog(HWND hwnd, SearchDialogState* state, HFONT font) {
 
   HWND find_label = GetDlgItem(hwnd, kFindLabel);
   SetWindowPos(find_label, nullptr, x, y + 4, label_w, 18, SWP_NOZORDER);
-  int combo_w = width - x * 2 - label_w - 8;
+  int combo_w = width - x * 2 - label_w - 96;
   SetWindowPos(state->find_combo, nullptr, x + label_w + 8, y, combo_w, line_h, SWP_NOZORDER);
+  SetWindowPos(state->find_patterns, nullptr, x + label_w + combo_w + 16, y, 80, line_h, SWP_NOZORDER);
   y += line_h + 12;
 
   int group_w = width - x * 2;
@@ -1058,6 +1093,7 @@ LRESULT CALLBACK SearchDialogProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lpa
 
     CreateWindowExW(0, L"STATIC", L"Find what:", WS_CHILD | WS_VISIBLE, 0, 0, 0, 0, hwnd, reinterpret_cast<HMENU>(kFindLabel), nullptr, nullptr);
     state->find_combo = CreateWindowExW(0, WC_COMBOBOXW, L"", WS_CHILD | WS_VISIBLE | CBS_DROPDOWN | CBS_AUTOHSCROLL, 0, 0, 0, 0, hwnd, reinterpret_cast<HMENU>(kFindCombo), nullptr, nullptr);
+    state->find_patterns = CreateWindowExW(0, L"BUTTON", L"Patterns...", WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON, 0, 0, 0, 0, hwnd, reinterpret_cast<HMENU>(kFindPatterns), nullptr, nullptr);
 
     CreateWindowExW(0, L"BUTTON", L"Where to search", WS_CHILD | WS_VISIBLE | BS_GROUPBOX, 0, 0, 0, 0, hwnd, reinterpret_cast<HMENU>(kWhereGroup), nullptr, nullptr);
     state->scope_top = CreateWindowExW(0, L"BUTTON", L"Top-level keys", WS_CHILD | WS_VISIBLE | BS_AUTORADIOBUTTON | WS_GROUP, 0, 0, 0, 0, hwnd, reinterpret_cast<HMENU>(kScopeTop), nullptr, nullptr);
@@ -1117,6 +1153,9 @@ LRESULT CALLBACK SearchDialogProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lpa
     state->history = LoadSearchHistory();
     PopulateHistoryCombo(state->find_combo, state->history);
     if (state->out && !state->out->criteria.query.empty()) {
+      if (state->out->criteria.queries.size() > 1) {
+        state->patterns = state->out->criteria.queries;
+      }
       SetWindowTextW(state->find_combo, state->out->criteria.query.c_str());
     } else if (!state->history.empty()) {
       SetWindowTextW(state->find_combo, state->history.front().c_str());
@@ -1296,6 +1335,31 @@ LRESULT CALLBACK SearchDialogProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lpa
     case kOptDataTypes:
       ShowDataTypesDialog(hwnd, &state->data_types);
       return 0;
+    case kFindPatterns: {
+      wchar_t buffer[4096] = {};
+      GetWindowTextW(state->find_combo, buffer, static_cast<int>(_countof(buffer)));
+      std::wstring multiline = buffer;
+      if (state->patterns.size() > 1 && multiline == JoinPatterns(state->patterns)) {
+        multiline.clear();
+        for (const auto& pattern : state->patterns) {
+          if (!multiline.empty()) {
+            multiline.append(L"\r\n");
+          }
+          multiline.append(pattern);
+        }
+      }
+      if (PromptForMultiLineText(hwnd, L"Find Patterns", L"Each line is searched as a separate pattern.", &multiline)) {
+        std::vector<std::wstring> lines = SplitPatternLines(multiline);
+        state->patterns.clear();
+        if (lines.size() > 1) {
+          state->patterns = std::move(lines);
+          SetWindowTextW(state->find_combo, JoinPatterns(state->patterns).c_str());
+        } else if (lines.size() == 1) {
+          SetWindowTextW(state->find_combo, lines.front().c_str());
+        }
+      }
+      return 0;
+    }
     case kExcludeButton: {
       wchar_t buffer[2048] = {};
       GetWindowTextW(state->exclude_edit, buffer, static_cast<int>(_countof(buffer)));
@@ -1318,7 +1382,7 @@ LRESULT CALLBACK SearchDialogProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lpa
       return 0;
     }
     case kFindButton: {
-      wchar_t query[512] = {};
+      wchar_t query[4096] = {};
       GetWindowTextW(state->find_combo, query, static_cast<int>(_countof(query)));
       std::wstring query_text = query;
       if (query_text.empty()) {
@@ -1348,6 +1412,9 @@ LRESULT CALLBACK SearchDialogProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lpa
 
       SearchDialogResult result;
       result.criteria.query = query_text;
+      if (state->patterns.size() > 1 && query_text == JoinPatterns(state->patterns)) {
+        result.criteria.queries = state->patterns;
+      }
       result.criteria.search_keys = keys;
       result.criteria.search_values = values;
       result.criteria.search_data = data;
@@ -29,6 +29,7 @@
 
 #include "app/theme.h"
 #include "app/ui_helpers.h"
+#include "registry/hex_bytes.h"
 #include "resource.h"
 
 namespace regkit {
@@ -106,7 +107,6 @@ struct ExtendedValueDialogState {
   HFONT ui_font = nullptr;
 };
 
-bool ParseHexBytes(const std::wstring& text, std::vector<BYTE>* out);
 std::wstring FormatBinaryPreview(const std::vector<BYTE>& data, int group_bytes, bool unicode);
 std::wstring BinaryToHex(const std::vector<BYTE>& data);
 std::wstring RegDataToString(const std::vector<BYTE>& data);
@@ -1077,7 +1077,7 @@ bool PromptExportPath(HWND owner, std::wstring* path) {
   OPENFILENAMEW ofn = {};
   ofn.lStructSize = sizeof(ofn);
   ofn.hwndOwner = owner;
-  ofn.lpstrFilter = L"Registry Files (*.reg)\0*.reg\0All Files (*.*)\0*.*\0";
+  ofn.lpstrFilter = L"Registry Files (*.reg)\0*.reg\0Registry Snapshots (*.rksnap)\0*.rksnap\0All Files (*.*)\0*.*\0";
   ofn.lpstrFile = buffer;
   ofn.nMaxFile = static_cast<DWORD>(_countof(buffer));
   ofn.Flags = OFN_PATHMUSTEXIST | OFN_OVERWRITEPROMPT;
@@ -1992,33 +1992,6 @@ std::wstring BinaryToHex(const std::vector<BYTE>& data) {
   return stream.str();
 }
 
-bool ParseHexBytes(const std::wstring& text, std::vector<BYTE>* out) {
-  if (!out) {
-    return false;
-  }
-  out->clear();
-  int nibble = -1;
-  for (wchar_t ch : text) {
-    if (iswxdigit(ch)) {
-      int value = 0;
-      if (ch >= L'0' && ch <= L'9') {
-        value = ch - L'0';
-      } else if (ch >= L'a' && ch <= L'f') {
-        value = 10 + (ch - L'a');
-      } else if (ch >= L'A' && ch <= L'F') {
-        value = 10 + (ch - L'A');
-      }
-      if (nibble < 0) {
-        nibble = value;
-      } else {
-        out->push_back(static_cast<BYTE>((nibble << 4) | value));
-        nibble = -1;
-      }
-    }
-  }
-  return nibble < 0;
-}
-
 std::wstring MultiSzToText(const std::vector<BYTE>& data) {
   if (data.empty()) {
     return L"";
@@ -16,20 +16,9 @@
 
 #include "app/value_list.h"
 
-namespace regkit {
-
-namespace {
-bool ContainsInsensitive(const std::wstring& text, const std::wstring& needle) {
-  if (needle.empty()) {
-    return true;
-  }
-  if (text.empty()) {
-    return false;
-  }
-  return FindStringOrdinal(FIND_FROMSTART, text.c_str(), static_cast<int>(text.size()), needle.c_str(), static_cast<int>(needle.size()), TRUE) >= 0;
-}
+#include "registry/ordinal_search.h"
 
-} // namespace
+namespace regkit {
 
 void ValueList::Create(HWND parent, HINSTANCE instance, int control_id) {
   hwnd_ = CreateWindowExW(0, WC_LISTVIEWW, L"", WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SHOWSELALWAYS | LVS_OWNERDATA | LVS_EDITLABELS, 0, 0, 100, 100, parent, reinterpret_cast<HMENU>(static_cast<INT_PTR>(control_id)), instance, nullptr);
@@ -92,9 +81,10 @@ void ValueList::RebuildFilter() {
       visible_indices_.push_back(static_cast<int>(i));
     }
   } else {
+    OrdinalFinder filter(filter_text_);
     for (size_t i = 0; i < rows_.size(); ++i) {
       const auto& row = rows_[i];
-      if (ContainsInsensitive(row.name, filter_text_) || ContainsInsensitive(row.type, filter_text_) || ContainsInsensitive(row.data, filter_text_) || ContainsInsensitive(row.default_data, filter_text_) || ContainsInsensitive(row.read_on_boot, filter_text_) || ContainsInsensitive(row.extra, filter_text_) || ContainsInsensitive(row.size, filter_text_) || ContainsInsensitive(row.date, filter_text_) || ContainsInsensitive(row.details, filter_text_) || ContainsInsensitive(row.comment, filter_text_)) {
+      if (filter.Contains(row.name) || filter.Contains(row.type) || filter.Contains(row.data) || filter.Contains(row.default_data) || filter.Contains(row.read_on_boot) || filter.Contains(row.extra) || filter.Contains(row.size) || filter.Contains(row.date) || filter.Contains(row.details) || filter.Contains(row.comment)) {
         visible_indices_.push_back(static_cast<int>(i));
       }
     }
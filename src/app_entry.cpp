@@ -25,6 +25,7 @@
 #include "app/app_window.h"
 #include "app/theme.h"
 #include "app/ui_helpers.h"
+#include "registry/reg_snapshot.h"
 #include "win32/win32_helpers.h"
 
 namespace {
@@ -74,13 +75,13 @@ bool HasCommandLineArg(const std::vector<std::wstring>& args, const wchar_t* arg
   return false;
 }
 
-bool HasRegExtension(const std::wstring& path) {
+bool IsRegFileTabPath(const std::wstring& path) {
   size_t dot = path.find_last_of(L'.');
   if (dot == std::wstring::npos) {
     return false;
   }
   std::wstring ext = path.substr(dot);
-  return _wcsicmp(ext.c_str(), L".reg") == 0;
+  return _wcsicmp(ext.c_str(), L".reg") == 0 || _wcsicmp(ext.c_str(), regkit::kRegSnapshotExtension) == 0;
 }
 
 bool LoadSingleInstanceSetting() {
@@ -560,7 +561,7 @@ int WINAPI wWinMain(HINSTANCE instance, HINSTANCE, PWSTR, int cmd_show) {
     if (!arg.empty() && arg[0] == L'-') {
       continue;
     }
-    if (HasRegExtension(arg)) {
+    if (IsRegFileTabPath(arg)) {
       window.OpenRegFileTab(arg);
     }
   }
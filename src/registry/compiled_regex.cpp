@@ -0,0 +1,1018 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "registry/compiled_regex.h"
+
+#include <algorithm>
+#include <cwctype>
+
+namespace regkit {
+
+namespace {
+
+constexpr uint32_t kUnbounded = 0xFFFFFFFFu;
+constexpr uint32_t kMaxRepeat = 1000;
+constexpr size_t kMaxProgram = 10000;
+constexpr size_t kMaxLiteral = 256;
+constexpr int kMaxDepth = 64;
+
+constexpr uint8_t kDigit = 0x01;
+constexpr uint8_t kNotDigit = 0x02;
+constexpr uint8_t kWord = 0x04;
+constexpr uint8_t kNotWord = 0x08;
+constexpr uint8_t kSpace = 0x10;
+constexpr uint8_t kNotSpace = 0x20;
+
+using Op = RegexInst::Op;
+
+wchar_t Fold(wchar_t ch) {
+  if (static_cast<uint32_t>(ch) < 0x80) {
+    return (ch >= L'A' && ch <= L'Z') ? static_cast<wchar_t>(ch + (L'a' - L'A')) : ch;
+  }
+  return static_cast<wchar_t>(towlower(static_cast<wint_t>(ch)));
+}
+
+bool IsWordChar(wchar_t ch) {
+  return ch == L'_' || iswalnum(static_cast<wint_t>(ch)) != 0;
+}
+
+bool IsLineTerminator(wchar_t ch) {
+  return ch == L'\n' || ch == L'\r' || ch == 0x2028 || ch == 0x2029;
+}
+
+bool AtWordBoundary(std::wstring_view text, size_t pos) {
+  bool before = pos > 0 && IsWordChar(text[pos - 1]);
+  bool after = pos < text.size() && IsWordChar(text[pos]);
+  return before != after;
+}
+
+bool ClassContains(const RegexClass& cls, wchar_t ch) {
+  for (const auto& range : cls.ranges) {
+    if (ch >= range.first && ch <= range.second) {
+      return true;
+    }
+  }
+  if (cls.kinds == 0) {
+    return false;
+  }
+  wint_t wide = static_cast<wint_t>(ch);
+  bool digit = iswdigit(wide) != 0;
+  bool word = IsWordChar(ch);
+  bool space = iswspace(wide) != 0;
+  return ((cls.kinds & kDigit) && digit) || ((cls.kinds & kNotDigit) && !digit) || ((cls.kinds & kWord) && word) || ((cls.kinds & kNotWord) && !word) || ((cls.kinds & kSpace) && space) || ((cls.kinds & kNotSpace) && !space);
+}
+
+bool ClassMatches(const RegexClass& cls, wchar_t ch, bool match_case) {
+  bool found = ClassContains(cls, ch);
+  if (!found && !match_case) {
+    found = ClassContains(cls, static_cast<wchar_t>(towlower(static_cast<wint_t>(ch)))) || ClassContains(cls, static_cast<wchar_t>(towupper(static_cast<wint_t>(ch))));
+  }
+  return found != cls.negated;
+}
+
+struct Node {
+  enum class Kind : uint8_t { kEmpty, kChar, kAny, kClass, kConcat, kAlternate, kRepeat, kLineStart, kLineEnd, kWordBoundary, kNotWordBoundary };
+
+  Kind kind = Kind::kEmpty;
+  wchar_t ch = 0;
+  uint32_t cls = 0;
+  uint32_t min = 0;
+  uint32_t max = 0;
+  bool greedy = true;
+  std::vector<uint32_t> children;
+};
+
+using Kind = Node::Kind;
+
+class Parser {
+public:
+  Parser(std::wstring_view pattern, bool match_case, std::vector<RegexClass>* classes) : pattern_(pattern), match_case_(match_case), classes_(classes) {}
+
+  bool Parse(uint32_t* root) { return ParseAlternation(root, 0) && pos_ == pattern_.size(); }
+
+  std::vector<Node> nodes;
+
+private:
+  uint32_t Add(Node node) {
+    nodes.push_back(std::move(node));
+    return static_cast<uint32_t>(nodes.size() - 1);
+  }
+
+  uint32_t AddKind(Kind kind) {
+    Node node;
+    node.kind = kind;
+    return Add(std::move(node));
+  }
+
+  uint32_t AddChar(wchar_t ch) {
+    Node node;
+    node.kind = Kind::kChar;
+    node.ch = match_case_ ? ch : Fold(ch);
+    return Add(std::move(node));
+  }
+
+  uint32_t AddClass(RegexClass cls) {
+    for (wchar_t ch = 0; ch < 0x80; ++ch) {
+      if (ClassMatches(cls, ch, match_case_)) {
+        cls.ascii[ch >> 6] |= 1ull << (ch & 63);
+      }
+    }
+    classes_->push_back(std::move(cls));
+    Node node;
+    node.kind = Kind::kClass;
+    node.cls = static_cast<uint32_t>(classes_->size() - 1);
+    return Add(std::move(node));
+  }
+
+  bool Peek(wchar_t ch) const { return pos_ < pattern_.size() && pattern_[pos_] == ch; }
+
+  bool Nullable(uint32_t index) const {
+    const Node& node = nodes[index];
+    switch (node.kind) {
+    case Kind::kChar:
+    case Kind::kAny:
+    case Kind::kClass:
+      return false;
+    case Kind::kConcat:
+      return std::all_of(node.children.begin(), node.children.end(), [&](uint32_t child) { return Nullable(child); });
+    case Kind::kAlternate:
+      return std::any_of(node.children.begin(), node.children.end(), [&](uint32_t child) { return Nullable(child); });
+    case Kind::kRepeat:
+      return node.min == 0 || Nullable(node.children.front());
+    default:
+      return true;
+    }
+  }
+
+  bool ParseAlternation(uint32_t* out, int depth) {
+    if (depth > kMaxDepth) {
+      return false;
+    }
+    Node alternate;
+    alternate.kind = Kind::kAlternate;
+    for (;;) {
+      uint32_t sequence = 0;
+      if (!ParseSequence(&sequence, depth)) {
+        return false;
+      }
+      alternate.children.push_back(sequence);
+      if (!Peek(L'|')) {
+        break;
+      }
+      ++pos_;
+    }
+    *out = alternate.children.size() == 1 ? alternate.children.front() : Add(std::move(alternate));
+    return true;
+  }
+
+  bool ParseSequence(uint32_t* out, int depth) {
+    Node concat;
+    concat.kind = Kind::kConcat;
+    while (pos_ < pattern_.size() && pattern_[pos_] != L'|' && pattern_[pos_] != L')') {
+      uint32_t atom = 0;
+      bool quantifiable = true;
+      if (!ParseAtom(&atom, &quantifiable, depth) || !ParseQuantifier(&atom, quantifiable)) {
+        return false;
+      }
+      concat.children.push_back(atom);
+    }
+    if (concat.children.empty()) {
+      *out = AddKind(Kind::kEmpty);
+    } else if (concat.children.size() == 1) {
+      *out = concat.children.front();
+    } else {
+      *out = Add(std::move(concat));
+    }
+    return true;
+  }
+
+  bool ParseCount(uint32_t* value) {
+    size_t digits = 0;
+    uint32_t result = 0;
+    while (pos_ < pattern_.size() && pattern_[pos_] >= L'0' && pattern_[pos_] <= L'9') {
+      if (++digits > 4) {
+        return false;
+      }
+      result = result * 10 + static_cast<uint32_t>(pattern_[pos_] - L'0');
+      ++pos_;
+    }
+    *value = result;
+    return digits > 0 && result <= kMaxRepeat;
+  }
+
+  bool ParseQuantifier(uint32_t* atom, bool quantifiable) {
+    if (pos_ >= pattern_.size()) {
+      return true;
+    }
+    uint32_t min = 0;
+    uint32_t max = 0;
+    switch (pattern_[pos_]) {
+    case L'*':
+      max = kUnbounded;
+      ++pos_;
+      break;
+    case L'+':
+      min = 1;
+      max = kUnbounded;
+      ++pos_;
+      break;
+    case L'?':
+      max = 1;
+      ++pos_;
+      break;
+    case L'{':
+      ++pos_;
+      if (!ParseCount(&min)) {
+        return false;
+      }
+      max = min;
+      if (Peek(L',')) {
+        ++pos_;
+        max = kUnbounded;
+        if (!Peek(L'}') && (!ParseCount(&max) || max < min)) {
+          return false;
+        }
+      }
+      if (!Peek(L'}')) {
+        return false;
+      }
+      ++pos_;
+      break;
+    default:
+      return true;
+    }
+    if (!quantifiable || (max > min && Nullable(*atom))) {
+      return false;
+    }
+    Node repeat;
+    repeat.kind = Kind::kRepeat;
+    repeat.min = min;
+    repeat.max = max;
+    if (Peek(L'?')) {
+      repeat.greedy = false;
+      ++pos_;
+    }
+    repeat.children.push_back(*atom);
+    *atom = Add(std::move(repeat));
+    return !(Peek(L'*') || Peek(L'+') || Peek(L'?') || Peek(L'{'));
+  }
+
+  bool ParseHex(size_t digits, wchar_t* out) {
+    if (pattern_.size() - pos_ < digits) {
+      return false;
+    }
+    uint32_t value = 0;
+    for (size_t i = 0; i < digits; ++i) {
+      wchar_t ch = pattern_[pos_++];
+      uint32_t digit = 0;
+      if (ch >= L'0' && ch <= L'9') {
+        digit = static_cast<uint32_t>(ch - L'0');
+      } else if (ch >= L'a' && ch <= L'f') {
+        digit = static_cast<uint32_t>(ch - L'a' + 10);
+      } else if (ch >= L'A' && ch <= L'F') {
+        digit = static_cast<uint32_t>(ch - L'A' + 10);
+      } else {
+        return false;
+      }
+      value = value * 16 + digit;
+    }
+    *out = static_cast<wchar_t>(value);
+    return true;
+  }
+
+  bool ParseCharEscape(wchar_t* out) {
+    wchar_t ch = pattern_[pos_++];
+    switch (ch) {
+    case L'f':
+      *out = L'\f';
+      return true;
+    case L'n':
+      *out = L'\n';
+      return true;
+    case L'r':
+      *out = L'\r';
+      return true;
+    case L't':
+      *out = L'\t';
+      return true;
+    case L'v':
+      *out = L'\v';
+      return true;
+    case L'0':
+      *out = 0;
+      return !(pos_ < pattern_.size() && pattern_[pos_] >= L'0' && pattern_[pos_] <= L'9');
+    case L'x':
+      return ParseHex(2, out);
+    case L'u':
+      return ParseHex(4, out);
+    case L'c':
+      if (pos_ < pattern_.size() && ((pattern_[pos_] >= L'a' && pattern_[pos_] <= L'z') || (pattern_[pos_] >= L'A' && pattern_[pos_] <= L'Z'))) {
+        *out = static_cast<wchar_t>(pattern_[pos_++] % 32);
+        return true;
+      }
+      return false;
+    default:
+      *out = ch;
+      return ch != L'_' && !iswalnum(static_cast<wint_t>(ch));
+    }
+  }
+
+  static uint8_t ClassKind(wchar_t ch) {
+    switch (ch) {
+    case L'd':
+      return kDigit;
+    case L'D':
+      return kNotDigit;
+    case L'w':
+      return kWord;
+    case L'W':
+      return kNotWord;
+    case L's':
+      return kSpace;
+    case L'S':
+      return kNotSpace;
+    default:
+      return 0;
+    }
+  }
+
+  bool ParseClassAtom(wchar_t* ch, uint8_t* kind) {
+    wchar_t next = pattern_[pos_++];
+    if (next != L'\\') {
+      *ch = next;
+      return true;
+    }
+    if (pos_ >= pattern_.size()) {
+      return false;
+    }
+    next = pattern_[pos_];
+    if ((*kind = ClassKind(next)) != 0) {
+      ++pos_;
+      return true;
+    }
+    if (next == L'b' || next == L'-') {
+      ++pos_;
+      *ch = next == L'b' ? L'\b' : L'-';
+      return true;
+    }
+    return ParseCharEscape(ch);
+  }
+
+  bool ParseClass(uint32_t* out) {
+    RegexClass cls;
+    if (Peek(L'^')) {
+      cls.negated = true;
+      ++pos_;
+    }
+    if (Peek(L']')) {
+      return false;
+    }
+    for (;;) {
+      if (pos_ >= pattern_.size() || Peek(L'[')) {
+        return false;
+      }
+      if (Peek(L']')) {
+        ++pos_;
+        break;
+      }
+      wchar_t low = 0;
+      uint8_t kind = 0;
+      if (!ParseClassAtom(&low, &kind)) {
+        return false;
+      }
+      bool range = Peek(L'-') && pos_ + 1 < pattern_.size() && pattern_[pos_ + 1] != L']';
+      if (kind != 0) {
+        if (range) {
+          return false;
+        }
+        cls.kinds |= kind;
+        continue;
+      }
+      if (!range) {
+        cls.ranges.emplace_back(low, low);
+        continue;
+      }
+      ++pos_;
+      wchar_t high = 0;
+      uint8_t high_kind = 0;
+      if (Peek(L'[') || !ParseClassAtom(&high, &high_kind) || high_kind != 0 || high < low) {
+        return false;
+      }
+      cls.ranges.emplace_back(low, high);
+    }
+    *out = AddClass(std::move(cls));
+    return true;
+  }
+
+  bool ParseAtom(uint32_t* out, bool* quantifiable, int depth) {
+    wchar_t ch = pattern_[pos_++];
+    switch (ch) {
+    case L'^':
+      *quantifiable = false;
+      *out = AddKind(Kind::kLineStart);
+      return true;
+    case L'$':
+      *quantifiable = false;
+      *out = AddKind(Kind::kLineEnd);
+      return true;
+    case L'.':
+      *out = AddKind(Kind::kAny);
+      return true;
+    case L'(':
+      if (Peek(L'?')) {
+        if (pos_ + 1 >= pattern_.size() || pattern_[pos_ + 1] != L':') {
+          return false;
+        }
+        pos_ += 2;
+      }
+      if (!ParseAlternation(out, depth + 1) || !Peek(L')')) {
+        return false;
+      }
+      ++pos_;
+      return true;
+    case L'[':
+      return ParseClass(out);
+    case L'\\': {
+      if (pos_ >= pattern_.size()) {
+        return false;
+      }
+      wchar_t next = pattern_[pos_];
+      if (next == L'b' || next == L'B') {
+        ++pos_;
+        *quantifiable = false;
+        *out = AddKind(next == L'b' ? Kind::kWordBoundary : Kind::kNotWordBoundary);
+        return true;
+      }
+      if (uint8_t kind = ClassKind(next)) {
+        ++pos_;
+        RegexClass cls;
+        cls.kinds = kind;
+        *out = AddClass(std::move(cls));
+        return true;
+      }
+      wchar_t value = 0;
+      if (!ParseCharEscape(&value)) {
+        return false;
+      }
+      *out = AddChar(value);
+      return true;
+    }
+    case L')':
+    case L'*':
+    case L'+':
+    case L'?':
+    case L'{':
+    case L'}':
+    case L']':
+      return false;
+    default:
+      *out = AddChar(ch);
+      return true;
+    }
+  }
+
+  std::wstring_view pattern_;
+  size_t pos_ = 0;
+  bool match_case_ = true;
+  std::vector<RegexClass>* classes_ = nullptr;
+};
+
+size_t ProgramSize(const std::vector<Node>& nodes, uint32_t index) {
+  const Node& node = nodes[index];
+  size_t size = 0;
+  switch (node.kind) {
+  case Kind::kEmpty:
+    return 0;
+  case Kind::kConcat:
+  case Kind::kAlternate:
+    for (uint32_t child : node.children) {
+      size += ProgramSize(nodes, child);
+    }
+    if (node.kind == Kind::kAlternate) {
+      size += 2 * (node.children.size() - 1);
+    }
+    return std::min(size, kMaxProgram + 1);
+  case Kind::kRepeat: {
+    size_t child = ProgramSize(nodes, node.children.front());
+    size = child * node.min;
+    size += node.max == kUnbounded ? child + 2 : (child + 1) * (node.max - node.min);
+    return std::min(size, kMaxProgram + 1);
+  }
+  default:
+    return 1;
+  }
+}
+
+class Emitter {
+public:
+  Emitter(const std::vector<Node>& nodes, std::vector<RegexInst>* program) : nodes_(nodes), program_(program) {}
+
+  void Emit(uint32_t index) {
+    const Node& node = nodes_[index];
+    switch (node.kind) {
+    case Kind::kEmpty:
+      break;
+    case Kind::kChar:
+      Push(Op::kChar)->ch = node.ch;
+      break;
+    case Kind::kAny:
+      Push(Op::kAny);
+      break;
+    case Kind::kClass:
+      Push(Op::kClass)->x = node.cls;
+      break;
+    case Kind::kLineStart:
+      Push(Op::kLineStart);
+      break;
+    case Kind::kLineEnd:
+      Push(Op::kLineEnd);
+      break;
+    case Kind::kWordBoundary:
+      Push(Op::kWordBoundary);
+      break;
+    case Kind::kNotWordBoundary:
+      Push(Op::kNotWordBoundary);
+      break;
+    case Kind::kConcat:
+      for (uint32_t child : node.children) {
+        Emit(child);
+      }
+      break;
+    case Kind::kAlternate: {
+      std::vector<size_t> jumps;
+      for (size_t i = 0; i < node.children.size(); ++i) {
+        if (i + 1 == node.children.size()) {
+          Emit(node.children[i]);
+          break;
+        }
+        size_t split = Here();
+        Push(Op::kSplit);
+        Emit(node.children[i]);
+        jumps.push_back(Here());
+        Push(Op::kJump);
+        SetSplit(split, split + 1, Here(), true);
+      }
+      for (size_t jump : jumps) {
+        (*program_)[jump].x = static_cast<uint32_t>(Here());
+      }
+      break;
+    }
+    case Kind::kRepeat: {
+      uint32_t child = node.children.front();
+      for (uint32_t i = 0; i < node.min; ++i) {
+        Emit(child);
+      }
+      if (node.max == kUnbounded) {
+        size_t split = Here();
+        Push(Op::kSplit);
+        Emit(child);
+        Push(Op::kJump)->x = static_cast<uint32_t>(split);
+        SetSplit(split, split + 1, Here(), node.greedy);
+        break;
+      }
+      std::vector<size_t> splits;
+      for (uint32_t i = node.min; i < node.max; ++i) {
+        splits.push_back(Here());
+        Push(Op::kSplit);
+        Emit(child);
+      }
+      for (size_t split : splits) {
+        SetSplit(split, split + 1, Here(), node.greedy);
+      }
+      break;
+    }
+    }
+  }
+
+private:
+  size_t Here() const { return program_->size(); }
+
+  RegexInst* Push(Op op) {
+    program_->emplace_back();
+    program_->back().op = op;
+    return &program_->back();
+  }
+
+  void SetSplit(size_t split, size_t body, size_t skip, bool greedy) {
+    RegexInst& inst = (*program_)[split];
+    inst.x = static_cast<uint32_t>(greedy ? body : skip);
+    inst.y = static_cast<uint32_t>(greedy ? skip : body);
+  }
+
+  const std::vector<Node>& nodes_;
+  std::vector<RegexInst>* program_;
+};
+
+struct LiteralInfo {
+  bool exact = false;
+  bool pure = true;
+  std::wstring text;
+  std::wstring required;
+};
+
+void KeepLonger(std::wstring* best, const std::wstring& candidate) {
+  if (candidate.size() > best->size()) {
+    *best = candidate;
+  }
+}
+
+LiteralInfo AnalyzeLiterals(const std::vector<Node>& nodes, uint32_t index) {
+  const Node& node = nodes[index];
+  LiteralInfo info;
+  switch (node.kind) {
+  case Kind::kEmpty:
+    info.exact = true;
+    break;
+  case Kind::kChar:
+    info.exact = true;
+    info.text.assign(1, node.ch);
+    break;
+  case Kind::kLineStart:
+  case Kind::kLineEnd:
+  case Kind::kWordBoundary:
+  case Kind::kNotWordBoundary:
+    info.exact = true;
+    info.pure = false;
+    break;
+  case Kind::kConcat: {
+    info.exact = true;
+    std::wstring run;
+    for (uint32_t child : node.children) {
+      LiteralInfo part = AnalyzeLiterals(nodes, child);
+      info.pure = info.pure && part.pure;
+      if (part.exact && run.size() + part.text.size() <= kMaxLiteral) {
+        run += part.text;
+        continue;
+      }
+      info.exact = false;
+      KeepLonger(&info.required, run);
+      KeepLonger(&info.required, part.exact ? part.text : part.required);
+      run.clear();
+    }
+    if (info.exact) {
+      info.text = run;
+    }
+    KeepLonger(&info.required, run);
+    break;
+  }
+  case Kind::kAlternate: {
+    bool first = true;
+    for (uint32_t child : node.children) {
+      LiteralInfo part = AnalyzeLiterals(nodes, child);
+      if (!part.exact) {
+        info.required.clear();
+        break;
+      }
+      if (first) {
+        info.required = part.text;
+        first = false;
+        continue;
+      }
+      size_t common = 0;
+      while (common < info.required.size() && common < part.text.size() && info.required[common] == part.text[common]) {
+        ++common;
+      }
+      info.required.resize(common);
+    }
+    break;
+  }
+  case Kind::kRepeat: {
+    LiteralInfo part = AnalyzeLiterals(nodes, node.children.front());
+    if (part.exact && node.min == node.max && part.text.size() * node.min <= kMaxLiteral) {
+      info.exact = true;
+      info.pure = part.pure;
+      for (uint32_t i = 0; i < node.min; ++i) {
+        info.text += part.text;
+      }
+    } else if (node.min > 0) {
+      info.required = part.exact ? part.text : part.required;
+    }
+    break;
+  }
+  default:
+    break;
+  }
+  if (info.exact) {
+    KeepLonger(&info.required, info.text);
+  }
+  return info;
+}
+
+bool StartsAnchored(const std::vector<Node>& nodes, uint32_t index) {
+  const Node& node = nodes[index];
+  switch (node.kind) {
+  case Kind::kLineStart:
+    return true;
+  case Kind::kConcat:
+    return StartsAnchored(nodes, node.children.front());
+  case Kind::kRepeat:
+    return node.min > 0 && StartsAnchored(nodes, node.children.front());
+  case Kind::kAlternate:
+    return std::all_of(node.children.begin(), node.children.end(), [&](uint32_t child) { return StartsAnchored(nodes, child); });
+  default:
+    return false;
+  }
+}
+
+struct ThreadList {
+  std::vector<uint32_t> sparse;
+  std::vector<uint32_t> pcs;
+  std::vector<size_t> starts;
+  size_t size = 0;
+
+  void Prepare(size_t count) {
+    if (sparse.size() < count) {
+      sparse.resize(count);
+      pcs.resize(count);
+      starts.resize(count);
+    }
+    size = 0;
+  }
+
+  bool Contains(uint32_t pc) const {
+    uint32_t slot = sparse[pc];
+    return slot < size && pcs[slot] == pc;
+  }
+
+  void Add(uint32_t pc, size_t start) {
+    sparse[pc] = static_cast<uint32_t>(size);
+    pcs[size] = pc;
+    starts[size] = start;
+    ++size;
+  }
+};
+
+struct PikeScratch {
+  ThreadList lists[2];
+  std::vector<uint32_t> stack;
+};
+
+void AddThread(const std::vector<RegexInst>& program, std::wstring_view text, size_t pos, uint32_t pc, size_t start, ThreadList* list, std::vector<uint32_t>* stack) {
+  stack->push_back(pc);
+  while (!stack->empty()) {
+    pc = stack->back();
+    stack->pop_back();
+    if (list->Contains(pc)) {
+      continue;
+    }
+    list->Add(pc, start);
+    const RegexInst& inst = program[pc];
+    switch (inst.op) {
+    case Op::kJump:
+      stack->push_back(inst.x);
+      break;
+    case Op::kSplit:
+      stack->push_back(inst.y);
+      stack->push_back(inst.x);
+      break;
+    case Op::kLineStart:
+      if (pos == 0) {
+        stack->push_back(pc + 1);
+      }
+      break;
+    case Op::kLineEnd:
+      if (pos == text.size()) {
+        stack->push_back(pc + 1);
+      }
+      break;
+    case Op::kWordBoundary:
+    case Op::kNotWordBoundary:
+      if (AtWordBoundary(text, pos) == (inst.op == Op::kWordBoundary)) {
+        stack->push_back(pc + 1);
+      }
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+} // namespace
+
+bool CompiledRegex::Compile(std::wstring_view pattern, bool match_case) {
+  *this = CompiledRegex();
+  match_case_ = match_case;
+  Parser parser(pattern, match_case, &classes_);
+  uint32_t root = 0;
+  if (!parser.Parse(&root) || ProgramSize(parser.nodes, root) > kMaxProgram) {
+    classes_.clear();
+    return false;
+  }
+  Emitter(parser.nodes, &program_).Emit(root);
+  program_.emplace_back();
+  program_.back().op = Op::kMatch;
+
+  LiteralInfo literals = AnalyzeLiterals(parser.nodes, root);
+  literal_ = literals.required.substr(0, kMaxLiteral);
+  exact_ = literals.exact && literals.pure && !literals.text.empty() && literals.text.size() <= kMaxLiteral;
+  anchored_ = StartsAnchored(parser.nodes, root);
+
+  std::vector<uint32_t> stack = {0};
+  std::vector<bool> seen(program_.size());
+  first_filter_ = true;
+  while (!stack.empty() && first_filter_) {
+    uint32_t pc = stack.back();
+    stack.pop_back();
+    if (seen[pc]) {
+      continue;
+    }
+    seen[pc] = true;
+    const RegexInst& inst = program_[pc];
+    switch (inst.op) {
+    case Op::kSplit:
+      stack.push_back(inst.x);
+      stack.push_back(inst.y);
+      break;
+    case Op::kJump:
+      stack.push_back(inst.x);
+      break;
+    case Op::kChar:
+      if (static_cast<uint32_t>(inst.ch) >= 0x80 || (!match_case_ && iswalpha(static_cast<wint_t>(inst.ch)))) {
+        first_other_ = true;
+      }
+      if (static_cast<uint32_t>(inst.ch) < 0x80) {
+        first_ascii_[inst.ch >> 6] |= 1ull << (inst.ch & 63);
+        if (!match_case_ && inst.ch >= L'a' && inst.ch <= L'z') {
+          wchar_t upper = static_cast<wchar_t>(inst.ch - (L'a' - L'A'));
+          first_ascii_[upper >> 6] |= 1ull << (upper & 63);
+        }
+      }
+      break;
+    case Op::kClass:
+      first_ascii_[0] |= classes_[inst.x].ascii[0];
+      first_ascii_[1] |= classes_[inst.x].ascii[1];
+      first_other_ = true;
+      break;
+    case Op::kAny:
+    case Op::kMatch:
+      first_filter_ = false;
+      break;
+    default:
+      stack.push_back(pc + 1);
+      break;
+    }
+  }
+  compiled_ = true;
+  return true;
+}
+
+bool CompiledRegex::Consumes(const RegexInst& inst, wchar_t ch) const {
+  switch (inst.op) {
+  case Op::kChar:
+    return (match_case_ ? ch : Fold(ch)) == inst.ch;
+  case Op::kAny:
+    return !IsLineTerminator(ch);
+  case Op::kClass: {
+    const RegexClass& cls = classes_[inst.x];
+    if (static_cast<uint32_t>(ch) < 0x80) {
+      return (cls.ascii[ch >> 6] >> (ch & 63)) & 1;
+    }
+    return ClassMatches(cls, ch, match_case_);
+  }
+  default:
+    return false;
+  }
+}
+
+bool CompiledRegex::MayStart(wchar_t ch) const {
+  if (static_cast<uint32_t>(ch) < 0x80) {
+    return (first_ascii_[ch >> 6] >> (ch & 63)) & 1;
+  }
+  return first_other_;
+}
+
+size_t CompiledRegex::FindLiteral(std::wstring_view text) const {
+  if (match_case_) {
+    return text.find(literal_);
+  }
+  size_t count = literal_.size();
+  if (count > text.size()) {
+    return std::wstring_view::npos;
+  }
+  wchar_t first = literal_.front();
+  for (size_t i = 0; i + count <= text.size(); ++i) {
+    if (Fold(text[i]) != first) {
+      continue;
+    }
+    size_t k = 1;
+    while (k < count && Fold(text[i + k]) == literal_[k]) {
+      ++k;
+    }
+    if (k == count) {
+      return i;
+    }
+  }
+  return std::wstring_view::npos;
+}
+
+bool CompiledRegex::Run(std::wstring_view text, bool whole, RegexMatch* match) const {
+  thread_local PikeScratch scratch;
+  scratch.lists[0].Prepare(program_.size());
+  scratch.lists[1].Prepare(program_.size());
+  ThreadList* current = &scratch.lists[0];
+  ThreadList* next = &scratch.lists[1];
+  bool anchored = whole || anchored_;
+  bool matched = false;
+  size_t match_start = 0;
+  size_t match_end = 0;
+  size_t count = text.size();
+  for (size_t pos = 0;; ++pos) {
+    if (!matched && (pos == 0 || !anchored)) {
+      if (current->size == 0 && first_filter_ && !anchored) {
+        while (pos < count && !MayStart(text[pos])) {
+          ++pos;
+        }
+        if (pos >= count) {
+          break;
+        }
+      }
+      AddThread(program_, text, pos, 0, pos, current, &scratch.stack);
+    }
+    if (current->size == 0) {
+      break;
+    }
+    for (size_t i = 0; i < current->size; ++i) {
+      const RegexInst& inst = program_[current->pcs[i]];
+      if (inst.op == Op::kMatch) {
+        if (whole && pos != count) {
+          continue;
+        }
+        matched = true;
+        match_start = current->starts[i];
+        match_end = pos;
+        break;
+      }
+      if (pos < count && Consumes(inst, text[pos])) {
+        AddThread(program_, text, pos + 1, current->pcs[i] + 1, current->starts[i], next, &scratch.stack);
+      }
+    }
+    if (pos >= count || (whole && matched)) {
+      break;
+    }
+    std::swap(current, next);
+    next->size = 0;
+  }
+  if (matched && match) {
+    match->start = match_start;
+    match->length = match_end - match_start;
+  }
+  return matched;
+}
+
+bool CompiledRegex::Search(std::wstring_view text, RegexMatch* match) const {
+  if (!compiled_) {
+    return false;
+  }
+  if (!literal_.empty()) {
+    size_t pos = FindLiteral(text);
+    if (pos == std::wstring_view::npos) {
+      return false;
+    }
+    if (exact_) {
+      if (match) {
+        match->start = pos;
+        match->length = literal_.size();
+      }
+      return true;
+    }
+  }
+  return Run(text, false, match);
+}
+
+bool CompiledRegex::MatchWhole(std::wstring_view text, RegexMatch* match) const {
+  if (!compiled_) {
+    return false;
+  }
+  if (!literal_.empty()) {
+    if (exact_) {
+      if (text.size() != literal_.size() || FindLiteral(text) != 0) {
+        return false;
+      }
+      if (match) {
+        match->start = 0;
+        match->length = text.size();
+      }
+      return true;
+    }
+    if (FindLiteral(text) == std::wstring_view::npos) {
+      return false;
+    }
+  }
+  return Run(text, true, match);
+}
+
+} // namespace regkit
@@ -0,0 +1,138 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "registry/hex_bytes.h"
+
+#include <bit>
+
+#if !defined(REGKIT_HEX_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define REGKIT_HEX_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace regkit {
+
+namespace {
+
+int HexDigit(wchar_t ch) {
+  if (ch >= L'0' && ch <= L'9') {
+    return ch - L'0';
+  }
+  if (ch >= L'a' && ch <= L'f') {
+    return 10 + (ch - L'a');
+  }
+  if (ch >= L'A' && ch <= L'F') {
+    return 10 + (ch - L'A');
+  }
+  return -1;
+}
+
+struct HexState {
+  uint8_t* out = nullptr;
+  int pending = -1;
+
+  void Push(int value) {
+    if (pending < 0) {
+      pending = value;
+      return;
+    }
+    *out++ = static_cast<uint8_t>((pending << 4) | value);
+    pending = -1;
+  }
+};
+
+void DecodeScalar(const wchar_t* text, size_t count, HexState* state) {
+  for (size_t i = 0; i < count; ++i) {
+    int value = HexDigit(text[i]);
+    if (value >= 0) {
+      state->Push(value);
+    }
+  }
+}
+
+#ifdef REGKIT_HEX_SSE2
+constexpr size_t kHexBlock = 16;
+
+__m128i LoadUnits(const wchar_t* text) {
+  if constexpr (sizeof(wchar_t) == 2) {
+    __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+    __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + 8));
+    return _mm_packus_epi16(low, high);
+  } else {
+    const __m128i* units = reinterpret_cast<const __m128i*>(text);
+    __m128i low = _mm_packs_epi32(_mm_loadu_si128(units), _mm_loadu_si128(units + 1));
+    __m128i high = _mm_packs_epi32(_mm_loadu_si128(units + 2), _mm_loadu_si128(units + 3));
+    return _mm_packus_epi16(low, high);
+  }
+}
+
+size_t DecodeSse2(const wchar_t* text, size_t count, HexState* state) {
+  const __m128i zero_below = _mm_set1_epi8('0' - 1);
+  const __m128i nine_above = _mm_set1_epi8('9' + 1);
+  const __m128i a_below = _mm_set1_epi8('a' - 1);
+  const __m128i f_above = _mm_set1_epi8('f' + 1);
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  const __m128i digit_base = _mm_set1_epi8('0');
+  const __m128i alpha_base = _mm_set1_epi8('a' - 10);
+  const __m128i low_byte = _mm_set1_epi16(0x00FF);
+  alignas(16) uint8_t nibbles[kHexBlock];
+  size_t i = 0;
+  for (; i + kHexBlock <= count; i += kHexBlock) {
+    __m128i bytes = LoadUnits(text + i);
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(bytes, zero_below), _mm_cmplt_epi8(bytes, nine_above));
+    __m128i lower = _mm_or_si128(bytes, case_bit);
+    __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, a_below), _mm_cmplt_epi8(lower, f_above));
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(digit, alpha)));
+    if (!mask) {
+      continue;
+    }
+    __m128i values = _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(bytes, digit_base)), _mm_andnot_si128(digit, _mm_sub_epi8(lower, alpha_base)));
+    if (mask == 0xFFFF && state->pending < 0) {
+      __m128i high = _mm_and_si128(_mm_slli_epi16(values, 4), low_byte);
+      __m128i combined = _mm_or_si128(high, _mm_srli_epi16(values, 8));
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(state->out), _mm_packus_epi16(combined, combined));
+      state->out += kHexBlock / 2;
+      continue;
+    }
+    _mm_store_si128(reinterpret_cast<__m128i*>(nibbles), values);
+    while (mask) {
+      state->Push(nibbles[std::countr_zero(mask)]);
+      mask &= mask - 1;
+    }
+  }
+  return i;
+}
+#endif
+
+} // namespace
+
+bool ParseHexBytes(std::wstring_view text, std::vector<uint8_t>* out) {
+  if (!out) {
+    return false;
+  }
+  out->resize(text.size() / 2);
+  HexState state;
+  state.out = out->data();
+  size_t done = 0;
+#ifdef REGKIT_HEX_SSE2
+  done = DecodeSse2(text.data(), text.size(), &state);
+#endif
+  DecodeScalar(text.data() + done, text.size() - done, &state);
+  out->resize(static_cast<size_t>(state.out - out->data()));
+  return state.pending < 0;
+}
+
+} // namespace regkit
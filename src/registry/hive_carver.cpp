@@ -0,0 +1,453 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "registry/hive_carver.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REGKIT_CARVER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace regkit {
+
+namespace {
+
+constexpr uint32_t kHbinHeaderSize = 32;
+constexpr uint32_t kKeyNodeNameOffset = 0x4C;
+constexpr uint32_t kValueNameOffset = 0x14;
+constexpr uint32_t kSecurityDescriptorOffset = 0x14;
+constexpr uint16_t kKeyCompressedName = 0x0020;
+constexpr uint16_t kValueCompressedName = 0x0001;
+constexpr uint32_t kResidentDataFlag = 0x80000000u;
+constexpr uint32_t kMaxKeyNameBytes = 255 * 2;
+constexpr uint32_t kMaxValueNameBytes = 16383 * 2;
+constexpr uint32_t kMaxCarvedCount = 0x00FFFFFFu;
+constexpr uint32_t kMaxCarvedValueList = 0x10000;
+constexpr uint32_t kMaxCarvedDataSize = 0x40000000u;
+constexpr uint32_t kMinDescriptorSize = 20;
+constexpr uint64_t kMinFileTime = 116444736000000000ull;
+constexpr uint64_t kMaxFileTime = 157469184000000000ull;
+constexpr uint32_t kMinSlackSize = 0x18;
+
+uint16_t Read16(const uint8_t* data) {
+  uint16_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t Read32(const uint8_t* data) {
+  uint32_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint64_t Read64(const uint8_t* data) {
+  uint64_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+unsigned int ClampThreads(unsigned int thread_count, size_t work) {
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+  return static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(thread_count, work)));
+}
+
+void RunThreads(unsigned int thread_count, const std::function<void(unsigned int index)>& body) {
+  if (thread_count <= 1) {
+    body(0);
+    return;
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (unsigned int i = 1; i < thread_count; ++i) {
+    threads.emplace_back(body, i);
+  }
+  body(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+bool IsCancelled(const std::atomic_bool* cancel) {
+  return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+bool IsSignatureByte(uint8_t ch) {
+  return ch == 'n' || ch == 'v' || ch == 's';
+}
+
+template <typename Callback>
+void FindSignatures(const uint8_t* bins, uint32_t begin, uint32_t end, Callback&& callback) {
+  uint32_t offset = begin;
+#if defined(REGKIT_CARVER_SSE2)
+  const __m128i k = _mm_set1_epi8('k');
+  const __m128i n = _mm_set1_epi8('n');
+  const __m128i v = _mm_set1_epi8('v');
+  const __m128i s = _mm_set1_epi8('s');
+  while (end - offset >= 64) {
+    uint64_t k_mask = 0;
+    uint64_t lead_mask = 0;
+    for (int lane = 0; lane < 4; ++lane) {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bins + offset + lane * 16));
+      __m128i lead = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, n), _mm_cmpeq_epi8(block, v)), _mm_cmpeq_epi8(block, s));
+      k_mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, k)))) << (lane * 16);
+      lead_mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(lead))) << (lane * 16);
+    }
+    uint64_t hits = (k_mask >> 1) & lead_mask & 0x1010101010101010ull;
+    while (hits) {
+      callback(offset + static_cast<uint32_t>(std::countr_zero(hits)));
+      hits &= hits - 1;
+    }
+    offset += 64;
+  }
+#endif
+  for (offset += 4; offset < end && end - offset >= 2; offset += 8) {
+    if (bins[offset + 1] == 'k' && IsSignatureByte(bins[offset])) {
+      callback(offset);
+    }
+  }
+}
+
+bool CellFits(const uint8_t* bins, uint32_t record, uint32_t limit, uint64_t needed) {
+  int32_t raw = static_cast<int32_t>(Read32(bins + record - 4));
+  uint32_t cell_size = raw < 0 ? static_cast<uint32_t>(-static_cast<int64_t>(raw)) : static_cast<uint32_t>(raw);
+  return (cell_size & 7) == 0 && cell_size >= 4 + needed && cell_size <= limit - (record - 4);
+}
+
+bool IsPlausibleName(const uint8_t* data, uint32_t bytes, bool compressed, bool key) {
+  if (compressed) {
+    for (uint32_t i = 0; i < bytes; ++i) {
+      if (data[i] < 0x20 || (key && data[i] == '\\')) {
+        return false;
+      }
+    }
+    return true;
+  }
+  if (bytes & 1) {
+    return false;
+  }
+  for (uint32_t i = 0; i < bytes; i += 2) {
+    uint16_t unit = Read16(data + i);
+    if (unit < 0x20 || (key && unit == L'\\')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsPlausibleCell(uint32_t cell, uint32_t bins_size) {
+  return (cell & 7) == 0 && cell < bins_size;
+}
+
+bool CarveKey(const HiveReader& reader, uint32_t record, uint32_t limit, CarvedKey* key) {
+  const uint8_t* bins = reader.bins();
+  if (limit - record < kKeyNodeNameOffset) {
+    return false;
+  }
+  const uint8_t* node = bins + record;
+  uint32_t name_bytes = Read16(node + 0x48);
+  if (name_bytes == 0 || name_bytes > kMaxKeyNameBytes || kKeyNodeNameOffset + name_bytes > limit - record) {
+    return false;
+  }
+  if (!CellFits(bins, record, limit, kKeyNodeNameOffset + name_bytes)) {
+    return false;
+  }
+  uint64_t last_write = Read64(node + 0x04);
+  if (last_write < kMinFileTime || last_write > kMaxFileTime) {
+    return false;
+  }
+  uint32_t parent = Read32(node + 0x10);
+  if (parent != HiveReader::kNoCell && !IsPlausibleCell(parent, reader.bins_size())) {
+    return false;
+  }
+  if (Read32(node + 0x14) > kMaxCarvedCount || Read32(node + 0x24) > kMaxCarvedCount) {
+    return false;
+  }
+  HiveName name;
+  name.data = node + kKeyNodeNameOffset;
+  name.bytes = name_bytes;
+  name.compressed = (Read16(node + 0x02) & kKeyCompressedName) != 0;
+  if (!IsPlausibleName(name.data, name.bytes, name.compressed, true)) {
+    return false;
+  }
+  key->cell = record - 4;
+  key->name = name.ToString();
+  key->last_write = last_write;
+  key->parent = parent;
+  key->value_count = Read32(node + 0x24);
+  key->values.clear();
+  return true;
+}
+
+bool CarveValue(const HiveReader& reader, uint32_t record, uint32_t limit, std::vector<uint8_t>* scratch, CarvedValue* value) {
+  const uint8_t* bins = reader.bins();
+  if (limit - record < kValueNameOffset) {
+    return false;
+  }
+  const uint8_t* vk = bins + record;
+  uint32_t name_bytes = Read16(vk + 0x02);
+  if (name_bytes > kMaxValueNameBytes || kValueNameOffset + name_bytes > limit - record) {
+    return false;
+  }
+  if (!CellFits(bins, record, limit, kValueNameOffset + name_bytes)) {
+    return false;
+  }
+  uint16_t flags = Read16(vk + 0x10);
+  if ((flags & ~0x0003u) != 0) {
+    return false;
+  }
+  uint32_t type = Read32(vk + 0x0C);
+  if (type > 0xFFFF && (type & 0xFFFF0000u) != 0xFFFF0000u) {
+    return false;
+  }
+  uint32_t raw_size = Read32(vk + 0x04);
+  bool resident = (raw_size & kResidentDataFlag) != 0;
+  uint32_t data_size = raw_size & ~kResidentDataFlag;
+  uint32_t data_cell = Read32(vk + 0x08);
+  if (resident ? data_size > 4 : data_size > kMaxCarvedDataSize) {
+    return false;
+  }
+  if (!resident && data_size != 0 && !IsPlausibleCell(data_cell, reader.bins_size())) {
+    return false;
+  }
+  HiveName name;
+  name.data = vk + kValueNameOffset;
+  name.bytes = name_bytes;
+  name.compressed = (flags & kValueCompressedName) != 0;
+  if (!IsPlausibleName(name.data, name.bytes, name.compressed, false)) {
+    return false;
+  }
+  value->cell = record - 4;
+  value->name = name.ToString();
+  value->type = type;
+  value->data_size = data_size;
+  value->data.clear();
+  value->data_recovered = false;
+  if (data_size == 0) {
+    value->data_recovered = true;
+    return true;
+  }
+  if (!resident && IsLiveHiveCell(reader, data_cell)) {
+    return true;
+  }
+  HiveValue source;
+  source.cell = record - 4;
+  source.type = type;
+  source.data_size = data_size;
+  const uint8_t* data = nullptr;
+  uint32_t size = 0;
+  if (reader.ValueData(source, scratch, &data, &size) && data) {
+    value->data.assign(data, data + size);
+    value->data_recovered = true;
+  }
+  return true;
+}
+
+bool CarveSecurity(const HiveReader& reader, uint32_t record, uint32_t limit, CarvedSecurity* security) {
+  const uint8_t* bins = reader.bins();
+  if (limit - record < kSecurityDescriptorOffset + kMinDescriptorSize) {
+    return false;
+  }
+  const uint8_t* sk = bins + record;
+  uint32_t descriptor_size = Read32(sk + 0x10);
+  if (descriptor_size < kMinDescriptorSize || descriptor_size > limit - record - kSecurityDescriptorOffset) {
+    return false;
+  }
+  if (!CellFits(bins, record, limit, kSecurityDescriptorOffset + descriptor_size)) {
+    return false;
+  }
+  const uint8_t* descriptor = sk + kSecurityDescriptorOffset;
+  if (descriptor[0] != 1 || (Read16(descriptor + 2) & 0x8000) == 0) {
+    return false;
+  }
+  if (!IsPlausibleCell(Read32(sk + 0x04), reader.bins_size()) || !IsPlausibleCell(Read32(sk + 0x08), reader.bins_size())) {
+    return false;
+  }
+  security->cell = record - 4;
+  security->descriptor.assign(descriptor, descriptor + descriptor_size);
+  return true;
+}
+
+uint32_t RecordUsage(const uint8_t* cell, uint32_t cell_size) {
+  uint32_t payload = cell_size - 4;
+  const uint8_t* record = cell + 4;
+  uint64_t used = 0;
+  if (payload >= kKeyNodeNameOffset && record[0] == 'n' && record[1] == 'k') {
+    used = kKeyNodeNameOffset + Read16(record + 0x48);
+  } else if (payload >= kValueNameOffset && record[0] == 'v' && record[1] == 'k') {
+    used = kValueNameOffset + Read16(record + 0x02);
+  } else if (payload >= kSecurityDescriptorOffset && record[0] == 's' && record[1] == 'k') {
+    used = kSecurityDescriptorOffset + static_cast<uint64_t>(Read32(record + 0x10));
+  } else {
+    return cell_size;
+  }
+  used = (used + 4 + 7) & ~7ull;
+  return used >= cell_size ? cell_size : static_cast<uint32_t>(used);
+}
+
+struct CarveChunk {
+  std::vector<CarvedKey> keys;
+  std::vector<CarvedValue> values;
+  std::vector<CarvedSecurity> security;
+  uint64_t scanned_bytes = 0;
+};
+
+} // namespace
+
+bool IsLiveHiveCell(const HiveReader& reader, uint32_t offset) {
+  if (!reader.Cell(offset, nullptr)) {
+    return false;
+  }
+  return static_cast<int32_t>(Read32(reader.bins() + offset)) < 0;
+}
+
+bool CarveHive(const HiveReader& reader, unsigned int thread_count, const std::atomic_bool* cancel, HiveCarveResult* result) {
+  if (!result) {
+    return false;
+  }
+  *result = HiveCarveResult();
+  const uint8_t* bins = reader.bins();
+  if (!bins) {
+    return false;
+  }
+  std::vector<HiveBin> hbins = reader.Bins();
+  if (hbins.empty()) {
+    return false;
+  }
+
+  unsigned int chunk_count = ClampThreads(thread_count, hbins.size());
+  std::vector<size_t> chunk_starts;
+  chunk_starts.reserve(chunk_count + 1);
+  chunk_starts.push_back(0);
+  uint64_t covered = static_cast<uint64_t>(hbins.back().offset) + hbins.back().size;
+  uint64_t accumulated = 0;
+  for (size_t i = 0; i < hbins.size() && chunk_starts.size() < chunk_count; ++i) {
+    accumulated += hbins[i].size;
+    if (accumulated * chunk_count >= covered * chunk_starts.size()) {
+      chunk_starts.push_back(i + 1);
+    }
+  }
+  chunk_starts.push_back(hbins.size());
+  chunk_count = static_cast<unsigned int>(chunk_starts.size() - 1);
+
+  std::vector<CarveChunk> chunks(chunk_count);
+  std::atomic_bool cancelled(false);
+  RunThreads(chunk_count, [&](unsigned int index) {
+    CarveChunk& chunk = chunks[index];
+    std::vector<uint8_t> scratch;
+    CarvedKey key;
+    CarvedValue value;
+    CarvedSecurity security;
+    for (size_t h = chunk_starts[index]; h < chunk_starts[index + 1]; ++h) {
+      if (IsCancelled(cancel)) {
+        cancelled.store(true);
+        return;
+      }
+      reader.Touch(hbins[h].offset, hbins[h].size);
+      uint32_t end = hbins[h].offset + hbins[h].size;
+      auto carve = [&](uint32_t record) {
+        if (bins[record] == 'n') {
+          if (CarveKey(reader, record, end, &key)) {
+            chunk.keys.push_back(std::move(key));
+          }
+        } else if (bins[record] == 'v') {
+          if (CarveValue(reader, record, end, &scratch, &value)) {
+            chunk.values.push_back(std::move(value));
+          }
+        } else if (CarveSecurity(reader, record, end, &security)) {
+          chunk.security.push_back(std::move(security));
+        }
+      };
+      auto scan = [&](uint32_t begin, uint32_t limit) {
+        chunk.scanned_bytes += limit - begin;
+        FindSignatures(bins, begin, limit, carve);
+      };
+      uint32_t offset = hbins[h].offset + kHbinHeaderSize;
+      while (end - offset >= 8) {
+        int32_t raw = static_cast<int32_t>(Read32(bins + offset));
+        uint32_t cell_size = raw < 0 ? static_cast<uint32_t>(-static_cast<int64_t>(raw)) : static_cast<uint32_t>(raw);
+        if (cell_size < 8 || (cell_size & 7) != 0 || cell_size > end - offset) {
+          scan(offset, end);
+          break;
+        }
+        if (raw > 0) {
+          scan(offset, offset + cell_size);
+        } else {
+          uint32_t used = RecordUsage(bins + offset, cell_size);
+          if (cell_size - used >= kMinSlackSize) {
+            scan(offset + used, offset + cell_size);
+          }
+        }
+        offset += cell_size;
+      }
+    }
+  });
+  if (cancelled.load()) {
+    return false;
+  }
+
+  for (auto& chunk : chunks) {
+    result->scanned_bytes += chunk.scanned_bytes;
+    std::move(chunk.keys.begin(), chunk.keys.end(), std::back_inserter(result->keys));
+    std::move(chunk.values.begin(), chunk.values.end(), std::back_inserter(result->values));
+    std::move(chunk.security.begin(), chunk.security.end(), std::back_inserter(result->security));
+    chunk = CarveChunk();
+  }
+
+  std::vector<uint8_t> claimed(result->values.size(), 0);
+  auto find_value = [&](uint32_t cell) -> size_t {
+    auto it = std::lower_bound(result->values.begin(), result->values.end(), cell, [](const CarvedValue& entry, uint32_t target) { return entry.cell < target; });
+    if (it == result->values.end() || it->cell != cell) {
+      return result->values.size();
+    }
+    return static_cast<size_t>(it - result->values.begin());
+  };
+  for (CarvedKey& key : result->keys) {
+    if (key.value_count == 0 || key.value_count > kMaxCarvedValueList) {
+      continue;
+    }
+    const uint8_t* node = bins + key.cell + 4;
+    uint32_t list_size = 0;
+    const uint8_t* list = reader.Cell(Read32(node + 0x28), &list_size);
+    if (!list || key.value_count * 4ull > list_size) {
+      continue;
+    }
+    for (uint32_t i = 0; i < key.value_count; ++i) {
+      size_t found = find_value(Read32(list + i * 4));
+      if (found < result->values.size() && !claimed[found]) {
+        claimed[found] = 1;
+        key.values.push_back(static_cast<uint32_t>(found));
+      }
+    }
+  }
+  for (size_t i = 0; i < claimed.size(); ++i) {
+    if (!claimed[i]) {
+      result->orphan_values.push_back(static_cast<uint32_t>(i));
+    }
+  }
+  return !IsCancelled(cancel);
+}
+
+} // namespace regkit
@@ -0,0 +1,659 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "registry/hive_check.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+#include <functional>
+#include <thread>
+
+#include "registry/hive_log.h"
+#include "registry/mapped_file.h"
+
+namespace regkit {
+
+namespace {
+
+constexpr uint32_t kBaseBlockSize = 4096;
+constexpr uint32_t kHbinHeaderSize = 32;
+constexpr uint32_t kHbinAlignment = 4096;
+constexpr uint32_t kKeyNodeNameOffset = 0x4C;
+constexpr uint32_t kValueNameOffset = 0x14;
+constexpr uint32_t kSecurityDescriptorOffset = 0x14;
+constexpr uint16_t kKeyCompressedName = 0x0020;
+constexpr uint16_t kKeyHiveEntry = 0x0004;
+constexpr uint32_t kResidentDataFlag = 0x80000000u;
+constexpr uint32_t kBigDataSegmentSize = 16344;
+constexpr uint32_t kNoCell = 0xFFFFFFFFu;
+
+uint16_t Read16(const uint8_t* data) {
+  uint16_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t Read32(const uint8_t* data) {
+  uint32_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+bool HasSignature(const uint8_t* data, char first, char second) {
+  return data[0] == static_cast<uint8_t>(first) && data[1] == static_cast<uint8_t>(second);
+}
+
+uint16_t UpcaseUnit(uint32_t ch) {
+  if (ch < 0x80) {
+    return static_cast<uint16_t>((ch >= 'a' && ch <= 'z') ? ch - ('a' - 'A') : ch);
+  }
+  return static_cast<uint16_t>(towupper(static_cast<wint_t>(ch)));
+}
+
+unsigned int ClampThreads(unsigned int thread_count, size_t work) {
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+  return static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(thread_count, work)));
+}
+
+void RunThreads(unsigned int thread_count, const std::function<void(unsigned int index)>& body) {
+  if (thread_count <= 1) {
+    body(0);
+    return;
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (unsigned int i = 1; i < thread_count; ++i) {
+    threads.emplace_back(body, i);
+  }
+  body(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+bool IsCancelled(const std::atomic_bool* cancel) {
+  return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+void AddIssue(std::vector<HiveIssue>* issues, uint64_t offset, uint32_t cell, HiveIssueKind kind, const char* detail) {
+  HiveIssue issue;
+  issue.offset = offset;
+  issue.cell = cell;
+  issue.kind = kind;
+  issue.detail = detail;
+  issues->push_back(issue);
+}
+
+struct CheckChunk {
+  std::vector<HiveIssue> issues;
+  std::vector<uint32_t> records;
+  uint64_t cell_count = 0;
+  uint64_t key_count = 0;
+  uint64_t value_count = 0;
+  uint64_t security_count = 0;
+};
+
+class HiveChecker {
+public:
+  HiveChecker(const uint8_t* bins, uint32_t bins_size, uint32_t minor_version, uint32_t root_cell, const std::vector<uint64_t>& allocated)
+      : bins_(bins), bins_size_(bins_size), minor_version_(minor_version), root_cell_(root_cell), allocated_(allocated) {}
+
+  const uint8_t* Allocated(uint32_t offset, uint32_t* size) const {
+    if ((offset & 7) != 0 || offset >= bins_size_ || (allocated_[offset / 512] & (1ull << ((offset / 8) % 64))) == 0) {
+      return nullptr;
+    }
+    *size = static_cast<uint32_t>(-static_cast<int64_t>(static_cast<int32_t>(Read32(bins_ + offset)))) - 4;
+    return bins_ + offset + 4;
+  }
+
+  const uint8_t* Record(uint32_t offset, char first, char second, uint32_t* size) const {
+    const uint8_t* record = Allocated(offset, size);
+    if (!record || *size < 2 || !HasSignature(record, first, second)) {
+      return nullptr;
+    }
+    return record;
+  }
+
+  void Check(uint32_t cell, CheckChunk* chunk) {
+    uint32_t size = 0;
+    const uint8_t* record = Allocated(cell, &size);
+    if (HasSignature(record, 'n', 'k')) {
+      ++chunk->key_count;
+      CheckKey(cell, record, size, &chunk->issues);
+    } else if (HasSignature(record, 'v', 'k')) {
+      ++chunk->value_count;
+      CheckValue(cell, record, size, &chunk->issues);
+    } else {
+      ++chunk->security_count;
+      CheckSecurity(cell, record, size, &chunk->issues);
+    }
+  }
+
+private:
+  static uint64_t FileOffset(uint32_t offset) { return static_cast<uint64_t>(kBaseBlockSize) + offset; }
+
+  void UpperName(const uint8_t* node, std::u16string* out) const {
+    out->clear();
+    uint32_t bytes = Read16(node + 0x48);
+    const uint8_t* name = node + kKeyNodeNameOffset;
+    if (Read16(node + 0x02) & kKeyCompressedName) {
+      for (uint32_t i = 0; i < bytes; ++i) {
+        out->push_back(static_cast<char16_t>(UpcaseUnit(name[i])));
+      }
+      return;
+    }
+    for (uint32_t i = 0; i + 1 < bytes; i += 2) {
+      out->push_back(static_cast<char16_t>(UpcaseUnit(Read16(name + i))));
+    }
+  }
+
+  const uint8_t* ChildKey(uint32_t offset) const {
+    uint32_t size = 0;
+    const uint8_t* node = Record(offset, 'n', 'k', &size);
+    if (!node || size < kKeyNodeNameOffset || kKeyNodeNameOffset + Read16(node + 0x48) > size) {
+      return nullptr;
+    }
+    return node;
+  }
+
+  void CollectSubkeys(uint32_t owner, uint32_t list, int depth, std::vector<HiveIssue>* issues) {
+    uint32_t size = 0;
+    const uint8_t* cell = Allocated(list, &size);
+    if (!cell || size < 4) {
+      AddIssue(issues, FileOffset(owner), owner, HiveIssueKind::kSubkeyList, "subkey list is not an allocated cell");
+      return;
+    }
+    uint32_t count = Read16(cell + 2);
+    if (HasSignature(cell, 'l', 'i') || HasSignature(cell, 'r', 'i')) {
+      if (4 + count * 4ull > size) {
+        AddIssue(issues, FileOffset(list), owner, HiveIssueKind::kSubkeyList, "subkey list entries exceed the cell");
+        return;
+      }
+      bool is_index = cell[0] == 'r';
+      if (is_index && depth > 0) {
+        AddIssue(issues, FileOffset(list), owner, HiveIssueKind::kSubkeyList, "index root is nested");
+        return;
+      }
+      for (uint32_t i = 0; i < count; ++i) {
+        uint32_t entry = Read32(cell + 4 + i * 4);
+        if (is_index) {
+          CollectSubkeys(owner, entry, depth + 1, issues);
+        } else {
+          children_.push_back(entry);
+        }
+      }
+      return;
+    }
+    if (!HasSignature(cell, 'l', 'f') && !HasSignature(cell, 'l', 'h')) {
+      AddIssue(issues, FileOffset(list), owner, HiveIssueKind::kSubkeyList, "subkey list signature is unknown");
+      return;
+    }
+    if (4 + count * 8ull > size) {
+      AddIssue(issues, FileOffset(list), owner, HiveIssueKind::kSubkeyList, "subkey list entries exceed the cell");
+      return;
+    }
+    bool hashed = cell[1] == 'h';
+    for (uint32_t i = 0; i < count; ++i) {
+      uint32_t entry = Read32(cell + 4 + i * 8);
+      children_.push_back(entry);
+      const uint8_t* child = hashed ? ChildKey(entry) : nullptr;
+      if (!child) {
+        continue;
+      }
+      UpperName(child, &name_);
+      uint32_t hash = 0;
+      for (char16_t unit : name_) {
+        hash = hash * 37 + unit;
+      }
+      if (hash != Read32(cell + 8 + i * 8)) {
+        AddIssue(issues, FileOffset(list), owner, HiveIssueKind::kSubkeyList, "lh hash does not match the key name");
+      }
+    }
+  }
+
+  void CheckKey(uint32_t cell, const uint8_t* node, uint32_t size, std::vector<HiveIssue>* issues) {
+    if (size < kKeyNodeNameOffset) {
+      AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kKeyNode, "key node is truncated");
+      return;
+    }
+    if (kKeyNodeNameOffset + Read16(node + 0x48) > size) {
+      AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kKeyNode, "key name exceeds its cell");
+      return;
+    }
+    uint32_t record_size = 0;
+    if (cell == root_cell_) {
+      if ((Read16(node + 0x02) & kKeyHiveEntry) == 0) {
+        AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kKeyNode, "root key lacks the hive entry flag");
+      }
+    } else if (!Record(Read32(node + 0x10), 'n', 'k', &record_size)) {
+      AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kKeyNode, "parent is not a key node");
+    }
+
+    uint32_t subkey_count = Read32(node + 0x14);
+    if (subkey_count != 0) {
+      children_.clear();
+      CollectSubkeys(cell, Read32(node + 0x1C), 0, issues);
+      if (children_.size() != subkey_count) {
+        AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kSubkeyList, "subkey count does not match the list");
+      }
+      bool have_previous = false;
+      for (uint32_t child_cell : children_) {
+        const uint8_t* child = ChildKey(child_cell);
+        if (!child) {
+          AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kSubkeyList, "subkey entry is not a key node");
+          have_previous = false;
+          continue;
+        }
+        if (Read32(child + 0x10) != cell) {
+          AddIssue(issues, FileOffset(child_cell), cell, HiveIssueKind::kSubkeyList, "subkey parent does not point back");
+        }
+        UpperName(child, &name_);
+        if (have_previous) {
+          int order = previous_.compare(name_);
+          if (order >= 0) {
+            AddIssue(issues, FileOffset(child_cell), cell, HiveIssueKind::kSubkeyOrder, order == 0 ? "subkey name is duplicated" : "subkeys are out of order");
+          }
+        }
+        previous_.swap(name_);
+        have_previous = true;
+      }
+    }
+
+    uint32_t value_count = Read32(node + 0x24);
+    if (value_count != 0) {
+      uint32_t list_cell = Read32(node + 0x28);
+      uint32_t list_size = 0;
+      const uint8_t* list = Allocated(list_cell, &list_size);
+      if (!list) {
+        AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kValueList, "value list is not an allocated cell");
+      } else if (value_count * 4ull > list_size) {
+        AddIssue(issues, FileOffset(list_cell), cell, HiveIssueKind::kValueList, "value count exceeds the list cell");
+      } else {
+        for (uint32_t i = 0; i < value_count; ++i) {
+          if (!Record(Read32(list + i * 4), 'v', 'k', &record_size)) {
+            AddIssue(issues, FileOffset(list_cell), cell, HiveIssueKind::kValueList, "value entry is not a value node");
+          }
+        }
+      }
+    }
+
+    if (!Record(Read32(node + 0x2C), 's', 'k', &record_size)) {
+      AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kSecurity, "key security is not a security cell");
+    }
+
+    uint32_t class_bytes = Read16(node + 0x4A);
+    if (class_bytes != 0) {
+      uint32_t class_size = 0;
+      if (!Allocated(Read32(node + 0x30), &class_size) || class_size < class_bytes) {
+        AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kClassName, "class name cell is invalid");
+      }
+    }
+  }
+
+  void CheckBigData(uint32_t owner, uint32_t cell, const uint8_t* header, uint32_t data_size, std::vector<HiveIssue>* issues) const {
+    uint32_t segments = Read16(header + 2);
+    if (segments != (data_size + kBigDataSegmentSize - 1) / kBigDataSegmentSize) {
+      AddIssue(issues, FileOffset(cell), owner, HiveIssueKind::kBigData, "segment count does not match the data size");
+    }
+    uint32_t list_cell = Read32(header + 4);
+    uint32_t list_size = 0;
+    const uint8_t* list = Allocated(list_cell, &list_size);
+    if (!list || segments * 4ull > list_size) {
+      AddIssue(issues, FileOffset(cell), owner, HiveIssueKind::kBigData, "segment list is invalid");
+      return;
+    }
+    uint32_t remaining = data_size;
+    for (uint32_t i = 0; i < segments; ++i) {
+      uint32_t segment = Read32(list + i * 4);
+      uint32_t segment_size = 0;
+      uint32_t expected = std::min(remaining, kBigDataSegmentSize);
+      if (!Allocated(segment, &segment_size)) {
+        AddIssue(issues, FileOffset(list_cell), owner, HiveIssueKind::kBigData, "segment is not an allocated cell");
+      } else if (segment_size < expected) {
+        AddIssue(issues, FileOffset(segment), owner, HiveIssueKind::kBigData, "segment is smaller than its data");
+      }
+      remaining -= expected;
+    }
+  }
+
+  void CheckValue(uint32_t cell, const uint8_t* vk, uint32_t size, std::vector<HiveIssue>* issues) const {
+    if (size < kValueNameOffset) {
+      AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kValue, "value node is truncated");
+      return;
+    }
+    if (kValueNameOffset + Read16(vk + 0x02) > size) {
+      AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kValue, "value name exceeds its cell");
+      return;
+    }
+    uint32_t raw_size = Read32(vk + 0x04);
+    uint32_t data_size = raw_size & ~kResidentDataFlag;
+    if (raw_size & kResidentDataFlag) {
+      if (data_size > 4) {
+        AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kValueData, "resident data is larger than four bytes");
+      }
+      return;
+    }
+    if (data_size == 0) {
+      return;
+    }
+    uint32_t data_cell = Read32(vk + 0x08);
+    uint32_t data_capacity = 0;
+    const uint8_t* data = Allocated(data_cell, &data_capacity);
+    if (!data) {
+      AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kValueData, "value data is not an allocated cell");
+      return;
+    }
+    if (minor_version_ >= 4 && data_size > kBigDataSegmentSize && data_capacity >= 8 && HasSignature(data, 'd', 'b')) {
+      CheckBigData(cell, data_cell, data, data_size, issues);
+      return;
+    }
+    if (data_capacity < data_size) {
+      AddIssue(issues, FileOffset(data_cell), cell, HiveIssueKind::kValueData, "value data exceeds its cell");
+    }
+  }
+
+  void CheckSecurity(uint32_t cell, const uint8_t* sk, uint32_t size, std::vector<HiveIssue>* issues) const {
+    if (size < kSecurityDescriptorOffset) {
+      AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kSecurity, "security cell is truncated");
+      return;
+    }
+    if (kSecurityDescriptorOffset + static_cast<uint64_t>(Read32(sk + 0x10)) > size) {
+      AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kSecurity, "security descriptor exceeds its cell");
+    }
+    uint32_t next_size = 0;
+    const uint8_t* next = Record(Read32(sk + 0x04), 's', 'k', &next_size);
+    if (!next || next_size < kSecurityDescriptorOffset || Read32(next + 0x08) != cell) {
+      AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kSecurity, "security list link is broken");
+    }
+    if (Read32(sk + 0x0C) == 0) {
+      AddIssue(issues, FileOffset(cell), cell, HiveIssueKind::kSecurity, "security cell has no references");
+    }
+  }
+
+  const uint8_t* bins_;
+  uint32_t bins_size_;
+  uint32_t minor_version_;
+  uint32_t root_cell_;
+  const std::vector<uint64_t>& allocated_;
+  std::vector<uint32_t> children_;
+  std::u16string name_;
+  std::u16string previous_;
+};
+
+void WriteJsonString(std::ostream& out, std::string_view text) {
+  static const char kHex[] = "0123456789abcdef";
+  out << '"';
+  for (char ch : text) {
+    uint8_t byte = static_cast<uint8_t>(ch);
+    if (ch == '"' || ch == '\\') {
+      out << '\\' << ch;
+    } else if (byte < 0x20) {
+      out << "\\u00" << kHex[byte >> 4] << kHex[byte & 0xF];
+    } else {
+      out << ch;
+    }
+  }
+  out << '"';
+}
+
+const char* RecoveryStateName(HiveRecoveryState state) {
+  switch (state) {
+    case HiveRecoveryState::kClean:
+      return "clean";
+    case HiveRecoveryState::kReplayed:
+      return "replayed";
+    case HiveRecoveryState::kDirtyNoLogs:
+      return "no_logs";
+    case HiveRecoveryState::kReplayFailed:
+      return "replay_failed";
+  }
+  return "unknown";
+}
+
+} // namespace
+
+const char* HiveIssueKindName(HiveIssueKind kind) {
+  switch (kind) {
+    case HiveIssueKind::kBaseBlock:
+      return "base_block";
+    case HiveIssueKind::kHbinHeader:
+      return "hbin_header";
+    case HiveIssueKind::kCellSize:
+      return "cell_size";
+    case HiveIssueKind::kKeyNode:
+      return "key_node";
+    case HiveIssueKind::kSubkeyList:
+      return "subkey_list";
+    case HiveIssueKind::kSubkeyOrder:
+      return "subkey_order";
+    case HiveIssueKind::kValueList:
+      return "value_list";
+    case HiveIssueKind::kValue:
+      return "value";
+    case HiveIssueKind::kValueData:
+      return "value_data";
+    case HiveIssueKind::kBigData:
+      return "big_data";
+    case HiveIssueKind::kSecurity:
+      return "security";
+    case HiveIssueKind::kClassName:
+      return "class_name";
+  }
+  return "unknown";
+}
+
+bool CheckHiveImage(const uint8_t* data, uint64_t size, unsigned int thread_count, const std::atomic_bool* cancel, HiveCheckReport* report) {
+  if (!report) {
+    return false;
+  }
+  *report = HiveCheckReport();
+  report->file_size = size;
+  std::vector<HiveIssue>& issues = report->issues;
+  if (!data || size < kBaseBlockSize) {
+    AddIssue(&issues, 0, kNoCell, HiveIssueKind::kBaseBlock, "file is smaller than a base block");
+    return true;
+  }
+
+  if (memcmp(data, "regf", 4) != 0) {
+    AddIssue(&issues, 0x00, kNoCell, HiveIssueKind::kBaseBlock, "base block signature is missing");
+  }
+  report->dirty = Read32(data + 0x04) != Read32(data + 0x08);
+  if (Read32(data + 0x14) != 1) {
+    AddIssue(&issues, 0x14, kNoCell, HiveIssueKind::kBaseBlock, "major version is unsupported");
+  }
+  uint32_t minor_version = Read32(data + 0x18);
+  if (minor_version < 2 || minor_version > 6) {
+    AddIssue(&issues, 0x18, kNoCell, HiveIssueKind::kBaseBlock, "minor version is unsupported");
+  }
+  if (Read32(data + 0x1C) != 0) {
+    AddIssue(&issues, 0x1C, kNoCell, HiveIssueKind::kBaseBlock, "file type is not a primary hive");
+  }
+  if (Read32(data + 0x20) != 1) {
+    AddIssue(&issues, 0x20, kNoCell, HiveIssueKind::kBaseBlock, "file format is unsupported");
+  }
+  uint64_t available = std::min<uint64_t>((size - kBaseBlockSize) & ~static_cast<uint64_t>(kHbinAlignment - 1), 0xFFFFF000u);
+  uint32_t bins_size = Read32(data + 0x28);
+  if (bins_size == 0 || (bins_size % kHbinAlignment) != 0 || bins_size > available) {
+    AddIssue(&issues, 0x28, kNoCell, HiveIssueKind::kBaseBlock, "hive bins size is invalid");
+    bins_size = static_cast<uint32_t>(available);
+  }
+  if (HiveBaseBlockChecksum(data) != Read32(data + kHiveBaseBlockChecksumOffset)) {
+    AddIssue(&issues, kHiveBaseBlockChecksumOffset, kNoCell, HiveIssueKind::kBaseBlock, "base block checksum mismatch");
+  }
+  report->bins_size = bins_size;
+
+  const uint8_t* bins = data + kBaseBlockSize;
+  std::vector<std::pair<uint32_t, uint32_t>> hbins;
+  uint32_t offset = 0;
+  while (offset < bins_size) {
+    const uint8_t* header = bins + offset;
+    uint32_t hbin_size = Read32(header + 8);
+    if (memcmp(header, "hbin", 4) != 0) {
+      AddIssue(&issues, kBaseBlockSize + static_cast<uint64_t>(offset), kNoCell, HiveIssueKind::kHbinHeader, "hbin signature is missing");
+      offset += kHbinAlignment;
+      continue;
+    }
+    if (Read32(header + 4) != offset) {
+      AddIssue(&issues, kBaseBlockSize + static_cast<uint64_t>(offset) + 4, kNoCell, HiveIssueKind::kHbinHeader, "hbin offset field is wrong");
+    }
+    if (hbin_size < kHbinAlignment || (hbin_size % kHbinAlignment) != 0 || hbin_size > bins_size - offset) {
+      AddIssue(&issues, kBaseBlockSize + static_cast<uint64_t>(offset) + 8, kNoCell, HiveIssueKind::kHbinHeader, "hbin size is invalid");
+      offset += kHbinAlignment;
+      continue;
+    }
+    hbins.emplace_back(offset, hbin_size);
+    offset += hbin_size;
+  }
+  report->hbin_count = static_cast<uint32_t>(hbins.size());
+
+  uint32_t root_cell = Read32(data + 0x24);
+  std::vector<uint64_t> allocated((bins_size / 8 + 63) / 64, 0);
+  unsigned int chunk_count = ClampThreads(thread_count, hbins.size());
+  std::vector<size_t> chunk_starts;
+  chunk_starts.push_back(0);
+  for (unsigned int i = 1; i < chunk_count; ++i) {
+    chunk_starts.push_back(hbins.size() * i / chunk_count);
+  }
+  chunk_starts.push_back(hbins.size());
+
+  std::vector<CheckChunk> chunks(chunk_count);
+  std::atomic_bool cancelled(false);
+  RunThreads(chunk_count, [&](unsigned int index) {
+    CheckChunk& chunk = chunks[index];
+    for (size_t h = chunk_starts[index]; h < chunk_starts[index + 1]; ++h) {
+      if (IsCancelled(cancel)) {
+        cancelled.store(true);
+        return;
+      }
+      uint32_t end = hbins[h].first + hbins[h].second;
+      uint32_t cell = hbins[h].first + kHbinHeaderSize;
+      while (cell < end) {
+        int32_t raw = static_cast<int32_t>(Read32(bins + cell));
+        uint32_t cell_size = raw < 0 ? static_cast<uint32_t>(-static_cast<int64_t>(raw)) : static_cast<uint32_t>(raw);
+        if (cell_size < 8 || (cell_size & 7) != 0 || cell_size > end - cell) {
+          AddIssue(&chunk.issues, kBaseBlockSize + static_cast<uint64_t>(cell), kNoCell, HiveIssueKind::kCellSize, cell_size == 0 ? "cell size is zero" : "cell size is invalid");
+          break;
+        }
+        ++chunk.cell_count;
+        if (raw < 0) {
+          allocated[cell / 512] |= 1ull << ((cell / 8) % 64);
+          const uint8_t* record = bins + cell + 4;
+          if (cell_size >= 8 && record[1] == 'k' && (record[0] == 'n' || record[0] == 'v' || record[0] == 's')) {
+            chunk.records.push_back(cell);
+          }
+        }
+        cell += cell_size;
+      }
+    }
+  });
+  if (cancelled.load()) {
+    return false;
+  }
+
+  uint32_t root_size = 0;
+  if (!HiveChecker(bins, bins_size, minor_version, root_cell, allocated).Record(root_cell, 'n', 'k', &root_size)) {
+    AddIssue(&issues, 0x24, kNoCell, HiveIssueKind::kBaseBlock, "root cell is not a key node");
+  }
+
+  RunThreads(chunk_count, [&](unsigned int index) {
+    CheckChunk& chunk = chunks[index];
+    HiveChecker checker(bins, bins_size, minor_version, root_cell, allocated);
+    for (size_t i = 0; i < chunk.records.size(); ++i) {
+      if ((i & 0xFFF) == 0 && IsCancelled(cancel)) {
+        cancelled.store(true);
+        return;
+      }
+      checker.Check(chunk.records[i], &chunk);
+    }
+  });
+  if (cancelled.load()) {
+    return false;
+  }
+
+  for (auto& chunk : chunks) {
+    report->cell_count += chunk.cell_count;
+    report->key_count += chunk.key_count;
+    report->value_count += chunk.value_count;
+    report->security_count += chunk.security_count;
+    issues.insert(issues.end(), chunk.issues.begin(), chunk.issues.end());
+  }
+  std::stable_sort(issues.begin(), issues.end(), [](const HiveIssue& left, const HiveIssue& right) { return left.offset < right.offset; });
+  return true;
+}
+
+bool CheckHiveFile(const std::filesystem::path& path, unsigned int thread_count, const std::atomic_bool* cancel, HiveCheckReport* report, std::wstring* error) {
+  MappedFile file;
+  if (!file.Open(path, error)) {
+    return false;
+  }
+  if (!CheckHiveImage(file.data(), file.size(), thread_count, cancel, report)) {
+    if (error) {
+      *error = L"The integrity check was cancelled.";
+    }
+    return false;
+  }
+  if (file.size() >= kBaseBlockSize && IsHiveBaseBlockDirty(file.data())) {
+    file.Close();
+    HiveReader reader;
+    report->recovery = reader.Open(path, nullptr) ? reader.recovery_state() : HiveRecoveryState::kReplayFailed;
+  }
+  return true;
+}
+
+void WriteHiveCheckJson(std::ostream& out, std::string_view source, const HiveCheckReport& report) {
+  out << "{\"source\":";
+  WriteJsonString(out, source);
+  out << ",\"ok\":" << (report.ok() ? "true" : "false");
+  out << ",\"dirty\":" << (report.dirty ? "true" : "false");
+  out << ",\"recovery\":\"" << RecoveryStateName(report.recovery) << '"';
+  out << ",\"file_size\":" << report.file_size;
+  out << ",\"bins_size\":" << report.bins_size;
+  out << ",\"hbins\":" << report.hbin_count;
+  out << ",\"cells\":" << report.cell_count;
+  out << ",\"keys\":" << report.key_count;
+  out << ",\"values\":" << report.value_count;
+  out << ",\"security\":" << report.security_count;
+  out << ",\"issues\":[";
+  for (size_t i = 0; i < report.issues.size(); ++i) {
+    const HiveIssue& issue = report.issues[i];
+    if (i != 0) {
+      out << ',';
+    }
+    out << "{\"offset\":" << issue.offset << ",\"cell\":";
+    if (issue.cell == kNoCell) {
+      out << "null";
+    } else {
+      out << issue.cell;
+    }
+    out << ",\"check\":\"" << HiveIssueKindName(issue.kind) << "\",\"detail\":";
+    WriteJsonString(out, issue.detail);
+    out << '}';
+  }
+  out << "]}\n";
+}
+
+void WriteHiveCheckErrorJson(std::ostream& out, std::string_view source, std::string_view error) {
+  out << "{\"source\":";
+  WriteJsonString(out, source);
+  out << ",\"ok\":false,\"error\":";
+  WriteJsonString(out, error);
+  out << "}\n";
+}
+
+} // namespace regkit
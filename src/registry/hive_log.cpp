@@ -0,0 +1,276 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "registry/hive_log.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace regkit {
+
+namespace {
+
+constexpr uint64_t kLogEntrySeed = 0x82EF4D887A4E55C5ull;
+constexpr uint32_t kLogEntryHeaderSize = 40;
+constexpr uint32_t kLogEntryAlignment = 512;
+constexpr uint32_t kLogPageSize = 4096;
+constexpr uint32_t kHiveBaseBlockSize = 4096;
+
+uint32_t Read32(const uint8_t* data) {
+  uint32_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint64_t Read64(const uint8_t* data) {
+  uint64_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void Write32(uint8_t* data, uint32_t value) {
+  memcpy(data, &value, sizeof(value));
+}
+
+uint32_t RotateLeft(uint32_t value, int shift) {
+  return (value << shift) | (value >> (32 - shift));
+}
+
+void MarvinBlock(uint32_t* p0, uint32_t* p1) {
+  *p1 ^= *p0;
+  *p0 = RotateLeft(*p0, 20);
+  *p0 += *p1;
+  *p1 = RotateLeft(*p1, 9);
+  *p1 ^= *p0;
+  *p0 = RotateLeft(*p0, 27);
+  *p0 += *p1;
+  *p1 = RotateLeft(*p1, 19);
+}
+
+bool ParseLogEntry(const uint8_t* entry, uint64_t available, HiveLogEntry* out, uint32_t* entry_size) {
+  if (available < kLogEntryHeaderSize || memcmp(entry, "HvLE", 4) != 0) {
+    return false;
+  }
+  uint32_t size = Read32(entry + 0x04);
+  if (size < kLogEntryHeaderSize || (size % kLogEntryAlignment) != 0 || size > available) {
+    return false;
+  }
+  uint32_t page_count = Read32(entry + 0x14);
+  uint64_t refs_end = kLogEntryHeaderSize + static_cast<uint64_t>(page_count) * 8;
+  if (refs_end > size) {
+    return false;
+  }
+  if (Marvin32(entry, 32, kLogEntrySeed) != Read64(entry + 0x20)) {
+    return false;
+  }
+  if (Marvin32(entry + kLogEntryHeaderSize, size - kLogEntryHeaderSize, kLogEntrySeed) != Read64(entry + 0x18)) {
+    return false;
+  }
+  out->sequence = Read32(entry + 0x0C);
+  out->bins_size = Read32(entry + 0x10);
+  out->pages.clear();
+  out->pages.reserve(page_count);
+  uint64_t data_offset = refs_end;
+  for (uint32_t i = 0; i < page_count; ++i) {
+    const uint8_t* ref = entry + kLogEntryHeaderSize + i * 8;
+    HiveLogPage page;
+    page.offset = Read32(ref);
+    page.size = Read32(ref + 4);
+    if ((page.offset % kLogPageSize) != 0 || page.size == 0 || (page.size % kLogPageSize) != 0 || page.size > size - data_offset) {
+      return false;
+    }
+    if (static_cast<uint64_t>(page.offset) + page.size > out->bins_size) {
+      return false;
+    }
+    page.data = entry + data_offset;
+    data_offset += page.size;
+    out->pages.push_back(page);
+  }
+  *entry_size = size;
+  return true;
+}
+
+} // namespace
+
+uint64_t Marvin32(const uint8_t* data, size_t size, uint64_t seed) {
+  uint32_t p0 = static_cast<uint32_t>(seed);
+  uint32_t p1 = static_cast<uint32_t>(seed >> 32);
+  while (size >= 4) {
+    p0 += Read32(data);
+    MarvinBlock(&p0, &p1);
+    data += 4;
+    size -= 4;
+  }
+  uint32_t final = 0x80;
+  switch (size) {
+    case 1:
+      final = 0x8000u | data[0];
+      break;
+    case 2:
+      final = 0x800000u | data[0] | (static_cast<uint32_t>(data[1]) << 8);
+      break;
+    case 3:
+      final = 0x80000000u | data[0] | (static_cast<uint32_t>(data[1]) << 8) | (static_cast<uint32_t>(data[2]) << 16);
+      break;
+    default:
+      break;
+  }
+  p0 += final;
+  MarvinBlock(&p0, &p1);
+  MarvinBlock(&p0, &p1);
+  return (static_cast<uint64_t>(p1) << 32) | p0;
+}
+
+uint32_t HiveBaseBlockChecksum(const uint8_t* base) {
+  uint32_t checksum = 0;
+  for (uint32_t offset = 0; offset < kHiveBaseBlockChecksumOffset; offset += 4) {
+    checksum ^= Read32(base + offset);
+  }
+  if (checksum == 0) {
+    return 1;
+  }
+  if (checksum == 0xFFFFFFFFu) {
+    return 0xFFFFFFFEu;
+  }
+  return checksum;
+}
+
+bool IsHiveBaseBlockValid(const uint8_t* base) {
+  return base && memcmp(base, "regf", 4) == 0 && HiveBaseBlockChecksum(base) == Read32(base + kHiveBaseBlockChecksumOffset);
+}
+
+bool IsHiveBaseBlockDirty(const uint8_t* base) {
+  return !IsHiveBaseBlockValid(base) || Read32(base + 0x04) != Read32(base + 0x08);
+}
+
+bool HiveLog::Open(const std::filesystem::path& path, std::wstring* error) {
+  Close();
+  if (!file_.Open(path, error)) {
+    return false;
+  }
+  if (file_.size() < kHiveLogBaseBlockSize || !IsHiveBaseBlockValid(file_.data())) {
+    Close();
+    if (error) {
+      *error = L"The transaction log base block is invalid.";
+    }
+    return false;
+  }
+  const uint8_t* data = file_.data();
+  uint64_t offset = kHiveLogBaseBlockSize;
+  bool have_previous = false;
+  uint32_t previous = 0;
+  while (offset < file_.size()) {
+    HiveLogEntry entry;
+    uint32_t entry_size = 0;
+    if (!ParseLogEntry(data + offset, file_.size() - offset, &entry, &entry_size)) {
+      break;
+    }
+    if (have_previous && entry.sequence != previous + 1) {
+      break;
+    }
+    previous = entry.sequence;
+    have_previous = true;
+    entries_.push_back(std::move(entry));
+    offset += entry_size;
+  }
+  return true;
+}
+
+void HiveLog::Close() {
+  entries_.clear();
+  file_.Close();
+}
+
+bool PlanHiveRecovery(const uint8_t* primary_base, const std::vector<const HiveLog*>& logs, HiveRecoveryPlan* plan) {
+  if (!plan) {
+    return false;
+  }
+  *plan = HiveRecoveryPlan();
+  bool primary_valid = IsHiveBaseBlockValid(primary_base);
+  uint32_t min_sequence = primary_valid ? Read32(primary_base + 0x08) : 0;
+
+  std::vector<const HiveLog*> ordered;
+  for (const HiveLog* log : logs) {
+    if (log && log->is_open()) {
+      ordered.push_back(log);
+    }
+  }
+  std::sort(ordered.begin(), ordered.end(), [](const HiveLog* left, const HiveLog* right) { return Read32(left->base_block() + 0x04) < Read32(right->base_block() + 0x04); });
+
+  bool have_last = false;
+  uint32_t last = 0;
+  for (const HiveLog* log : ordered) {
+    bool used = false;
+    for (const HiveLogEntry& entry : log->entries()) {
+      if (entry.sequence < min_sequence || (have_last && entry.sequence <= last)) {
+        continue;
+      }
+      if (have_last && entry.sequence != last + 1) {
+        break;
+      }
+      plan->entries.push_back(&entry);
+      plan->bins_size = entry.bins_size;
+      last = entry.sequence;
+      have_last = true;
+      used = true;
+    }
+    if (used) {
+      plan->base_block = log->base_block();
+    }
+  }
+
+  if (!plan->base_block) {
+    if (primary_valid) {
+      plan->base_block = primary_base;
+    } else if (!ordered.empty()) {
+      plan->base_block = ordered.back()->base_block();
+    } else {
+      return false;
+    }
+  }
+  if (plan->entries.empty()) {
+    plan->bins_size = Read32(plan->base_block + 0x28);
+    plan->sequence = Read32(plan->base_block + 0x04);
+  } else {
+    plan->sequence = last + 1;
+  }
+  return !plan->entries.empty() || plan->base_block != primary_base;
+}
+
+void ApplyHiveRecovery(const HiveRecoveryPlan& plan, uint8_t* base, uint64_t capacity) {
+  if (!base || capacity < kHiveBaseBlockSize || !plan.base_block) {
+    return;
+  }
+  if (plan.base_block != base) {
+    memmove(base, plan.base_block, kHiveLogBaseBlockSize);
+  }
+  uint8_t* bins = base + kHiveBaseBlockSize;
+  uint64_t bins_capacity = capacity - kHiveBaseBlockSize;
+  for (const HiveLogEntry* entry : plan.entries) {
+    for (const HiveLogPage& page : entry->pages) {
+      if (static_cast<uint64_t>(page.offset) + page.size <= bins_capacity) {
+        memcpy(bins + page.offset, page.data, page.size);
+      }
+    }
+  }
+  Write32(base + 0x04, plan.sequence);
+  Write32(base + 0x08, plan.sequence);
+  Write32(base + 0x1C, 0);
+  Write32(base + 0x28, plan.bins_size);
+  Write32(base + kHiveBaseBlockChecksumOffset, HiveBaseBlockChecksum(base));
+}
+
+} // namespace regkit
@@ -0,0 +1,657 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "registry/hive_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+#include <mutex>
+
+#include "registry/hive_log.h"
+
+namespace regkit {
+
+namespace {
+
+constexpr uint32_t kBaseBlockSize = 4096;
+constexpr uint32_t kHbinHeaderSize = 32;
+constexpr uint32_t kHbinAlignment = 4096;
+constexpr uint32_t kKeyNodeNameOffset = 0x4C;
+constexpr uint32_t kValueNameOffset = 0x14;
+constexpr uint16_t kKeyCompressedName = 0x0020;
+constexpr uint16_t kValueCompressedName = 0x0001;
+constexpr uint32_t kResidentDataFlag = 0x80000000u;
+constexpr uint32_t kBigDataSegmentSize = 16344;
+constexpr size_t kPathCacheLimit = 65536;
+
+uint16_t Read16(const uint8_t* data) {
+  uint16_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t Read32(const uint8_t* data) {
+  uint32_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint64_t Read64(const uint8_t* data) {
+  uint64_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+bool HasSignature(const uint8_t* data, char first, char second) {
+  return data[0] == static_cast<uint8_t>(first) && data[1] == static_cast<uint8_t>(second);
+}
+
+uint16_t UpcaseUnit(uint32_t ch) {
+  if (ch < 0x80) {
+    return static_cast<uint16_t>((ch >= 'a' && ch <= 'z') ? ch - ('a' - 'A') : ch);
+  }
+  return static_cast<uint16_t>(towupper(static_cast<wint_t>(ch)));
+}
+
+bool HintMatches(const uint8_t* hint, std::wstring_view name) {
+  for (size_t i = 0; i < 4; ++i) {
+    if (i >= name.size()) {
+      return hint[i] == 0;
+    }
+    if (hint[i] == 0) {
+      return true;
+    }
+    if (UpcaseUnit(hint[i]) != UpcaseUnit(name[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<std::wstring_view> SplitKeyPath(std::wstring_view path) {
+  std::vector<std::wstring_view> parts;
+  size_t start = 0;
+  while (start <= path.size()) {
+    size_t end = path.find(L'\\', start);
+    if (end == std::wstring_view::npos) {
+      end = path.size();
+    }
+    if (end > start) {
+      parts.push_back(path.substr(start, end - start));
+    }
+    start = end + 1;
+  }
+  return parts;
+}
+
+} // namespace
+
+bool HivePathCache::Find(std::wstring_view path, uint32_t* cell) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = cells_.find(path);
+  if (it == cells_.end()) {
+    return false;
+  }
+  *cell = it->second;
+  return true;
+}
+
+void HivePathCache::Insert(std::wstring_view path, uint32_t cell) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  if (cells_.size() >= kPathCacheLimit) {
+    cells_.clear();
+  }
+  cells_.emplace(std::wstring(path), cell);
+}
+
+uint16_t HiveName::at(size_t index) const {
+  if (compressed) {
+    return data[index];
+  }
+  return Read16(data + index * 2);
+}
+
+std::wstring HiveName::ToString() const {
+  std::wstring out;
+  AppendTo(&out);
+  return out;
+}
+
+void HiveName::AppendTo(std::wstring* out) const {
+  if (!out || !data) {
+    return;
+  }
+  size_t count = length();
+  out->reserve(out->size() + count);
+  if (compressed) {
+    for (size_t i = 0; i < count; ++i) {
+      out->push_back(static_cast<wchar_t>(data[i]));
+    }
+    return;
+  }
+  if constexpr (sizeof(wchar_t) == sizeof(uint16_t)) {
+    size_t offset = out->size();
+    out->resize(offset + count);
+    memcpy(out->data() + offset, data, count * sizeof(uint16_t));
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      uint32_t unit = at(i);
+      if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < count) {
+        uint32_t low = at(i + 1);
+        if (low >= 0xDC00 && low <= 0xDFFF) {
+          out->push_back(static_cast<wchar_t>(0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00)));
+          ++i;
+          continue;
+        }
+      }
+      out->push_back(static_cast<wchar_t>(unit));
+    }
+  }
+}
+
+bool HiveName::EqualsInsensitive(std::wstring_view text) const {
+  size_t count = length();
+  if constexpr (sizeof(wchar_t) != sizeof(uint16_t)) {
+    for (wchar_t ch : text) {
+      if (static_cast<uint32_t>(ch) > 0xFFFF) {
+        std::wstring name = ToString();
+        if (name.size() != text.size()) {
+          return false;
+        }
+        for (size_t i = 0; i < name.size(); ++i) {
+          if (towupper(static_cast<wint_t>(name[i])) != towupper(static_cast<wint_t>(text[i]))) {
+            return false;
+          }
+        }
+        return true;
+      }
+    }
+  }
+  if (count != text.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    uint16_t left = at(i);
+    uint32_t right = static_cast<uint32_t>(text[i]);
+    if (left != right && UpcaseUnit(left) != UpcaseUnit(right)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HiveReader::Open(const std::filesystem::path& path, std::wstring* error) {
+  Close();
+  if (!file_.Open(path, error)) {
+    return false;
+  }
+  if (file_.size() < kBaseBlockSize || memcmp(file_.data(), "regf", 4) != 0) {
+    Close();
+    if (error) {
+      *error = L"The file is not a registry hive.";
+    }
+    return false;
+  }
+  if (IsHiveBaseBlockDirty(file_.data())) {
+    ReplayLogs(path);
+  }
+  const uint8_t* base = recovered_.empty() ? file_.data() : recovered_.data();
+  uint64_t size = recovered_.empty() ? file_.size() : recovered_.size();
+  if (Read32(base + 0x14) != 1) {
+    Close();
+    if (error) {
+      *error = L"Unsupported hive format version.";
+    }
+    return false;
+  }
+  uint64_t available = size - kBaseBlockSize;
+  uint32_t declared = Read32(base + 0x28);
+  bins_ = base + kBaseBlockSize;
+  bins_size_ = static_cast<uint32_t>(std::min<uint64_t>(declared == 0 ? available : declared, std::min<uint64_t>(available, 0xFFFFFFF0u)));
+  minor_version_ = Read32(base + 0x18);
+  root_cell_ = Read32(base + 0x24);
+  if (!KeyNode(root_cell_)) {
+    Close();
+    if (error) {
+      *error = L"The hive root key is invalid.";
+    }
+    return false;
+  }
+  if (mapping_budget_ != 0 && recovery_state_ != HiveRecoveryState::kReplayed) {
+    file_.SetResidencyBudget(mapping_budget_);
+  }
+  path_cache_ = std::make_unique<HivePathCache>();
+  return true;
+}
+
+void HiveReader::ReplayLogs(const std::filesystem::path& path) {
+  HiveLog logs[2];
+  std::vector<const HiveLog*> opened;
+  for (int i = 0; i < 2; ++i) {
+    for (const wchar_t* suffix : {i == 0 ? L".LOG1" : L".LOG2", i == 0 ? L".log1" : L".log2"}) {
+      std::filesystem::path log_path = path;
+      log_path += suffix;
+      std::error_code ec;
+      if (std::filesystem::is_regular_file(log_path, ec) && logs[i].Open(log_path, nullptr)) {
+        opened.push_back(&logs[i]);
+        break;
+      }
+    }
+  }
+  if (opened.empty()) {
+    recovery_state_ = HiveRecoveryState::kDirtyNoLogs;
+    return;
+  }
+  HiveRecoveryPlan plan;
+  MappedFile copy;
+  if (!PlanHiveRecovery(file_.data(), opened, &plan) || !copy.Open(path, nullptr, true) || copy.size() != file_.size()) {
+    recovery_state_ = HiveRecoveryState::kReplayFailed;
+    return;
+  }
+  file_ = std::move(copy);
+  if (!PlanHiveRecovery(file_.data(), opened, &plan)) {
+    recovery_state_ = HiveRecoveryState::kReplayFailed;
+    return;
+  }
+  uint64_t needed = static_cast<uint64_t>(kBaseBlockSize) + plan.bins_size;
+  if (needed <= file_.size()) {
+    ApplyHiveRecovery(plan, file_.mutable_data(), file_.size());
+  } else {
+    recovered_.resize(static_cast<size_t>(needed));
+    memcpy(recovered_.data(), file_.data(), static_cast<size_t>(file_.size()));
+    ApplyHiveRecovery(plan, recovered_.data(), recovered_.size());
+  }
+  recovery_state_ = HiveRecoveryState::kReplayed;
+}
+
+void HiveReader::Close() {
+  file_.Close();
+  recovered_.clear();
+  recovered_.shrink_to_fit();
+  recovery_state_ = HiveRecoveryState::kClean;
+  bins_ = nullptr;
+  bins_size_ = 0;
+  root_cell_ = kNoCell;
+  minor_version_ = 0;
+  path_cache_.reset();
+}
+
+std::vector<HiveBin> HiveReader::Bins() const {
+  std::vector<HiveBin> bins;
+  uint32_t offset = 0;
+  while (bins_ && bins_size_ - offset >= kHbinHeaderSize) {
+    const uint8_t* header = bins_ + offset;
+    Touch(offset, kHbinHeaderSize);
+    if (memcmp(header, "hbin", 4) != 0) {
+      break;
+    }
+    uint32_t size = Read32(header + 8);
+    if (size < kHbinAlignment || (size % kHbinAlignment) != 0 || size > bins_size_ - offset) {
+      break;
+    }
+    bins.push_back({offset, size});
+    offset += size;
+  }
+  return bins;
+}
+
+const uint8_t* HiveReader::Cell(uint32_t offset, uint32_t* size) const {
+  if (!bins_ || bins_size_ < 8 || (offset & 7) != 0 || offset > bins_size_ - 8) {
+    return nullptr;
+  }
+  int32_t raw = static_cast<int32_t>(Read32(bins_ + offset));
+  uint32_t cell_size = raw < 0 ? static_cast<uint32_t>(-static_cast<int64_t>(raw)) : static_cast<uint32_t>(raw);
+  if (cell_size < 8 || cell_size > bins_size_ - offset) {
+    return nullptr;
+  }
+  Touch(offset, cell_size);
+  if (size) {
+    *size = cell_size - 4;
+  }
+  return bins_ + offset + 4;
+}
+
+void HiveReader::Touch(uint32_t offset, uint32_t size) const {
+  if (recovered_.empty()) {
+    file_.Touch(static_cast<uint64_t>(kBaseBlockSize) + offset, size);
+  }
+}
+
+const uint8_t* HiveReader::KeyNode(uint32_t offset) const {
+  uint32_t size = 0;
+  const uint8_t* cell = Cell(offset, &size);
+  if (!cell || size < kKeyNodeNameOffset || !HasSignature(cell, 'n', 'k')) {
+    return nullptr;
+  }
+  if (kKeyNodeNameOffset + Read16(cell + 0x48) > size) {
+    return nullptr;
+  }
+  return cell;
+}
+
+HiveName HiveReader::KeyName(uint32_t cell) const {
+  HiveName name;
+  const uint8_t* node = KeyNode(cell);
+  if (!node) {
+    return name;
+  }
+  name.data = node + kKeyNodeNameOffset;
+  name.bytes = Read16(node + 0x48);
+  name.compressed = (Read16(node + 0x02) & kKeyCompressedName) != 0;
+  return name;
+}
+
+bool HiveReader::QueryKey(uint32_t cell, HiveKeyInfo* info) const {
+  const uint8_t* node = KeyNode(cell);
+  if (!node || !info) {
+    return false;
+  }
+  info->flags = Read16(node + 0x02);
+  info->last_write = Read64(node + 0x04);
+  info->parent = Read32(node + 0x10);
+  info->subkey_count = Read32(node + 0x14);
+  info->value_count = Read32(node + 0x24);
+  return true;
+}
+
+bool HiveReader::EnumSubkeyList(uint32_t list, const std::function<bool(uint32_t child)>& callback, int depth) const {
+  uint32_t size = 0;
+  const uint8_t* cell = Cell(list, &size);
+  if (!cell || size < 4 || depth > 2) {
+    return true;
+  }
+  uint32_t count = Read16(cell + 2);
+  if (HasSignature(cell, 'l', 'i') || HasSignature(cell, 'r', 'i')) {
+    if (4 + count * 4ull > size) {
+      return true;
+    }
+    bool is_index = cell[0] == 'r';
+    for (uint32_t i = 0; i < count; ++i) {
+      uint32_t offset = Read32(cell + 4 + i * 4);
+      if (is_index) {
+        if (!EnumSubkeyList(offset, callback, depth + 1)) {
+          return false;
+        }
+      } else if (!callback(offset)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  if (HasSignature(cell, 'l', 'f') || HasSignature(cell, 'l', 'h')) {
+    if (4 + count * 8ull > size) {
+      return true;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+      if (!callback(Read32(cell + 4 + i * 8))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool HiveReader::EnumSubkeys(uint32_t cell, const std::function<bool(uint32_t child)>& callback) const {
+  const uint8_t* node = KeyNode(cell);
+  if (!node) {
+    return false;
+  }
+  if (Read32(node + 0x14) == 0) {
+    return true;
+  }
+  return EnumSubkeyList(Read32(node + 0x1C), [&](uint32_t child) -> bool {
+    if (!KeyNode(child)) {
+      return true;
+    }
+    return callback(child);
+  }, 0);
+}
+
+bool HiveReader::FindInSubkeyList(uint32_t list, std::wstring_view name, bool hashed, uint32_t hash, uint32_t* cell, int depth) const {
+  uint32_t size = 0;
+  const uint8_t* leaf = Cell(list, &size);
+  if (!leaf || size < 4 || depth > 2) {
+    return false;
+  }
+  uint32_t count = Read16(leaf + 2);
+  auto matches = [&](uint32_t child) -> bool {
+    if (!KeyNode(child) || !KeyName(child).EqualsInsensitive(name)) {
+      return false;
+    }
+    *cell = child;
+    return true;
+  };
+  if (HasSignature(leaf, 'l', 'i') || HasSignature(leaf, 'r', 'i')) {
+    if (4 + count * 4ull > size) {
+      return false;
+    }
+    bool is_index = leaf[0] == 'r';
+    for (uint32_t i = 0; i < count; ++i) {
+      uint32_t offset = Read32(leaf + 4 + i * 4);
+      if (is_index ? FindInSubkeyList(offset, name, hashed, hash, cell, depth + 1) : matches(offset)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  bool fast = HasSignature(leaf, 'l', 'f');
+  if ((!fast && !HasSignature(leaf, 'l', 'h')) || 4 + count * 8ull > size) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint8_t* entry = leaf + 4 + i * 8;
+    if (hashed && (fast ? !HintMatches(entry + 4, name) : Read32(entry + 4) != hash)) {
+      continue;
+    }
+    if (matches(Read32(entry))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HiveReader::FindSubkey(uint32_t parent, std::wstring_view name, uint32_t* cell) const {
+  const uint8_t* node = KeyNode(parent);
+  if (!node || name.empty() || Read32(node + 0x14) == 0) {
+    return false;
+  }
+  bool hashed = true;
+  uint32_t hash = 0;
+  for (wchar_t ch : name) {
+    if (static_cast<uint32_t>(ch) >= 0x80) {
+      hashed = false;
+      break;
+    }
+    hash = hash * 37 + UpcaseUnit(ch);
+  }
+  uint32_t found = kNoCell;
+  if (!FindInSubkeyList(Read32(node + 0x1C), name, hashed, hash, &found, 0)) {
+    return false;
+  }
+  if (cell) {
+    *cell = found;
+  }
+  return true;
+}
+
+bool HiveReader::FindKey(std::wstring_view path, uint32_t* cell) const {
+  if (!KeyNode(root_cell_)) {
+    return false;
+  }
+  std::vector<std::wstring_view> parts = SplitKeyPath(path);
+  std::wstring normalized;
+  normalized.reserve(path.size());
+  std::vector<size_t> ends;
+  ends.reserve(parts.size());
+  for (std::wstring_view part : parts) {
+    if (!normalized.empty()) {
+      normalized.push_back(L'\\');
+    }
+    for (wchar_t ch : part) {
+      normalized.push_back(static_cast<wchar_t>(UpcaseUnit(static_cast<uint32_t>(ch))));
+    }
+    ends.push_back(normalized.size());
+  }
+
+  uint32_t current = root_cell_;
+  size_t resolved = 0;
+  if (path_cache_) {
+    for (size_t i = parts.size(); i > 0; --i) {
+      if (path_cache_->Find(std::wstring_view(normalized.data(), ends[i - 1]), &current)) {
+        resolved = i;
+        break;
+      }
+    }
+  }
+  for (size_t i = resolved; i < parts.size(); ++i) {
+    if (!FindSubkey(current, parts[i], &current)) {
+      return false;
+    }
+    if (path_cache_) {
+      path_cache_->Insert(std::wstring_view(normalized.data(), ends[i]), current);
+    }
+  }
+  if (cell) {
+    *cell = current;
+  }
+  return true;
+}
+
+bool HiveReader::ReadValue(uint32_t offset, HiveValue* value) const {
+  uint32_t size = 0;
+  const uint8_t* cell = Cell(offset, &size);
+  if (!cell || size < kValueNameOffset || !HasSignature(cell, 'v', 'k')) {
+    return false;
+  }
+  uint16_t name_bytes = Read16(cell + 0x02);
+  if (kValueNameOffset + name_bytes > size) {
+    return false;
+  }
+  uint32_t raw_size = Read32(cell + 0x04);
+  value->cell = offset;
+  value->name.data = cell + kValueNameOffset;
+  value->name.bytes = name_bytes;
+  value->name.compressed = (Read16(cell + 0x10) & kValueCompressedName) != 0;
+  value->type = Read32(cell + 0x0C);
+  value->data_size = (raw_size & kResidentDataFlag) ? std::min<uint32_t>(raw_size & ~kResidentDataFlag, 4) : raw_size;
+  return true;
+}
+
+bool HiveReader::EnumValues(uint32_t cell, const std::function<bool(const HiveValue& value)>& callback) const {
+  const uint8_t* node = KeyNode(cell);
+  if (!node) {
+    return false;
+  }
+  uint32_t count = Read32(node + 0x24);
+  if (count == 0) {
+    return true;
+  }
+  uint32_t list_size = 0;
+  const uint8_t* list = Cell(Read32(node + 0x28), &list_size);
+  if (!list || count * 4ull > list_size) {
+    return true;
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    HiveValue value;
+    if (!ReadValue(Read32(list + i * 4), &value)) {
+      continue;
+    }
+    if (!callback(value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HiveReader::FindValue(uint32_t cell, std::wstring_view name, HiveValue* value) const {
+  bool found = false;
+  EnumValues(cell, [&](const HiveValue& entry) -> bool {
+    if (entry.name.EqualsInsensitive(name)) {
+      if (value) {
+        *value = entry;
+      }
+      found = true;
+      return false;
+    }
+    return true;
+  });
+  return found;
+}
+
+bool HiveReader::ValueData(const HiveValue& value, std::vector<uint8_t>* scratch, const uint8_t** data, uint32_t* size) const {
+  if (!data || !size) {
+    return false;
+  }
+  *data = nullptr;
+  *size = 0;
+  uint32_t vk_size = 0;
+  const uint8_t* vk = Cell(value.cell, &vk_size);
+  if (!vk || vk_size < kValueNameOffset) {
+    return false;
+  }
+  if (value.data_size == 0) {
+    return true;
+  }
+  uint32_t raw_size = Read32(vk + 0x04);
+  if (raw_size & kResidentDataFlag) {
+    *data = vk + 0x08;
+    *size = value.data_size;
+    return true;
+  }
+  uint32_t cell_size = 0;
+  const uint8_t* cell = Cell(Read32(vk + 0x08), &cell_size);
+  if (!cell) {
+    return false;
+  }
+  if (minor_version_ >= 4 && value.data_size > kBigDataSegmentSize && cell_size >= 8 && HasSignature(cell, 'd', 'b')) {
+    if (!scratch) {
+      return false;
+    }
+    uint32_t segments = Read16(cell + 2);
+    uint32_t list_size = 0;
+    const uint8_t* list = Cell(Read32(cell + 4), &list_size);
+    if (!list || segments * 4ull > list_size) {
+      return false;
+    }
+    scratch->clear();
+    scratch->reserve(value.data_size);
+    for (uint32_t i = 0; i < segments && scratch->size() < value.data_size; ++i) {
+      uint32_t segment_size = 0;
+      const uint8_t* segment = Cell(Read32(list + i * 4), &segment_size);
+      if (!segment) {
+        return false;
+      }
+      size_t remaining = value.data_size - scratch->size();
+      size_t take = std::min<size_t>({remaining, segment_size, kBigDataSegmentSize});
+      scratch->insert(scratch->end(), segment, segment + take);
+    }
+    if (scratch->size() != value.data_size) {
+      return false;
+    }
+    *data = scratch->data();
+    *size = value.data_size;
+    return true;
+  }
+  if (value.data_size > cell_size) {
+    return false;
+  }
+  *data = cell;
+  *size = value.data_size;
+  return true;
+}
+
+} // namespace regkit
@@ -0,0 +1,670 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "registry/hive_scan.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace regkit {
+
+namespace {
+
+constexpr uint32_t kHbinHeaderSize = 32;
+constexpr uint32_t kKeyNodeMinSize = 4 + 0x4C;
+constexpr size_t kScanBatch = 64;
+constexpr char kIndexMagic[4] = {'r', 'k', 'i', 'x'};
+constexpr uint32_t kIndexVersion = 4;
+constexpr uint64_t kHashPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kHashPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kHashPrime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t kHashPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t kHashPrime5 = 0x27D4EB2F165667C5ull;
+
+enum : uint8_t {
+  kUnknown,
+  kVisiting,
+  kInside,
+  kOutside,
+};
+
+uint32_t Read32(const uint8_t* data) {
+  uint32_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint64_t Read64(const uint8_t* data) {
+  uint64_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint64_t Rotl64(uint64_t value, int shift) {
+  return (value << shift) | (value >> (64 - shift));
+}
+
+uint64_t HashRound(uint64_t acc, uint64_t input) {
+  return Rotl64(acc + input * kHashPrime2, 31) * kHashPrime1;
+}
+
+uint64_t HashBytes(const uint8_t* data, uint64_t size) {
+  uint64_t lanes[4] = {kHashPrime1 + kHashPrime2, kHashPrime2, 0, 0 - kHashPrime1};
+  uint64_t stripes_end = size - size % 32;
+  for (uint64_t offset = 0; offset < stripes_end; offset += 32) {
+    for (int lane = 0; lane < 4; ++lane) {
+      lanes[lane] = HashRound(lanes[lane], Read64(data + offset + lane * 8));
+    }
+  }
+  uint64_t hash = kHashPrime5;
+  if (size >= 32) {
+    hash = Rotl64(lanes[0], 1) + Rotl64(lanes[1], 7) + Rotl64(lanes[2], 12) + Rotl64(lanes[3], 18);
+    for (uint64_t lane : lanes) {
+      hash = (hash ^ HashRound(0, lane)) * kHashPrime1 + kHashPrime4;
+    }
+  }
+  hash += size;
+  uint64_t offset = stripes_end;
+  for (; size - offset >= 8; offset += 8) {
+    hash = Rotl64(hash ^ HashRound(0, Read64(data + offset)), 27) * kHashPrime1 + kHashPrime4;
+  }
+  for (; offset < size; ++offset) {
+    hash = Rotl64(hash ^ (data[offset] * kHashPrime5), 11) * kHashPrime1;
+  }
+  hash ^= hash >> 33;
+  hash *= kHashPrime2;
+  hash ^= hash >> 29;
+  hash *= kHashPrime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+char16_t LowerUnit(uint32_t ch) {
+  if (ch < 0x80) {
+    return static_cast<char16_t>((ch >= 'A' && ch <= 'Z') ? ch + ('a' - 'A') : ch);
+  }
+  return static_cast<char16_t>(towlower(towupper(static_cast<wint_t>(ch))));
+}
+
+uint32_t NameHash(uint32_t parent, std::u16string_view name) {
+  uint64_t hash = (14695981039346656037ull ^ parent) * 1099511628211ull;
+  for (char16_t unit : name) {
+    hash = (hash ^ unit) * 1099511628211ull;
+  }
+  return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+unsigned int ClampThreads(unsigned int thread_count, size_t work) {
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+  return static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(thread_count, work)));
+}
+
+void RunThreads(unsigned int thread_count, const std::function<void(unsigned int index)>& body) {
+  if (thread_count <= 1) {
+    body(0);
+    return;
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (unsigned int i = 1; i < thread_count; ++i) {
+    threads.emplace_back(body, i);
+  }
+  body(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+bool IsCancelled(const std::atomic_bool* cancel) {
+  return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+template <typename Table>
+void ResolveChains(const Table& table, std::vector<uint8_t>* state) {
+  std::vector<uint32_t> chain;
+  for (uint32_t i = 0; i < table.size(); ++i) {
+    if ((*state)[i] != kUnknown) {
+      continue;
+    }
+    chain.clear();
+    uint32_t current = i;
+    uint8_t result = kOutside;
+    while (current != 0xFFFFFFFFu) {
+      if ((*state)[current] == kInside || (*state)[current] == kOutside) {
+        result = (*state)[current];
+        break;
+      }
+      if ((*state)[current] == kVisiting) {
+        break;
+      }
+      (*state)[current] = kVisiting;
+      chain.push_back(current);
+      current = table[current].parent;
+    }
+    for (uint32_t index : chain) {
+      (*state)[index] = result;
+    }
+  }
+}
+
+struct IndexHeader {
+  char magic[4] = {};
+  uint32_t version = 0;
+  uint64_t hive_size = 0;
+  int64_t write_time = 0;
+  uint64_t payload_hash = 0;
+  uint32_t checksum = 0;
+  uint32_t primary_sequence = 0;
+  uint32_t secondary_sequence = 0;
+  uint32_t bins_size = 0;
+  uint32_t key_count = 0;
+  uint32_t name_units = 0;
+  uint32_t value_count = 0;
+  uint32_t lookup_size = 0;
+};
+
+static_assert(sizeof(IndexHeader) == 64);
+
+uint64_t NamePoolBytes(uint32_t name_units) {
+  return (static_cast<uint64_t>(name_units) * sizeof(char16_t) + 3) & ~3ull;
+}
+
+bool StampIndex(const HiveReader& reader, const std::filesystem::path& hive_path, IndexHeader* header) {
+  const uint8_t* base = reader.base_block();
+  if (!base || reader.replayed_logs()) {
+    return false;
+  }
+  std::error_code ec;
+  uint64_t size = std::filesystem::file_size(hive_path, ec);
+  if (ec) {
+    return false;
+  }
+  std::filesystem::file_time_type write_time = std::filesystem::last_write_time(hive_path, ec);
+  if (ec) {
+    return false;
+  }
+  *header = IndexHeader();
+  memcpy(header->magic, kIndexMagic, sizeof(kIndexMagic));
+  header->version = kIndexVersion;
+  header->hive_size = size;
+  header->write_time = static_cast<int64_t>(write_time.time_since_epoch().count());
+  header->checksum = Read32(base + 0x1FC);
+  header->primary_sequence = Read32(base + 0x04);
+  header->secondary_sequence = Read32(base + 0x08);
+  header->bins_size = reader.bins_size();
+  return true;
+}
+
+} // namespace
+
+void HiveScanner::Reset() {
+  keys_.clear();
+  names_.clear();
+  values_.clear();
+  lookup_.clear();
+  index_.Close();
+  shared_.reset();
+  table_ = {};
+  name_pool_ = {};
+  value_table_ = {};
+  lookup_table_ = {};
+  selected_.clear();
+  start_index_ = kNoIndex;
+}
+
+bool HiveScanner::Index(unsigned int thread_count, const std::atomic_bool* cancel) {
+  Reset();
+  const uint8_t* bins = reader_.bins();
+  if (!bins) {
+    return false;
+  }
+
+  std::vector<HiveBin> hbins = reader_.Bins();
+  if (hbins.empty()) {
+    return false;
+  }
+  unsigned int chunk_count = ClampThreads(thread_count, hbins.size());
+  std::vector<size_t> chunk_starts;
+  chunk_starts.reserve(chunk_count + 1);
+  chunk_starts.push_back(0);
+  uint64_t covered = static_cast<uint64_t>(hbins.back().offset) + hbins.back().size;
+  uint64_t accumulated = 0;
+  for (size_t i = 0; i < hbins.size() && chunk_starts.size() < chunk_count; ++i) {
+    accumulated += hbins[i].size;
+    if (accumulated * chunk_count >= covered * chunk_starts.size()) {
+      chunk_starts.push_back(i + 1);
+    }
+  }
+  chunk_starts.push_back(hbins.size());
+  chunk_count = static_cast<unsigned int>(chunk_starts.size() - 1);
+
+  std::vector<std::vector<KeyEntry>> chunks(chunk_count);
+  std::atomic_bool cancelled(false);
+  RunThreads(chunk_count, [&](unsigned int index) {
+    std::vector<KeyEntry>& found = chunks[index];
+    HiveKeyInfo info;
+    for (size_t h = chunk_starts[index]; h < chunk_starts[index + 1]; ++h) {
+      if (IsCancelled(cancel)) {
+        cancelled.store(true);
+        return;
+      }
+      reader_.Touch(hbins[h].offset, hbins[h].size);
+      uint32_t end = hbins[h].offset + hbins[h].size;
+      uint32_t offset = hbins[h].offset + kHbinHeaderSize;
+      while (end - offset >= 8) {
+        int32_t raw = static_cast<int32_t>(Read32(bins + offset));
+        uint32_t cell_size = raw < 0 ? static_cast<uint32_t>(-static_cast<int64_t>(raw)) : static_cast<uint32_t>(raw);
+        if (cell_size < 8 || (cell_size & 7) != 0 || cell_size > end - offset) {
+          break;
+        }
+        if (raw < 0 && cell_size >= kKeyNodeMinSize && bins[offset + 4] == 'n' && bins[offset + 5] == 'k' && reader_.QueryKey(offset, &info)) {
+          found.push_back({offset, info.parent, kNoIndex});
+        }
+        offset += cell_size;
+      }
+    }
+  });
+  if (cancelled.load()) {
+    return false;
+  }
+
+  size_t total = 0;
+  for (const auto& chunk : chunks) {
+    total += chunk.size();
+  }
+  keys_.reserve(total);
+  for (auto& chunk : chunks) {
+    keys_.insert(keys_.end(), chunk.begin(), chunk.end());
+    std::vector<KeyEntry>().swap(chunk);
+  }
+  table_ = keys_;
+
+  unsigned int link_threads = ClampThreads(thread_count, keys_.size() / 4096 + 1);
+  std::vector<std::atomic<uint8_t>> listed(keys_.size());
+  RunThreads(link_threads, [&](unsigned int index) {
+    size_t begin = keys_.size() * index / link_threads;
+    size_t end = keys_.size() * (index + 1) / link_threads;
+    for (size_t i = begin; i < end && !IsCancelled(cancel); ++i) {
+      uint32_t parent_cell = keys_[i].cell;
+      reader_.EnumSubkeys(parent_cell, [&](uint32_t child) -> bool {
+        uint32_t child_index = FindIndex(child);
+        if (child_index != kNoIndex && keys_[child_index].parent_cell == parent_cell) {
+          listed[child_index].store(1, std::memory_order_relaxed);
+        }
+        return true;
+      });
+    }
+  });
+  RunThreads(link_threads, [&](unsigned int index) {
+    size_t begin = keys_.size() * index / link_threads;
+    size_t end = keys_.size() * (index + 1) / link_threads;
+    for (size_t i = begin; i < end; ++i) {
+      keys_[i].parent = FindIndex(keys_[i].parent_cell);
+    }
+  });
+  if (IsCancelled(cancel)) {
+    return false;
+  }
+
+  std::vector<uint8_t> state(keys_.size(), kUnknown);
+  for (size_t i = 0; i < keys_.size(); ++i) {
+    if (!listed[i].load(std::memory_order_relaxed)) {
+      state[i] = kOutside;
+    }
+  }
+  uint32_t root = FindIndex(reader_.root_cell());
+  if (root != kNoIndex) {
+    keys_[root].parent = kNoIndex;
+    state[root] = kInside;
+  }
+  ResolveChains(keys_, &state);
+  std::vector<uint32_t> remap(keys_.size(), kNoIndex);
+  uint32_t kept = 0;
+  for (size_t i = 0; i < keys_.size(); ++i) {
+    if (state[i] == kInside) {
+      remap[i] = kept;
+      keys_[kept++] = keys_[i];
+    }
+  }
+  keys_.resize(kept);
+  for (KeyEntry& key : keys_) {
+    key.parent = key.parent == kNoIndex ? kNoIndex : remap[key.parent];
+  }
+  table_ = keys_;
+  return BuildTables(thread_count, cancel);
+}
+
+bool HiveScanner::BuildTables(unsigned int thread_count, const std::atomic_bool* cancel) {
+  unsigned int threads = ClampThreads(thread_count, keys_.size() / 4096 + 1);
+  std::vector<std::u16string> chunk_names(threads);
+  std::vector<std::vector<uint32_t>> chunk_values(threads);
+  RunThreads(threads, [&](unsigned int index) {
+    size_t begin = keys_.size() * index / threads;
+    size_t end = keys_.size() * (index + 1) / threads;
+    std::u16string& names = chunk_names[index];
+    std::vector<uint32_t>& values = chunk_values[index];
+    for (size_t i = begin; i < end && !IsCancelled(cancel); ++i) {
+      KeyEntry& key = keys_[i];
+      HiveName name = reader_.KeyName(key.cell);
+      key.name_offset = static_cast<uint32_t>(names.size());
+      for (size_t unit = 0; unit < name.length(); ++unit) {
+        names.push_back(LowerUnit(name.at(unit)));
+      }
+      key.value_begin = static_cast<uint32_t>(values.size());
+      reader_.EnumValues(key.cell, [&](const HiveValue& value) -> bool {
+        values.push_back(value.cell);
+        return true;
+      });
+      key.value_count = static_cast<uint32_t>(values.size()) - key.value_begin;
+    }
+  });
+  if (IsCancelled(cancel)) {
+    return false;
+  }
+
+  uint64_t name_units = 0;
+  uint64_t value_count = 0;
+  for (unsigned int i = 0; i < threads; ++i) {
+    name_units += chunk_names[i].size();
+    value_count += chunk_values[i].size();
+  }
+  if (name_units > 0xFFFFFFFFu || value_count > 0xFFFFFFFFu || keys_.size() > 0x40000000u) {
+    return false;
+  }
+  names_.reserve(static_cast<size_t>(name_units));
+  values_.reserve(static_cast<size_t>(value_count));
+  for (unsigned int i = 0; i < threads; ++i) {
+    uint32_t name_base = static_cast<uint32_t>(names_.size());
+    uint32_t value_base = static_cast<uint32_t>(values_.size());
+    for (size_t key = keys_.size() * i / threads; key < keys_.size() * (i + 1) / threads; ++key) {
+      keys_[key].name_offset += name_base;
+      keys_[key].value_begin += value_base;
+    }
+    names_.append(chunk_names[i]);
+    values_.insert(values_.end(), chunk_values[i].begin(), chunk_values[i].end());
+  }
+  table_ = keys_;
+  name_pool_ = names_;
+  value_table_ = values_;
+
+  size_t slots = 16;
+  while (slots < keys_.size() * 2) {
+    slots <<= 1;
+  }
+  lookup_.assign(slots, kNoIndex);
+  for (uint32_t i = 0; i < keys_.size(); ++i) {
+    if (keys_[i].parent == kNoIndex) {
+      continue;
+    }
+    size_t slot = NameHash(keys_[i].parent, LowerName(i)) & (slots - 1);
+    while (lookup_[slot] != kNoIndex) {
+      slot = (slot + 1) & (slots - 1);
+    }
+    lookup_[slot] = i;
+  }
+  lookup_table_ = lookup_;
+  return true;
+}
+
+bool HiveScanner::Attach(std::shared_ptr<const HiveScanner> index) {
+  Reset();
+  if (!index || &index->reader_ != &reader_ || index->table_.empty() || index->lookup_table_.empty()) {
+    return false;
+  }
+  table_ = index->table_;
+  name_pool_ = index->name_pool_;
+  value_table_ = index->value_table_;
+  lookup_table_ = index->lookup_table_;
+  shared_ = std::move(index);
+  return true;
+}
+
+bool HiveScanner::LoadIndex(const std::filesystem::path& index_path, const std::filesystem::path& hive_path) {
+  Reset();
+  MappedFile file;
+  if (!file.Open(index_path, nullptr) || file.size() < sizeof(IndexHeader)) {
+    return false;
+  }
+  IndexHeader header;
+  memcpy(&header, file.data(), sizeof(header));
+  if (memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) != 0 || header.version != kIndexVersion) {
+    return false;
+  }
+  uint64_t keys_bytes = static_cast<uint64_t>(header.key_count) * sizeof(KeyEntry);
+  uint64_t names_bytes = NamePoolBytes(header.name_units);
+  uint64_t values_bytes = static_cast<uint64_t>(header.value_count) * sizeof(uint32_t);
+  uint64_t lookup_bytes = static_cast<uint64_t>(header.lookup_size) * sizeof(uint32_t);
+  if (file.size() != sizeof(IndexHeader) + keys_bytes + names_bytes + values_bytes + lookup_bytes || header.lookup_size <= header.key_count || (header.lookup_size & (header.lookup_size - 1)) != 0) {
+    return false;
+  }
+  const uint8_t* payload = file.data() + sizeof(IndexHeader);
+  if (HashBytes(payload, file.size() - sizeof(IndexHeader)) != header.payload_hash) {
+    return false;
+  }
+  IndexHeader expected;
+  if (!StampIndex(reader_, hive_path, &expected)) {
+    return false;
+  }
+  expected.payload_hash = header.payload_hash;
+  expected.key_count = header.key_count;
+  expected.name_units = header.name_units;
+  expected.value_count = header.value_count;
+  expected.lookup_size = header.lookup_size;
+  if (memcmp(&header, &expected, sizeof(header)) != 0) {
+    return false;
+  }
+
+  const KeyEntry* entries = reinterpret_cast<const KeyEntry*>(payload);
+  for (uint32_t i = 0; i < header.key_count; ++i) {
+    const KeyEntry& entry = entries[i];
+    if ((i > 0 && (entry.cell <= entries[i - 1].cell || entry.name_offset < entries[i - 1].name_offset)) || (entry.parent != kNoIndex && entry.parent >= header.key_count) || entry.name_offset > header.name_units || static_cast<uint64_t>(entry.value_begin) + entry.value_count > header.value_count) {
+      return false;
+    }
+  }
+  const uint32_t* lookup = reinterpret_cast<const uint32_t*>(payload + keys_bytes + names_bytes + values_bytes);
+  for (uint32_t i = 0; i < header.lookup_size; ++i) {
+    if (lookup[i] != kNoIndex && lookup[i] >= header.key_count) {
+      return false;
+    }
+  }
+  index_ = std::move(file);
+  table_ = std::span<const KeyEntry>(entries, header.key_count);
+  name_pool_ = std::u16string_view(reinterpret_cast<const char16_t*>(payload + keys_bytes), header.name_units);
+  value_table_ = std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(payload + keys_bytes + names_bytes), header.value_count);
+  lookup_table_ = std::span<const uint32_t>(lookup, header.lookup_size);
+  return true;
+}
+
+bool HiveScanner::SaveIndex(const std::filesystem::path& index_path, const std::filesystem::path& hive_path) const {
+  IndexHeader header;
+  if (keys_.empty() || lookup_.empty() || !StampIndex(reader_, hive_path, &header)) {
+    return false;
+  }
+  header.key_count = static_cast<uint32_t>(keys_.size());
+  header.name_units = static_cast<uint32_t>(names_.size());
+  header.value_count = static_cast<uint32_t>(values_.size());
+  header.lookup_size = static_cast<uint32_t>(lookup_.size());
+  uint64_t keys_bytes = keys_.size() * sizeof(KeyEntry);
+  uint64_t names_bytes = NamePoolBytes(header.name_units);
+  std::vector<uint8_t> payload(static_cast<size_t>(keys_bytes + names_bytes + (values_.size() + lookup_.size()) * sizeof(uint32_t)), 0);
+  uint8_t* out = payload.data();
+  memcpy(out, keys_.data(), static_cast<size_t>(keys_bytes));
+  memcpy(out + keys_bytes, names_.data(), names_.size() * sizeof(char16_t));
+  out += keys_bytes + names_bytes;
+  memcpy(out, values_.data(), values_.size() * sizeof(uint32_t));
+  memcpy(out + values_.size() * sizeof(uint32_t), lookup_.data(), lookup_.size() * sizeof(uint32_t));
+  header.payload_hash = HashBytes(payload.data(), payload.size());
+
+  std::filesystem::path staged = index_path;
+  staged += L".tmp";
+  std::ofstream file(staged, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+  file.close();
+  std::error_code ec;
+  if (!file) {
+    std::filesystem::remove(staged, ec);
+    return false;
+  }
+  std::filesystem::rename(staged, index_path, ec);
+  if (ec) {
+    std::filesystem::remove(staged, ec);
+    return false;
+  }
+  return true;
+}
+
+uint32_t HiveScanner::FindIndex(uint32_t cell) const {
+  auto it = std::lower_bound(table_.begin(), table_.end(), cell, [](const KeyEntry& entry, uint32_t value) { return entry.cell < value; });
+  if (it == table_.end() || it->cell != cell) {
+    return kNoIndex;
+  }
+  return static_cast<uint32_t>(it - table_.begin());
+}
+
+std::u16string_view HiveScanner::LowerName(uint32_t index) const {
+  uint32_t begin = table_[index].name_offset;
+  size_t end = index + 1 < table_.size() ? table_[index + 1].name_offset : name_pool_.size();
+  return name_pool_.substr(begin, end - begin);
+}
+
+uint32_t HiveScanner::FindChild(uint32_t parent, std::u16string_view lower_name) const {
+  size_t mask = lookup_table_.size() - 1;
+  size_t slot = NameHash(parent, lower_name) & mask;
+  for (size_t probe = 0; probe < lookup_table_.size(); ++probe) {
+    uint32_t index = lookup_table_[slot];
+    if (index == kNoIndex) {
+      break;
+    }
+    if (table_[index].parent == parent && LowerName(index) == lower_name) {
+      return index;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return kNoIndex;
+}
+
+bool HiveScanner::FindKey(std::wstring_view path, uint32_t* cell) const {
+  uint32_t current = FindIndex(reader_.root_cell());
+  if (current == kNoIndex || lookup_table_.empty()) {
+    return false;
+  }
+  std::u16string lower;
+  size_t start = 0;
+  while (start <= path.size()) {
+    size_t end = path.find(L'\\', start);
+    if (end == std::wstring_view::npos) {
+      end = path.size();
+    }
+    if (end > start) {
+      lower.clear();
+      for (wchar_t ch : path.substr(start, end - start)) {
+        lower.push_back(LowerUnit(static_cast<uint32_t>(ch)));
+      }
+      current = FindChild(current, lower);
+      if (current == kNoIndex) {
+        return false;
+      }
+    }
+    start = end + 1;
+  }
+  if (cell) {
+    *cell = table_[current].cell;
+  }
+  return true;
+}
+
+size_t HiveScanner::Select(uint32_t start_cell) {
+  selected_.clear();
+  start_index_ = FindIndex(start_cell);
+  if (start_index_ == kNoIndex) {
+    return 0;
+  }
+
+  std::vector<uint8_t> state(table_.size(), kUnknown);
+  state[start_index_] = kInside;
+  ResolveChains(table_, &state);
+
+  for (uint32_t i = 0; i < table_.size(); ++i) {
+    if (state[i] == kInside) {
+      selected_.push_back(i);
+    }
+  }
+  return selected_.size();
+}
+
+bool HiveScanner::Scan(unsigned int thread_count, const std::atomic_bool* cancel, const HiveScanCallback& callback) const {
+  if (start_index_ == kNoIndex || selected_.empty()) {
+    return true;
+  }
+  std::atomic<size_t> next(0);
+  std::atomic_bool stop(false);
+  unsigned int workers = ClampThreads(thread_count, (selected_.size() + kScanBatch - 1) / kScanBatch);
+  RunThreads(workers, [&](unsigned int) {
+    std::wstring path;
+    std::vector<uint32_t> chain;
+    HiveScanKey key;
+    for (;;) {
+      size_t begin = next.fetch_add(kScanBatch);
+      if (begin >= selected_.size()) {
+        return;
+      }
+      size_t end = std::min(selected_.size(), begin + kScanBatch);
+      for (size_t i = begin; i < end; ++i) {
+        if (stop.load(std::memory_order_relaxed) || IsCancelled(cancel)) {
+          stop.store(true);
+          return;
+        }
+        uint32_t index = selected_[i];
+        chain.clear();
+        for (uint32_t current = index; current != start_index_ && current != kNoIndex; current = table_[current].parent) {
+          chain.push_back(current);
+        }
+        path.clear();
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+          if (!path.empty()) {
+            path.push_back(L'\\');
+          }
+          reader_.KeyName(table_[*it].cell).AppendTo(&path);
+        }
+        key.cell = table_[index].cell;
+        key.name = reader_.KeyName(key.cell);
+        key.lower_name = LowerName(index);
+        key.values = value_table_.subspan(table_[index].value_begin, table_[index].value_count);
+        if (!reader_.QueryKey(key.cell, &key.info)) {
+          continue;
+        }
+        key.path = path;
+        if (!callback(key)) {
+          stop.store(true);
+          return;
+        }
+      }
+    }
+  });
+  return !stop.load();
+}
+
+} // namespace regkit
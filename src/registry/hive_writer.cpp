@@ -0,0 +1,469 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "registry/hive_writer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "registry/hive_log.h"
+
+namespace regkit {
+
+namespace {
+
+constexpr uint32_t kBaseBlockSize = 4096;
+constexpr uint32_t kHbinSize = 4096;
+constexpr uint32_t kHbinHeaderSize = 32;
+constexpr uint32_t kKeyNodeNameOffset = 0x4C;
+constexpr uint32_t kValueNameOffset = 0x14;
+constexpr uint32_t kSecurityHeaderSize = 0x14;
+constexpr uint32_t kResidentDataFlag = 0x80000000u;
+constexpr uint32_t kBigDataSegmentSize = 16344;
+constexpr uint32_t kLeafLimit = 1012;
+constexpr int kMaxKeyDepth = 512;
+
+uint16_t Read16(const uint8_t* data) {
+  uint16_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t Read32(const uint8_t* data) {
+  uint32_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void Write16(uint8_t* data, uint16_t value) {
+  memcpy(data, &value, sizeof(value));
+}
+
+void Write32(uint8_t* data, uint32_t value) {
+  memcpy(data, &value, sizeof(value));
+}
+
+uint32_t NameHash(const HiveName& name) {
+  uint32_t hash = 0;
+  for (size_t i = 0; i < name.length(); ++i) {
+    uint32_t ch = name.at(i);
+    if (ch < 0x80) {
+      ch = (ch >= 'a' && ch <= 'z') ? ch - ('a' - 'A') : ch;
+    } else {
+      ch = static_cast<uint16_t>(towupper(static_cast<wint_t>(ch)));
+    }
+    hash = hash * 37 + ch;
+  }
+  return hash;
+}
+
+uint32_t NameHint(const HiveName& name) {
+  uint8_t hint[4] = {};
+  for (size_t i = 0; i < 4 && i < name.length(); ++i) {
+    uint16_t ch = name.at(i);
+    hint[i] = ch < 0x100 ? static_cast<uint8_t>(ch) : 0;
+  }
+  uint32_t value = 0;
+  memcpy(&value, hint, sizeof(value));
+  return value;
+}
+
+class CompactWriter {
+public:
+  explicit CompactWriter(const HiveReader& reader) : reader_(reader) {}
+
+  bool Build(std::vector<uint8_t>* image, std::wstring* error);
+
+private:
+  uint32_t Allocate(uint32_t payload);
+  void FinishBin();
+  uint8_t* Payload(uint32_t cell) { return bins_.data() + cell + 4; }
+  uint32_t LeafEntrySize() const { return reader_.minor_version() >= 3 ? 8 : 4; }
+  uint32_t CopyKey(uint32_t source, uint32_t parent, int depth);
+  uint32_t CopyClass(const uint8_t* node);
+  uint32_t CopySecurity(uint32_t source);
+  uint32_t CopyValue(const HiveValue& value);
+  uint32_t CopyData(const uint8_t* data, uint32_t size);
+  void LinkSecurity();
+  uint32_t Fail(const wchar_t* message);
+
+  const HiveReader& reader_;
+  std::vector<uint8_t> bins_;
+  uint32_t bin_end_ = 0;
+  std::unordered_map<uint32_t, uint32_t> security_;
+  std::vector<uint32_t> security_order_;
+  std::unordered_set<uint32_t> visited_;
+  std::vector<uint8_t> scratch_;
+  std::wstring error_;
+};
+
+uint32_t CompactWriter::Fail(const wchar_t* message) {
+  if (error_.empty()) {
+    error_ = message;
+  }
+  return HiveReader::kNoCell;
+}
+
+uint32_t CompactWriter::Allocate(uint32_t payload) {
+  uint32_t size = (payload + 4 + 7) & ~7u;
+  if (bins_.size() + size > bin_end_) {
+    FinishBin();
+    uint32_t bin_size = (size + kHbinHeaderSize + kHbinSize - 1) / kHbinSize * kHbinSize;
+    uint32_t bin_offset = static_cast<uint32_t>(bins_.size());
+    bins_.resize(bins_.size() + kHbinHeaderSize, 0);
+    uint8_t* header = bins_.data() + bin_offset;
+    memcpy(header, "hbin", 4);
+    Write32(header + 0x04, bin_offset);
+    Write32(header + 0x08, bin_size);
+    bin_end_ = bin_offset + bin_size;
+  }
+  uint32_t cell = static_cast<uint32_t>(bins_.size());
+  bins_.resize(bins_.size() + size, 0);
+  Write32(bins_.data() + cell, static_cast<uint32_t>(-static_cast<int32_t>(size)));
+  return cell;
+}
+
+void CompactWriter::FinishBin() {
+  uint32_t remaining = bin_end_ - static_cast<uint32_t>(bins_.size());
+  if (remaining == 0) {
+    return;
+  }
+  uint32_t cell = static_cast<uint32_t>(bins_.size());
+  bins_.resize(bin_end_, 0);
+  Write32(bins_.data() + cell, remaining);
+}
+
+uint32_t CompactWriter::CopyClass(const uint8_t* node) {
+  uint32_t source = Read32(node + 0x30);
+  uint16_t length = Read16(node + 0x4A);
+  if (source == HiveReader::kNoCell || length == 0) {
+    return HiveReader::kNoCell;
+  }
+  uint32_t size = 0;
+  const uint8_t* data = reader_.Cell(source, &size);
+  if (!data || size < length) {
+    return Fail(L"A key class name could not be read.");
+  }
+  uint32_t cell = Allocate(length);
+  memcpy(Payload(cell), data, length);
+  return cell;
+}
+
+uint32_t CompactWriter::CopySecurity(uint32_t source) {
+  auto it = security_.find(source);
+  if (it != security_.end()) {
+    uint8_t* sk = Payload(it->second);
+    Write32(sk + 0x0C, Read32(sk + 0x0C) + 1);
+    return it->second;
+  }
+  uint32_t size = 0;
+  const uint8_t* data = reader_.Cell(source, &size);
+  if (!data || size < kSecurityHeaderSize || data[0] != 's' || data[1] != 'k') {
+    return HiveReader::kNoCell;
+  }
+  uint32_t descriptor = Read32(data + 0x10);
+  if (descriptor > size - kSecurityHeaderSize) {
+    return HiveReader::kNoCell;
+  }
+  uint32_t cell = Allocate(kSecurityHeaderSize + descriptor);
+  uint8_t* sk = Payload(cell);
+  memcpy(sk, data, kSecurityHeaderSize + descriptor);
+  Write32(sk + 0x0C, 1);
+  security_.emplace(source, cell);
+  security_order_.push_back(cell);
+  return cell;
+}
+
+void CompactWriter::LinkSecurity() {
+  size_t count = security_order_.size();
+  for (size_t i = 0; i < count; ++i) {
+    uint8_t* sk = Payload(security_order_[i]);
+    Write32(sk + 0x04, security_order_[(i + 1) % count]);
+    Write32(sk + 0x08, security_order_[(i + count - 1) % count]);
+  }
+}
+
+uint32_t CompactWriter::CopyData(const uint8_t* data, uint32_t size) {
+  if (reader_.minor_version() < 4 || size <= kBigDataSegmentSize) {
+    uint32_t cell = Allocate(size);
+    memcpy(Payload(cell), data, size);
+    return cell;
+  }
+  uint32_t segments = (size + kBigDataSegmentSize - 1) / kBigDataSegmentSize;
+  uint32_t db = Allocate(8);
+  uint32_t list = Allocate(segments * 4);
+  uint8_t* header = Payload(db);
+  header[0] = 'd';
+  header[1] = 'b';
+  Write16(header + 0x02, static_cast<uint16_t>(segments));
+  Write32(header + 0x04, list);
+  for (uint32_t i = 0; i < segments; ++i) {
+    uint32_t offset = i * kBigDataSegmentSize;
+    uint32_t chunk = std::min(kBigDataSegmentSize, size - offset);
+    uint32_t segment = Allocate(chunk);
+    memcpy(Payload(segment), data + offset, chunk);
+    Write32(Payload(list) + i * 4, segment);
+  }
+  return db;
+}
+
+uint32_t CompactWriter::CopyValue(const HiveValue& value) {
+  uint32_t size = 0;
+  const uint8_t* source = reader_.Cell(value.cell, &size);
+  if (!source || size < kValueNameOffset) {
+    return Fail(L"A value could not be read.");
+  }
+  uint32_t vk_size = kValueNameOffset + Read16(source + 0x02);
+  if (vk_size > size) {
+    return Fail(L"A value could not be read.");
+  }
+  uint32_t cell = Allocate(vk_size);
+  memcpy(Payload(cell), source, vk_size);
+  uint32_t raw_size = Read32(source + 0x04);
+  if ((raw_size & kResidentDataFlag) || value.data_size == 0) {
+    if (value.data_size == 0) {
+      Write32(Payload(cell) + 0x08, HiveReader::kNoCell);
+    }
+    return cell;
+  }
+  const uint8_t* data = nullptr;
+  uint32_t data_size = 0;
+  if (!reader_.ValueData(value, &scratch_, &data, &data_size) || !data) {
+    return Fail(L"Value data could not be read.");
+  }
+  uint32_t data_cell = CopyData(data, data_size);
+  uint8_t* vk = Payload(cell);
+  Write32(vk + 0x04, data_size);
+  Write32(vk + 0x08, data_cell);
+  return cell;
+}
+
+uint32_t CompactWriter::CopyKey(uint32_t source, uint32_t parent, int depth) {
+  uint32_t size = 0;
+  const uint8_t* node = reader_.Cell(source, &size);
+  HiveKeyInfo info;
+  if (!error_.empty()) {
+    return HiveReader::kNoCell;
+  }
+  if (!node || depth > kMaxKeyDepth || !reader_.QueryKey(source, &info) || !visited_.insert(source).second) {
+    return Fail(L"A key could not be read.");
+  }
+  uint32_t node_size = kKeyNodeNameOffset + Read16(node + 0x48);
+  uint32_t cell = Allocate(node_size);
+  memcpy(Payload(cell), node, node_size);
+  uint8_t* nk = Payload(cell);
+  if (parent != HiveReader::kNoCell) {
+    Write32(nk + 0x10, parent);
+  }
+  Write32(nk + 0x18, 0);
+  Write32(nk + 0x20, HiveReader::kNoCell);
+
+  uint32_t class_cell = CopyClass(node);
+  Write32(Payload(cell) + 0x30, class_cell);
+  if (class_cell == HiveReader::kNoCell) {
+    Write16(Payload(cell) + 0x4A, 0);
+  }
+  uint32_t security = CopySecurity(Read32(node + 0x2C));
+  if (security == HiveReader::kNoCell) {
+    if (parent == HiveReader::kNoCell) {
+      return Fail(L"The hive root key has no valid security descriptor.");
+    }
+    security = Read32(Payload(parent) + 0x2C);
+    uint8_t* sk = Payload(security);
+    Write32(sk + 0x0C, Read32(sk + 0x0C) + 1);
+  }
+  Write32(Payload(cell) + 0x2C, security);
+
+  std::vector<HiveValue> values;
+  reader_.EnumValues(source, [&](const HiveValue& value) -> bool {
+    values.push_back(value);
+    return true;
+  });
+  uint32_t value_list = HiveReader::kNoCell;
+  uint32_t value_count = 0;
+  if (!values.empty()) {
+    value_list = Allocate(static_cast<uint32_t>(values.size() * 4));
+    for (const HiveValue& value : values) {
+      uint32_t vk = CopyValue(value);
+      if (vk == HiveReader::kNoCell) {
+        return HiveReader::kNoCell;
+      }
+      Write32(Payload(value_list) + value_count * 4, vk);
+      ++value_count;
+    }
+  }
+  Write32(Payload(cell) + 0x24, value_count);
+  Write32(Payload(cell) + 0x28, value_count > 0 ? value_list : HiveReader::kNoCell);
+
+  std::vector<uint32_t> children;
+  reader_.EnumSubkeys(source, [&](uint32_t child) -> bool {
+    if (visited_.find(child) == visited_.end() && reader_.QueryKey(child, &info)) {
+      children.push_back(child);
+    }
+    return true;
+  });
+  uint32_t count = static_cast<uint32_t>(children.size());
+  uint32_t subkey_list = HiveReader::kNoCell;
+  std::vector<uint32_t> leaves;
+  if (count > 0) {
+    uint32_t leaf_count = (count + kLeafLimit - 1) / kLeafLimit;
+    uint32_t index = HiveReader::kNoCell;
+    if (leaf_count > 1) {
+      index = Allocate(4 + leaf_count * 4);
+      Payload(index)[0] = 'r';
+      Payload(index)[1] = 'i';
+      Write16(Payload(index) + 0x02, static_cast<uint16_t>(leaf_count));
+    }
+    for (uint32_t i = 0; i < leaf_count; ++i) {
+      uint32_t entries = std::min(kLeafLimit, count - i * kLeafLimit);
+      uint32_t leaf = Allocate(4 + entries * LeafEntrySize());
+      Payload(leaf)[0] = 'l';
+      Payload(leaf)[1] = reader_.minor_version() >= 5 ? 'h' : reader_.minor_version() >= 3 ? 'f' : 'i';
+      Write16(Payload(leaf) + 0x02, static_cast<uint16_t>(entries));
+      if (index != HiveReader::kNoCell) {
+        Write32(Payload(index) + 4 + i * 4, leaf);
+      }
+      leaves.push_back(leaf);
+    }
+    subkey_list = index != HiveReader::kNoCell ? index : leaves.front();
+  }
+  Write32(Payload(cell) + 0x1C, subkey_list);
+
+  uint32_t written = 0;
+  for (uint32_t child : children) {
+    uint32_t child_cell = CopyKey(child, cell, depth + 1);
+    if (child_cell == HiveReader::kNoCell) {
+      return HiveReader::kNoCell;
+    }
+    uint32_t leaf = leaves[written / kLeafLimit];
+    uint8_t* entry = Payload(leaf) + 4 + (written % kLeafLimit) * LeafEntrySize();
+    Write32(entry, child_cell);
+    if (reader_.minor_version() >= 5) {
+      Write32(entry + 4, NameHash(reader_.KeyName(child)));
+    } else if (reader_.minor_version() >= 3) {
+      Write32(entry + 4, NameHint(reader_.KeyName(child)));
+    }
+    ++written;
+  }
+  Write32(Payload(cell) + 0x14, written);
+  return cell;
+}
+
+bool CompactWriter::Build(std::vector<uint8_t>* image, std::wstring* error) {
+  if (!reader_.is_open()) {
+    if (error) {
+      *error = L"The hive is not open.";
+    }
+    return false;
+  }
+  uint32_t root = CopyKey(reader_.root_cell(), HiveReader::kNoCell, 0);
+  if (root == HiveReader::kNoCell) {
+    if (error) {
+      *error = error_.empty() ? L"The hive root key is invalid." : error_;
+    }
+    return false;
+  }
+  FinishBin();
+  LinkSecurity();
+
+  image->assign(kBaseBlockSize, 0);
+  const uint8_t* source = reader_.base_block();
+  memcpy(image->data(), source, kBaseBlockSize);
+  uint8_t* base = image->data();
+  uint32_t sequence = std::max(Read32(source + 0x04), Read32(source + 0x08)) + 1;
+  Write32(base + 0x04, sequence);
+  Write32(base + 0x08, sequence);
+  Write32(base + 0x1C, 0);
+  Write32(base + 0x20, 1);
+  Write32(base + 0x24, root);
+  Write32(base + 0x28, static_cast<uint32_t>(bins_.size()));
+  Write32(base + 0x2C, 1);
+  Write32(base + kHiveBaseBlockChecksumOffset, HiveBaseBlockChecksum(base));
+  image->insert(image->end(), bins_.begin(), bins_.end());
+  return true;
+}
+
+} // namespace
+
+bool BuildCompactHive(const HiveReader& reader, std::vector<uint8_t>* image, std::wstring* error) {
+  if (error) {
+    error->clear();
+  }
+  if (!image) {
+    return false;
+  }
+  CompactWriter writer(reader);
+  return writer.Build(image, error);
+}
+
+bool WriteHiveImage(const std::filesystem::path& path, const std::vector<uint8_t>& image, std::wstring* error) {
+  if (error) {
+    error->clear();
+  }
+  constexpr size_t kWriteChunk = 1u << 30;
+  bool ok = true;
+#ifdef _WIN32
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    if (error) {
+      *error = L"Failed to create file.";
+    }
+    return false;
+  }
+  for (size_t offset = 0; ok && offset < image.size();) {
+    DWORD written = 0;
+    DWORD chunk = static_cast<DWORD>(std::min(image.size() - offset, kWriteChunk));
+    ok = WriteFile(file, image.data() + offset, chunk, &written, nullptr) && written > 0;
+    offset += written;
+  }
+  ok = ok && FlushFileBuffers(file);
+  CloseHandle(file);
+#else
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    if (error) {
+      *error = L"Failed to create file.";
+    }
+    return false;
+  }
+  for (size_t offset = 0; ok && offset < image.size();) {
+    ssize_t written = ::write(fd, image.data() + offset, std::min(image.size() - offset, kWriteChunk));
+    ok = written > 0;
+    offset += ok ? static_cast<size_t>(written) : 0;
+  }
+  ok = ok && ::fsync(fd) == 0;
+  ok = ::close(fd) == 0 && ok;
+#endif
+  if (!ok) {
+    if (error) {
+      *error = L"Failed to write file.";
+    }
+    return false;
+  }
+  return true;
+}
+
+} // namespace regkit
@@ -0,0 +1,315 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "registry/mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace regkit {
+
+namespace {
+
+constexpr uint64_t kWindowGranularity = 64 * 1024;
+constexpr uint64_t kNoWindow = UINT64_MAX;
+
+} // namespace
+
+struct MappedFile::WindowState {
+  uint64_t window_size = 0;
+  uint64_t budget = 0;
+  uint64_t count = 0;
+  std::unique_ptr<std::atomic<uint64_t>[]> last_use;
+  std::unique_ptr<uint64_t[]> queued;
+  std::unique_ptr<uint64_t[]> prev;
+  std::unique_ptr<uint64_t[]> next;
+  uint64_t head = kNoWindow;
+  uint64_t tail = kNoWindow;
+  std::atomic<uint64_t> clock{1};
+  std::atomic<uint64_t> resident{0};
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+  std::atomic<uint64_t> evictions{0};
+  std::mutex mutex;
+
+  void PushFront(uint64_t window, uint64_t stamp) {
+    queued[window] = stamp;
+    prev[window] = kNoWindow;
+    next[window] = head;
+    if (head != kNoWindow) {
+      prev[head] = window;
+    } else {
+      tail = window;
+    }
+    head = window;
+  }
+
+  void Unlink(uint64_t window) {
+    if (prev[window] != kNoWindow) {
+      next[prev[window]] = next[window];
+    } else {
+      head = next[window];
+    }
+    if (next[window] != kNoWindow) {
+      prev[next[window]] = prev[window];
+    } else {
+      tail = prev[window];
+    }
+  }
+};
+
+MappedFile::MappedFile() noexcept = default;
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+  *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    Close();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    copy_on_write_ = std::exchange(other.copy_on_write_, false);
+    windows_ = std::move(other.windows_);
+#ifdef _WIN32
+    file_ = std::exchange(other.file_, nullptr);
+    mapping_ = std::exchange(other.mapping_, nullptr);
+#else
+    fd_ = std::exchange(other.fd_, -1);
+#endif
+  }
+  return *this;
+}
+
+bool MappedFile::Open(const std::filesystem::path& path, std::wstring* error, bool copy_on_write) {
+  Close();
+  if (error) {
+    error->clear();
+  }
+#ifdef _WIN32
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    if (error) {
+      *error = L"Failed to open file.";
+    }
+    return false;
+  }
+  LARGE_INTEGER size = {};
+  if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+    CloseHandle(file);
+    if (error) {
+      *error = L"File is empty.";
+    }
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingW(file, nullptr, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    CloseHandle(file);
+    if (error) {
+      *error = L"Failed to map file.";
+    }
+    return false;
+  }
+  void* view = MapViewOfFile(mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+  if (!view) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    if (error) {
+      *error = L"Failed to map file.";
+    }
+    return false;
+  }
+  file_ = file;
+  mapping_ = mapping;
+  data_ = static_cast<uint8_t*>(view);
+  size_ = static_cast<uint64_t>(size.QuadPart);
+  copy_on_write_ = copy_on_write;
+#else
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    if (error) {
+      *error = L"Failed to open file.";
+    }
+    return false;
+  }
+  struct stat st = {};
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    if (error) {
+      *error = L"File is empty.";
+    }
+    return false;
+  }
+  void* view = mmap(nullptr, static_cast<size_t>(st.st_size), copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+  if (view == MAP_FAILED) {
+    ::close(fd);
+    if (error) {
+      *error = L"Failed to map file.";
+    }
+    return false;
+  }
+  fd_ = fd;
+  data_ = static_cast<uint8_t*>(view);
+  size_ = static_cast<uint64_t>(st.st_size);
+  copy_on_write_ = copy_on_write;
+#endif
+  return true;
+}
+
+void MappedFile::Close() noexcept {
+  windows_.reset();
+#ifdef _WIN32
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_) {
+    CloseHandle(mapping_);
+  }
+  if (file_) {
+    CloseHandle(file_);
+  }
+  mapping_ = nullptr;
+  file_ = nullptr;
+#else
+  if (data_) {
+    munmap(data_, static_cast<size_t>(size_));
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+  fd_ = -1;
+#endif
+  data_ = nullptr;
+  size_ = 0;
+  copy_on_write_ = false;
+}
+
+bool MappedFile::SetResidencyBudget(uint64_t budget_bytes, uint32_t window_size) {
+  windows_.reset();
+  if (budget_bytes == 0) {
+    return true;
+  }
+  if (!data_) {
+    return false;
+  }
+#ifndef _WIN32
+  if (copy_on_write_) {
+    return false;
+  }
+#endif
+  auto state = std::make_unique<WindowState>();
+  state->window_size = std::max<uint64_t>(kWindowGranularity, (static_cast<uint64_t>(window_size) + kWindowGranularity - 1) / kWindowGranularity * kWindowGranularity);
+  state->budget = std::max(budget_bytes, state->window_size * 2);
+  state->count = (size_ + state->window_size - 1) / state->window_size;
+  state->last_use = std::make_unique<std::atomic<uint64_t>[]>(static_cast<size_t>(state->count));
+  state->queued = std::make_unique<uint64_t[]>(static_cast<size_t>(state->count));
+  state->prev = std::make_unique<uint64_t[]>(static_cast<size_t>(state->count));
+  state->next = std::make_unique<uint64_t[]>(static_cast<size_t>(state->count));
+  windows_ = std::move(state);
+  return true;
+}
+
+void MappedFile::Touch(uint64_t offset, uint64_t size) const noexcept {
+  WindowState* state = windows_.get();
+  if (!state || offset >= size_) {
+    return;
+  }
+  uint64_t last = std::min(offset + std::max<uint64_t>(size, 1), size_) - 1;
+  for (uint64_t window = offset / state->window_size; window <= last / state->window_size; ++window) {
+    std::atomic<uint64_t>& slot = state->last_use[window];
+    uint64_t seen = slot.load(std::memory_order_relaxed);
+    if (seen == 0) {
+      Fault(state, window);
+      continue;
+    }
+    state->hits.fetch_add(1, std::memory_order_relaxed);
+    uint64_t now = state->clock.load(std::memory_order_relaxed);
+    if (seen != now) {
+      slot.compare_exchange_strong(seen, now, std::memory_order_relaxed);
+    }
+  }
+}
+
+MappedFileStats MappedFile::stats() const noexcept {
+  MappedFileStats stats;
+  const WindowState* state = windows_.get();
+  if (!state) {
+    return stats;
+  }
+  stats.window_size = state->window_size;
+  stats.budget_bytes = state->budget;
+  stats.resident_bytes = state->resident.load(std::memory_order_relaxed);
+  stats.hits = state->hits.load(std::memory_order_relaxed);
+  stats.misses = state->misses.load(std::memory_order_relaxed);
+  stats.evictions = state->evictions.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void MappedFile::Fault(WindowState* state, uint64_t window) const noexcept {
+  std::lock_guard<std::mutex> lock(state->mutex);
+  uint64_t now = state->clock.fetch_add(1, std::memory_order_relaxed) + 1;
+  uint64_t expected = 0;
+  if (!state->last_use[window].compare_exchange_strong(expected, now, std::memory_order_relaxed)) {
+    state->hits.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  state->misses.fetch_add(1, std::memory_order_relaxed);
+  auto window_bytes = [&](uint64_t index) { return std::min(state->window_size, size_ - index * state->window_size); };
+  state->PushFront(window, now);
+  uint64_t resident = state->resident.load(std::memory_order_relaxed) + window_bytes(window);
+  uint64_t promoted = 0;
+  while (resident > state->budget && state->tail != window) {
+    uint64_t victim = state->tail;
+    state->Unlink(victim);
+    uint64_t used = state->last_use[victim].load(std::memory_order_relaxed);
+    if (used > state->queued[victim] && promoted++ < state->count) {
+      state->PushFront(victim, used);
+      continue;
+    }
+    state->last_use[victim].store(0, std::memory_order_relaxed);
+    if (Release(victim * state->window_size, window_bytes(victim))) {
+      state->evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    resident -= window_bytes(victim);
+  }
+  state->resident.store(resident, std::memory_order_relaxed);
+}
+
+bool MappedFile::Release(uint64_t offset, uint64_t size) const noexcept {
+#ifdef _WIN32
+  // Unlocking pages that were never locked trims them from the working set; Discard/OfferVirtualMemory reject file views.
+  return VirtualUnlock(data_ + offset, static_cast<SIZE_T>(size)) || GetLastError() == ERROR_NOT_LOCKED;
+#else
+  return madvise(data_ + offset, static_cast<size_t>(size), MADV_DONTNEED) == 0;
+#endif
+}
+
+} // namespace regkit
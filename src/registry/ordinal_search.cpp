@@ -0,0 +1,237 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "registry/ordinal_search.h"
+
+#include <bit>
+#include <cwctype>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REGKIT_ORDINAL_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace regkit {
+
+namespace {
+
+struct UpcaseTable {
+  std::vector<uint16_t> units;
+  std::vector<std::pair<wchar_t, wchar_t>> ascii_aliases;
+};
+
+const UpcaseTable& Table() {
+  static const UpcaseTable table = [] {
+    UpcaseTable result;
+    result.units.resize(0x10000);
+    for (uint32_t ch = 0; ch < 0x10000; ++ch) {
+      uint32_t upper = ch;
+      if (ch < 0x80) {
+        if (ch >= 'a' && ch <= 'z') {
+          upper = ch - ('a' - 'A');
+        }
+      } else if (ch < 0xD800 || ch > 0xDFFF) {
+#ifdef _WIN32
+        wchar_t source = static_cast<wchar_t>(ch);
+        wchar_t mapped = source;
+        if (LCMapStringEx(LOCALE_NAME_INVARIANT, LCMAP_UPPERCASE, &source, 1, &mapped, 1, nullptr, nullptr, 0) == 1) {
+          upper = static_cast<uint16_t>(mapped);
+        }
+#else
+        uint32_t mapped = static_cast<uint32_t>(towupper(static_cast<wint_t>(ch)));
+        if (mapped < 0x10000) {
+          upper = mapped;
+        }
+#endif
+        if (upper < 0x80) {
+          result.ascii_aliases.emplace_back(static_cast<wchar_t>(upper), static_cast<wchar_t>(ch));
+        }
+      }
+      result.units[ch] = static_cast<uint16_t>(upper);
+    }
+    return result;
+  }();
+  return table;
+}
+
+inline wchar_t Fold(const uint16_t* units, wchar_t ch) {
+  uint32_t value = static_cast<uint32_t>(ch);
+  if (value < 0x10000) {
+    return static_cast<wchar_t>(units[value]);
+  }
+  return static_cast<wchar_t>(towupper(static_cast<wint_t>(ch)));
+}
+
+bool CollectAliases(const UpcaseTable& table, wchar_t target, wchar_t* out, uint8_t* count, size_t capacity) {
+  if (static_cast<uint32_t>(target) >= 0x80) {
+    return false;
+  }
+  out[(*count)++] = target;
+  if (target >= L'A' && target <= L'Z') {
+    out[(*count)++] = static_cast<wchar_t>(target + (L'a' - L'A'));
+  }
+  for (const auto& alias : table.ascii_aliases) {
+    if (alias.first != target) {
+      continue;
+    }
+    if (*count == capacity) {
+      return false;
+    }
+    out[(*count)++] = alias.second;
+  }
+  return true;
+}
+
+#if defined(REGKIT_ORDINAL_SSE2)
+constexpr size_t kLanes = 16 / sizeof(wchar_t);
+constexpr uint32_t kLaneBits = sizeof(wchar_t) == 2 ? 0x5555u : 0x1111u;
+
+inline __m128i Broadcast(wchar_t ch) {
+  if constexpr (sizeof(wchar_t) == 2) {
+    return _mm_set1_epi16(static_cast<short>(ch));
+  } else {
+    return _mm_set1_epi32(static_cast<int>(ch));
+  }
+}
+
+inline __m128i LanesEqual(__m128i block, __m128i value) {
+  if constexpr (sizeof(wchar_t) == 2) {
+    return _mm_cmpeq_epi16(block, value);
+  } else {
+    return _mm_cmpeq_epi32(block, value);
+  }
+}
+
+inline __m128i AnyEqual(__m128i block, const __m128i* values, uint8_t count) {
+  __m128i hit = LanesEqual(block, values[0]);
+  for (uint8_t i = 1; i < count; ++i) {
+    hit = _mm_or_si128(hit, LanesEqual(block, values[i]));
+  }
+  return hit;
+}
+#endif
+
+} // namespace
+
+wchar_t UpcaseOrdinal(wchar_t ch) {
+  return Fold(Table().units.data(), ch);
+}
+
+bool EqualsOrdinalInsensitive(std::wstring_view left, std::wstring_view right) {
+  if (left.size() != right.size()) {
+    return false;
+  }
+  const uint16_t* units = Table().units.data();
+  for (size_t i = 0; i < left.size(); ++i) {
+    if (left[i] != right[i] && Fold(units, left[i]) != Fold(units, right[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t FindOrdinalInsensitive(std::wstring_view text, std::wstring_view needle) {
+  return OrdinalFinder(needle).Find(text);
+}
+
+void OrdinalFinder::Reset(std::wstring_view needle) {
+  const UpcaseTable& table = Table();
+  units_ = table.units.data();
+  upper_.clear();
+  upper_.reserve(needle.size());
+  for (wchar_t ch : needle) {
+    upper_.push_back(Fold(units_, ch));
+  }
+  first_count_ = 0;
+  last_count_ = 0;
+  vector_ = !upper_.empty() && CollectAliases(table, upper_.front(), first_, &first_count_, kMaxAliases) && CollectAliases(table, upper_.back(), last_, &last_count_, kMaxAliases);
+}
+
+bool OrdinalFinder::Verify(const wchar_t* text) const {
+  for (size_t i = 1; i + 1 < upper_.size(); ++i) {
+    if (Fold(units_, text[i]) != upper_[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t OrdinalFinder::Find(std::wstring_view text) const {
+  size_t count = upper_.size();
+  if (count == 0) {
+    return 0;
+  }
+  if (text.size() < count) {
+    return std::wstring_view::npos;
+  }
+  const wchar_t* data = text.data();
+  size_t starts = text.size() - count + 1;
+  size_t pos = 0;
+#if defined(REGKIT_ORDINAL_SSE2)
+  if (vector_ && starts >= kLanes) {
+    __m128i first[kMaxAliases];
+    __m128i last[kMaxAliases];
+    for (uint8_t i = 0; i < first_count_; ++i) {
+      first[i] = Broadcast(first_[i]);
+    }
+    for (uint8_t i = 0; i < last_count_; ++i) {
+      last[i] = Broadcast(last_[i]);
+    }
+    for (; pos + kLanes <= starts; pos += kLanes) {
+      __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+      __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + count - 1));
+      __m128i hits = _mm_and_si128(AnyEqual(head, first, first_count_), AnyEqual(tail, last, last_count_));
+      uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hits)) & kLaneBits;
+      while (mask) {
+        size_t lane = static_cast<size_t>(std::countr_zero(mask)) / sizeof(wchar_t);
+        if (Verify(data + pos + lane)) {
+          return pos + lane;
+        }
+        mask &= mask - 1;
+      }
+    }
+  }
+#endif
+  wchar_t head = upper_.front();
+  wchar_t tail = upper_.back();
+  for (; pos < starts; ++pos) {
+    if (Fold(units_, data[pos]) == head && Fold(units_, data[pos + count - 1]) == tail && Verify(data + pos)) {
+      return pos;
+    }
+  }
+  return std::wstring_view::npos;
+}
+
+bool OrdinalFinder::Equals(std::wstring_view text) const {
+  if (text.size() != upper_.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (Fold(units_, text[i]) != upper_[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace regkit
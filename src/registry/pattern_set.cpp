@@ -0,0 +1,201 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "registry/pattern_set.h"
+
+#include <algorithm>
+
+#include "registry/ordinal_search.h"
+
+namespace regkit {
+
+namespace {
+
+constexpr uint32_t kNoState = 0xFFFFFFFFu;
+constexpr size_t kMaxTransitions = 16u * 1024u * 1024u;
+
+} // namespace
+
+bool PatternSet::Build(const std::vector<std::wstring>& patterns, bool match_case) {
+  *this = PatternSet();
+  match_case_ = match_case;
+
+  std::vector<std::wstring> folded(patterns.size());
+  std::vector<wchar_t> alphabet;
+  size_t total = 0;
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    folded[i].reserve(patterns[i].size());
+    for (wchar_t ch : patterns[i]) {
+      wchar_t unit = match_case ? ch : UpcaseOrdinal(ch);
+      folded[i].push_back(unit);
+      alphabet.push_back(unit);
+    }
+    total += patterns[i].size();
+    max_length_ = std::max(max_length_, patterns[i].size());
+  }
+  if (total == 0) {
+    return false;
+  }
+  std::sort(alphabet.begin(), alphabet.end());
+  alphabet.erase(std::unique(alphabet.begin(), alphabet.end()), alphabet.end());
+  class_count_ = alphabet.size() + 1;
+  if ((total + 1) > kMaxTransitions / class_count_) {
+    class_count_ = 0;
+    max_length_ = 0;
+    return false;
+  }
+  for (size_t i = 0; i < alphabet.size(); ++i) {
+    uint32_t cls = static_cast<uint32_t>(i + 1);
+    if (static_cast<uint32_t>(alphabet[i]) < 0x80) {
+      ascii_classes_[alphabet[i]] = cls;
+    } else {
+      wide_classes_.emplace_back(alphabet[i], cls);
+    }
+  }
+  if (!match_case) {
+    for (wchar_t ch = 0; ch < 0x80; ++ch) {
+      wchar_t upper = UpcaseOrdinal(ch);
+      if (upper != ch && static_cast<uint32_t>(upper) < 0x80) {
+        ascii_classes_[ch] = ascii_classes_[upper];
+      }
+    }
+  }
+
+  std::vector<uint32_t> table((total + 1) * class_count_, kNoState);
+  std::vector<uint32_t> outputs(total + 1, kNoPattern);
+  uint32_t state_count = 1;
+  for (size_t i = 0; i < folded.size(); ++i) {
+    lengths_.push_back(static_cast<uint32_t>(folded[i].size()));
+    if (folded[i].empty()) {
+      continue;
+    }
+    uint32_t state = 0;
+    for (wchar_t unit : folded[i]) {
+      uint32_t& next = table[state * class_count_ + FoldedClass(unit)];
+      if (next == kNoState) {
+        next = state_count++;
+      }
+      state = next;
+    }
+    if (outputs[state] == kNoPattern) {
+      outputs[state] = static_cast<uint32_t>(i);
+    }
+  }
+  table.resize(state_count * class_count_);
+  outputs.resize(state_count);
+
+  std::vector<uint32_t> fail(state_count, 0);
+  std::vector<uint32_t> queue;
+  queue.reserve(state_count);
+  for (size_t c = 0; c < class_count_; ++c) {
+    uint32_t& child = table[c];
+    if (child == kNoState) {
+      child = 0;
+    } else {
+      queue.push_back(child);
+    }
+  }
+  for (size_t head = 0; head < queue.size(); ++head) {
+    uint32_t state = queue[head];
+    const uint32_t* fallback = &table[fail[state] * class_count_];
+    uint32_t* row = &table[state * class_count_];
+    for (size_t c = 0; c < class_count_; ++c) {
+      if (row[c] == kNoState) {
+        row[c] = fallback[c];
+        continue;
+      }
+      uint32_t child = row[c];
+      fail[child] = fallback[c];
+      if (outputs[child] == kNoPattern) {
+        outputs[child] = outputs[fail[child]];
+      }
+      queue.push_back(child);
+    }
+  }
+  transitions_ = std::move(table);
+  outputs_ = std::move(outputs);
+  return true;
+}
+
+uint32_t PatternSet::ClassOf(wchar_t ch) const {
+  if (static_cast<uint32_t>(ch) < 0x80) {
+    return ascii_classes_[ch];
+  }
+  return FoldedClass(match_case_ ? ch : UpcaseOrdinal(ch));
+}
+
+uint32_t PatternSet::FoldedClass(wchar_t unit) const {
+  if (static_cast<uint32_t>(unit) < 0x80) {
+    return ascii_classes_[unit];
+  }
+  auto it = std::lower_bound(wide_classes_.begin(), wide_classes_.end(), unit, [](const std::pair<wchar_t, uint32_t>& entry, wchar_t value) { return entry.first < value; });
+  return it != wide_classes_.end() && it->first == unit ? it->second : 0;
+}
+
+bool PatternSet::Find(std::wstring_view text, PatternHit* hit) const {
+  if (empty()) {
+    return false;
+  }
+  bool found = false;
+  size_t best_start = 0;
+  uint32_t best_pattern = kNoPattern;
+  uint32_t state = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (found && i >= best_start + max_length_) {
+      break;
+    }
+    state = transitions_[state * class_count_ + ClassOf(text[i])];
+    uint32_t pattern = outputs_[state];
+    if (pattern == kNoPattern) {
+      continue;
+    }
+    size_t start = i + 1 - lengths_[pattern];
+    if (!found || start < best_start || (start == best_start && pattern < best_pattern)) {
+      found = true;
+      best_start = start;
+      best_pattern = pattern;
+    }
+  }
+  if (found && hit) {
+    hit->start = best_start;
+    hit->length = lengths_[best_pattern];
+    hit->pattern = best_pattern;
+  }
+  return found;
+}
+
+bool PatternSet::MatchWhole(std::wstring_view text, PatternHit* hit) const {
+  if (empty() || text.empty() || text.size() > max_length_) {
+    return false;
+  }
+  uint32_t state = 0;
+  for (wchar_t ch : text) {
+    state = transitions_[state * class_count_ + ClassOf(ch)];
+  }
+  uint32_t pattern = outputs_[state];
+  if (pattern == kNoPattern || lengths_[pattern] != text.size()) {
+    return false;
+  }
+  if (hit) {
+    hit->start = 0;
+    hit->length = text.size();
+    hit->pattern = pattern;
+  }
+  return true;
+}
+
+} // namespace regkit
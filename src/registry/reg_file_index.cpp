@@ -0,0 +1,404 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "registry/reg_file_index.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <system_error>
+#include <utility>
+
+#include "registry/mapped_file.h"
+#include "registry/reg_file_writer.h"
+
+namespace regkit {
+
+namespace {
+
+enum class SaveState : uint8_t {
+  kSkip,
+  kClean,
+  kMoved,
+  kDirty,
+  kNew,
+};
+
+bool IsNewline(const uint8_t* data, uint64_t offset, bool utf16) {
+  return utf16 ? data[offset] == '\n' && data[offset + 1] == 0 : data[offset] == '\n';
+}
+
+uint64_t HeaderEnd(const uint8_t* data, uint64_t begin, uint64_t end, bool utf16) {
+  uint64_t unit = utf16 ? 2 : 1;
+  for (uint64_t pos = begin; pos + unit <= end; pos += unit) {
+    if (IsNewline(data, pos, utf16)) {
+      return pos + unit;
+    }
+  }
+  return end;
+}
+
+} // namespace
+
+bool StampRegFile(const std::filesystem::path& path, RegFileStamp* stamp) {
+  if (!stamp) {
+    return false;
+  }
+  std::error_code ec;
+  uint64_t size = std::filesystem::file_size(path, ec);
+  if (ec) {
+    return false;
+  }
+  auto write_time = std::filesystem::last_write_time(path, ec);
+  if (ec) {
+    return false;
+  }
+  stamp->size = size;
+  stamp->write_time = static_cast<int64_t>(write_time.time_since_epoch().count());
+  return true;
+}
+
+struct RegFileIndex::SavePlan {
+  std::vector<SaveState> state;
+  std::unordered_map<uint32_t, std::wstring> paths;
+  std::unordered_set<uint32_t> emitted;
+  std::vector<uint32_t> appended;
+  std::vector<RegFileSection> written;
+};
+
+RegFileIndex::RegFileIndex(std::filesystem::path path, RegFileStamp stamp, std::vector<RegFileSection> sections) : path_(std::move(path)), stamp_(stamp), sections_(std::move(sections)) {
+  std::sort(sections_.begin(), sections_.end(), [](const RegFileSection& left, const RegFileSection& right) { return left.range.begin < right.range.begin; });
+  IndexByKey();
+}
+
+std::shared_ptr<const VirtualHive> RegFileIndex::Load(uint32_t key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (adopted_.count(key) != 0) {
+    return nullptr;
+  }
+  auto cached = cache_.find(key);
+  if (cached != cache_.end()) {
+    recent_.splice(recent_.begin(), recent_, cached->second.use);
+    return cached->second.values;
+  }
+  auto [begin, end] = FindSections(key);
+  if (begin == end) {
+    return nullptr;
+  }
+  auto values = std::make_shared<VirtualHive>();
+  if (!Decode(begin, end, values.get(), values->root())) {
+    return nullptr;
+  }
+  CachedKey entry;
+  for (auto it = begin; it != end; ++it) {
+    entry.bytes += sections_[*it].range.end - sections_[*it].range.begin;
+  }
+  while (!recent_.empty() && cached_bytes_ + entry.bytes > kCacheBytes) {
+    Evict(recent_.back());
+  }
+  entry.values = values;
+  entry.use = recent_.insert(recent_.begin(), key);
+  cached_bytes_ += entry.bytes;
+  cache_.emplace(key, std::move(entry));
+  return values;
+}
+
+bool RegFileIndex::Adopt(uint32_t key, VirtualHive* hive) {
+  if (!hive) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (adopted_.count(key) == 0) {
+    auto [begin, end] = FindSections(key);
+    if (begin != end && !Decode(begin, end, hive, key)) {
+      return false;
+    }
+    adopted_.insert(key);
+    if (cache_.find(key) != cache_.end()) {
+      Evict(key);
+    }
+  }
+  dirty_.insert(key);
+  return true;
+}
+
+void RegFileIndex::MarkMoved(uint32_t key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  moved_.insert(key);
+}
+
+bool RegFileIndex::Save(const std::filesystem::path& target, const std::vector<RegFileSaveRoot>& roots, std::wstring* error) {
+  if (roots.empty()) {
+    return false;
+  }
+  std::vector<std::unique_lock<std::mutex>> locks;
+  for (const auto& root : roots) {
+    if (!root.hive || !root.index || root.index->path_ != roots.front().index->path_) {
+      if (error) {
+        *error = L"Failed to write registry file.";
+      }
+      return false;
+    }
+    locks.emplace_back(root.index->mutex_);
+  }
+  for (const auto& root : roots) {
+    if (!root.index->Unchanged()) {
+      if (error) {
+        *error = L"The registry file changed on disk after it was opened. Reopen it before saving.";
+      }
+      return false;
+    }
+  }
+
+  const std::filesystem::path source_path = roots.front().index->path_;
+  MappedFile source;
+  if (!source.Open(source_path, error)) {
+    return false;
+  }
+  source.SetResidencyBudget(kCopyChunkBytes * 4);
+  const uint8_t* data = source.data();
+  uint64_t size = source.size();
+  bool utf16 = size >= 2 && data[0] == 0xFF && data[1] == 0xFE;
+  uint64_t unit = utf16 ? 2 : 1;
+
+  std::error_code ec;
+  bool in_place = std::filesystem::equivalent(source_path, target, ec);
+  std::filesystem::path output = target;
+  if (in_place) {
+    output += L".tmp";
+  }
+  RegFileWriter writer;
+  if (!writer.OpenRaw(output, utf16, error)) {
+    return false;
+  }
+
+  std::vector<SavePlan> plans(roots.size());
+  for (size_t i = 0; i < roots.size(); ++i) {
+    roots[i].index->Plan(roots[i], &plans[i]);
+  }
+
+  bool line_start = true;
+  auto copy = [&](uint64_t begin, uint64_t end) {
+    if (end <= begin) {
+      return;
+    }
+    line_start = end - begin >= unit && IsNewline(data, end - unit, utf16);
+    while (begin < end) {
+      uint64_t count = std::min(end - begin, kCopyChunkBytes);
+      source.Touch(begin, count);
+      writer.WriteRaw(data + begin, static_cast<size_t>(count));
+      begin += count;
+    }
+  };
+  auto generate = [&](const VirtualHive& hive, uint32_t key, const std::wstring& path) {
+    if (!line_start) {
+      writer.NewLine();
+    }
+    writer.BeginSection(path);
+    for (uint32_t i = 0; i < hive.ValueCount(key); ++i) {
+      VirtualHiveValue value = hive.Value(key, i);
+      writer.WriteValue(value.name, value.type, value.data, value.size);
+    }
+    writer.NewLine();
+    line_start = true;
+  };
+
+  std::vector<size_t> next(roots.size(), 0);
+  uint64_t cursor = 0;
+  for (;;) {
+    size_t pick = roots.size();
+    for (size_t i = 0; i < roots.size(); ++i) {
+      const auto& sections = roots[i].index->sections_;
+      if (next[i] < sections.size() && (pick == roots.size() || sections[next[i]].range.begin < roots[pick].index->sections_[next[pick]].range.begin)) {
+        pick = i;
+      }
+    }
+    if (pick == roots.size()) {
+      break;
+    }
+    const RegFileSection& section = roots[pick].index->sections_[next[pick]++];
+    SavePlan& plan = plans[pick];
+    if (section.range.begin < cursor || section.range.end > size) {
+      continue;
+    }
+    copy(cursor, section.range.begin);
+    cursor = section.range.end;
+    SaveState state = section.key < plan.state.size() ? plan.state[section.key] : SaveState::kSkip;
+    if (state == SaveState::kSkip || (state == SaveState::kDirty && !plan.emitted.insert(section.key).second)) {
+      continue;
+    }
+    uint64_t begin = writer.Tell();
+    if (state == SaveState::kClean) {
+      copy(section.range.begin, section.range.end);
+    } else if (state == SaveState::kMoved) {
+      if (!line_start) {
+        writer.NewLine();
+      }
+      writer.BeginSection(plan.paths[section.key]);
+      line_start = true;
+      copy(HeaderEnd(data, section.range.begin, section.range.end, utf16), section.range.end);
+    } else {
+      generate(*roots[pick].hive, section.key, plan.paths[section.key]);
+    }
+    plan.written.push_back({section.key, {begin, writer.Tell()}});
+  }
+  copy(cursor, size);
+  for (size_t i = 0; i < roots.size(); ++i) {
+    for (uint32_t key : plans[i].appended) {
+      uint64_t begin = writer.Tell();
+      generate(*roots[i].hive, key, plans[i].paths[key]);
+      plans[i].written.push_back({key, {begin, writer.Tell()}});
+    }
+  }
+  source.Close();
+  if (!writer.Close(error)) {
+    std::filesystem::remove(output, ec);
+    return false;
+  }
+  if (!in_place) {
+    return true;
+  }
+
+  for (const auto& root : roots) {
+    root.index->reader_.Close();
+    root.index->reader_open_ = false;
+  }
+  std::filesystem::rename(output, target, ec);
+  if (ec) {
+    std::filesystem::remove(output, ec);
+    if (error) {
+      *error = L"Failed to replace registry file.";
+    }
+    return false;
+  }
+  RegFileStamp stamp;
+  bool stamped = StampRegFile(target, &stamp);
+  for (size_t i = 0; i < roots.size(); ++i) {
+    RegFileIndex* index = roots[i].index;
+    index->stamp_ = stamp;
+    index->stale_ = !stamped;
+    index->adopted_.insert(plans[i].appended.begin(), plans[i].appended.end());
+    index->dirty_.clear();
+    index->moved_.clear();
+    index->sections_ = std::move(plans[i].written);
+    index->IndexByKey();
+  }
+  return true;
+}
+
+void RegFileIndex::IndexByKey() {
+  by_key_.resize(sections_.size());
+  std::iota(by_key_.begin(), by_key_.end(), 0u);
+  std::stable_sort(by_key_.begin(), by_key_.end(), [&](uint32_t left, uint32_t right) { return sections_[left].key < sections_[right].key; });
+}
+
+std::pair<const uint32_t*, const uint32_t*> RegFileIndex::FindSections(uint32_t key) const {
+  const uint32_t* first = by_key_.data();
+  const uint32_t* last = first + by_key_.size();
+  const uint32_t* lower = std::partition_point(first, last, [&](uint32_t index) { return sections_[index].key < key; });
+  const uint32_t* upper = std::partition_point(lower, last, [&](uint32_t index) { return sections_[index].key == key; });
+  return {lower, upper};
+}
+
+bool RegFileIndex::Unchanged() {
+  RegFileStamp current;
+  if (!stale_ && (!StampRegFile(path_, &current) || current != stamp_)) {
+    stale_ = true;
+    reader_.Close();
+    reader_open_ = false;
+  }
+  return !stale_;
+}
+
+bool RegFileIndex::Decode(const uint32_t* begin, const uint32_t* end, VirtualHive* hive, uint32_t key) {
+  if (!Unchanged()) {
+    return false;
+  }
+  if (!reader_open_) {
+    if (!reader_.Open(path_, nullptr)) {
+      return false;
+    }
+    reader_open_ = true;
+  }
+  RegFileToken token;
+  std::wstring name;
+  std::wstring scratch;
+  std::vector<uint8_t> data;
+  for (auto it = begin; it != end; ++it) {
+    if (!reader_.Seek(sections_[*it].range)) {
+      return false;
+    }
+    while (reader_.Next(&token)) {
+      uint32_t type = 0;
+      if (token.kind != RegFileTokenKind::kValue || !UnescapeRegFileString(token.name, &name) || !ParseRegFileValueData(token.data, &type, &data, &scratch)) {
+        continue;
+      }
+      hive->SetValue(key, name, type, data.data(), data.size());
+    }
+  }
+  return true;
+}
+
+void RegFileIndex::Evict(uint32_t key) {
+  auto it = cache_.find(key);
+  cached_bytes_ -= it->second.bytes;
+  recent_.erase(it->second.use);
+  cache_.erase(it);
+}
+
+void RegFileIndex::Plan(const RegFileSaveRoot& root, SavePlan* plan) const {
+  const VirtualHive& hive = *root.hive;
+  std::vector<bool> has_sections(hive.KeyCount(), false);
+  for (const auto& section : sections_) {
+    if (section.key < has_sections.size()) {
+      has_sections[section.key] = true;
+    }
+  }
+  plan->state.assign(hive.KeyCount(), SaveState::kSkip);
+  std::wstring path = root.name;
+  std::function<void(uint32_t, bool)> visit;
+  visit = [&](uint32_t key, bool moved) {
+    moved = moved || moved_.count(key) != 0;
+    SaveState state = SaveState::kClean;
+    if (!has_sections[key]) {
+      bool empty_leaf = key != hive.root() && hive.SubkeyCount(key) == 0;
+      state = hive.ValueCount(key) > 0 || empty_leaf ? SaveState::kNew : SaveState::kSkip;
+    } else if (dirty_.count(key) != 0) {
+      state = SaveState::kDirty;
+    } else if (moved) {
+      state = SaveState::kMoved;
+    }
+    plan->state[key] = state;
+    if (state == SaveState::kMoved || state == SaveState::kDirty || state == SaveState::kNew) {
+      plan->paths.emplace(key, path);
+    }
+    if (state == SaveState::kNew) {
+      plan->appended.push_back(key);
+    }
+    for (uint32_t i = 0; i < hive.SubkeyCount(key); ++i) {
+      uint32_t child = hive.Subkey(key, i);
+      size_t length = path.size();
+      path.push_back(L'\\');
+      path.append(hive.KeyName(child));
+      visit(child, moved);
+      path.resize(length);
+    }
+  };
+  visit(hive.root(), false);
+}
+
+} // namespace regkit
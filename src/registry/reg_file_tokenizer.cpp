@@ -0,0 +1,648 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "registry/reg_file_tokenizer.h"
+
+#include <cstring>
+
+#include "registry/hex_bytes.h"
+
+namespace regkit {
+
+namespace {
+
+constexpr uint32_t kRegSz = 1;
+constexpr uint32_t kRegBinary = 3;
+constexpr uint32_t kRegDword = 4;
+constexpr uint32_t kRegLink = 6;
+constexpr uint32_t kRegQword = 11;
+constexpr uint64_t kReaderResidentBytes = 4 * RegFileReader::kChunkBytes;
+
+bool IsBlank(wchar_t ch) {
+  return ch == L' ' || ch == L'\t';
+}
+
+std::wstring_view TrimBlank(std::wstring_view text) {
+  size_t start = 0;
+  while (start < text.size() && IsBlank(text[start])) {
+    ++start;
+  }
+  size_t end = text.size();
+  while (end > start && IsBlank(text[end - 1])) {
+    --end;
+  }
+  return text.substr(start, end - start);
+}
+
+int HexDigit(wchar_t ch) {
+  if (ch >= L'0' && ch <= L'9') {
+    return ch - L'0';
+  }
+  if (ch >= L'a' && ch <= L'f') {
+    return 10 + (ch - L'a');
+  }
+  if (ch >= L'A' && ch <= L'F') {
+    return 10 + (ch - L'A');
+  }
+  return -1;
+}
+
+uint32_t ParseHexNumber(std::wstring_view text) {
+  text = TrimBlank(text);
+  if (text.size() >= 2 && text[0] == L'0' && (text[1] == L'x' || text[1] == L'X')) {
+    text.remove_prefix(2);
+  }
+  uint64_t value = 0;
+  for (wchar_t ch : text) {
+    int digit = HexDigit(ch);
+    if (digit < 0) {
+      break;
+    }
+    value = (value << 4) | static_cast<uint64_t>(digit);
+    if (value > 0xFFFFFFFFull) {
+      return 0xFFFFFFFFu;
+    }
+  }
+  return static_cast<uint32_t>(value);
+}
+
+bool StartsWithInsensitive(std::wstring_view text, std::wstring_view prefix) {
+  if (text.size() < prefix.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < prefix.size(); ++i) {
+    wchar_t ch = text[i];
+    if (ch >= L'A' && ch <= L'Z') {
+      ch = static_cast<wchar_t>(ch - L'A' + L'a');
+    }
+    if (ch != prefix[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FindClosingQuote(std::wstring_view text, size_t* close) {
+  for (size_t i = 1; i < text.size(); ++i) {
+    if (text[i] == L'\\') {
+      ++i;
+      continue;
+    }
+    if (text[i] == L'"') {
+      *close = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t ContinuationLength(std::wstring_view text, size_t backslash) {
+  size_t i = backslash + 1;
+  while (i < text.size() && IsBlank(text[i])) {
+    ++i;
+  }
+  if (i < text.size() && text[i] == L'\r') {
+    ++i;
+  }
+  if (i < text.size() && text[i] == L'\n') {
+    return i + 1 - backslash;
+  }
+  return 0;
+}
+
+uint16_t ReadUnit(const uint8_t* data, uint64_t offset, bool utf16) {
+  return utf16 ? static_cast<uint16_t>(data[offset] | (data[offset + 1] << 8)) : data[offset];
+}
+
+uint64_t FindUnit(const uint8_t* data, uint64_t pos, uint64_t end, bool utf16, uint8_t ch) {
+  uint64_t parity = pos & 1;
+  while (pos < end) {
+    const void* found = memchr(data + pos, ch, static_cast<size_t>(end - pos));
+    if (!found) {
+      return end;
+    }
+    uint64_t at = static_cast<uint64_t>(static_cast<const uint8_t*>(found) - data);
+    if (!utf16 || ((at & 1) == parity && at + 1 < end && data[at + 1] == 0)) {
+      return at;
+    }
+    pos = at + 1;
+  }
+  return end;
+}
+
+uint64_t FindNewline(const uint8_t* data, uint64_t pos, uint64_t end, bool utf16) {
+  return FindUnit(data, pos, end, utf16, '\n');
+}
+
+bool EndsWithContinuation(const uint8_t* data, uint64_t floor, uint64_t newline, bool utf16) {
+  uint64_t unit = utf16 ? 2 : 1;
+  uint64_t last = newline;
+  if (last > floor && ReadUnit(data, last - unit, utf16) == L'\r') {
+    last -= unit;
+  }
+  while (last > floor && IsBlank(ReadUnit(data, last - unit, utf16))) {
+    last -= unit;
+  }
+  return last > floor && ReadUnit(data, last - unit, utf16) == L'\\';
+}
+
+uint64_t FindChunkEnd(const uint8_t* data, uint64_t begin, uint64_t end, bool utf16) {
+  uint64_t unit = utf16 ? 2 : 1;
+  uint64_t pos = begin + RegFileReader::kChunkBytes;
+  while (pos < end) {
+    uint64_t newline = FindNewline(data, pos, end, utf16);
+    if (newline >= end) {
+      return end;
+    }
+    pos = newline + unit;
+    if (!EndsWithContinuation(data, begin, newline, utf16)) {
+      return pos;
+    }
+  }
+  return end;
+}
+
+bool StartsSection(const uint8_t* data, uint64_t pos, uint64_t end, bool utf16) {
+  uint64_t unit = utf16 ? 2 : 1;
+  while (pos < end && IsBlank(ReadUnit(data, pos, utf16))) {
+    pos += unit;
+  }
+  return pos < end && ReadUnit(data, pos, utf16) == L'[';
+}
+
+uint64_t FindSectionStart(const uint8_t* data, uint64_t floor, uint64_t pos, uint64_t end, bool utf16) {
+  uint64_t unit = utf16 ? 2 : 1;
+  uint64_t search = pos;
+  while (search < end) {
+    uint64_t bracket = FindUnit(data, search, end, utf16, '[');
+    if (bracket >= end) {
+      return end;
+    }
+    search = bracket + unit;
+    uint64_t start = bracket;
+    while (start > pos && IsBlank(ReadUnit(data, start - unit, utf16))) {
+      start -= unit;
+    }
+    if (start <= pos) {
+      continue;
+    }
+    uint64_t newline = start - unit;
+    if (ReadUnit(data, newline, utf16) == L'\n' && !EndsWithContinuation(data, floor, newline, utf16)) {
+      return start;
+    }
+  }
+  return end;
+}
+
+void AppendCodePoint(uint32_t code_point, std::wstring* out) {
+  if (sizeof(wchar_t) == 2 && code_point >= 0x10000) {
+    code_point -= 0x10000;
+    out->push_back(static_cast<wchar_t>(0xD800 + (code_point >> 10)));
+    out->push_back(static_cast<wchar_t>(0xDC00 + (code_point & 0x3FF)));
+    return;
+  }
+  out->push_back(static_cast<wchar_t>(code_point));
+}
+
+void AppendUtf8(const uint8_t* data, size_t size, std::wstring* out) {
+  out->reserve(out->size() + size);
+  size_t i = 0;
+  while (i < size) {
+    uint8_t lead = data[i];
+    if (lead < 0x80) {
+      out->push_back(static_cast<wchar_t>(lead));
+      ++i;
+      continue;
+    }
+    size_t length = 0;
+    uint32_t code_point = 0;
+    uint32_t minimum = 0;
+    if ((lead & 0xE0) == 0xC0) {
+      length = 2;
+      code_point = lead & 0x1F;
+      minimum = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+      length = 3;
+      code_point = lead & 0x0F;
+      minimum = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+      length = 4;
+      code_point = lead & 0x07;
+      minimum = 0x10000;
+    }
+    bool valid = length != 0 && i + length <= size;
+    for (size_t k = 1; valid && k < length; ++k) {
+      uint8_t next = data[i + k];
+      valid = (next & 0xC0) == 0x80;
+      code_point = (code_point << 6) | (next & 0x3F);
+    }
+    if (!valid || code_point < minimum || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+      out->push_back(static_cast<wchar_t>(0xFFFD));
+      ++i;
+      continue;
+    }
+    AppendCodePoint(code_point, out);
+    i += length;
+  }
+}
+
+void AppendUtf16(const uint8_t* data, size_t size, std::wstring* out) {
+  size_t count = size / 2;
+  size_t base = out->size();
+  out->resize(base + count);
+  if (sizeof(wchar_t) == 2) {
+    memcpy(out->data() + base, data, count * 2);
+    return;
+  }
+  size_t length = base;
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t unit = ReadUnit(data, i * 2, true);
+    if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < count) {
+      uint32_t low = ReadUnit(data, (i + 1) * 2, true);
+      if (low >= 0xDC00 && low <= 0xDFFF) {
+        unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+        ++i;
+      }
+    }
+    (*out)[length++] = static_cast<wchar_t>(unit);
+  }
+  out->resize(length);
+}
+
+} // namespace
+
+std::wstring_view RegFileTokenizer::NextLine() {
+  size_t begin = position_;
+  size_t end = begin;
+  while (position_ < text_.size()) {
+    size_t line_start = position_;
+    size_t newline = text_.find(L'\n', line_start);
+    size_t line_end = newline == std::wstring_view::npos ? text_.size() : newline;
+    position_ = newline == std::wstring_view::npos ? text_.size() : newline + 1;
+    if (line_end > line_start && text_[line_end - 1] == L'\r') {
+      --line_end;
+    }
+    end = line_end;
+    size_t last = line_end;
+    while (last > line_start && IsBlank(text_[last - 1])) {
+      --last;
+    }
+    if (last == line_start || text_[last - 1] != L'\\') {
+      break;
+    }
+  }
+  return text_.substr(begin, end - begin);
+}
+
+bool RegFileTokenizer::Next(RegFileToken* token) {
+  if (!token) {
+    return false;
+  }
+  while (position_ < text_.size()) {
+    std::wstring_view line = TrimBlank(NextLine());
+    if (line.empty() || line.front() == L';') {
+      continue;
+    }
+    if (line.front() == L'[') {
+      if (line.size() < 2 || line.back() != L']') {
+        continue;
+      }
+      std::wstring_view key = TrimBlank(line.substr(1, line.size() - 2));
+      token->kind = RegFileTokenKind::kKey;
+      if (!key.empty() && key.front() == L'-') {
+        token->kind = RegFileTokenKind::kDeleteKey;
+        key = TrimBlank(key.substr(1));
+      }
+      token->key = key;
+      token->name = {};
+      token->data = {};
+      return true;
+    }
+
+    std::wstring_view name;
+    size_t rest = 0;
+    if (line.front() == L'@') {
+      rest = 1;
+    } else if (line.front() == L'"') {
+      size_t close = 0;
+      if (!FindClosingQuote(line, &close)) {
+        continue;
+      }
+      name = line.substr(1, close - 1);
+      rest = close + 1;
+    } else {
+      continue;
+    }
+    while (rest < line.size() && IsBlank(line[rest])) {
+      ++rest;
+    }
+    if (rest >= line.size() || line[rest] != L'=') {
+      continue;
+    }
+    std::wstring_view data = TrimBlank(line.substr(rest + 1));
+    if (data.empty()) {
+      continue;
+    }
+    token->kind = data == L"-" ? RegFileTokenKind::kDeleteValue : RegFileTokenKind::kValue;
+    token->key = {};
+    token->name = name;
+    token->data = data;
+    return true;
+  }
+  return false;
+}
+
+bool RegFileReader::Open(const std::filesystem::path& path, std::wstring* error) {
+  Close();
+  if (!file_.Open(path, error)) {
+    return false;
+  }
+  const uint8_t* data = file_.data();
+  uint64_t size = file_.size();
+  text_end_ = size;
+  if (size >= 2 && data[0] == 0xFF && data[1] == 0xFE) {
+    utf16_ = true;
+    text_begin_ = 2;
+    text_end_ = text_begin_ + ((size - text_begin_) & ~1ull);
+  } else if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+    text_begin_ = 3;
+  }
+  offset_ = text_begin_;
+  end_ = text_end_;
+  if (offset_ >= end_) {
+    Close();
+    if (error) {
+      *error = L"File is empty.";
+    }
+    return false;
+  }
+  file_.SetResidencyBudget(kReaderResidentBytes);
+  return true;
+}
+
+void RegFileReader::Close() {
+  file_.Close();
+  tokenizer_ = RegFileTokenizer(std::wstring_view());
+  chunk_.clear();
+  text_begin_ = 0;
+  text_end_ = 0;
+  offset_ = 0;
+  end_ = 0;
+  utf16_ = false;
+}
+
+bool RegFileReader::Next(RegFileToken* token) {
+  if (!token) {
+    return false;
+  }
+  while (!tokenizer_.Next(token)) {
+    if (!Fill()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<RegFileRange> RegFileReader::SplitSections(size_t count) const {
+  std::vector<RegFileRange> ranges;
+  if (!file_.is_open()) {
+    return ranges;
+  }
+  uint64_t unit = utf16_ ? 2 : 1;
+  uint64_t span = text_end_ - text_begin_;
+  uint64_t begin = text_begin_;
+  for (size_t i = 1; i < count; ++i) {
+    uint64_t target = text_begin_ + span / count * i;
+    target -= (target - text_begin_) % unit;
+    if (target <= begin) {
+      continue;
+    }
+    uint64_t split = FindSectionStart(file_.data(), text_begin_, target, text_end_, utf16_);
+    if (split >= text_end_) {
+      break;
+    }
+    ranges.push_back({begin, split});
+    begin = split;
+  }
+  ranges.push_back({begin, text_end_});
+  return ranges;
+}
+
+bool RegFileReader::NextSection(RegFileToken* token, RegFileRange* section) {
+  if (!token || !section || !file_.is_open()) {
+    return false;
+  }
+  const uint8_t* data = file_.data();
+  tokenizer_ = RegFileTokenizer(std::wstring_view());
+  while (offset_ < end_) {
+    uint64_t begin = offset_;
+    if (!StartsSection(data, begin, end_, utf16_)) {
+      begin = FindSectionStart(data, text_begin_, begin, end_, utf16_);
+      if (begin >= end_) {
+        offset_ = end_;
+        return false;
+      }
+    }
+    uint64_t next = FindSectionStart(data, text_begin_, begin, end_, utf16_);
+    uint64_t newline = FindNewline(data, begin, next, utf16_);
+    file_.Touch(begin, next - begin);
+    offset_ = next;
+    chunk_.clear();
+    if (utf16_) {
+      AppendUtf16(data + begin, static_cast<size_t>(newline - begin), &chunk_);
+    } else {
+      AppendUtf8(data + begin, static_cast<size_t>(newline - begin), &chunk_);
+    }
+    RegFileTokenizer header(chunk_);
+    if (header.Next(token) && (token->kind == RegFileTokenKind::kKey || token->kind == RegFileTokenKind::kDeleteKey)) {
+      *section = {begin, next};
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RegFileReader::Seek(const RegFileRange& range) {
+  if (!file_.is_open() || range.begin < text_begin_ || range.end > text_end_ || range.begin > range.end) {
+    return false;
+  }
+  if (utf16_ && ((range.begin - text_begin_) % 2 != 0 || (range.end - text_begin_) % 2 != 0)) {
+    return false;
+  }
+  tokenizer_ = RegFileTokenizer(std::wstring_view());
+  offset_ = range.begin;
+  end_ = range.end;
+  return true;
+}
+
+bool RegFileReader::Fill() {
+  if (!file_.is_open() || offset_ >= end_) {
+    return false;
+  }
+  const uint8_t* data = file_.data();
+  uint64_t begin = offset_;
+  uint64_t end = FindChunkEnd(data, begin, end_, utf16_);
+  file_.Touch(begin, end - begin);
+  offset_ = end;
+  size_t bytes = static_cast<size_t>(end - begin);
+  if (utf16_ && sizeof(wchar_t) == 2) {
+    tokenizer_ = RegFileTokenizer(std::wstring_view(reinterpret_cast<const wchar_t*>(data + begin), bytes / 2));
+    return true;
+  }
+  chunk_.clear();
+  if (utf16_) {
+    AppendUtf16(data + begin, bytes, &chunk_);
+  } else {
+    AppendUtf8(data + begin, bytes, &chunk_);
+  }
+  tokenizer_ = RegFileTokenizer(chunk_);
+  return true;
+}
+
+bool DecodeRegFileText(const uint8_t* data, size_t size, std::wstring* out, bool* utf16) {
+  if (!out) {
+    return false;
+  }
+  out->clear();
+  bool is_utf16 = size >= 2 && data[0] == 0xFF && data[1] == 0xFE;
+  if (is_utf16) {
+    AppendUtf16(data + 2, size - 2, out);
+  } else if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+    AppendUtf8(data + 3, size - 3, out);
+  } else if (size) {
+    AppendUtf8(data, size, out);
+  }
+  if (utf16) {
+    *utf16 = is_utf16;
+  }
+  return !out->empty();
+}
+
+bool UnescapeRegFileString(std::wstring_view text, std::wstring* out) {
+  if (!out) {
+    return false;
+  }
+  out->clear();
+  size_t start = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text[i] != L'\\') {
+      continue;
+    }
+    out->append(text.substr(start, i - start));
+    size_t skip = ContinuationLength(text, i);
+    if (skip) {
+      i += skip - 1;
+      start = i + 1;
+      continue;
+    }
+    if (i + 1 >= text.size()) {
+      start = text.size();
+      break;
+    }
+    wchar_t ch = text[++i];
+    switch (ch) {
+    case L'n':
+      out->push_back(L'\n');
+      break;
+    case L'r':
+      out->push_back(L'\r');
+      break;
+    case L't':
+      out->push_back(L'\t');
+      break;
+    case L'0':
+      out->push_back(L'\0');
+      break;
+    default:
+      out->push_back(ch);
+      break;
+    }
+    start = i + 1;
+  }
+  if (start < text.size()) {
+    out->append(text.substr(start));
+  }
+  return true;
+}
+
+bool ParseRegFileValueData(std::wstring_view data, uint32_t* type, std::vector<uint8_t>* out, std::wstring* scratch) {
+  if (!type || !out || data.empty()) {
+    return false;
+  }
+  out->clear();
+  if (data.front() == L'"') {
+    size_t close = 0;
+    if (!FindClosingQuote(data, &close)) {
+      return false;
+    }
+    std::wstring local;
+    std::wstring* text = scratch ? scratch : &local;
+    UnescapeRegFileString(data.substr(1, close - 1), text);
+    out->reserve((text->size() + 1) * 2);
+    auto put = [&](uint32_t unit) {
+      out->push_back(static_cast<uint8_t>(unit & 0xFF));
+      out->push_back(static_cast<uint8_t>(unit >> 8));
+    };
+    for (wchar_t ch : *text) {
+      uint32_t code = static_cast<uint32_t>(ch);
+      if (code > 0xFFFF) {
+        code -= 0x10000;
+        put(0xD800 + (code >> 10));
+        put(0xDC00 + (code & 0x3FF));
+      } else {
+        put(code);
+      }
+    }
+    put(0);
+    *type = kRegSz;
+    return true;
+  }
+  if (StartsWithInsensitive(data, L"dword:")) {
+    std::wstring_view hex = TrimBlank(data.substr(6));
+    if (hex.empty()) {
+      return false;
+    }
+    uint32_t number = ParseHexNumber(hex);
+    out->resize(sizeof(number));
+    for (size_t i = 0; i < sizeof(number); ++i) {
+      (*out)[i] = static_cast<uint8_t>(number >> (i * 8));
+    }
+    *type = kRegDword;
+    return true;
+  }
+  if (!StartsWithInsensitive(data, L"hex")) {
+    return false;
+  }
+  size_t colon = data.find(L':');
+  if (colon == std::wstring_view::npos) {
+    return false;
+  }
+  uint32_t parsed_type = kRegBinary;
+  std::wstring_view prefix = data.substr(0, colon);
+  size_t open = prefix.find(L'(');
+  size_t close = prefix.find(L')');
+  if (open != std::wstring_view::npos && close != std::wstring_view::npos && close > open) {
+    uint32_t code = ParseHexNumber(prefix.substr(open + 1, close - open - 1));
+    parsed_type = (code <= kRegQword && code != kRegLink) ? code : kRegBinary;
+  }
+  if (!ParseHexBytes(data.substr(colon + 1), out)) {
+    return false;
+  }
+  *type = parsed_type;
+  return true;
+}
+
+} // namespace regkit
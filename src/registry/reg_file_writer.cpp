@@ -0,0 +1,367 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "registry/reg_file_writer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace regkit {
+
+namespace {
+
+constexpr uint32_t kRegSz = 1;
+constexpr uint32_t kRegBinary = 3;
+constexpr uint32_t kRegDword = 4;
+constexpr size_t kHexWrapColumn = 77;
+constexpr size_t kHexIndent = 2;
+constexpr char16_t kHexDigits[] = u"0123456789abcdef";
+constexpr char16_t kHexBreak[] = u"\\\r\n  ";
+constexpr size_t kHexBreakUnits = 5;
+
+struct HexTriplets {
+  char16_t units[256][3];
+};
+
+constexpr HexTriplets MakeHexTriplets() {
+  HexTriplets table{};
+  for (size_t i = 0; i < 256; ++i) {
+    table.units[i][0] = kHexDigits[i >> 4];
+    table.units[i][1] = kHexDigits[i & 0xF];
+    table.units[i][2] = u',';
+  }
+  return table;
+}
+
+constexpr HexTriplets kHexTriplets = MakeHexTriplets();
+
+size_t HexLineBytes(size_t column) {
+  if (column >= kHexWrapColumn) {
+    return 1;
+  }
+  return (kHexWrapColumn - column + 2) / 3;
+}
+
+uint16_t ReadUnit(const uint8_t* data) {
+  return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+bool PlainStringUnits(const uint8_t* data, size_t size, size_t* units) {
+  if (size % 2 != 0) {
+    return false;
+  }
+  size_t count = size / 2;
+  while (count > 0 && ReadUnit(data + (count - 1) * 2) == 0) {
+    --count;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (ReadUnit(data + i * 2) == 0) {
+      return false;
+    }
+  }
+  *units = count;
+  return true;
+}
+
+void EncodeUtf8(const char16_t* units, size_t count, std::string* out) {
+  out->clear();
+  out->reserve(count * 3);
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t code = units[i];
+    if (code >= 0xD800 && code <= 0xDBFF && i + 1 < count && units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+      code = 0x10000 + ((code - 0xD800) << 10) + (units[++i] - 0xDC00);
+    } else if (code >= 0xD800 && code <= 0xDFFF) {
+      code = 0xFFFD;
+    }
+    if (code < 0x80) {
+      out->push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      out->push_back(static_cast<char>(0xC0 | (code >> 6)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+      out->push_back(static_cast<char>(0xE0 | (code >> 12)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+      out->push_back(static_cast<char>(0xF0 | (code >> 18)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+  }
+}
+
+char16_t EscapeCode(uint32_t ch) {
+  switch (ch) {
+  case u'\\':
+  case u'"':
+    return static_cast<char16_t>(ch);
+  case u'\n':
+    return u'n';
+  case u'\r':
+    return u'r';
+  case u'\t':
+    return u't';
+  case u'\0':
+    return u'0';
+  default:
+    return 0;
+  }
+}
+
+} // namespace
+
+bool RegFileWriter::Open(const std::filesystem::path& path, std::wstring* error) {
+  if (!OpenRaw(path, true, error)) {
+    return false;
+  }
+  framed_ = true;
+  Put(L'\xFEFF');
+  Append(L"Windows Registry Editor Version 5.00\r\n");
+  return true;
+}
+
+bool RegFileWriter::OpenRaw(const std::filesystem::path& path, bool utf16, std::wstring* error) {
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_) {
+    if (error) {
+      *error = L"Failed to create registry file.";
+    }
+    return false;
+  }
+  if (!buffer_) {
+    buffer_ = std::make_unique<char16_t[]>(kBufferUnits);
+  }
+  ok_ = true;
+  used_ = 0;
+  written_ = 0;
+  utf16_ = utf16;
+  framed_ = false;
+  return true;
+}
+
+bool RegFileWriter::Close(std::wstring* error) {
+  if (file_.is_open()) {
+    if (framed_) {
+      Append(L"\r\n");
+    }
+    Flush();
+    file_.close();
+    ok_ = ok_ && !file_.fail();
+  }
+  if (!ok_ && error) {
+    *error = L"Failed to write registry file.";
+  }
+  return ok_;
+}
+
+uint64_t RegFileWriter::Tell() {
+  Flush();
+  return written_;
+}
+
+void RegFileWriter::BeginKey(std::wstring_view path) {
+  NewLine();
+  BeginSection(path);
+}
+
+void RegFileWriter::BeginSection(std::wstring_view path) {
+  Put(L'[');
+  Append(path);
+  Append(L"]\r\n");
+}
+
+void RegFileWriter::NewLine() {
+  Append(L"\r\n");
+}
+
+void RegFileWriter::WriteValue(std::wstring_view name, uint32_t type, const uint8_t* data, size_t size) {
+  size_t column = 2;
+  if (name.empty()) {
+    Put(L'@');
+  } else {
+    Put(L'"');
+    column = AppendEscaped(name) + 3;
+    Put(L'"');
+  }
+  Put(L'=');
+
+  size_t units = 0;
+  if (type == kRegSz && (size == 0 || data) && PlainStringUnits(data, size, &units)) {
+    Put(L'"');
+    AppendEscapedUnits(data, units);
+    Append(L"\"\r\n");
+    return;
+  }
+  if (type == kRegDword && size == 4 && data) {
+    uint32_t value = static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) | (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    char16_t* out = Reserve(16);
+    memcpy(out, u"dword:", 6 * sizeof(char16_t));
+    for (size_t i = 0; i < 8; ++i) {
+      out[6 + i] = kHexDigits[(value >> (28 - i * 4)) & 0xF];
+    }
+    out[14] = u'\r';
+    out[15] = u'\n';
+    used_ += 16;
+    return;
+  }
+  if (type == kRegBinary) {
+    Append(L"hex:");
+    column += 4;
+  } else {
+    char16_t digits[8] = {};
+    size_t count = 0;
+    uint32_t code = type;
+    do {
+      digits[count++] = kHexDigits[code & 0xF];
+      code >>= 4;
+    } while (code);
+    Append(L"hex(");
+    char16_t* out = Reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = digits[count - 1 - i];
+    }
+    used_ += count;
+    Append(L"):");
+    column += 6 + count;
+  }
+  AppendHex(data, data ? size : 0, column);
+  Append(L"\r\n");
+}
+
+void RegFileWriter::WriteRaw(const uint8_t* data, size_t size) {
+  Flush();
+  if (ok_ && size > 0) {
+    file_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    ok_ = !file_.fail();
+    written_ += size;
+  }
+}
+
+char16_t* RegFileWriter::Reserve(size_t units) {
+  if (used_ + units > kBufferUnits) {
+    Flush();
+  }
+  return buffer_.get() + used_;
+}
+
+void RegFileWriter::Put(wchar_t ch) {
+  uint32_t code = static_cast<uint32_t>(ch);
+  char16_t* out = Reserve(2);
+  if (code > 0xFFFF) {
+    code -= 0x10000;
+    out[0] = static_cast<char16_t>(0xD800 + (code >> 10));
+    out[1] = static_cast<char16_t>(0xDC00 + (code & 0x3FF));
+    used_ += 2;
+  } else {
+    out[0] = static_cast<char16_t>(code);
+    used_ += 1;
+  }
+}
+
+void RegFileWriter::Append(std::wstring_view text) {
+  if constexpr (sizeof(wchar_t) == sizeof(char16_t)) {
+    while (!text.empty()) {
+      size_t count = std::min(text.size(), kBufferUnits);
+      memcpy(Reserve(count), text.data(), count * sizeof(char16_t));
+      used_ += count;
+      text.remove_prefix(count);
+    }
+  } else {
+    for (wchar_t ch : text) {
+      Put(ch);
+    }
+  }
+}
+
+size_t RegFileWriter::AppendEscaped(std::wstring_view text) {
+  size_t length = 0;
+  for (wchar_t ch : text) {
+    char16_t code = EscapeCode(static_cast<uint32_t>(ch));
+    if (code) {
+      char16_t* out = Reserve(2);
+      out[0] = u'\\';
+      out[1] = code;
+      used_ += 2;
+      length += 2;
+    } else {
+      Put(ch);
+      length += static_cast<uint32_t>(ch) > 0xFFFF ? 2 : 1;
+    }
+  }
+  return length;
+}
+
+void RegFileWriter::AppendEscapedUnits(const uint8_t* data, size_t units) {
+  for (size_t i = 0; i < units; ++i) {
+    char16_t unit = ReadUnit(data + i * 2);
+    char16_t code = EscapeCode(unit);
+    char16_t* out = Reserve(2);
+    char16_t next = i + 1 < units ? ReadUnit(data + (i + 1) * 2) : 0;
+    if (unit >= 0xD800 && unit <= 0xDBFF && next >= 0xDC00 && next <= 0xDFFF) {
+      out[0] = unit;
+      out[1] = next;
+      used_ += 2;
+      ++i;
+    } else if (code) {
+      out[0] = u'\\';
+      out[1] = code;
+      used_ += 2;
+    } else {
+      out[0] = unit;
+      used_ += 1;
+    }
+  }
+}
+
+void RegFileWriter::AppendHex(const uint8_t* data, size_t size, size_t column) {
+  size_t line_bytes = HexLineBytes(column);
+  while (size > 0) {
+    size_t count = std::min(size, line_bytes);
+    char16_t* out = Reserve(count * 3 + kHexBreakUnits);
+    for (size_t i = 0; i < count; ++i) {
+      memcpy(out + i * 3, kHexTriplets.units[data[i]], 3 * sizeof(char16_t));
+    }
+    data += count;
+    size -= count;
+    if (size == 0) {
+      used_ += count * 3 - 1;
+      break;
+    }
+    memcpy(out + count * 3, kHexBreak, kHexBreakUnits * sizeof(char16_t));
+    used_ += count * 3 + kHexBreakUnits;
+    line_bytes = HexLineBytes(kHexIndent);
+  }
+}
+
+void RegFileWriter::Flush() {
+  if (used_ == 0) {
+    return;
+  }
+  if (ok_ && utf16_) {
+    file_.write(reinterpret_cast<const char*>(buffer_.get()), static_cast<std::streamsize>(used_ * sizeof(char16_t)));
+    ok_ = !file_.fail();
+    written_ += used_ * sizeof(char16_t);
+  } else if (ok_) {
+    EncodeUtf8(buffer_.get(), used_, &encoded_);
+    file_.write(encoded_.data(), static_cast<std::streamsize>(encoded_.size()));
+    ok_ = !file_.fail();
+    written_ += encoded_.size();
+  }
+  used_ = 0;
+}
+
+} // namespace regkit
@@ -0,0 +1,526 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "registry/reg_snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+
+namespace regkit {
+
+namespace {
+
+constexpr uint8_t kMagic[8] = {'R', 'K', 'S', 'N', 'A', 'P', 0x1A, 0};
+constexpr size_t kHeaderSize = 96;
+constexpr size_t kKeyRecordSize = 32;
+constexpr size_t kLinkRecordSize = 4;
+constexpr size_t kValueRecordSize = 24;
+constexpr size_t kNameRecordSize = 8;
+constexpr size_t kInlineDataSize = 8;
+constexpr size_t kTableAlignment = 8;
+constexpr uint32_t kCompressedName = 0x80000000u;
+
+uint32_t Read32(const uint8_t* data) {
+  uint32_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint64_t Read64(const uint8_t* data) {
+  uint64_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void Put32(uint8_t* data, uint32_t value) {
+  memcpy(data, &value, sizeof(value));
+}
+
+void Put64(uint8_t* data, uint64_t value) {
+  memcpy(data, &value, sizeof(value));
+}
+
+uint16_t FoldUnit(uint16_t unit) {
+  if (unit < 0x80) {
+    return static_cast<uint16_t>((unit >= 'a' && unit <= 'z') ? unit - ('a' - 'A') : unit);
+  }
+  return static_cast<uint16_t>(towupper(static_cast<wint_t>(unit)));
+}
+
+void EncodeUnits(std::wstring_view text, std::u16string* out) {
+  out->clear();
+  out->reserve(text.size());
+  for (wchar_t ch : text) {
+    uint32_t code = static_cast<uint32_t>(ch);
+    if (code > 0xFFFF) {
+      code -= 0x10000;
+      out->push_back(static_cast<char16_t>(0xD800 + (code >> 10)));
+      out->push_back(static_cast<char16_t>(0xDC00 + (code & 0x3FF)));
+    } else {
+      out->push_back(static_cast<char16_t>(code));
+    }
+  }
+}
+
+template <typename Left, typename Right>
+int CompareFolded(const Left& left, const Right& right) {
+  size_t count = std::min<size_t>(left.length(), right.length());
+  for (size_t i = 0; i < count; ++i) {
+    uint16_t a = static_cast<uint16_t>(left.at(i));
+    uint16_t b = static_cast<uint16_t>(right.at(i));
+    if (a == b) {
+      continue;
+    }
+    a = FoldUnit(a);
+    b = FoldUnit(b);
+    if (a != b) {
+      return a < b ? -1 : 1;
+    }
+  }
+  if (left.length() == right.length()) {
+    return 0;
+  }
+  return left.length() < right.length() ? -1 : 1;
+}
+
+HiveName PoolName(const uint8_t* pool, uint64_t pool_size, uint32_t offset, uint32_t bytes) {
+  HiveName name;
+  bool compressed = (bytes & kCompressedName) != 0;
+  bytes &= ~kCompressedName;
+  if (offset > pool_size || bytes > pool_size - offset) {
+    return name;
+  }
+  name.data = pool + offset;
+  name.bytes = bytes;
+  name.compressed = compressed;
+  return name;
+}
+
+bool FitsTable(uint64_t offset, uint64_t count, uint64_t record_size, uint64_t file_size) {
+  return offset <= file_size && count <= (file_size - offset) / record_size;
+}
+
+} // namespace
+
+bool RegSnapshot::Open(const std::filesystem::path& path, std::wstring* error) {
+  Close();
+  if (!file_.Open(path, error)) {
+    return false;
+  }
+  const uint8_t* base = file_.data();
+  uint64_t size = file_.size();
+  auto fail = [&]() {
+    Close();
+    if (error) {
+      *error = L"The file is not a registry snapshot.";
+    }
+    return false;
+  };
+  if (size < kHeaderSize || memcmp(base, kMagic, sizeof(kMagic)) != 0) {
+    return fail();
+  }
+  if (Read32(base + 8) != kVersion) {
+    Close();
+    if (error) {
+      *error = L"Unsupported registry snapshot version.";
+    }
+    return false;
+  }
+  key_count_ = Read32(base + 12);
+  link_count_ = Read32(base + 16);
+  value_count_ = Read32(base + 20);
+  name_count_ = Read32(base + 24);
+  uint64_t keys = Read64(base + 32);
+  uint64_t links = Read64(base + 40);
+  uint64_t values = Read64(base + 48);
+  uint64_t names = Read64(base + 56);
+  uint64_t pool = Read64(base + 64);
+  pool_size_ = Read64(base + 72);
+  uint64_t blobs = Read64(base + 80);
+  blob_size_ = Read64(base + 88);
+  if (key_count_ == 0 || !FitsTable(keys, key_count_, kKeyRecordSize, size) || !FitsTable(links, link_count_, kLinkRecordSize, size) ||
+      !FitsTable(values, value_count_, kValueRecordSize, size) || !FitsTable(names, name_count_, kNameRecordSize, size) || !FitsTable(pool, pool_size_, 1, size) ||
+      !FitsTable(blobs, blob_size_, 1, size)) {
+    return fail();
+  }
+  if (Read32(base + keys + 4) != kNoKey) {
+    return fail();
+  }
+  keys_ = base + keys;
+  links_ = base + links;
+  values_ = base + values;
+  names_ = base + names;
+  pool_ = base + pool;
+  blobs_ = base + blobs;
+  return true;
+}
+
+void RegSnapshot::Close() {
+  file_.Close();
+  keys_ = nullptr;
+  links_ = nullptr;
+  values_ = nullptr;
+  names_ = nullptr;
+  pool_ = nullptr;
+  blobs_ = nullptr;
+  key_count_ = 0;
+  link_count_ = 0;
+  value_count_ = 0;
+  name_count_ = 0;
+  pool_size_ = 0;
+  blob_size_ = 0;
+}
+
+HiveName RegSnapshot::Name(uint32_t name) const {
+  if (name >= name_count_) {
+    return HiveName();
+  }
+  const uint8_t* record = names_ + static_cast<size_t>(name) * kNameRecordSize;
+  return PoolName(pool_, pool_size_, Read32(record), Read32(record + 4));
+}
+
+HiveName RegSnapshot::KeyName(uint32_t key) const {
+  const uint8_t* record = Key(key);
+  return record ? Name(Read32(record)) : HiveName();
+}
+
+uint64_t RegSnapshot::LastWrite(uint32_t key) const {
+  const uint8_t* record = Key(key);
+  return record ? Read64(record + 24) : 0;
+}
+
+uint32_t RegSnapshot::SubkeyCount(uint32_t key) const {
+  const uint8_t* record = Key(key);
+  if (!record) {
+    return 0;
+  }
+  uint32_t first = Read32(record + 8);
+  uint32_t count = Read32(record + 12);
+  return (first <= link_count_ && count <= link_count_ - first) ? count : 0;
+}
+
+uint32_t RegSnapshot::Subkey(uint32_t key, uint32_t index) const {
+  if (index >= SubkeyCount(key)) {
+    return kNoKey;
+  }
+  uint32_t first = Read32(Key(key) + 8);
+  uint32_t child = Read32(links_ + (static_cast<size_t>(first) + index) * kLinkRecordSize);
+  const uint8_t* record = Key(child);
+  if (!record || Read32(record + 4) != key) {
+    return kNoKey;
+  }
+  return child;
+}
+
+uint32_t RegSnapshot::FindSubkey(uint32_t key, std::wstring_view name) const {
+  std::u16string units;
+  EncodeUnits(name, &units);
+  std::u16string_view target(units);
+  uint32_t low = 0;
+  uint32_t high = SubkeyCount(key);
+  while (low < high) {
+    uint32_t middle = low + (high - low) / 2;
+    uint32_t child = Subkey(key, middle);
+    int order = CompareFolded(KeyName(child), target);
+    if (order == 0) {
+      return child;
+    }
+    if (order < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return kNoKey;
+}
+
+uint32_t RegSnapshot::FindKey(uint32_t key, std::wstring_view path) const {
+  uint32_t current = Key(key) ? key : kNoKey;
+  size_t start = 0;
+  while (start <= path.size() && current != kNoKey) {
+    size_t end = path.find_first_of(L"\\/", start);
+    if (end == std::wstring_view::npos) {
+      end = path.size();
+    }
+    if (end > start) {
+      current = FindSubkey(current, path.substr(start, end - start));
+    }
+    start = end + 1;
+  }
+  return current;
+}
+
+uint32_t RegSnapshot::ValueCount(uint32_t key) const {
+  const uint8_t* record = Key(key);
+  if (!record) {
+    return 0;
+  }
+  uint32_t first = Read32(record + 16);
+  uint32_t count = Read32(record + 20);
+  return (first <= value_count_ && count <= value_count_ - first) ? count : 0;
+}
+
+RegSnapshotValue RegSnapshot::Value(uint32_t key, uint32_t index) const {
+  RegSnapshotValue value;
+  if (index >= ValueCount(key)) {
+    return value;
+  }
+  uint32_t first = Read32(Key(key) + 16);
+  const uint8_t* record = values_ + (static_cast<size_t>(first) + index) * kValueRecordSize;
+  value.name = Name(Read32(record));
+  value.type = Read32(record + 4);
+  uint32_t size = Read32(record + 8);
+  if (size <= kInlineDataSize) {
+    value.data = record + 16;
+    value.size = size;
+    return value;
+  }
+  uint64_t offset = Read64(record + 16);
+  if (offset <= blob_size_ && size <= blob_size_ - offset) {
+    value.data = blobs_ + offset;
+    value.size = size;
+  }
+  return value;
+}
+
+bool RegSnapshot::FindValue(uint32_t key, std::wstring_view name, RegSnapshotValue* value) const {
+  uint32_t count = ValueCount(key);
+  for (uint32_t i = 0; i < count; ++i) {
+    RegSnapshotValue candidate = Value(key, i);
+    if (candidate.name.EqualsInsensitive(name)) {
+      if (value) {
+        *value = candidate;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RegSnapshotWriter::Open(const std::filesystem::path& path, std::wstring* error) {
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_) {
+    if (error) {
+      *error = L"Failed to create snapshot file.";
+    }
+    return false;
+  }
+  keys_ = VirtualHive();
+  current_ = keys_.root();
+  last_write_.assign(1, 0);
+  values_.clear();
+  name_ids_.clear();
+  names_.clear();
+  pool_.clear();
+  offset_ = 0;
+  blob_size_ = 0;
+  ok_ = true;
+  uint8_t header[kHeaderSize] = {};
+  Write(header, sizeof(header));
+  return ok_;
+}
+
+void RegSnapshotWriter::BeginKey(std::wstring_view path) {
+  current_ = keys_.CreateKey(path);
+  if (last_write_.size() < keys_.KeyCount()) {
+    last_write_.resize(keys_.KeyCount(), 0);
+  }
+}
+
+void RegSnapshotWriter::SetLastWrite(uint64_t time) {
+  last_write_[current_] = time;
+}
+
+void RegSnapshotWriter::WriteValue(std::wstring_view name, uint32_t type, const uint8_t* data, size_t size) {
+  if (!ok_) {
+    return;
+  }
+  if (size > 0xFFFFFFFFu) {
+    ok_ = false;
+    return;
+  }
+  PendingValue value;
+  value.key = current_;
+  value.name = Intern(name);
+  value.type = type;
+  value.size = static_cast<uint32_t>(size);
+  if (size <= kInlineDataSize) {
+    if (size > 0) {
+      memcpy(&value.data, data, size);
+    }
+  } else {
+    value.data = blob_size_;
+    Write(data, size);
+    blob_size_ += size;
+  }
+  values_.push_back(value);
+}
+
+bool RegSnapshotWriter::Close(std::wstring* error) {
+  if (file_.is_open()) {
+    uint32_t key_count = keys_.KeyCount();
+    last_write_.resize(key_count, 0);
+    std::vector<uint32_t> key_names(key_count);
+    for (uint32_t key = 0; key < key_count; ++key) {
+      key_names[key] = Intern(keys_.KeyName(key));
+    }
+    auto by_key = [](const PendingValue& left, const PendingValue& right) { return left.key < right.key; };
+    if (!std::is_sorted(values_.begin(), values_.end(), by_key)) {
+      std::stable_sort(values_.begin(), values_.end(), by_key);
+    }
+
+    std::vector<uint32_t> parents(key_count, RegSnapshot::kNoKey);
+    std::vector<uint32_t> first_link(key_count, 0);
+    std::vector<uint32_t> links;
+    links.reserve(key_count);
+    auto by_name = [&](uint32_t left, uint32_t right) { return CompareNames(key_names[left], key_names[right]) < 0; };
+    for (uint32_t key = 0; key < key_count; ++key) {
+      first_link[key] = static_cast<uint32_t>(links.size());
+      for (uint32_t i = 0; i < keys_.SubkeyCount(key); ++i) {
+        uint32_t child = keys_.Subkey(key, i);
+        parents[child] = key;
+        links.push_back(child);
+      }
+      auto begin = links.begin() + first_link[key];
+      if (!std::is_sorted(begin, links.end(), by_name)) {
+        std::sort(begin, links.end(), by_name);
+      }
+    }
+
+    std::vector<uint8_t> table;
+    auto write_table = [&]() -> uint64_t {
+      static constexpr uint8_t kPadding[kTableAlignment] = {};
+      Write(kPadding, static_cast<size_t>((kTableAlignment - offset_ % kTableAlignment) % kTableAlignment));
+      uint64_t offset = offset_;
+      Write(table.data(), table.size());
+      return offset;
+    };
+
+    uint8_t header[kHeaderSize] = {};
+    memcpy(header, kMagic, sizeof(kMagic));
+    Put32(header + 8, RegSnapshot::kVersion);
+    Put32(header + 12, key_count);
+    Put32(header + 16, static_cast<uint32_t>(links.size()));
+    Put32(header + 20, static_cast<uint32_t>(values_.size()));
+    Put64(header + 80, kHeaderSize);
+    Put64(header + 88, blob_size_);
+
+    table.assign(static_cast<size_t>(key_count) * kKeyRecordSize, 0);
+    size_t next_value = 0;
+    for (uint32_t key = 0; key < key_count; ++key) {
+      size_t first_value = next_value;
+      while (next_value < values_.size() && values_[next_value].key == key) {
+        ++next_value;
+      }
+      uint8_t* record = table.data() + static_cast<size_t>(key) * kKeyRecordSize;
+      Put32(record, key_names[key]);
+      Put32(record + 4, parents[key]);
+      Put32(record + 8, first_link[key]);
+      Put32(record + 12, keys_.SubkeyCount(key));
+      Put32(record + 16, static_cast<uint32_t>(first_value));
+      Put32(record + 20, static_cast<uint32_t>(next_value - first_value));
+      Put64(record + 24, last_write_[key]);
+    }
+    Put64(header + 32, write_table());
+
+    table.assign(links.size() * kLinkRecordSize, 0);
+    for (size_t i = 0; i < links.size(); ++i) {
+      Put32(table.data() + i * kLinkRecordSize, links[i]);
+    }
+    Put64(header + 40, write_table());
+
+    table.assign(values_.size() * kValueRecordSize, 0);
+    for (size_t i = 0; i < values_.size(); ++i) {
+      uint8_t* record = table.data() + i * kValueRecordSize;
+      Put32(record, values_[i].name);
+      Put32(record + 4, values_[i].type);
+      Put32(record + 8, values_[i].size);
+      Put64(record + 16, values_[i].data);
+    }
+    Put64(header + 48, write_table());
+
+    Put32(header + 24, static_cast<uint32_t>(names_.size()));
+    table.assign(names_.size() * kNameRecordSize, 0);
+    for (size_t i = 0; i < names_.size(); ++i) {
+      Put64(table.data() + i * kNameRecordSize, names_[i]);
+    }
+    Put64(header + 56, write_table());
+
+    table = std::move(pool_);
+    Put64(header + 64, write_table());
+    Put64(header + 72, table.size());
+
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file_.close();
+    ok_ = ok_ && !file_.fail();
+    keys_ = VirtualHive();
+    values_ = {};
+    name_ids_ = {};
+    names_ = {};
+    pool_ = {};
+  }
+  if (!ok_ && error) {
+    *error = L"Failed to write snapshot file.";
+  }
+  return ok_;
+}
+
+uint32_t RegSnapshotWriter::Intern(std::wstring_view name) {
+  auto it = name_ids_.find(name);
+  if (it != name_ids_.end()) {
+    return it->second;
+  }
+  std::u16string units;
+  EncodeUnits(name, &units);
+  bool compressed = std::all_of(units.begin(), units.end(), [](char16_t unit) { return unit < 0x100; });
+  uint64_t offset = pool_.size();
+  uint64_t bytes = compressed ? units.size() : units.size() * 2;
+  if (offset + bytes >= kCompressedName) {
+    ok_ = false;
+    return 0;
+  }
+  for (char16_t unit : units) {
+    pool_.push_back(static_cast<uint8_t>(unit));
+    if (!compressed) {
+      pool_.push_back(static_cast<uint8_t>(unit >> 8));
+    }
+  }
+  uint32_t id = static_cast<uint32_t>(names_.size());
+  names_.push_back(offset | (static_cast<uint64_t>(bytes | (compressed ? kCompressedName : 0)) << 32));
+  name_ids_.emplace(std::wstring(name), id);
+  return id;
+}
+
+int RegSnapshotWriter::CompareNames(uint32_t left, uint32_t right) const {
+  auto name = [&](uint32_t id) { return PoolName(pool_.data(), pool_.size(), static_cast<uint32_t>(names_[id]), static_cast<uint32_t>(names_[id] >> 32)); };
+  return CompareFolded(name(left), name(right));
+}
+
+void RegSnapshotWriter::Write(const void* data, size_t size) {
+  if (!ok_ || size == 0) {
+    return;
+  }
+  file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+  offset_ += size;
+  if (!file_) {
+    ok_ = false;
+  }
+}
+
+} // namespace regkit
@@ -17,15 +17,24 @@
 #include "registry/registry_provider.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cwctype>
+#include <filesystem>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include <shlwapi.h>
 #include <unordered_map>
 #include <vector>
 
 #include <winternl.h>
 
+#include "registry/hive_check.h"
+#include "registry/hive_reader.h"
+#include "registry/hive_scan.h"
+#include "registry/hive_writer.h"
+#include "registry/virtual_hive.h"
 #include "win32/win32_helpers.h"
 
 namespace regkit {
@@ -113,6 +122,7 @@ OffregApi* GetOffreg() {
   return api.EnsureLoaded() ? &api : nullptr;
 }
 
+std::shared_mutex g_offline_roots_mutex;
 std::vector<HKEY> g_offline_roots;
 
 struct VirtualRootEntry {
@@ -138,27 +148,190 @@ NtOpenKeyFn GetNtOpenKey() {
 }
 
 bool IsOfflineNode(const RegistryNode& node) {
-  if (!node.root || g_offline_roots.empty()) {
+  if (!node.root) {
     return false;
   }
+  std::shared_lock<std::shared_mutex> lock(g_offline_roots_mutex);
   return std::find(g_offline_roots.begin(), g_offline_roots.end(), node.root) != g_offline_roots.end();
 }
 
+struct OfflineHive {
+  ~OfflineHive() {
+    if (offreg) {
+      if (OffregApi* api = GetOffreg()) {
+        api->close_hive(offreg);
+      }
+    }
+    reader.Close();
+    if (!offreg_path.empty()) {
+      DeleteFileW(offreg_path.c_str());
+    }
+    if (!discard_path.empty()) {
+      DeleteFileW(discard_path.c_str());
+    }
+  }
+
+  std::wstring path;
+  HiveReader reader;
+  std::mutex index_mutex;
+  std::shared_ptr<const HiveScanner> index;
+  std::mutex offreg_mutex;
+  ORHKEY offreg = nullptr;
+  std::wstring offreg_path;
+  std::atomic_bool modified{false};
+  std::unique_ptr<int> handle_tag;
+  std::wstring discard_path;
+};
+
+std::mutex g_offline_mutex;
+std::unordered_map<HKEY, std::shared_ptr<OfflineHive>> g_offline_hives;
+// Applied to each offline hive's mapping on its own, not shared across open hives.
+std::atomic<uint64_t> g_offline_memory_budget{256ull * 1024 * 1024};
+std::atomic_bool g_offline_hive_index{true};
+
+std::shared_ptr<OfflineHive> FindOfflineHive(HKEY root) {
+  std::lock_guard<std::mutex> lock(g_offline_mutex);
+  auto it = g_offline_hives.find(root);
+  if (it == g_offline_hives.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+bool HiveIndexPath(const OfflineHive& hive, std::wstring* index_path) {
+  if (!g_offline_hive_index.load() || !hive.reader.is_open() || hive.modified.load()) {
+    return false;
+  }
+  std::wstring folder = util::GetAppDataFolder();
+  if (folder.empty()) {
+    return false;
+  }
+  folder = util::JoinPath(folder, L"cache\\hive_index");
+  std::error_code ec;
+  std::filesystem::create_directories(folder, ec);
+  uint64_t hash = 14695981039346656037ull;
+  for (wchar_t ch : hive.path) {
+    hash ^= static_cast<uint64_t>(std::towlower(ch));
+    hash *= 1099511628211ull;
+  }
+  wchar_t name[32] = {};
+  swprintf_s(name, L"%016llx.rkidx", static_cast<unsigned long long>(hash));
+  *index_path = util::JoinPath(folder, name);
+  return true;
+}
+
+DWORD StageReplayedHive(const HiveReader& reader, std::wstring* path) {
+  wchar_t folder[MAX_PATH] = {};
+  wchar_t name[MAX_PATH] = {};
+  if (GetTempPathW(MAX_PATH, folder) == 0 || GetTempFileNameW(folder, L"rgk", 0, name) == 0) {
+    return GetLastError();
+  }
+  const uint8_t* base = reader.base_block();
+  std::vector<uint8_t> image(base, base + 4096 + static_cast<size_t>(reader.bins_size()));
+  if (!WriteHiveImage(name, image, nullptr)) {
+    DeleteFileW(name);
+    return ERROR_WRITE_FAULT;
+  }
+  *path = name;
+  return ERROR_SUCCESS;
+}
+
+ORHKEY OffregHive(OfflineHive* hive, DWORD* error) {
+  if (error) {
+    *error = ERROR_SUCCESS;
+  }
+  if (!hive) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(hive->offreg_mutex);
+  if (hive->offreg) {
+    return hive->offreg;
+  }
+  OffregApi* api = GetOffreg();
+  if (!api) {
+    if (error) {
+      *error = ERROR_MOD_NOT_FOUND;
+    }
+    return nullptr;
+  }
+  if (hive->reader.replayed_logs() && hive->offreg_path.empty()) {
+    DWORD staged = StageReplayedHive(hive->reader, &hive->offreg_path);
+    if (staged != ERROR_SUCCESS) {
+      if (error) {
+        *error = staged;
+      }
+      return nullptr;
+    }
+  }
+  ORHKEY handle = nullptr;
+  DWORD result = api->open_hive(hive->offreg_path.empty() ? hive->path.c_str() : hive->offreg_path.c_str(), &handle);
+  if (result != ERROR_SUCCESS || !handle) {
+    if (error) {
+      *error = result == ERROR_SUCCESS ? ERROR_INVALID_HANDLE : result;
+    }
+    return nullptr;
+  }
+  hive->offreg = handle;
+  return handle;
+}
+
+enum class NativeLookup {
+  kUnavailable,
+  kMissing,
+  kFound,
+};
+
+struct NativeKey {
+  std::shared_ptr<OfflineHive> hive;
+  uint32_t cell = HiveReader::kNoCell;
+};
+
+std::shared_ptr<const HiveScanner> LoadedIndex(OfflineHive* hive) {
+  std::lock_guard<std::mutex> lock(hive->index_mutex);
+  return hive->index;
+}
+
+NativeLookup LookupNativeKey(const RegistryNode& node, NativeKey* out) {
+  std::shared_ptr<OfflineHive> hive = FindOfflineHive(node.root);
+  if (!hive || !hive->reader.is_open() || hive->modified.load()) {
+    return NativeLookup::kUnavailable;
+  }
+  uint32_t cell = HiveReader::kNoCell;
+  std::shared_ptr<const HiveScanner> index = LoadedIndex(hive.get());
+  if (index ? !index->FindKey(node.subkey, &cell) : !hive->reader.FindKey(node.subkey, &cell)) {
+    return NativeLookup::kMissing;
+  }
+  out->hive = std::move(hive);
+  out->cell = cell;
+  return NativeLookup::kFound;
+}
+
+FILETIME ToFileTime(uint64_t value) {
+  FILETIME ft = {};
+  ft.dwLowDateTime = static_cast<DWORD>(value & 0xFFFFFFFFu);
+  ft.dwHighDateTime = static_cast<DWORD>(value >> 32);
+  return ft;
+}
+
 struct OfflineKey {
   ORHKEY handle = nullptr;
   bool close = false;
 };
 
-OfflineKey OpenOfflineKey(const RegistryNode& node) {
+OfflineKey OpenOfflineKey(const RegistryNode& node, bool write = false) {
   OfflineKey result;
   OffregApi* api = GetOffreg();
   if (!api) {
     return result;
   }
-  ORHKEY root = reinterpret_cast<ORHKEY>(node.root);
+  std::shared_ptr<OfflineHive> hive = FindOfflineHive(node.root);
+  ORHKEY root = OffregHive(hive.get(), nullptr);
   if (!root) {
     return result;
   }
+  if (write) {
+    hive->modified.store(true);
+  }
   if (node.subkey.empty()) {
     result.handle = root;
     result.close = false;
@@ -254,6 +427,28 @@ std::wstring FormatWin32Error(DWORD code) {
   return buffer;
 }
 
+bool FlushFileToDisk(const std::wstring& path) {
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  bool ok = FlushFileBuffers(file) != FALSE;
+  CloseHandle(file);
+  return ok;
+}
+
+std::wstring DescribeHiveDamage(const std::wstring& path) {
+  HiveCheckReport report;
+  if (!CheckHiveFile(path, std::max(1u, std::thread::hardware_concurrency()), nullptr, &report, nullptr) || report.ok()) {
+    return L"";
+  }
+  const HiveIssue& first = report.issues.front();
+  std::string detail = first.detail;
+  wchar_t buffer[160] = {};
+  swprintf_s(buffer, L"Integrity check found %zu problem(s). First at offset 0x%llX: ", report.issues.size(), static_cast<unsigned long long>(first.offset));
+  return std::wstring(buffer) + std::wstring(detail.begin(), detail.end()) + L".";
+}
+
 bool SplitSubKey(const std::wstring& subkey, std::wstring* parent, std::wstring* name) {
   if (!parent || !name) {
     return false;
@@ -269,34 +464,6 @@ bool SplitSubKey(const std::wstring& subkey, std::wstring* parent, std::wstring*
   return !name->empty();
 }
 
-std::wstring ToLower(const std::wstring& text) {
-  std::wstring out;
-  out.reserve(text.size());
-  for (wchar_t ch : text) {
-    out.push_back(static_cast<wchar_t>(towlower(ch)));
-  }
-  return out;
-}
-
-std::vector<std::wstring> SplitPath(const std::wstring& path) {
-  std::vector<std::wstring> parts;
-  std::wstring current;
-  for (wchar_t ch : path) {
-    if (ch == L'\\' || ch == L'/') {
-      if (!current.empty()) {
-        parts.push_back(current);
-        current.clear();
-      }
-    } else {
-      current.push_back(ch);
-    }
-  }
-  if (!current.empty()) {
-    parts.push_back(current);
-  }
-  return parts;
-}
-
 bool GetVirtualRootData(HKEY root, std::shared_ptr<RegistryProvider::VirtualRegistryData>* data, std::wstring* root_name) {
   if (data) {
     data->reset();
@@ -321,44 +488,36 @@ bool GetVirtualRootData(HKEY root, std::shared_ptr<RegistryProvider::VirtualRegi
   return true;
 }
 
-RegistryProvider::VirtualRegistryKey* FindVirtualKey(RegistryProvider::VirtualRegistryKey* root, const std::wstring& subkey) {
-  if (!root) {
-    return nullptr;
-  }
-  if (subkey.empty()) {
-    return root;
-  }
-  auto parts = SplitPath(subkey);
-  RegistryProvider::VirtualRegistryKey* current = root;
-  for (const auto& part : parts) {
-    std::wstring lower = ToLower(part);
-    auto it = current->children.find(lower);
-    if (it == current->children.end()) {
-      return nullptr;
-    }
-    current = it->second.get();
-  }
-  return current;
+uint32_t FindVirtualKey(const VirtualHive& hive, const std::wstring& subkey) {
+  return hive.FindKey(subkey);
 }
 
-const RegistryProvider::VirtualRegistryKey* FindVirtualKey(const RegistryProvider::VirtualRegistryKey* root, const std::wstring& subkey) {
-  if (!root) {
-    return nullptr;
-  }
-  if (subkey.empty()) {
-    return root;
-  }
-  auto parts = SplitPath(subkey);
-  const RegistryProvider::VirtualRegistryKey* current = root;
-  for (const auto& part : parts) {
-    std::wstring lower = ToLower(part);
-    auto it = current->children.find(lower);
-    if (it == current->children.end()) {
-      return nullptr;
+uint32_t FindSnapshotKey(const RegistryProvider::VirtualRegistryData& data, const std::wstring& subkey) {
+  return data.snapshot->FindKey(data.snapshot_key, subkey);
+}
+
+struct VirtualValues {
+  std::shared_ptr<const VirtualHive> loaded;
+  const VirtualHive* hive = nullptr;
+  uint32_t key = VirtualHive::kNoKey;
+};
+
+VirtualValues ResolveVirtualValues(const RegistryProvider::VirtualRegistryData& data, uint32_t key) {
+  VirtualValues values;
+  values.hive = &data.hive;
+  values.key = key;
+  if (data.source) {
+    values.loaded = data.source->Load(key);
+    if (values.loaded) {
+      values.hive = values.loaded.get();
+      values.key = values.loaded->root();
     }
-    current = it->second.get();
   }
-  return current;
+  return values;
+}
+
+bool AdoptVirtualValues(RegistryProvider::VirtualRegistryData* data, uint32_t key) {
+  return !data->source || data->source->Adopt(key, &data->hive);
 }
 
 } // namespace
@@ -462,22 +621,34 @@ bool RegistryProvider::OpenOfflineHive(const std::wstring& path, HKEY* root, std
     return false;
   }
   *root = nullptr;
-  OffregApi* api = GetOffreg();
-  if (!api) {
-    if (error) {
-      *error = L"offreg.dll is not available.";
+  auto hive = std::make_shared<OfflineHive>();
+  hive->path = path;
+  hive->reader.set_mapping_budget(g_offline_memory_budget.load());
+  std::wstring native_error;
+  if (!hive->reader.Open(path, &native_error)) {
+    DWORD result = ERROR_SUCCESS;
+    if (!OffregHive(hive.get(), &result)) {
+      if (error) {
+        if (result == ERROR_MOD_NOT_FOUND) {
+          *error = native_error.empty() ? L"offreg.dll is not available." : native_error;
+        } else {
+          *error = FormatWin32Error(result);
+        }
+        std::wstring damage = DescribeHiveDamage(path);
+        if (!damage.empty()) {
+          *error += L"\n\n" + damage;
+        }
+      }
+      return false;
     }
-    return false;
   }
-  ORHKEY hive = nullptr;
-  DWORD result = api->open_hive(path.c_str(), &hive);
-  if (result != ERROR_SUCCESS || !hive) {
-    if (error) {
-      *error = FormatWin32Error(result);
-    }
-    return false;
+  hive->handle_tag = std::make_unique<int>(0);
+  HKEY handle = reinterpret_cast<HKEY>(hive->handle_tag.get());
+  {
+    std::lock_guard<std::mutex> lock(g_offline_mutex);
+    g_offline_hives.emplace(handle, std::move(hive));
   }
-  *root = reinterpret_cast<HKEY>(hive);
+  *root = handle;
   return true;
 }
 
@@ -485,29 +656,124 @@ bool RegistryProvider::SaveOfflineHive(HKEY root, const std::wstring& path, std:
   if (error) {
     error->clear();
   }
-  if (!root) {
+  if (!root || path.empty()) {
     return false;
   }
-  OffregApi* api = GetOffreg();
-  if (!api) {
+  std::shared_ptr<OfflineHive> hive = FindOfflineHive(root);
+  if (!hive) {
     if (error) {
-      *error = L"offreg.dll is not available.";
+      *error = L"The offline hive is not loaded.";
+    }
+    return false;
+  }
+
+  std::wstring staged = path + L".regkit-save";
+  DeleteFileW(staged.c_str());
+  std::vector<uint8_t> image;
+  std::wstring build_error;
+  if (hive->reader.is_open() && !hive->modified.load()) {
+    if (!BuildCompactHive(hive->reader, &image, &build_error)) {
+      if (error) {
+        *error = build_error.empty() ? L"Failed to rebuild the offline hive." : build_error;
+      }
+      return false;
+    }
+  } else {
+    OffregApi* api = GetOffreg();
+    if (!api) {
+      if (error) {
+        *error = L"offreg.dll is not available.";
+      }
+      return false;
+    }
+    DWORD result = ERROR_SUCCESS;
+    ORHKEY handle = OffregHive(hive.get(), &result);
+    if (!handle) {
+      if (error) {
+        *error = FormatWin32Error(result);
+      }
+      return false;
+    }
+    DWORD major = 0;
+    DWORD minor = 0;
+    if (!GetOsVersion(&major, &minor)) {
+      major = 10;
+      minor = 0;
+    }
+    result = api->save_hive(handle, staged.c_str(), major, minor);
+    if (result != ERROR_SUCCESS) {
+      if (error) {
+        *error = FormatWin32Error(result);
+      }
+      return false;
+    }
+    HiveReader saved;
+    if (saved.Open(staged, nullptr) && !BuildCompactHive(saved, &image, nullptr)) {
+      image.clear();
+    }
+    saved.Close();
+  }
+  if (!image.empty() && !WriteHiveImage(staged, image, &build_error)) {
+    DeleteFileW(staged.c_str());
+    if (error) {
+      *error = build_error;
     }
     return false;
   }
-  DWORD major = 0;
-  DWORD minor = 0;
-  if (!GetOsVersion(&major, &minor)) {
-    major = 10;
-    minor = 0;
+  if (image.empty() && !FlushFileToDisk(staged)) {
+    DWORD result = GetLastError();
+    DeleteFileW(staged.c_str());
+    if (error) {
+      *error = FormatWin32Error(result);
+    }
+    return false;
   }
-  DWORD result = api->save_hive(reinterpret_cast<ORHKEY>(root), path.c_str(), major, minor);
-  if (result != ERROR_SUCCESS) {
+
+  bool replaces_source = _wcsicmp(hive->path.c_str(), path.c_str()) == 0 && hive->reader.is_open();
+  std::wstring backup;
+  if (replaces_source) {
+    backup = path + L".regkit-old";
+    DeleteFileW(backup.c_str());
+    if (!MoveFileExW(path.c_str(), backup.c_str(), 0)) {
+      DWORD result = GetLastError();
+      DeleteFileW(staged.c_str());
+      if (error) {
+        *error = FormatWin32Error(result);
+      }
+      return false;
+    }
+  }
+  if (!MoveFileExW(staged.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+    DWORD result = GetLastError();
+    if (replaces_source) {
+      MoveFileExW(backup.c_str(), path.c_str(), 0);
+    }
+    DeleteFileW(staged.c_str());
     if (error) {
       *error = FormatWin32Error(result);
     }
     return false;
   }
+  if (!replaces_source) {
+    return true;
+  }
+
+  auto reopened = std::make_shared<OfflineHive>();
+  reopened->path = path;
+  reopened->reader.set_mapping_budget(g_offline_memory_budget.load());
+  if (!reopened->reader.Open(path, nullptr)) {
+    hive->discard_path = backup;
+    return true;
+  }
+  {
+    std::lock_guard<std::mutex> lock(g_offline_mutex);
+    auto it = g_offline_hives.find(root);
+    if (it != g_offline_hives.end() && it->second == hive) {
+      reopened->handle_tag = std::move(hive->handle_tag);
+      it->second = reopened;
+    }
+  }
+  hive->discard_path = backup;
   return true;
 }
 
@@ -518,6 +784,20 @@ bool RegistryProvider::CloseOfflineHive(HKEY root, std::wstring* error) {
   if (!root) {
     return true;
   }
+  std::shared_ptr<OfflineHive> hive;
+  {
+    std::lock_guard<std::mutex> lock(g_offline_mutex);
+    auto it = g_offline_hives.find(root);
+    if (it == g_offline_hives.end()) {
+      return true;
+    }
+    hive = std::move(it->second);
+    g_offline_hives.erase(it);
+  }
+  std::lock_guard<std::mutex> lock(hive->offreg_mutex);
+  if (!hive->offreg) {
+    return true;
+  }
   OffregApi* api = GetOffreg();
   if (!api) {
     if (error) {
@@ -525,7 +805,8 @@ bool RegistryProvider::CloseOfflineHive(HKEY root, std::wstring* error) {
     }
     return false;
   }
-  DWORD result = api->close_hive(reinterpret_cast<ORHKEY>(root));
+  DWORD result = api->close_hive(hive->offreg);
+  hive->offreg = nullptr;
   if (result != ERROR_SUCCESS) {
     if (error) {
       *error = FormatWin32Error(result);
@@ -535,7 +816,90 @@ bool RegistryProvider::CloseOfflineHive(HKEY root, std::wstring* error) {
   return true;
 }
 
+std::shared_ptr<const HiveReader> RegistryProvider::OfflineHiveReader(const RegistryNode& node, uint32_t* cell) {
+  if (!IsOfflineNode(node)) {
+    return nullptr;
+  }
+  NativeKey native;
+  if (LookupNativeKey(node, &native) != NativeLookup::kFound) {
+    return nullptr;
+  }
+  if (cell) {
+    *cell = native.cell;
+  }
+  return std::shared_ptr<const HiveReader>(native.hive, &native.hive->reader);
+}
+
+bool RegistryProvider::OfflineHiveMappingStats(HKEY root, MappedFileStats* stats) {
+  std::shared_ptr<OfflineHive> hive = FindOfflineHive(root);
+  if (!hive || !stats || !hive->reader.is_open()) {
+    return false;
+  }
+  *stats = hive->reader.mapping_stats();
+  return stats->window_size != 0;
+}
+
+HiveRecoveryState RegistryProvider::OfflineHiveRecovery(HKEY root) {
+  std::shared_ptr<OfflineHive> hive = FindOfflineHive(root);
+  if (!hive || !hive->reader.is_open()) {
+    return HiveRecoveryState::kClean;
+  }
+  return hive->reader.recovery_state();
+}
+
+void RegistryProvider::SetOfflineMemoryBudget(uint64_t bytes) {
+  g_offline_memory_budget.store(bytes);
+}
+
+bool RegistryProvider::OfflineHiveIndexPaths(const RegistryNode& node, std::wstring* hive_path, std::wstring* index_path) {
+  if (!hive_path || !index_path || !IsOfflineNode(node)) {
+    return false;
+  }
+  std::shared_ptr<OfflineHive> hive = FindOfflineHive(node.root);
+  if (!hive || !HiveIndexPath(*hive, index_path)) {
+    return false;
+  }
+  *hive_path = hive->path;
+  return true;
+}
+
+std::shared_ptr<const HiveScanner> RegistryProvider::OfflineHiveIndex(HKEY root) {
+  std::shared_ptr<OfflineHive> hive = FindOfflineHive(root);
+  if (!hive || hive->modified.load()) {
+    return nullptr;
+  }
+  std::shared_ptr<const HiveScanner> index = LoadedIndex(hive.get());
+  if (!index) {
+    return nullptr;
+  }
+  const HiveScanner* raw = index.get();
+  return std::shared_ptr<const HiveScanner>(raw, [hive, index](const HiveScanner*) {});
+}
+
+bool RegistryProvider::IndexOfflineHive(HKEY root, unsigned int thread_count, const std::atomic_bool* cancel) {
+  std::shared_ptr<OfflineHive> hive = FindOfflineHive(root);
+  std::wstring index_path;
+  if (!hive || !HiveIndexPath(*hive, &index_path)) {
+    return false;
+  }
+  auto scanner = std::make_shared<HiveScanner>(hive->reader);
+  if (!scanner->LoadIndex(index_path, hive->path)) {
+    if (!scanner->Index(thread_count, cancel)) {
+      return false;
+    }
+    scanner->SaveIndex(index_path, hive->path);
+  }
+  std::lock_guard<std::mutex> lock(hive->index_mutex);
+  hive->index = std::move(scanner);
+  return true;
+}
+
+void RegistryProvider::SetOfflineHiveIndexing(bool enabled) {
+  g_offline_hive_index.store(enabled);
+}
+
 void RegistryProvider::SetOfflineRoot(HKEY root) {
+  std::unique_lock<std::shared_mutex> lock(g_offline_roots_mutex);
   g_offline_roots.clear();
   if (root) {
     g_offline_roots.push_back(root);
@@ -543,13 +907,15 @@ void RegistryProvider::SetOfflineRoot(HKEY root) {
 }
 
 void RegistryProvider::SetOfflineRoots(const std::vector<HKEY>& roots) {
-  g_offline_roots.clear();
-  g_offline_roots.reserve(roots.size());
+  std::vector<HKEY> filtered;
+  filtered.reserve(roots.size());
   for (HKEY root : roots) {
     if (root) {
-      g_offline_roots.push_back(root);
+      filtered.push_back(root);
     }
   }
+  std::unique_lock<std::shared_mutex> lock(g_offline_roots_mutex);
+  g_offline_roots.swap(filtered);
 }
 
 HKEY RegistryProvider::RegisterVirtualRoot(const std::wstring& root_name, const std::shared_ptr<VirtualRegistryData>& data) {
@@ -590,13 +956,27 @@ bool RegistryProvider::OpenKey(const RegistryNode& node, REGSAM sam, HKEY* key)
 bool RegistryProvider::HasSubKeys(const RegistryNode& node) {
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
+    if (!virtual_data) {
       return false;
     }
-    const VirtualRegistryKey* key = FindVirtualKey(virtual_data->root.get(), node.subkey);
-    return key && !key->children.empty();
+    if (virtual_data->snapshot) {
+      uint32_t key = FindSnapshotKey(*virtual_data, node.subkey);
+      return key != RegSnapshot::kNoKey && virtual_data->snapshot->SubkeyCount(key) > 0;
+    }
+    const VirtualHive& hive = virtual_data->hive;
+    uint32_t key = FindVirtualKey(hive, node.subkey);
+    return key != VirtualHive::kNoKey && hive.SubkeyCount(key) > 0;
   }
   if (IsOfflineNode(node)) {
+    NativeKey native;
+    NativeLookup lookup = LookupNativeKey(node, &native);
+    if (lookup == NativeLookup::kMissing) {
+      return false;
+    }
+    if (lookup == NativeLookup::kFound) {
+      HiveKeyInfo key_info;
+      return native.hive->reader.QueryKey(native.cell, &key_info) && key_info.subkey_count > 0;
+    }
     OffregApi* api = GetOffreg();
     if (!api) {
       return false;
@@ -626,19 +1006,47 @@ bool RegistryProvider::QueryKeyInfo(const RegistryNode& node, KeyInfo* info) {
   }
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
+    if (!virtual_data) {
       return false;
     }
-    const VirtualRegistryKey* key = FindVirtualKey(virtual_data->root.get(), node.subkey);
-    if (!key) {
+    if (virtual_data->snapshot) {
+      const RegSnapshot& snapshot = *virtual_data->snapshot;
+      uint32_t key = FindSnapshotKey(*virtual_data, node.subkey);
+      if (key == RegSnapshot::kNoKey) {
+        return false;
+      }
+      info->subkey_count = snapshot.SubkeyCount(key);
+      info->value_count = snapshot.ValueCount(key);
+      info->last_write = ToFileTime(snapshot.LastWrite(key));
+      return true;
+    }
+    const VirtualHive& hive = virtual_data->hive;
+    uint32_t key = FindVirtualKey(hive, node.subkey);
+    if (key == VirtualHive::kNoKey) {
       return false;
     }
-    info->subkey_count = static_cast<DWORD>(key->children.size());
-    info->value_count = static_cast<DWORD>(key->values.size());
+    VirtualValues values = ResolveVirtualValues(*virtual_data, key);
+    info->subkey_count = hive.SubkeyCount(key);
+    info->value_count = values.hive->ValueCount(values.key);
     info->last_write = {};
     return true;
   }
   if (IsOfflineNode(node)) {
+    NativeKey native;
+    NativeLookup lookup = LookupNativeKey(node, &native);
+    if (lookup == NativeLookup::kMissing) {
+      return false;
+    }
+    if (lookup == NativeLookup::kFound) {
+      HiveKeyInfo key_info;
+      if (!native.hive->reader.QueryKey(native.cell, &key_info)) {
+        return false;
+      }
+      info->subkey_count = key_info.subkey_count;
+      info->value_count = key_info.value_count;
+      info->last_write = ToFileTime(key_info.last_write);
+      return true;
+    }
     OffregApi* api = GetOffreg();
     if (!api) {
       return false;
@@ -687,6 +1095,36 @@ bool RegistryProvider::QuerySymbolicLinkTarget(const RegistryNode& node, std::ws
     return false;
   }
   if (IsOfflineNode(node)) {
+    NativeKey native;
+    NativeLookup lookup = LookupNativeKey(node, &native);
+    if (lookup == NativeLookup::kMissing) {
+      return false;
+    }
+    if (lookup == NativeLookup::kFound) {
+      const HiveReader& reader = native.hive->reader;
+      HiveValue link;
+      if (!reader.FindValue(native.cell, L"SymbolicLinkValue", &link)) {
+        return false;
+      }
+      if ((link.type != REG_LINK && link.type != REG_SZ && link.type != REG_EXPAND_SZ) || link.data_size == 0) {
+        return false;
+      }
+      std::vector<uint8_t> scratch;
+      const uint8_t* data = nullptr;
+      uint32_t size = 0;
+      if (!reader.ValueData(link, &scratch, &data, &size) || !data) {
+        return false;
+      }
+      std::wstring value(reinterpret_cast<const wchar_t*>(data), size / sizeof(wchar_t));
+      while (!value.empty() && value.back() == L'\0') {
+        value.pop_back();
+      }
+      if (value.empty()) {
+        return false;
+      }
+      *target = std::move(value);
+      return true;
+    }
     OffregApi* api = GetOffreg();
     if (!api) {
       return false;
@@ -773,25 +1211,49 @@ std::vector<std::wstring> RegistryProvider::EnumSubKeyNames(const RegistryNode&
   std::vector<std::wstring> names;
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
+    if (!virtual_data) {
       return names;
     }
-    const VirtualRegistryKey* key = FindVirtualKey(virtual_data->root.get(), node.subkey);
-    if (!key) {
+    if (virtual_data->snapshot) {
+      const RegSnapshot& snapshot = *virtual_data->snapshot;
+      uint32_t key = FindSnapshotKey(*virtual_data, node.subkey);
+      names.reserve(snapshot.SubkeyCount(key));
+      for (uint32_t i = 0; i < snapshot.SubkeyCount(key); ++i) {
+        uint32_t child = snapshot.Subkey(key, i);
+        if (child != RegSnapshot::kNoKey) {
+          names.push_back(snapshot.KeyName(child).ToString());
+        }
+      }
       return names;
     }
-    names.reserve(key->children.size());
-    for (const auto& entry : key->children) {
-      if (entry.second) {
-        names.push_back(entry.second->name);
-      }
+    const VirtualHive& hive = virtual_data->hive;
+    uint32_t key = FindVirtualKey(hive, node.subkey);
+    if (key == VirtualHive::kNoKey) {
+      return names;
     }
-    if (sorted) {
-      std::sort(names.begin(), names.end(), [](const std::wstring& left, const std::wstring& right) { return _wcsicmp(left.c_str(), right.c_str()) < 0; });
+    names.reserve(hive.SubkeyCount(key));
+    for (uint32_t i = 0; i < hive.SubkeyCount(key); ++i) {
+      names.emplace_back(hive.KeyName(hive.Subkey(key, i)));
     }
     return names;
   }
   if (IsOfflineNode(node)) {
+    NativeKey native;
+    NativeLookup lookup = LookupNativeKey(node, &native);
+    if (lookup == NativeLookup::kMissing) {
+      return names;
+    }
+    if (lookup == NativeLookup::kFound) {
+      const HiveReader& reader = native.hive->reader;
+      reader.EnumSubkeys(native.cell, [&](uint32_t child) -> bool {
+        names.push_back(reader.KeyName(child).ToString());
+        return true;
+      });
+      if (sorted) {
+        std::sort(names.begin(), names.end());
+      }
+      return names;
+    }
     OffregApi* api = GetOffreg();
     if (!api) {
       return names;
@@ -859,38 +1321,57 @@ std::vector<ValueInfo> RegistryProvider::EnumValueInfo(const RegistryNode& node)
   std::vector<ValueInfo> values;
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
+    if (!virtual_data) {
       return values;
     }
-    const VirtualRegistryKey* key = FindVirtualKey(virtual_data->root.get(), node.subkey);
-    if (!key) {
+    if (virtual_data->snapshot) {
+      const RegSnapshot& snapshot = *virtual_data->snapshot;
+      uint32_t key = FindSnapshotKey(*virtual_data, node.subkey);
+      values.reserve(snapshot.ValueCount(key));
+      for (uint32_t i = 0; i < snapshot.ValueCount(key); ++i) {
+        RegSnapshotValue value = snapshot.Value(key, i);
+        ValueInfo info;
+        info.name = value.name.ToString();
+        info.type = value.type;
+        info.data_size = value.size;
+        values.emplace_back(std::move(info));
+      }
       return values;
     }
-    std::vector<const VirtualRegistryValue*> ordered;
-    ordered.reserve(key->values.size());
-    for (const auto& entry : key->values) {
-      ordered.push_back(&entry.second);
+    const VirtualHive& hive = virtual_data->hive;
+    uint32_t key = FindVirtualKey(hive, node.subkey);
+    if (key == VirtualHive::kNoKey) {
+      return values;
     }
-    std::sort(ordered.begin(), ordered.end(), [](const VirtualRegistryValue* left, const VirtualRegistryValue* right) {
-      if (!left || !right) {
-        return left != nullptr;
-      }
-      return _wcsicmp(left->name.c_str(), right->name.c_str()) < 0;
-    });
-    values.reserve(ordered.size());
-    for (const auto* value : ordered) {
-      if (!value) {
-        continue;
-      }
+    VirtualValues source = ResolveVirtualValues(*virtual_data, key);
+    values.reserve(source.hive->ValueCount(source.key));
+    for (uint32_t i = 0; i < source.hive->ValueCount(source.key); ++i) {
+      VirtualHiveValue value = source.hive->Value(source.key, i);
       ValueInfo info;
-      info.name = value->name;
-      info.type = value->type;
-      info.data_size = static_cast<DWORD>(value->data.size());
+      info.name = value.name;
+      info.type = value.type;
+      info.data_size = value.size;
       values.emplace_back(std::move(info));
     }
     return values;
   }
   if (IsOfflineNode(node)) {
+    NativeKey native;
+    NativeLookup lookup = LookupNativeKey(node, &native);
+    if (lookup == NativeLookup::kMissing) {
+      return values;
+    }
+    if (lookup == NativeLookup::kFound) {
+      native.hive->reader.EnumValues(native.cell, [&](const HiveValue& value) -> bool {
+        ValueInfo info;
+        info.name = value.name.ToString();
+        info.type = value.type;
+        info.data_size = value.data_size;
+        values.emplace_back(std::move(info));
+        return true;
+      });
+      return values;
+    }
     OffregApi* api = GetOffreg();
     if (!api) {
       return values;
@@ -968,38 +1449,66 @@ std::vector<ValueEntry> RegistryProvider::EnumValues(const RegistryNode& node) {
   std::vector<ValueEntry> values;
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
+    if (!virtual_data) {
       return values;
     }
-    const VirtualRegistryKey* key = FindVirtualKey(virtual_data->root.get(), node.subkey);
-    if (!key) {
+    if (virtual_data->snapshot) {
+      const RegSnapshot& snapshot = *virtual_data->snapshot;
+      uint32_t key = FindSnapshotKey(*virtual_data, node.subkey);
+      values.reserve(snapshot.ValueCount(key));
+      for (uint32_t i = 0; i < snapshot.ValueCount(key); ++i) {
+        RegSnapshotValue value = snapshot.Value(key, i);
+        ValueEntry entry;
+        entry.name = value.name.ToString();
+        entry.type = value.type;
+        entry.data.assign(value.data, value.data + value.size);
+        values.emplace_back(std::move(entry));
+      }
       return values;
     }
-    std::vector<const VirtualRegistryValue*> ordered;
-    ordered.reserve(key->values.size());
-    for (const auto& entry : key->values) {
-      ordered.push_back(&entry.second);
+    const VirtualHive& hive = virtual_data->hive;
+    uint32_t key = FindVirtualKey(hive, node.subkey);
+    if (key == VirtualHive::kNoKey) {
+      return values;
     }
-    std::sort(ordered.begin(), ordered.end(), [](const VirtualRegistryValue* left, const VirtualRegistryValue* right) {
-      if (!left || !right) {
-        return left != nullptr;
-      }
-      return _wcsicmp(left->name.c_str(), right->name.c_str()) < 0;
-    });
-    values.reserve(ordered.size());
-    for (const auto* value : ordered) {
-      if (!value) {
-        continue;
-      }
+    VirtualValues source = ResolveVirtualValues(*virtual_data, key);
+    values.reserve(source.hive->ValueCount(source.key));
+    for (uint32_t i = 0; i < source.hive->ValueCount(source.key); ++i) {
+      VirtualHiveValue value = source.hive->Value(source.key, i);
       ValueEntry entry;
-      entry.name = value->name;
-      entry.type = value->type;
-      entry.data = value->data;
+      entry.name = value.name;
+      entry.type = value.type;
+      entry.data.assign(value.data, value.data + value.size);
       values.emplace_back(std::move(entry));
     }
     return values;
   }
   if (IsOfflineNode(node)) {
+    NativeKey native;
+    NativeLookup lookup = LookupNativeKey(node, &native);
+    if (lookup == NativeLookup::kMissing) {
+      return values;
+    }
+    if (lookup == NativeLookup::kFound) {
+      const HiveReader& reader = native.hive->reader;
+      std::vector<uint8_t> scratch;
+      reader.EnumValues(native.cell, [&](const HiveValue& value) -> bool {
+        const uint8_t* data = nullptr;
+        uint32_t size = 0;
+        if (!reader.ValueData(value, &scratch, &data, &size)) {
+          return true;
+        }
+        ValueEntry entry;
+        entry.name = value.name.ToString();
+        entry.type = value.type;
+        if (data && size > 0) {
+          entry.data.assign(data, data + size);
+        }
+        values.emplace_back(std::move(entry));
+        return true;
+      });
+      return values;
+    }
     OffregApi* api = GetOffreg();
     if (!api) {
       return values;
@@ -1083,55 +1592,81 @@ bool RegistryProvider::EnumKeyStreaming(const RegistryNode& node, bool include_v
   }
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
+    if (!virtual_data) {
       return false;
     }
-    const VirtualRegistryKey* key = FindVirtualKey(virtual_data->root.get(), node.subkey);
-    if (!key) {
+    if (virtual_data->snapshot) {
+      const RegSnapshot& snapshot = *virtual_data->snapshot;
+      uint32_t key = FindSnapshotKey(*virtual_data, node.subkey);
+      if (key == RegSnapshot::kNoKey) {
+        return false;
+      }
+      if (out_info) {
+        out_info->info.subkey_count = snapshot.SubkeyCount(key);
+        out_info->info.value_count = snapshot.ValueCount(key);
+        out_info->info.last_write = ToFileTime(snapshot.LastWrite(key));
+        out_info->info_valid = true;
+      }
+      if (include_values && value_callback) {
+        ValueInfo info;
+        for (uint32_t i = 0; i < snapshot.ValueCount(key); ++i) {
+          RegSnapshotValue value = snapshot.Value(key, i);
+          info.name.clear();
+          value.name.AppendTo(&info.name);
+          info.type = value.type;
+          info.data_size = value.size;
+          if (!value_callback(info, include_data ? value.data : nullptr, value.size)) {
+            return false;
+          }
+        }
+      }
+      if (include_subkeys && subkey_callback) {
+        std::wstring name;
+        for (uint32_t i = 0; i < snapshot.SubkeyCount(key); ++i) {
+          uint32_t child = snapshot.Subkey(key, i);
+          if (child == RegSnapshot::kNoKey) {
+            continue;
+          }
+          name.clear();
+          snapshot.KeyName(child).AppendTo(&name);
+          if (!subkey_callback(name)) {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+    const VirtualHive& hive = virtual_data->hive;
+    uint32_t key = FindVirtualKey(hive, node.subkey);
+    if (key == VirtualHive::kNoKey) {
       return false;
     }
+    VirtualValues values;
+    if (out_info || (include_values && value_callback)) {
+      values = ResolveVirtualValues(*virtual_data, key);
+    }
     if (out_info) {
-      out_info->info.subkey_count = static_cast<DWORD>(key->children.size());
-      out_info->info.value_count = static_cast<DWORD>(key->values.size());
+      out_info->info.subkey_count = hive.SubkeyCount(key);
+      out_info->info.value_count = values.hive->ValueCount(values.key);
       out_info->info.last_write = {};
       out_info->info_valid = true;
     }
     if (include_values && value_callback) {
-      std::vector<const VirtualRegistryValue*> ordered;
-      ordered.reserve(key->values.size());
-      for (const auto& entry : key->values) {
-        ordered.push_back(&entry.second);
-      }
-      std::sort(ordered.begin(), ordered.end(), [](const VirtualRegistryValue* left, const VirtualRegistryValue* right) {
-        if (!left || !right) {
-          return left != nullptr;
-        }
-        return _wcsicmp(left->name.c_str(), right->name.c_str()) < 0;
-      });
-      for (const auto* value : ordered) {
-        if (!value) {
-          continue;
-        }
-        ValueInfo info;
-        info.name = value->name;
-        info.type = value->type;
-        info.data_size = static_cast<DWORD>(value->data.size());
-        const BYTE* buffer = include_data && !value->data.empty() ? value->data.data() : nullptr;
-        if (!value_callback(info, buffer, static_cast<DWORD>(value->data.size()))) {
+      ValueInfo info;
+      for (uint32_t i = 0; i < values.hive->ValueCount(values.key); ++i) {
+        VirtualHiveValue value = values.hive->Value(values.key, i);
+        info.name.assign(value.name);
+        info.type = value.type;
+        info.data_size = value.size;
+        if (!value_callback(info, include_data ? value.data : nullptr, value.size)) {
           return false;
         }
       }
     }
     if (include_subkeys && subkey_callback) {
-      std::vector<std::wstring> names;
-      names.reserve(key->children.size());
-      for (const auto& entry : key->children) {
-        if (entry.second) {
-          names.push_back(entry.second->name);
-        }
-      }
-      std::sort(names.begin(), names.end(), [](const std::wstring& left, const std::wstring& right) { return _wcsicmp(left.c_str(), right.c_str()) < 0; });
-      for (const auto& name : names) {
+      std::wstring name;
+      for (uint32_t i = 0; i < hive.SubkeyCount(key); ++i) {
+        name.assign(hive.KeyName(hive.Subkey(key, i)));
         if (!subkey_callback(name)) {
           return false;
         }
@@ -1140,6 +1675,58 @@ bool RegistryProvider::EnumKeyStreaming(const RegistryNode& node, bool include_v
     return true;
   }
   if (IsOfflineNode(node)) {
+    NativeKey native;
+    NativeLookup lookup = LookupNativeKey(node, &native);
+    if (lookup == NativeLookup::kMissing) {
+      return false;
+    }
+    if (lookup == NativeLookup::kFound) {
+      const HiveReader& reader = native.hive->reader;
+      HiveKeyInfo key_info;
+      if (!reader.QueryKey(native.cell, &key_info)) {
+        return false;
+      }
+      if (out_info) {
+        out_info->info.subkey_count = key_info.subkey_count;
+        out_info->info.value_count = key_info.value_count;
+        out_info->info.last_write = ToFileTime(key_info.last_write);
+        out_info->info_valid = true;
+      }
+      bool keep_going = true;
+      if (include_values && value_callback) {
+        std::vector<uint8_t> scratch;
+        ValueInfo info;
+        reader.EnumValues(native.cell, [&](const HiveValue& value) -> bool {
+          const uint8_t* data = nullptr;
+          uint32_t size = value.data_size;
+          if (include_data && !reader.ValueData(value, &scratch, &data, &size)) {
+            return true;
+          }
+          info.name.clear();
+          value.name.AppendTo(&info.name);
+          info.type = value.type;
+          info.data_size = size;
+          keep_going = value_callback(info, include_data && size > 0 ? data : nullptr, size);
+          return keep_going;
+        });
+        if (!keep_going) {
+          return false;
+        }
+      }
+      if (include_subkeys && subkey_callback) {
+        std::wstring name;
+        reader.EnumSubkeys(native.cell, [&](uint32_t child) -> bool {
+          name.clear();
+          reader.KeyName(child).AppendTo(&name);
+          keep_going = subkey_callback(name);
+          return keep_going;
+        });
+        if (!keep_going) {
+          return false;
+        }
+      }
+      return true;
+    }
     OffregApi* api = GetOffreg();
     if (!api) {
       return false;
@@ -1301,24 +1888,58 @@ bool RegistryProvider::QueryValue(const RegistryNode& node, const std::wstring&
   }
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
+    if (!virtual_data) {
       return false;
     }
-    const VirtualRegistryKey* key = FindVirtualKey(virtual_data->root.get(), node.subkey);
-    if (!key) {
+    if (virtual_data->snapshot) {
+      RegSnapshotValue value;
+      uint32_t key = FindSnapshotKey(*virtual_data, node.subkey);
+      if (key == RegSnapshot::kNoKey || !virtual_data->snapshot->FindValue(key, value_name, &value)) {
+        return false;
+      }
+      out->name = value.name.ToString();
+      out->type = value.type;
+      out->data.assign(value.data, value.data + value.size);
+      return true;
+    }
+    const VirtualHive& hive = virtual_data->hive;
+    uint32_t key = FindVirtualKey(hive, node.subkey);
+    if (key == VirtualHive::kNoKey) {
       return false;
     }
-    std::wstring name_lower = ToLower(value_name);
-    auto it = key->values.find(name_lower);
-    if (it == key->values.end()) {
+    VirtualValues values = ResolveVirtualValues(*virtual_data, key);
+    VirtualHiveValue value;
+    if (!values.hive->FindValue(values.key, value_name, &value)) {
       return false;
     }
-    out->name = it->second.name;
-    out->type = it->second.type;
-    out->data = it->second.data;
+    out->name = value.name;
+    out->type = value.type;
+    out->data.assign(value.data, value.data + value.size);
     return true;
   }
   if (IsOfflineNode(node)) {
+    NativeKey native;
+    NativeLookup lookup = LookupNativeKey(node, &native);
+    if (lookup == NativeLookup::kMissing) {
+      return false;
+    }
+    if (lookup == NativeLookup::kFound) {
+      const HiveReader& reader = native.hive->reader;
+      HiveValue value;
+      if (!reader.FindValue(native.cell, value_name, &value)) {
+        return false;
+      }
+      std::vector<uint8_t> scratch;
+      const uint8_t* data = nullptr;
+      uint32_t size = 0;
+      if (!reader.ValueData(value, &scratch, &data, &size)) {
+        return false;
+      }
+      out->name = value_name;
+      out->type = value.type;
+      out->data.assign(data, data + size);
+      return true;
+    }
     OffregApi* api = GetOffreg();
     if (!api) {
       return false;
@@ -1568,21 +2189,15 @@ bool RegistryProvider::CreateKey(const RegistryNode& node, const std::wstring& n
   }
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
+    if (!virtual_data || virtual_data->read_only) {
       return false;
     }
-    VirtualRegistryKey* parent = FindVirtualKey(virtual_data->root.get(), node.subkey);
-    if (!parent) {
+    VirtualHive& hive = virtual_data->hive;
+    uint32_t parent = FindVirtualKey(hive, node.subkey);
+    if (parent == VirtualHive::kNoKey) {
       return false;
     }
-    std::wstring name_lower = ToLower(name);
-    auto it = parent->children.find(name_lower);
-    if (it != parent->children.end()) {
-      return true;
-    }
-    auto child = std::make_unique<VirtualRegistryKey>();
-    child->name = name;
-    parent->children.emplace(name_lower, std::move(child));
+    hive.CreateSubkey(parent, name);
     return true;
   }
   if (IsOfflineNode(node)) {
@@ -1590,7 +2205,7 @@ bool RegistryProvider::CreateKey(const RegistryNode& node, const std::wstring& n
     if (!api) {
       return false;
     }
-    OfflineKey key = OpenOfflineKey(node);
+    OfflineKey key = OpenOfflineKey(node, true);
     if (!key.handle) {
       return false;
     }
@@ -1622,7 +2237,7 @@ bool RegistryProvider::DeleteKey(const RegistryNode& node) {
   }
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
+    if (!virtual_data || virtual_data->read_only) {
       return false;
     }
     std::wstring parent_path;
@@ -1630,12 +2245,9 @@ bool RegistryProvider::DeleteKey(const RegistryNode& node) {
     if (!SplitSubKey(node.subkey, &parent_path, &name)) {
       return false;
     }
-    VirtualRegistryKey* parent = FindVirtualKey(virtual_data->root.get(), parent_path);
-    if (!parent) {
-      return false;
-    }
-    std::wstring name_lower = ToLower(name);
-    return parent->children.erase(name_lower) > 0;
+    VirtualHive& hive = virtual_data->hive;
+    uint32_t parent = FindVirtualKey(hive, parent_path);
+    return parent != VirtualHive::kNoKey && hive.DeleteSubkey(parent, name);
   }
   std::wstring parent_path;
   std::wstring name;
@@ -1649,7 +2261,7 @@ bool RegistryProvider::DeleteKey(const RegistryNode& node) {
     if (!api) {
       return false;
     }
-    OfflineKey key = OpenOfflineKey(parent);
+    OfflineKey key = OpenOfflineKey(parent, true);
     if (!key.handle) {
       return false;
     }
@@ -1670,7 +2282,7 @@ bool RegistryProvider::RenameKey(const RegistryNode& node, const std::wstring& n
   }
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
+    if (!virtual_data || virtual_data->read_only) {
       return false;
     }
     std::wstring parent_path;
@@ -1678,25 +2290,14 @@ bool RegistryProvider::RenameKey(const RegistryNode& node, const std::wstring& n
     if (!SplitSubKey(node.subkey, &parent_path, &name)) {
       return false;
     }
-    VirtualRegistryKey* parent = FindVirtualKey(virtual_data->root.get(), parent_path);
-    if (!parent) {
+    VirtualHive& hive = virtual_data->hive;
+    uint32_t parent = FindVirtualKey(hive, parent_path);
+    if (parent == VirtualHive::kNoKey || !hive.RenameSubkey(parent, name, new_name)) {
       return false;
     }
-    std::wstring old_lower = ToLower(name);
-    std::wstring new_lower = ToLower(new_name);
-    auto it = parent->children.find(old_lower);
-    if (it == parent->children.end()) {
-      return false;
+    if (virtual_data->source) {
+      virtual_data->source->MarkMoved(hive.FindSubkey(parent, new_name));
     }
-    if (parent->children.find(new_lower) != parent->children.end()) {
-      return false;
-    }
-    std::unique_ptr<VirtualRegistryKey> moved = std::move(it->second);
-    parent->children.erase(it);
-    if (moved) {
-      moved->name = new_name;
-    }
-    parent->children.emplace(new_lower, std::move(moved));
     return true;
   }
   if (IsOfflineNode(node)) {
@@ -1704,7 +2305,7 @@ bool RegistryProvider::RenameKey(const RegistryNode& node, const std::wstring& n
     if (!api) {
       return false;
     }
-    OfflineKey key = OpenOfflineKey(node);
+    OfflineKey key = OpenOfflineKey(node, true);
     if (!key.handle) {
       return false;
     }
@@ -1729,22 +2330,19 @@ bool RegistryProvider::RenameKey(const RegistryNode& node, const std::wstring& n
 bool RegistryProvider::DeleteValue(const RegistryNode& node, const std::wstring& value_name) {
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
-      return false;
-    }
-    VirtualRegistryKey* key = FindVirtualKey(virtual_data->root.get(), node.subkey);
-    if (!key) {
+    if (!virtual_data || virtual_data->read_only) {
       return false;
     }
-    std::wstring name_lower = ToLower(value_name);
-    return key->values.erase(name_lower) > 0;
+    VirtualHive& hive = virtual_data->hive;
+    uint32_t key = FindVirtualKey(hive, node.subkey);
+    return key != VirtualHive::kNoKey && AdoptVirtualValues(virtual_data.get(), key) && hive.DeleteValue(key, value_name);
   }
   if (IsOfflineNode(node)) {
     OffregApi* api = GetOffreg();
     if (!api) {
       return false;
     }
-    OfflineKey key = OpenOfflineKey(node);
+    OfflineKey key = OpenOfflineKey(node, true);
     if (!key.handle) {
       return false;
     }
@@ -1762,18 +2360,15 @@ bool RegistryProvider::DeleteValue(const RegistryNode& node, const std::wstring&
 bool RegistryProvider::SetValue(const RegistryNode& node, const std::wstring& value_name, DWORD type, const std::vector<BYTE>& data) {
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
+    if (!virtual_data || virtual_data->read_only) {
       return false;
     }
-    VirtualRegistryKey* key = FindVirtualKey(virtual_data->root.get(), node.subkey);
-    if (!key) {
+    VirtualHive& hive = virtual_data->hive;
+    uint32_t key = FindVirtualKey(hive, node.subkey);
+    if (key == VirtualHive::kNoKey || !AdoptVirtualValues(virtual_data.get(), key)) {
       return false;
     }
-    std::wstring name_lower = ToLower(value_name);
-    VirtualRegistryValue& value = key->values[name_lower];
-    value.name = value_name;
-    value.type = type;
-    value.data = data;
+    hive.SetValue(key, value_name, type, data.data(), data.size());
     return true;
   }
   if (IsOfflineNode(node)) {
@@ -1781,7 +2376,7 @@ bool RegistryProvider::SetValue(const RegistryNode& node, const std::wstring& va
     if (!api) {
       return false;
     }
-    OfflineKey key = OpenOfflineKey(node);
+    OfflineKey key = OpenOfflineKey(node, true);
     if (!key.handle) {
       return false;
     }
@@ -1806,34 +2401,19 @@ bool RegistryProvider::RenameValue(const RegistryNode& node, const std::wstring&
   }
   std::shared_ptr<VirtualRegistryData> virtual_data;
   if (GetVirtualRootData(node.root, &virtual_data, nullptr)) {
-    if (!virtual_data || !virtual_data->root) {
-      return false;
-    }
-    VirtualRegistryKey* key = FindVirtualKey(virtual_data->root.get(), node.subkey);
-    if (!key) {
-      return false;
-    }
-    std::wstring old_lower = ToLower(old_name);
-    std::wstring new_lower = ToLower(new_name);
-    auto it = key->values.find(old_lower);
-    if (it == key->values.end()) {
-      return false;
-    }
-    if (key->values.find(new_lower) != key->values.end()) {
+    if (!virtual_data || virtual_data->read_only) {
       return false;
     }
-    VirtualRegistryValue value = std::move(it->second);
-    key->values.erase(it);
-    value.name = new_name;
-    key->values.emplace(new_lower, std::move(value));
-    return true;
+    VirtualHive& hive = virtual_data->hive;
+    uint32_t key = FindVirtualKey(hive, node.subkey);
+    return key != VirtualHive::kNoKey && AdoptVirtualValues(virtual_data.get(), key) && hive.RenameValue(key, old_name, new_name);
   }
   if (IsOfflineNode(node)) {
     OffregApi* api = GetOffreg();
     if (!api) {
       return false;
     }
-    OfflineKey key = OpenOfflineKey(node);
+    OfflineKey key = OpenOfflineKey(node, true);
     if (!key.handle) {
       return false;
     }
@@ -17,10 +17,10 @@
 #include "registry/search_engine.h"
 
 #include <algorithm>
-#include <condition_variable>
 #include <cstring>
 #include <cwchar>
 #include <cwctype>
+#include <filesystem>
 #include <mutex>
 #include <regex>
 #include <string_view>
@@ -29,14 +29,39 @@
 
 #include <windows.h>
 
+#include "registry/compiled_regex.h"
+#include "registry/hive_reader.h"
+#include "registry/hive_scan.h"
+#include "registry/ordinal_search.h"
+#include "registry/pattern_set.h"
+#include "registry/trigram_index.h"
+#include "registry/work_stealing_scheduler.h"
+#include "win32/win32_helpers.h"
+
 namespace regkit {
 
 namespace {
 
+constexpr uint64_t kFileTimeMinute = 60ull * 10000000ull;
+constexpr uint64_t kSearchIndexRefreshAge = 10 * kFileTimeMinute;
+constexpr uint64_t kSearchIndexMaxAge = 20 * kFileTimeMinute;
+
+std::atomic_bool g_search_index{false};
+
 struct SearchNode {
   RegistryNode node;
   std::wstring path;
   std::wstring key_name;
+  bool indexed = false;
+};
+
+struct NativeScan {
+  SearchNode start;
+  std::shared_ptr<const HiveReader> reader;
+  std::shared_ptr<const HiveScanner> index;
+  uint32_t cell = HiveReader::kNoCell;
+  std::wstring hive_path;
+  std::wstring index_path;
 };
 
 std::wstring KeyLeafName(const RegistryNode& node) {
@@ -80,6 +105,13 @@ bool IsExcludedPath(const std::wstring& path, const std::vector<std::wstring>& e
   return false;
 }
 
+FILETIME ToFileTime(uint64_t value) {
+  FILETIME ft = {};
+  ft.dwLowDateTime = static_cast<DWORD>(value & 0xFFFFFFFFu);
+  ft.dwHighDateTime = static_cast<DWORD>(value >> 32);
+  return ft;
+}
+
 std::wstring FormatFileTime(const FILETIME& filetime) {
   if (filetime.dwLowDateTime == 0 && filetime.dwHighDateTime == 0) {
     return L"";
@@ -98,12 +130,16 @@ struct MatchLocation {
   bool matched = false;
   size_t start = std::wstring::npos;
   size_t length = 0;
+  uint32_t pattern = 0;
 };
 
-class Matcher {
+class PatternMatcher {
 public:
-  Matcher(const SearchCriteria& criteria, bool* ok) : query_(criteria.query), use_regex_(criteria.use_regex), match_case_(criteria.match_case), match_whole_(criteria.match_whole) {
-    if (use_regex_) {
+  PatternMatcher(const std::wstring& query, const SearchCriteria& criteria, bool* ok) : query_(query), use_regex_(criteria.use_regex), match_case_(criteria.match_case), match_whole_(criteria.match_whole) {
+    if (!use_regex_ && !match_case_) {
+      finder_.Reset(query_);
+    }
+    if (use_regex_ && !compiled_.Compile(query_, match_case_)) {
       try {
         auto flags = std::regex_constants::ECMAScript;
         if (!match_case_) {
@@ -124,6 +160,15 @@ public:
       return location;
     }
     if (use_regex_) {
+      RegexMatch compiled_match;
+      if (compiled_.compiled()) {
+        if (match_whole_ ? compiled_.MatchWhole(text, &compiled_match) : compiled_.Search(text, &compiled_match)) {
+          location.matched = true;
+          location.start = compiled_match.start;
+          location.length = compiled_match.length;
+        }
+        return location;
+      }
       std::wstring temp(text);
       std::wsmatch match;
       if (match_whole_) {
@@ -147,7 +192,7 @@ public:
           location.start = 0;
           location.length = text.size();
         }
-      } else if (CompareStringOrdinal(text.data(), static_cast<int>(text.size()), query_.c_str(), static_cast<int>(query_.size()), TRUE) == CSTR_EQUAL) {
+      } else if (finder_.Equals(text)) {
         location.matched = true;
         location.start = 0;
         location.length = text.size();
@@ -163,10 +208,10 @@ public:
         location.length = query_.size();
       }
     } else {
-      int pos = FindStringOrdinal(FIND_FROMSTART, text.data(), static_cast<int>(text.size()), query_.c_str(), static_cast<int>(query_.size()), TRUE);
-      if (pos >= 0) {
+      size_t pos = finder_.Find(text);
+      if (pos != std::wstring_view::npos) {
         location.matched = true;
-        location.start = static_cast<size_t>(pos);
+        location.start = pos;
         location.length = query_.size();
       }
     }
@@ -178,9 +223,66 @@ private:
   bool use_regex_ = false;
   bool match_case_ = false;
   bool match_whole_ = false;
+  CompiledRegex compiled_;
+  OrdinalFinder finder_;
   std::wregex regex_;
 };
 
+std::vector<std::wstring> SearchPatterns(const SearchCriteria& criteria) {
+  if (!criteria.queries.empty()) {
+    return criteria.queries;
+  }
+  return {criteria.query};
+}
+
+class Matcher {
+public:
+  Matcher(const SearchCriteria& criteria, bool* ok) : match_whole_(criteria.match_whole) {
+    std::vector<std::wstring> patterns = SearchPatterns(criteria);
+    if (patterns.size() > 1 && !criteria.use_regex && set_.Build(patterns, criteria.match_case)) {
+      return;
+    }
+    for (size_t i = 0; i < patterns.size(); ++i) {
+      if (!patterns[i].empty()) {
+        matchers_.emplace_back(static_cast<uint32_t>(i), PatternMatcher(patterns[i], criteria, ok));
+      }
+    }
+  }
+
+  MatchLocation MatchView(std::wstring_view text) const {
+    MatchLocation best;
+    if (text.empty()) {
+      return best;
+    }
+    if (!set_.empty()) {
+      PatternHit hit;
+      if (match_whole_ ? set_.MatchWhole(text, &hit) : set_.Find(text, &hit)) {
+        best.matched = true;
+        best.start = hit.start;
+        best.length = hit.length;
+        best.pattern = hit.pattern;
+      }
+      return best;
+    }
+    for (const auto& [index, matcher] : matchers_) {
+      MatchLocation location = matcher.MatchView(text);
+      if (location.matched && (!best.matched || location.start < best.start)) {
+        best = location;
+        best.pattern = index;
+        if (best.start == 0) {
+          break;
+        }
+      }
+    }
+    return best;
+  }
+
+private:
+  PatternSet set_;
+  std::vector<std::pair<uint32_t, PatternMatcher>> matchers_;
+  bool match_whole_ = false;
+};
+
 struct HexQuery {
   bool hex_only = false;
   bool parsed = false;
@@ -271,11 +373,12 @@ bool IsBinaryType(DWORD base_type) {
 
 struct DataMatch {
   bool matched = false;
+  uint32_t pattern = 0;
   MatchLocation match;
   std::wstring data_text;
 };
 
-DataMatch MatchValueData(const Matcher& matcher, const HexQuery& hex_query, DWORD type, const BYTE* data, DWORD size) {
+DataMatch MatchValueData(const Matcher& matcher, const std::vector<HexQuery>& hex_queries, DWORD type, const BYTE* data, DWORD size) {
   DataMatch result;
   if (!data || size == 0) {
     return result;
@@ -292,18 +395,26 @@ DataMatch MatchValueData(const Matcher& matcher, const HexQuery& hex_query, DWOR
       return result;
     }
     result.matched = true;
+    result.pattern = match.pattern;
     result.match = match;
     result.data_text = RegistryProvider::FormatValueDataForDisplay(type, data, size);
     return result;
   }
 
   if (IsBinaryType(base_type)) {
-    if (hex_query.hex_only && hex_query.parsed && !hex_query.bytes.empty()) {
+    bool text_search = false;
+    for (size_t pattern = 0; pattern < hex_queries.size(); ++pattern) {
+      const HexQuery& hex_query = hex_queries[pattern];
+      if (!hex_query.hex_only || !hex_query.parsed || hex_query.bytes.empty()) {
+        text_search = true;
+        continue;
+      }
       size_t needle = hex_query.bytes.size();
       if (needle <= size) {
         for (size_t i = 0; i + needle <= size; ++i) {
           if (memcmp(data + i, hex_query.bytes.data(), needle) == 0) {
             result.matched = true;
+            result.pattern = static_cast<uint32_t>(pattern);
             result.data_text = RegistryProvider::FormatValueData(type, data, size);
             constexpr size_t kPreviewBytes = 32;
             size_t preview = std::min<size_t>(size, kPreviewBytes);
@@ -316,10 +427,13 @@ DataMatch MatchValueData(const Matcher& matcher, const HexQuery& hex_query, DWOR
           }
         }
       }
-      if (!hex_query.digits_only) {
-        return result;
+      if (hex_query.digits_only) {
+        text_search = true;
       }
     }
+    if (!text_search) {
+      return result;
+    }
     std::wstring ascii;
     ascii.reserve(size);
     for (DWORD i = 0; i < size; ++i) {
@@ -328,6 +442,7 @@ DataMatch MatchValueData(const Matcher& matcher, const HexQuery& hex_query, DWOR
     MatchLocation ascii_match = matcher.MatchView(ascii);
     if (ascii_match.matched) {
       result.matched = true;
+      result.pattern = ascii_match.pattern;
       result.data_text = RegistryProvider::FormatValueData(type, data, size);
       return result;
     }
@@ -339,6 +454,7 @@ DataMatch MatchValueData(const Matcher& matcher, const HexQuery& hex_query, DWOR
       MatchLocation wide_match = matcher.MatchView(wide);
       if (wide_match.matched) {
         result.matched = true;
+        result.pattern = wide_match.pattern;
         result.data_text = RegistryProvider::FormatValueData(type, data, size);
         return result;
       }
@@ -352,6 +468,7 @@ DataMatch MatchValueData(const Matcher& matcher, const HexQuery& hex_query, DWOR
     return result;
   }
   result.matched = true;
+  result.pattern = match.pattern;
   result.match = match;
   result.data_text = std::move(text);
   return result;
@@ -406,10 +523,155 @@ bool IsKeyInRange(const SearchCriteria& criteria, const FILETIME& last_write) {
   return true;
 }
 
+bool IsIndexableRoot(HKEY root) {
+  return root == HKEY_LOCAL_MACHINE || root == HKEY_CURRENT_USER || root == HKEY_USERS || root == HKEY_CLASSES_ROOT || root == HKEY_CURRENT_CONFIG;
+}
+
+std::wstring SearchIndexPath(HKEY root) {
+  if (!IsIndexableRoot(root)) {
+    return L"";
+  }
+  std::wstring folder = util::GetAppDataFolder();
+  if (folder.empty()) {
+    return L"";
+  }
+  folder = util::JoinPath(folder, L"cache\\search_index");
+  std::error_code ec;
+  std::filesystem::create_directories(folder, ec);
+  return util::JoinPath(folder, RegistryProvider::RootName(root) + kTrigramIndexExtension);
+}
+
+uint64_t CurrentFileTime() {
+  FILETIME now = {};
+  GetSystemTimeAsFileTime(&now);
+  return (static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+}
+
+bool OpenSearchIndex(HKEY root, uint64_t max_age, TrigramIndex* index) {
+  std::wstring path = SearchIndexPath(root);
+  if (path.empty() || !index->Open(path, nullptr)) {
+    return false;
+  }
+  uint64_t now = CurrentFileTime();
+  if (index->stamp() > now || now - index->stamp() > max_age) {
+    index->Close();
+    return false;
+  }
+  return true;
+}
+
+void CollectValueTrigrams(DWORD type, const BYTE* data, DWORD size, std::vector<uint32_t>* trigrams) {
+  if (!data || size == 0) {
+    return;
+  }
+  DWORD base_type = RegistryProvider::NormalizeValueType(type);
+  if (base_type == REG_SZ || base_type == REG_EXPAND_SZ || base_type == REG_LINK || base_type == REG_MULTI_SZ) {
+    std::wstring_view view;
+    if (BuildStringView(data, size, &view)) {
+      CollectTrigrams(view, trigrams);
+    }
+    return;
+  }
+  if (IsBinaryType(base_type)) {
+    std::wstring ascii(data, data + size);
+    CollectTrigrams(ascii, trigrams);
+    if (size >= sizeof(wchar_t) && (size % sizeof(wchar_t)) == 0) {
+      std::wstring wide(size / sizeof(wchar_t), L'\0');
+      memcpy(wide.data(), data, size);
+      CollectTrigrams(wide, trigrams);
+    }
+    return;
+  }
+  CollectTrigrams(RegistryProvider::FormatValueDataForDisplay(type, data, size), trigrams);
+}
+
+bool IndexLiterals(const SearchCriteria& criteria, const std::vector<HexQuery>& hex_queries, std::vector<std::wstring>* literals) {
+  std::vector<std::wstring> patterns = SearchPatterns(criteria);
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    if (patterns[i].empty()) {
+      return false;
+    }
+    if (criteria.use_regex) {
+      CompiledRegex regex;
+      if (!regex.Compile(patterns[i], criteria.match_case)) {
+        return false;
+      }
+      literals->push_back(regex.required_literal());
+    } else {
+      literals->push_back(patterns[i]);
+    }
+    if (criteria.search_data && i < hex_queries.size() && hex_queries[i].parsed) {
+      literals->emplace_back(hex_queries[i].bytes.begin(), hex_queries[i].bytes.end());
+    }
+  }
+  return true;
+}
+
+bool IsIndexedPathUnder(const std::wstring& path, const std::wstring& start) {
+  if (start.empty()) {
+    return true;
+  }
+  if (path.size() < start.size() || (path.size() > start.size() && path[start.size()] != L'\\')) {
+    return false;
+  }
+  return EqualsOrdinalInsensitive(std::wstring_view(path).substr(0, start.size()), start);
+}
+
 } // namespace
 
-bool SearchRegistryStreaming(const SearchCriteria& criteria, std::atomic_bool* cancel_flag, const std::function<bool(const SearchResult&)>& callback, const SearchProgressCallback& progress, bool stop_on_first) {
-  if (criteria.query.empty() || criteria.start_nodes.empty()) {
+void SetSearchIndexing(bool enabled) {
+  g_search_index.store(enabled);
+}
+
+bool RefreshSearchIndex(HKEY root, const std::atomic_bool* cancel) {
+  TrigramIndex existing;
+  if (OpenSearchIndex(root, kSearchIndexRefreshAge, &existing)) {
+    return true;
+  }
+  existing.Close();
+  std::wstring path = SearchIndexPath(root);
+  if (path.empty()) {
+    return false;
+  }
+  uint64_t stamp = CurrentFileTime();
+  std::mutex writer_mutex;
+  TrigramIndexWriter writer;
+  WorkStealingScheduler<std::wstring> scheduler(std::max(1u, std::thread::hardware_concurrency()));
+  scheduler.Seed(std::wstring());
+  scheduler.Run([&](unsigned int, std::wstring& subkey, std::vector<std::wstring>* children) {
+    if (cancel && cancel->load()) {
+      scheduler.Stop();
+      return;
+    }
+    RegistryNode node;
+    node.root = root;
+    node.subkey = subkey;
+    thread_local std::vector<uint32_t> trigrams;
+    trigrams.clear();
+    CollectTrigrams(KeyLeafName(node), &trigrams);
+    RegistryProvider::KeyEnumResult enum_result;
+    RegistryProvider::EnumKeyStreaming(node, true, true, true, &enum_result, [&](const ValueInfo& value, const BYTE* data, DWORD data_size) -> bool {
+      CollectTrigrams(value.name.empty() ? std::wstring_view(L"(Default)") : std::wstring_view(value.name), &trigrams);
+      CollectValueTrigrams(value.type, data, data_size, &trigrams);
+      return true;
+    }, [&](const std::wstring& name) -> bool {
+      children->push_back(subkey.empty() ? name : subkey + L"\\" + name);
+      return true;
+    });
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    writer.AddKey(subkey, &trigrams);
+  }, []() { SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN); });
+  if ((cancel && cancel->load()) || writer.key_count() == 0) {
+    return false;
+  }
+  return writer.Save(path, stamp, nullptr);
+}
+
+bool SearchRegistryStreaming(const SearchCriteria& criteria, std::atomic_bool* cancel_flag, const std::function<bool(const SearchResult&)>& callback, const SearchProgressCallback& progress, bool stop_on_first, uint64_t* index_age) {
+  if (index_age) {
+    *index_age = 0;
+  }
+  if ((criteria.query.empty() && criteria.queries.empty()) || criteria.start_nodes.empty()) {
     return false;
   }
 
@@ -418,21 +680,74 @@ bool SearchRegistryStreaming(const SearchCriteria& criteria, std::atomic_bool* c
   if (!regex_ok) {
     return false;
   }
-  HexQuery hex_query = ParseHexQuery(criteria.query);
+  std::vector<std::wstring> patterns = SearchPatterns(criteria);
+  std::vector<HexQuery> hex_queries;
+  for (const auto& pattern : patterns) {
+    hex_queries.push_back(ParseHexQuery(pattern));
+  }
 
-  std::mutex mutex;
-  std::condition_variable cv;
-  std::vector<SearchNode> stack;
-  stack.reserve(criteria.start_nodes.size());
+  unsigned int core_count = std::max(1u, std::thread::hardware_concurrency());
+  WorkStealingScheduler<SearchNode> scheduler(core_count);
+  uint64_t initial_keys = 0;
+  std::vector<std::wstring> index_literals;
+  bool use_index = g_search_index.load() && criteria.recursive && IndexLiterals(criteria, hex_queries, &index_literals);
+  auto seed_from_index = [&](const RegistryNode& node) -> bool {
+    TrigramIndex index;
+    if (!use_index || !OpenSearchIndex(node.root, kSearchIndexMaxAge, &index)) {
+      return false;
+    }
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> merged;
+    for (const auto& literal : index_literals) {
+      if (!index.Candidates(literal, &candidates)) {
+        return false;
+      }
+      merged.clear();
+      std::set_union(keys.begin(), keys.end(), candidates.begin(), candidates.end(), std::back_inserter(merged));
+      keys.swap(merged);
+    }
+    if (index_age) {
+      uint64_t now = CurrentFileTime();
+      *index_age = std::max(*index_age, now > index.stamp() ? now - index.stamp() : 0);
+    }
+    for (uint32_t key : keys) {
+      RegistryNode candidate;
+      candidate.root = node.root;
+      candidate.root_name = node.root_name;
+      candidate.subkey = index.KeyPath(key);
+      if (!IsIndexedPathUnder(candidate.subkey, node.subkey)) {
+        continue;
+      }
+      SearchNode entry = MakeSearchNode(candidate);
+      entry.indexed = true;
+      scheduler.Seed(std::move(entry));
+      ++initial_keys;
+    }
+    return true;
+  };
+
+  std::vector<NativeScan> scans;
   for (const auto& node : criteria.start_nodes) {
-    stack.push_back(MakeSearchNode(node));
+    NativeScan scan;
+    if (criteria.recursive) {
+      scan.reader = RegistryProvider::OfflineHiveReader(node, &scan.cell);
+    }
+    if (scan.reader) {
+      RegistryProvider::OfflineHiveIndexPaths(node, &scan.hive_path, &scan.index_path);
+      scan.index = RegistryProvider::OfflineHiveIndex(node.root);
+      scan.start = MakeSearchNode(node);
+      scans.push_back(std::move(scan));
+      ++initial_keys;
+    } else if (!seed_from_index(node)) {
+      scheduler.Seed(MakeSearchNode(node));
+      ++initial_keys;
+    }
   }
   std::atomic<uint64_t> searched_keys(0);
-  std::atomic<uint64_t> total_keys(stack.size());
+  std::atomic<uint64_t> total_keys(initial_keys);
   std::atomic<uint64_t> last_reported(0);
   std::atomic<uint64_t> last_reported_tick(0);
-  int active = 0;
-  bool done = false;
   std::atomic_bool stop(false);
 
   auto should_stop = [&]() -> bool {
@@ -444,7 +759,7 @@ bool SearchRegistryStreaming(const SearchCriteria& criteria, std::atomic_bool* c
 
   auto request_stop = [&]() {
     stop.store(true);
-    cv.notify_all();
+    scheduler.Stop();
   };
 
   auto report_progress = [&](bool force) {
@@ -484,198 +799,282 @@ bool SearchRegistryStreaming(const SearchCriteria& criteria, std::atomic_bool* c
 
   bool has_excludes = !criteria.exclude_paths.empty();
 
-  auto worker = [&]() {
-    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
-    for (;;) {
-      SearchNode entry;
-      {
-        std::unique_lock<std::mutex> lock(mutex);
-        cv.wait(lock, [&]() { return done || should_stop() || !stack.empty(); });
-        if (done || should_stop()) {
-          return;
-        }
-        if (stack.empty()) {
-          continue;
+  auto search_key = [&](const SearchNode& entry, const auto& enumerate_key, std::vector<std::wstring>* pending_subkeys) {
+    RegistryProvider::KeyEnumResult enum_result;
+    std::wstring date_text;
+    bool key_range_checked = false;
+    bool key_in_range = true;
+
+    auto is_key_in_range = [&]() -> bool {
+      if (!criteria.use_modified_from && !criteria.use_modified_to) {
+        return true;
+      }
+      if (!key_range_checked) {
+        key_range_checked = true;
+        if (!enum_result.info_valid) {
+          key_in_range = false;
+        } else {
+          key_in_range = IsKeyInRange(criteria, enum_result.info.last_write);
         }
-        entry = std::move(stack.back());
-        stack.pop_back();
-        ++active;
       }
+      return key_in_range;
+    };
 
-      searched_keys.fetch_add(1);
-      report_progress(false);
-
-      if (!should_stop()) {
-        if (!has_excludes || !IsExcludedPath(entry.path, criteria.exclude_paths)) {
-          RegistryProvider::KeyEnumResult enum_result;
-          std::wstring date_text;
-          bool key_range_checked = false;
-          bool key_in_range = true;
+    auto get_date_text = [&]() -> const std::wstring& {
+      if (enum_result.info_valid && date_text.empty()) {
+        date_text = FormatFileTime(enum_result.info.last_write);
+      }
+      return date_text;
+    };
 
-          auto is_key_in_range = [&]() -> bool {
-            if (!criteria.use_modified_from && !criteria.use_modified_to) {
-              return true;
-            }
-            if (!key_range_checked) {
-              key_range_checked = true;
-              if (!enum_result.info_valid) {
-                key_in_range = false;
-              } else {
-                key_in_range = IsKeyInRange(criteria, enum_result.info.last_write);
-              }
-            }
-            return key_in_range;
-          };
+    bool want_values = criteria.search_values || criteria.search_data;
+    bool want_subkeys = pending_subkeys != nullptr;
+    auto value_cb = [&](const ValueInfo& value, const BYTE* data, DWORD data_size) -> bool {
+      if (should_stop()) {
+        return false;
+      }
+      if (!IsTypeAllowed(criteria, value.type)) {
+        return true;
+      }
+      if (!IsSizeAllowed(criteria, data_size)) {
+        return true;
+      }
+      if (!is_key_in_range()) {
+        return true;
+      }
 
-          auto get_date_text = [&]() -> const std::wstring& {
-            if (enum_result.info_valid && date_text.empty()) {
-              date_text = FormatFileTime(enum_result.info.last_write);
-            }
-            return date_text;
-          };
-
-          std::vector<std::wstring> pending_subkeys;
-          bool want_values = criteria.search_values || criteria.search_data;
-          bool want_subkeys = criteria.recursive;
-          auto value_cb = [&](const ValueInfo& value, const BYTE* data, DWORD data_size) -> bool {
-            if (should_stop()) {
-              return false;
-            }
-            if (!IsTypeAllowed(criteria, value.type)) {
-              return true;
-            }
-            if (!IsSizeAllowed(criteria, data_size)) {
-              return true;
-            }
-            if (!is_key_in_range()) {
-              return true;
-            }
+      std::wstring display_name = value.name.empty() ? L"(Default)" : value.name;
+      MatchLocation name_match;
+      if (criteria.search_values) {
+        name_match = matcher.MatchView(display_name);
+      }
+      DataMatch data_match;
+      if (criteria.search_data) {
+        data_match = MatchValueData(matcher, hex_queries, value.type, data, data_size);
+      }
 
-            std::wstring display_name = value.name.empty() ? L"(Default)" : value.name;
-            MatchLocation name_match;
-            if (criteria.search_values) {
-              name_match = matcher.MatchView(display_name);
-            }
-            DataMatch data_match;
-            if (criteria.search_data) {
-              data_match = MatchValueData(matcher, hex_query, value.type, data, data_size);
+      if (name_match.matched || data_match.matched) {
+        SearchResult result;
+        result.key_path = entry.path;
+        result.key_name = entry.key_name;
+        result.value_name = value.name;
+        result.display_name = display_name;
+        result.type = value.type;
+        result.type_text = RegistryProvider::FormatValueType(value.type);
+        if (criteria.search_data) {
+          if (data_match.matched) {
+            result.data = std::move(data_match.data_text);
+          } else if (name_match.matched) {
+            result.data = RegistryProvider::FormatValueDataForDisplay(value.type, data, data_size);
+          }
+        } else if (name_match.matched) {
+          constexpr DWORD kMaxDisplaySize = 1024 * 1024;
+          if (data_size > kMaxDisplaySize) {
+            result.data.clear();
+          } else {
+            ValueEntry entry_value;
+            if (RegistryProvider::QueryValue(entry.node, value.name, &entry_value)) {
+              result.data = RegistryProvider::FormatValueDataForDisplay(entry_value.type, entry_value.data.data(), static_cast<DWORD>(entry_value.data.size()));
+              result.size_text = std::to_wstring(entry_value.data.size());
+              result.type = entry_value.type;
+              result.type_text = RegistryProvider::FormatValueType(result.type);
             }
+          }
+        }
+        if (result.size_text.empty()) {
+          result.size_text = std::to_wstring(data_size);
+        }
+        result.date_text = get_date_text();
+        result.is_key = false;
+        result.pattern_index = static_cast<int>(name_match.matched ? name_match.pattern : data_match.pattern);
+        if (patterns.size() > 1 && static_cast<size_t>(result.pattern_index) < patterns.size()) {
+          result.pattern = patterns[static_cast<size_t>(result.pattern_index)];
+        }
+        if (name_match.matched) {
+          result.match_field = SearchMatchField::kName;
+          result.match_start = static_cast<int>(name_match.start);
+          result.match_length = static_cast<int>(name_match.length);
+        } else if (data_match.matched && data_match.match.matched) {
+          result.match_field = SearchMatchField::kData;
+          result.match_start = static_cast<int>(data_match.match.start);
+          result.match_length = static_cast<int>(data_match.match.length);
+        }
+        if (!emit(std::move(result))) {
+          request_stop();
+          return false;
+        }
+      }
+      return true;
+    };
 
-            if (name_match.matched || data_match.matched) {
-              SearchResult result;
-              result.key_path = entry.path;
-              result.key_name = entry.key_name;
-              result.value_name = value.name;
-              result.display_name = display_name;
-              result.type = value.type;
-              result.type_text = RegistryProvider::FormatValueType(value.type);
-              if (criteria.search_data) {
-                if (data_match.matched) {
-                  result.data = std::move(data_match.data_text);
-                } else if (name_match.matched) {
-                  result.data = RegistryProvider::FormatValueDataForDisplay(value.type, data, data_size);
-                }
-              } else if (name_match.matched) {
-                constexpr DWORD kMaxDisplaySize = 1024 * 1024;
-                if (data_size > kMaxDisplaySize) {
-                  result.data.clear();
-                } else {
-                  ValueEntry entry_value;
-                  if (RegistryProvider::QueryValue(entry.node, value.name, &entry_value)) {
-                    result.data = RegistryProvider::FormatValueDataForDisplay(entry_value.type, entry_value.data.data(), static_cast<DWORD>(entry_value.data.size()));
-                    result.size_text = std::to_wstring(entry_value.data.size());
-                    result.type = entry_value.type;
-                    result.type_text = RegistryProvider::FormatValueType(result.type);
-                  }
-                }
-              }
-              if (result.size_text.empty()) {
-                result.size_text = std::to_wstring(data_size);
-              }
-              result.date_text = get_date_text();
-              result.is_key = false;
-              if (name_match.matched) {
-                result.match_field = SearchMatchField::kName;
-                result.match_start = static_cast<int>(name_match.start);
-                result.match_length = static_cast<int>(name_match.length);
-              } else if (data_match.matched && data_match.match.matched) {
-                result.match_field = SearchMatchField::kData;
-                result.match_start = static_cast<int>(data_match.match.start);
-                result.match_length = static_cast<int>(data_match.match.length);
-              }
-              if (!emit(std::move(result))) {
-                request_stop();
-                return false;
-              }
-            }
-            return true;
-          };
+    auto subkey_cb = [&](const std::wstring& name) -> bool {
+      if (should_stop()) {
+        return false;
+      }
+      pending_subkeys->push_back(name);
+      return true;
+    };
 
-          auto subkey_cb = [&](const std::wstring& name) -> bool {
-            if (should_stop()) {
-              return false;
-            }
-            pending_subkeys.push_back(name);
-            return true;
-          };
-
-          RegistryProvider::EnumKeyStreaming(entry.node, want_values, criteria.search_data, want_subkeys, &enum_result, want_values ? value_cb : RegistryProvider::ValueStreamCallback(), want_subkeys ? subkey_cb : RegistryProvider::SubkeyStreamCallback());
-
-          if (criteria.search_keys && is_key_in_range()) {
-            MatchLocation key_match = matcher.MatchView(entry.key_name);
-            if (key_match.matched) {
-              SearchResult result;
-              result.key_path = entry.path;
-              result.key_name = entry.key_name;
-              result.type_text = L"Key";
-              result.is_key = true;
-              result.date_text = get_date_text();
-              size_t path_start = entry.path.size() >= entry.key_name.size() ? entry.path.size() - entry.key_name.size() : 0;
-              result.match_field = SearchMatchField::kPath;
-              result.match_start = static_cast<int>(path_start + key_match.start);
-              result.match_length = static_cast<int>(key_match.length);
-              if (!emit(std::move(result))) {
-                request_stop();
-              }
-            }
-          }
+    enumerate_key(&enum_result, want_values ? RegistryProvider::ValueStreamCallback(value_cb) : RegistryProvider::ValueStreamCallback(), want_subkeys ? RegistryProvider::SubkeyStreamCallback(subkey_cb) : RegistryProvider::SubkeyStreamCallback());
+    if (entry.indexed && !enum_result.info_valid) {
+      return;
+    }
 
-          if (!should_stop() && want_subkeys && !pending_subkeys.empty()) {
-            std::lock_guard<std::mutex> lock(mutex);
-            for (const auto& name : pending_subkeys) {
-              stack.push_back(MakeChildNode(entry, name));
-            }
-            total_keys.fetch_add(static_cast<uint64_t>(pending_subkeys.size()));
-            report_progress(false);
-            cv.notify_all();
-          }
+    if (criteria.search_keys && is_key_in_range()) {
+      MatchLocation key_match = matcher.MatchView(entry.key_name);
+      if (key_match.matched) {
+        SearchResult result;
+        result.key_path = entry.path;
+        result.key_name = entry.key_name;
+        result.type_text = L"Key";
+        result.is_key = true;
+        result.date_text = get_date_text();
+        size_t path_start = entry.path.size() >= entry.key_name.size() ? entry.path.size() - entry.key_name.size() : 0;
+        result.match_field = SearchMatchField::kPath;
+        result.match_start = static_cast<int>(path_start + key_match.start);
+        result.match_length = static_cast<int>(key_match.length);
+        result.pattern_index = static_cast<int>(key_match.pattern);
+        if (patterns.size() > 1 && key_match.pattern < patterns.size()) {
+          result.pattern = patterns[key_match.pattern];
         }
+        if (!emit(std::move(result))) {
+          request_stop();
+        }
+      }
+    }
+  };
+
+  auto expand_key = [&](unsigned int, SearchNode& entry, std::vector<SearchNode>* children) {
+    searched_keys.fetch_add(1);
+    report_progress(false);
+    if (should_stop()) {
+      scheduler.Stop();
+      return;
+    }
+    if (has_excludes && IsExcludedPath(entry.path, criteria.exclude_paths)) {
+      return;
+    }
+
+    thread_local std::vector<std::wstring> pending_subkeys;
+    pending_subkeys.clear();
+    search_key(entry, [&](RegistryProvider::KeyEnumResult* enum_result, const RegistryProvider::ValueStreamCallback& value_cb, const RegistryProvider::SubkeyStreamCallback& subkey_cb) {
+      RegistryProvider::EnumKeyStreaming(entry.node, static_cast<bool>(value_cb), criteria.search_data, static_cast<bool>(subkey_cb), enum_result, value_cb, subkey_cb);
+    }, criteria.recursive && !entry.indexed ? &pending_subkeys : nullptr);
+
+    if (should_stop()) {
+      scheduler.Stop();
+      return;
+    }
+    if (criteria.recursive && !entry.indexed && !pending_subkeys.empty()) {
+      children->reserve(pending_subkeys.size());
+      for (const auto& name : pending_subkeys) {
+        children->push_back(MakeChildNode(entry, name));
+      }
+      total_keys.fetch_add(static_cast<uint64_t>(pending_subkeys.size()));
+      report_progress(false);
+    }
+  };
+
+  auto scan_hive = [&](const NativeScan& scan) -> bool {
+    HiveScanner scanner(*scan.reader);
+    bool indexed = scanner.Attach(scan.index) || (!scan.index_path.empty() && scanner.LoadIndex(scan.index_path, scan.hive_path));
+    if (!indexed) {
+      if (!scanner.Index(core_count, cancel_flag)) {
+        return false;
+      }
+      if (!scan.index_path.empty()) {
+        scanner.SaveIndex(scan.index_path, scan.hive_path);
+      }
+    }
+    if (scanner.Select(scan.cell) == 0) {
+      return false;
+    }
+    total_keys.fetch_add(static_cast<uint64_t>(scanner.selected_count() - 1));
+    const HiveReader& reader = *scan.reader;
+    DWORD caller = GetCurrentThreadId();
+    bool caller_background = SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN) != FALSE;
+    scanner.Scan(core_count, cancel_flag, [&](const HiveScanKey& key) -> bool {
+      thread_local bool background = false;
+      if (!background && GetCurrentThreadId() != caller) {
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+        background = true;
+      }
+      if (should_stop()) {
+        return false;
       }
+      searched_keys.fetch_add(1);
+      report_progress(false);
 
-      {
-        std::lock_guard<std::mutex> lock(mutex);
-        --active;
-        if (stack.empty() && active == 0) {
-          done = true;
-          cv.notify_all();
+      SearchNode entry;
+      entry.node.root = scan.start.node.root;
+      entry.node.root_name = scan.start.node.root_name;
+      entry.node.subkey = scan.start.node.subkey;
+      entry.path = scan.start.path;
+      if (key.path.empty()) {
+        entry.key_name = scan.start.key_name;
+      } else {
+        if (!entry.node.subkey.empty()) {
+          entry.node.subkey.push_back(L'\\');
         }
+        entry.node.subkey.append(key.path);
+        if (!entry.path.empty()) {
+          entry.path.push_back(L'\\');
+        }
+        entry.path.append(key.path);
+        key.name.AppendTo(&entry.key_name);
+      }
+      if (has_excludes && IsExcludedPath(entry.path, criteria.exclude_paths)) {
+        return true;
       }
+
+      search_key(entry, [&](RegistryProvider::KeyEnumResult* enum_result, const RegistryProvider::ValueStreamCallback& value_cb, const RegistryProvider::SubkeyStreamCallback&) {
+        enum_result->info.subkey_count = key.info.subkey_count;
+        enum_result->info.value_count = key.info.value_count;
+        enum_result->info.last_write = ToFileTime(key.info.last_write);
+        enum_result->info_valid = true;
+        if (!value_cb) {
+          return;
+        }
+        std::vector<uint8_t> scratch;
+        ValueInfo info;
+        HiveValue value;
+        for (uint32_t cell : key.values) {
+          if (!reader.ReadValue(cell, &value)) {
+            continue;
+          }
+          const uint8_t* data = nullptr;
+          uint32_t size = value.data_size;
+          if (criteria.search_data && !reader.ValueData(value, &scratch, &data, &size)) {
+            continue;
+          }
+          info.name.clear();
+          value.name.AppendTo(&info.name);
+          info.type = value.type;
+          info.data_size = size;
+          if (!value_cb(info, criteria.search_data && size > 0 ? data : nullptr, size)) {
+            return;
+          }
+        }
+      }, nullptr);
+      return !should_stop();
+    });
+    if (caller_background) {
+      SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
     }
+    return true;
   };
 
-  unsigned int worker_count = std::thread::hardware_concurrency();
-  if (worker_count == 0) {
-    worker_count = 1;
-  }
-  unsigned int max_workers = criteria.start_nodes.size() > 1 ? 8u : 4u;
-  worker_count = std::min(worker_count, max_workers);
-  std::vector<std::thread> workers;
-  workers.reserve(worker_count);
-  for (unsigned int i = 0; i < worker_count; ++i) {
-    workers.emplace_back(worker);
+  for (const auto& scan : scans) {
+    if (should_stop()) {
+      break;
+    }
+    if (!scan_hive(scan)) {
+      scheduler.Seed(scan.start);
+    }
   }
-  for (auto& thread : workers) {
-    thread.join();
+
+  if (scheduler.pending() > 0 && !should_stop()) {
+    scheduler.Run(expand_key, []() { SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN); });
   }
 
   report_progress(true);
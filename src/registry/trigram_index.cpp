@@ -0,0 +1,432 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "registry/trigram_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+#include <fstream>
+#include <iterator>
+
+#include "registry/ordinal_search.h"
+
+namespace regkit {
+
+namespace {
+
+constexpr uint8_t kMagic[8] = {'R', 'K', 'T', 'R', 'I', 'X', 0x1A, 0};
+constexpr size_t kHeaderSize = 96;
+constexpr size_t kTrigramRecordSize = 16;
+constexpr uint8_t kOtherSymbol = 0x80;
+constexpr size_t kDirectVerify = 32;
+
+uint32_t Read32(const uint8_t* data) {
+  uint32_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint64_t Read64(const uint8_t* data) {
+  uint64_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void Put32(uint8_t* data, uint32_t value) {
+  memcpy(data, &value, sizeof(value));
+}
+
+void Put64(uint8_t* data, uint64_t value) {
+  memcpy(data, &value, sizeof(value));
+}
+
+bool FitsTable(uint64_t offset, uint64_t count, uint64_t record_size, uint64_t file_size) {
+  return offset <= file_size && count <= (file_size - offset) / record_size;
+}
+
+uint8_t AsciiUpper(uint32_t ch) {
+  return static_cast<uint8_t>((ch >= 'a' && ch <= 'z') ? ch - ('a' - 'A') : ch);
+}
+
+uint8_t Symbol(wchar_t ch) {
+  static const std::vector<uint8_t> table = [] {
+    std::vector<uint8_t> result(0x10000, kOtherSymbol);
+    for (uint32_t unit = 0; unit < 0x10000; ++unit) {
+      if (unit < 0x80) {
+        result[unit] = AsciiUpper(unit);
+        continue;
+      }
+      if (unit >= 0xD800 && unit <= 0xDFFF) {
+        continue;
+      }
+      uint32_t upper = static_cast<uint32_t>(UpcaseOrdinal(static_cast<wchar_t>(unit)));
+      uint32_t lower = static_cast<uint32_t>(towlower(static_cast<wint_t>(unit)));
+      if (upper < 0x80) {
+        result[unit] = AsciiUpper(upper);
+      } else if (lower < 0x80) {
+        result[unit] = AsciiUpper(lower);
+      }
+    }
+    return result;
+  }();
+  uint32_t value = static_cast<uint32_t>(ch);
+  return value < 0x10000 ? table[value] : kOtherSymbol;
+}
+
+void PutVarint(std::vector<uint8_t>* out, uint32_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+bool ReadVarint(const uint8_t** cursor, const uint8_t* end, uint32_t* value) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (*cursor >= end) {
+      return false;
+    }
+    uint8_t byte = *(*cursor)++;
+    result |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+void EncodeUnits(std::wstring_view text, std::u16string* out) {
+  for (wchar_t ch : text) {
+    uint32_t code = static_cast<uint32_t>(ch);
+    if (code > 0xFFFF) {
+      code -= 0x10000;
+      out->push_back(static_cast<char16_t>(0xD800 + (code >> 10)));
+      out->push_back(static_cast<char16_t>(0xDC00 + (code & 0x3FF)));
+    } else {
+      out->push_back(static_cast<char16_t>(code));
+    }
+  }
+}
+
+} // namespace
+
+void CollectTrigrams(std::wstring_view text, std::vector<uint32_t>* trigrams) {
+  if (text.size() < 3) {
+    return;
+  }
+  uint32_t window = (static_cast<uint32_t>(Symbol(text[0])) << 8) | Symbol(text[1]);
+  for (size_t i = 2; i < text.size(); ++i) {
+    window = ((window << 8) | Symbol(text[i])) & 0xFFFFFFu;
+    trigrams->push_back(window);
+  }
+}
+
+bool TrigramIndex::Open(const std::filesystem::path& path, std::wstring* error) {
+  Close();
+  if (!file_.Open(path, error)) {
+    return false;
+  }
+  const uint8_t* base = file_.data();
+  uint64_t size = file_.size();
+  auto fail = [&]() {
+    Close();
+    if (error) {
+      *error = L"The file is not a search index.";
+    }
+    return false;
+  };
+  if (size < kHeaderSize || memcmp(base, kMagic, sizeof(kMagic)) != 0) {
+    return fail();
+  }
+  if (Read32(base + 8) != kVersion) {
+    Close();
+    if (error) {
+      *error = L"Unsupported search index version.";
+    }
+    return false;
+  }
+  key_count_ = Read32(base + 12);
+  trigram_count_ = Read32(base + 16);
+  always_count_ = Read32(base + 20);
+  stamp_ = Read64(base + 24);
+  uint64_t trigrams = Read64(base + 32);
+  uint64_t paths = Read64(base + 40);
+  uint64_t always = Read64(base + 48);
+  uint64_t units = Read64(base + 56);
+  unit_count_ = Read64(base + 64);
+  uint64_t postings = Read64(base + 72);
+  posting_size_ = Read64(base + 80);
+  if (!FitsTable(trigrams, trigram_count_, kTrigramRecordSize, size) || !FitsTable(paths, static_cast<uint64_t>(key_count_) + 1, 8, size) ||
+      !FitsTable(always, always_count_, 4, size) || !FitsTable(units, unit_count_, 2, size) || !FitsTable(postings, posting_size_, 1, size)) {
+    return fail();
+  }
+  trigrams_ = base + trigrams;
+  paths_ = base + paths;
+  always_ = base + always;
+  units_ = base + units;
+  postings_ = base + postings;
+  if (Read64(paths_) != 0 || Read64(paths_ + static_cast<size_t>(key_count_) * 8) != unit_count_) {
+    return fail();
+  }
+  return true;
+}
+
+void TrigramIndex::Close() {
+  file_.Close();
+  trigrams_ = nullptr;
+  paths_ = nullptr;
+  units_ = nullptr;
+  postings_ = nullptr;
+  always_ = nullptr;
+  stamp_ = 0;
+  unit_count_ = 0;
+  posting_size_ = 0;
+  key_count_ = 0;
+  trigram_count_ = 0;
+  always_count_ = 0;
+}
+
+std::wstring TrigramIndex::KeyPath(uint32_t key) const {
+  std::wstring path;
+  if (key >= key_count_) {
+    return path;
+  }
+  uint64_t begin = Read64(paths_ + static_cast<size_t>(key) * 8);
+  uint64_t end = Read64(paths_ + (static_cast<size_t>(key) + 1) * 8);
+  if (begin > end || end > unit_count_) {
+    return path;
+  }
+  path.reserve(static_cast<size_t>(end - begin));
+  for (uint64_t i = begin; i < end; ++i) {
+    uint16_t unit = 0;
+    memcpy(&unit, units_ + i * 2, sizeof(unit));
+    if constexpr (sizeof(wchar_t) == 4) {
+      if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < end) {
+        uint16_t low = 0;
+        memcpy(&low, units_ + (i + 1) * 2, sizeof(low));
+        if (low >= 0xDC00 && low <= 0xDFFF) {
+          path.push_back(static_cast<wchar_t>(0x10000 + ((static_cast<uint32_t>(unit - 0xD800) << 10) | (low - 0xDC00))));
+          ++i;
+          continue;
+        }
+      }
+    }
+    path.push_back(static_cast<wchar_t>(unit));
+  }
+  return path;
+}
+
+bool TrigramIndex::Postings(uint32_t trigram, std::vector<uint32_t>* keys) const {
+  keys->clear();
+  size_t low = 0;
+  size_t high = trigram_count_;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (Read32(trigrams_ + mid * kTrigramRecordSize) < trigram) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == trigram_count_ || Read32(trigrams_ + low * kTrigramRecordSize) != trigram) {
+    return true;
+  }
+  const uint8_t* record = trigrams_ + low * kTrigramRecordSize;
+  uint32_t count = Read32(record + 4);
+  uint64_t offset = Read64(record + 8);
+  if (offset > posting_size_ || count > key_count_) {
+    return false;
+  }
+  const uint8_t* cursor = postings_ + offset;
+  const uint8_t* end = postings_ + posting_size_;
+  keys->reserve(count);
+  uint32_t key = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t delta = 0;
+    if (!ReadVarint(&cursor, end, &delta)) {
+      return false;
+    }
+    key += delta;
+    if (key >= key_count_) {
+      return false;
+    }
+    keys->push_back(key);
+  }
+  return true;
+}
+
+bool TrigramIndex::Candidates(std::wstring_view literal, std::vector<uint32_t>* keys) const {
+  if (!keys || !is_open()) {
+    return false;
+  }
+  std::vector<uint32_t> trigrams;
+  CollectTrigrams(literal, &trigrams);
+  if (trigrams.empty()) {
+    return false;
+  }
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+  keys->clear();
+  std::vector<uint32_t> postings;
+  std::vector<uint32_t> merged;
+  for (size_t i = 0; i < trigrams.size(); ++i) {
+    if (!Postings(trigrams[i], &postings)) {
+      return false;
+    }
+    if (i == 0) {
+      keys->swap(postings);
+    } else {
+      merged.clear();
+      std::set_intersection(keys->begin(), keys->end(), postings.begin(), postings.end(), std::back_inserter(merged));
+      keys->swap(merged);
+    }
+    if (keys->size() <= kDirectVerify) {
+      break;
+    }
+  }
+
+  if (always_count_ > 0) {
+    merged.clear();
+    merged.reserve(keys->size() + always_count_);
+    size_t next = 0;
+    for (uint32_t i = 0; i < always_count_; ++i) {
+      uint32_t key = Read32(always_ + static_cast<size_t>(i) * 4);
+      while (next < keys->size() && (*keys)[next] < key) {
+        merged.push_back((*keys)[next++]);
+      }
+      if (key < key_count_ && (next == keys->size() || (*keys)[next] != key)) {
+        merged.push_back(key);
+      }
+    }
+    merged.insert(merged.end(), keys->begin() + static_cast<std::ptrdiff_t>(next), keys->end());
+    keys->swap(merged);
+  }
+  return true;
+}
+
+void TrigramIndexWriter::AddKey(std::wstring_view path, std::vector<uint32_t>* trigrams) {
+  uint32_t key = key_count_++;
+  EncodeUnits(path, &units_);
+  paths_.push_back(units_.size());
+  std::sort(trigrams->begin(), trigrams->end());
+  trigrams->erase(std::unique(trigrams->begin(), trigrams->end()), trigrams->end());
+  if (trigrams->size() > kMaxKeyTrigrams) {
+    always_.push_back(key);
+    return;
+  }
+  for (uint32_t trigram : *trigrams) {
+    Posting& posting = postings_[trigram];
+    PutVarint(&posting.bytes, posting.count == 0 ? key : key - posting.last);
+    posting.last = key;
+    ++posting.count;
+  }
+}
+
+bool TrigramIndexWriter::Save(const std::filesystem::path& path, uint64_t stamp, std::wstring* error) const {
+  std::vector<uint32_t> order;
+  order.reserve(postings_.size());
+  uint64_t posting_size = 0;
+  for (const auto& [trigram, posting] : postings_) {
+    order.push_back(trigram);
+    posting_size += posting.bytes.size();
+  }
+  std::sort(order.begin(), order.end());
+
+  uint64_t trigrams = kHeaderSize;
+  uint64_t paths = trigrams + static_cast<uint64_t>(order.size()) * kTrigramRecordSize;
+  uint64_t always = paths + (static_cast<uint64_t>(key_count_) + 1) * 8;
+  uint64_t units = (always + static_cast<uint64_t>(always_.size()) * 4 + 7) & ~static_cast<uint64_t>(7);
+  uint64_t postings = units + static_cast<uint64_t>(units_.size()) * 2;
+
+  uint8_t header[kHeaderSize] = {};
+  memcpy(header, kMagic, sizeof(kMagic));
+  Put32(header + 8, TrigramIndex::kVersion);
+  Put32(header + 12, key_count_);
+  Put32(header + 16, static_cast<uint32_t>(order.size()));
+  Put32(header + 20, static_cast<uint32_t>(always_.size()));
+  Put64(header + 24, stamp);
+  Put64(header + 32, trigrams);
+  Put64(header + 40, paths);
+  Put64(header + 48, always);
+  Put64(header + 56, units);
+  Put64(header + 64, units_.size());
+  Put64(header + 72, postings);
+  Put64(header + 80, posting_size);
+
+  std::filesystem::path staged = path;
+  staged += L".tmp";
+  std::ofstream file(staged, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    if (error) {
+      *error = L"Failed to create search index file.";
+    }
+    return false;
+  }
+  auto write = [&](const void* data, size_t size) { file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size)); };
+  write(header, sizeof(header));
+  uint64_t offset = 0;
+  for (uint32_t trigram : order) {
+    const Posting& posting = postings_.at(trigram);
+    uint8_t record[kTrigramRecordSize] = {};
+    Put32(record, trigram);
+    Put32(record + 4, posting.count);
+    Put64(record + 8, offset);
+    write(record, sizeof(record));
+    offset += posting.bytes.size();
+  }
+  uint8_t value[8] = {};
+  write(value, sizeof(value));
+  for (uint64_t end : paths_) {
+    Put64(value, end);
+    write(value, sizeof(value));
+  }
+  for (uint32_t key : always_) {
+    Put32(value, key);
+    write(value, 4);
+  }
+  uint8_t padding[8] = {};
+  write(padding, static_cast<size_t>(units - always - always_.size() * 4));
+  write(units_.data(), units_.size() * 2);
+  for (uint32_t trigram : order) {
+    const std::vector<uint8_t>& bytes = postings_.at(trigram).bytes;
+    write(bytes.data(), bytes.size());
+  }
+  file.close();
+  std::error_code ec;
+  if (!file) {
+    std::filesystem::remove(staged, ec);
+    if (error) {
+      *error = L"Failed to write search index file.";
+    }
+    return false;
+  }
+  std::filesystem::rename(staged, path, ec);
+  if (ec) {
+    std::filesystem::remove(staged, ec);
+    if (error) {
+      *error = L"Failed to replace search index file.";
+    }
+    return false;
+  }
+  return true;
+}
+
+} // namespace regkit
@@ -0,0 +1,432 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "registry/virtual_hive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+
+namespace regkit {
+
+namespace {
+
+constexpr size_t kMinNameSlots = 1024;
+
+wchar_t FoldChar(wchar_t ch) {
+  if (ch < 0x80) {
+    return (ch >= L'a' && ch <= L'z') ? static_cast<wchar_t>(ch - (L'a' - L'A')) : ch;
+  }
+  return static_cast<wchar_t>(std::towupper(ch));
+}
+
+int CompareFolded(std::wstring_view left, std::wstring_view right) {
+  size_t count = std::min(left.size(), right.size());
+  for (size_t i = 0; i < count; ++i) {
+    wchar_t a = left[i];
+    wchar_t b = right[i];
+    if (a == b) {
+      continue;
+    }
+    a = FoldChar(a);
+    b = FoldChar(b);
+    if (a != b) {
+      return a < b ? -1 : 1;
+    }
+  }
+  if (left.size() == right.size()) {
+    return 0;
+  }
+  return left.size() < right.size() ? -1 : 1;
+}
+
+uint32_t HashName(std::wstring_view name) {
+  uint32_t hash = 2166136261u;
+  for (wchar_t ch : name) {
+    hash = (hash ^ static_cast<uint32_t>(ch)) * 16777619u;
+  }
+  return hash;
+}
+
+template <typename T>
+void InsertIntoRange(std::vector<T>* pool, uint32_t* begin, uint32_t* count, uint32_t* capacity, size_t position, const T& item) {
+  if (*count == *capacity) {
+    if (static_cast<size_t>(*begin) + *capacity == pool->size()) {
+      pool->push_back(T());
+      ++*capacity;
+    } else {
+      uint32_t grown = std::max<uint32_t>(1, *capacity * 2);
+      size_t moved = pool->size();
+      pool->resize(moved + grown);
+      std::copy(pool->begin() + *begin, pool->begin() + *begin + *count, pool->begin() + moved);
+      *begin = static_cast<uint32_t>(moved);
+      *capacity = grown;
+    }
+  }
+  T* range = pool->data() + *begin;
+  std::copy_backward(range + position, range + *count, range + *count + 1);
+  range[position] = item;
+  ++*count;
+}
+
+template <typename T>
+void EraseFromRange(std::vector<T>* pool, uint32_t begin, uint32_t* count, size_t position) {
+  T* range = pool->data() + begin;
+  std::copy(range + position + 1, range + *count, range + position);
+  --*count;
+}
+
+} // namespace
+
+VirtualHive::VirtualHive() {
+  KeyRecord root;
+  root.name = Intern(std::wstring_view());
+  keys_.push_back(root);
+}
+
+std::wstring_view VirtualHive::KeyName(uint32_t key) const {
+  return Name(keys_[key].name);
+}
+
+uint32_t VirtualHive::FindSubkey(uint32_t key, std::wstring_view name) const {
+  bool found = false;
+  size_t position = LowerSubkey(key, name, &found);
+  return found ? Subkey(key, static_cast<uint32_t>(position)) : kNoKey;
+}
+
+uint32_t VirtualHive::FindKey(std::wstring_view path) const {
+  uint32_t current = root();
+  size_t start = 0;
+  while (start <= path.size() && current != kNoKey) {
+    size_t end = path.find_first_of(L"\\/", start);
+    if (end == std::wstring_view::npos) {
+      end = path.size();
+    }
+    if (end > start) {
+      current = FindSubkey(current, path.substr(start, end - start));
+    }
+    start = end + 1;
+  }
+  return current;
+}
+
+uint32_t VirtualHive::CreateSubkey(uint32_t key, std::wstring_view name) {
+  bool found = false;
+  size_t position = LowerSubkey(key, name, &found);
+  if (found) {
+    return Subkey(key, static_cast<uint32_t>(position));
+  }
+  uint32_t child = static_cast<uint32_t>(keys_.size());
+  KeyRecord record;
+  record.name = Intern(name);
+  keys_.push_back(record);
+  KeyRecord& parent = keys_[key];
+  InsertIntoRange(&links_, &parent.children, &parent.child_count, &parent.child_capacity, position, child);
+  return child;
+}
+
+uint32_t VirtualHive::CreateKey(std::wstring_view path) {
+  size_t common = 0;
+  while (common < path.size() && common < created_path_.size() && path[common] == created_path_[common]) {
+    ++common;
+  }
+  uint32_t current = root();
+  size_t start = 0;
+  size_t reused = 0;
+  while (reused < created_keys_.size()) {
+    const CreatedKey& created = created_keys_[reused];
+    if (created.end > common || (created.end < path.size() && path[created.end] != L'\\' && path[created.end] != L'/')) {
+      break;
+    }
+    current = created.key;
+    start = created.end + 1;
+    ++reused;
+  }
+  created_keys_.resize(reused);
+  while (start <= path.size()) {
+    size_t end = path.find_first_of(L"\\/", start);
+    if (end == std::wstring_view::npos) {
+      end = path.size();
+    }
+    if (end > start) {
+      current = CreateSubkey(current, path.substr(start, end - start));
+      created_keys_.push_back({end, current});
+    }
+    start = end + 1;
+  }
+  created_path_.assign(path);
+  return current;
+}
+
+bool VirtualHive::DeleteSubkey(uint32_t key, std::wstring_view name) {
+  bool found = false;
+  size_t position = LowerSubkey(key, name, &found);
+  if (!found) {
+    return false;
+  }
+  KeyRecord& parent = keys_[key];
+  EraseFromRange(&links_, parent.children, &parent.child_count, position);
+  ForgetCreatedPath();
+  return true;
+}
+
+bool VirtualHive::RenameSubkey(uint32_t key, std::wstring_view old_name, std::wstring_view new_name) {
+  bool found = false;
+  size_t position = LowerSubkey(key, old_name, &found);
+  if (!found) {
+    return false;
+  }
+  uint32_t child = Subkey(key, static_cast<uint32_t>(position));
+  uint32_t existing = FindSubkey(key, new_name);
+  if (existing != kNoKey && existing != child) {
+    return false;
+  }
+  KeyRecord& parent = keys_[key];
+  EraseFromRange(&links_, parent.children, &parent.child_count, position);
+  keys_[child].name = Intern(new_name);
+  position = LowerSubkey(key, new_name, &found);
+  KeyRecord& renamed_parent = keys_[key];
+  InsertIntoRange(&links_, &renamed_parent.children, &renamed_parent.child_count, &renamed_parent.child_capacity, position, child);
+  ForgetCreatedPath();
+  return true;
+}
+
+VirtualHiveValue VirtualHive::Value(uint32_t key, uint32_t index) const {
+  const ValueRecord& record = values_[keys_[key].values + index];
+  VirtualHiveValue value;
+  value.name = Name(record.name);
+  value.type = record.type;
+  value.data = record.size ? blobs_.data() + record.data : nullptr;
+  value.size = record.size;
+  return value;
+}
+
+bool VirtualHive::FindValue(uint32_t key, std::wstring_view name, VirtualHiveValue* value) const {
+  bool found = false;
+  size_t position = LowerValue(key, name, &found);
+  if (found && value) {
+    *value = Value(key, static_cast<uint32_t>(position));
+  }
+  return found;
+}
+
+void VirtualHive::SetValue(uint32_t key, std::wstring_view name, uint32_t type, const uint8_t* data, size_t size) {
+  ValueRecord record;
+  record.name = Intern(name);
+  record.type = type;
+  record.size = static_cast<uint32_t>(size);
+  bool found = false;
+  size_t position = LowerValue(key, name, &found);
+  ValueRecord* existing = found ? &values_[keys_[key].values + position] : nullptr;
+  if (existing && size <= existing->size) {
+    record.data = existing->data;
+  } else {
+    record.data = blobs_.size();
+    blobs_.resize(blobs_.size() + size);
+  }
+  if (size) {
+    memcpy(blobs_.data() + record.data, data, size);
+  }
+  if (found) {
+    values_[keys_[key].values + position] = record;
+    return;
+  }
+  KeyRecord& target = keys_[key];
+  InsertIntoRange(&values_, &target.values, &target.value_count, &target.value_capacity, position, record);
+}
+
+bool VirtualHive::DeleteValue(uint32_t key, std::wstring_view name) {
+  bool found = false;
+  size_t position = LowerValue(key, name, &found);
+  if (!found) {
+    return false;
+  }
+  KeyRecord& target = keys_[key];
+  EraseFromRange(&values_, target.values, &target.value_count, position);
+  return true;
+}
+
+bool VirtualHive::RenameValue(uint32_t key, std::wstring_view old_name, std::wstring_view new_name) {
+  bool found = false;
+  size_t position = LowerValue(key, old_name, &found);
+  if (!found || (CompareFolded(old_name, new_name) != 0 && FindValue(key, new_name, nullptr))) {
+    return false;
+  }
+  ValueRecord record = values_[keys_[key].values + position];
+  KeyRecord& target = keys_[key];
+  EraseFromRange(&values_, target.values, &target.value_count, position);
+  record.name = Intern(new_name);
+  position = LowerValue(key, new_name, &found);
+  KeyRecord& renamed = keys_[key];
+  InsertIntoRange(&values_, &renamed.values, &renamed.value_count, &renamed.value_capacity, position, record);
+  return true;
+}
+
+void VirtualHive::Merge(const VirtualHive& source, std::vector<uint32_t>* remap) {
+  if (remap) {
+    remap->assign(source.keys_.size(), kNoKey);
+  }
+  MergeKey(root(), source, source.root(), remap);
+}
+
+void VirtualHive::Compact(std::vector<uint32_t>* remap) {
+  size_t key_count = 0;
+  size_t value_count = 0;
+  size_t blob_bytes = 0;
+  std::vector<uint32_t> pending = {root()};
+  while (!pending.empty()) {
+    uint32_t key = pending.back();
+    pending.pop_back();
+    const KeyRecord& record = keys_[key];
+    ++key_count;
+    value_count += record.value_count;
+    for (uint32_t i = 0; i < record.value_count; ++i) {
+      blob_bytes += values_[record.values + i].size;
+    }
+    for (uint32_t i = 0; i < record.child_count; ++i) {
+      pending.push_back(links_[record.children + i]);
+    }
+  }
+
+  std::vector<KeyRecord> keys;
+  std::vector<uint32_t> links;
+  std::vector<ValueRecord> values;
+  std::vector<uint8_t> blobs;
+  keys.reserve(key_count);
+  links.reserve(key_count);
+  values.reserve(value_count);
+  blobs.reserve(blob_bytes);
+  std::vector<uint32_t> order;
+  order.reserve(key_count);
+  order.push_back(root());
+  keys.push_back(keys_[root()]);
+  if (remap) {
+    remap->assign(keys_.size(), kNoKey);
+  }
+  for (size_t next = 0; next < order.size(); ++next) {
+    if (remap) {
+      (*remap)[order[next]] = static_cast<uint32_t>(next);
+    }
+    const KeyRecord& old = keys_[order[next]];
+    KeyRecord& record = keys[next];
+    record.values = static_cast<uint32_t>(values.size());
+    record.value_capacity = old.value_count;
+    for (uint32_t i = 0; i < old.value_count; ++i) {
+      ValueRecord value = values_[old.values + i];
+      const uint8_t* data = blobs_.data() + value.data;
+      value.data = blobs.size();
+      blobs.insert(blobs.end(), data, data + value.size);
+      values.push_back(value);
+    }
+    record.children = static_cast<uint32_t>(links.size());
+    record.child_capacity = old.child_count;
+    for (uint32_t i = 0; i < old.child_count; ++i) {
+      uint32_t child = links_[old.children + i];
+      links.push_back(static_cast<uint32_t>(keys.size()));
+      order.push_back(child);
+      keys.push_back(keys_[child]);
+    }
+  }
+  ForgetCreatedPath();
+  keys_ = std::move(keys);
+  links_ = std::move(links);
+  values_ = std::move(values);
+  blobs_ = std::move(blobs);
+}
+
+uint32_t VirtualHive::Intern(std::wstring_view name) {
+  if ((names_.size() + 1) * 2 > name_slots_.size()) {
+    GrowNameSlots();
+  }
+  uint32_t hash = HashName(name);
+  size_t mask = name_slots_.size() - 1;
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    uint32_t entry = name_slots_[slot];
+    if (entry == 0) {
+      NameRecord record;
+      record.offset = static_cast<uint32_t>(name_pool_.size());
+      record.length = static_cast<uint32_t>(name.size());
+      record.hash = hash;
+      name_pool_.append(name);
+      names_.push_back(record);
+      name_slots_[slot] = static_cast<uint32_t>(names_.size());
+      return static_cast<uint32_t>(names_.size() - 1);
+    }
+    if (names_[entry - 1].hash == hash && Name(entry - 1) == name) {
+      return entry - 1;
+    }
+  }
+}
+
+void VirtualHive::GrowNameSlots() {
+  std::vector<uint32_t> slots(std::max(kMinNameSlots, name_slots_.size() * 2), 0);
+  size_t mask = slots.size() - 1;
+  for (size_t i = 0; i < names_.size(); ++i) {
+    size_t slot = names_[i].hash & mask;
+    while (slots[slot] != 0) {
+      slot = (slot + 1) & mask;
+    }
+    slots[slot] = static_cast<uint32_t>(i + 1);
+  }
+  name_slots_ = std::move(slots);
+}
+
+size_t VirtualHive::LowerSubkey(uint32_t key, std::wstring_view name, bool* found) const {
+  const KeyRecord& record = keys_[key];
+  const uint32_t* begin = links_.data() + record.children;
+  const uint32_t* end = begin + record.child_count;
+  if (begin == end || CompareFolded(KeyName(end[-1]), name) < 0) {
+    *found = false;
+    return record.child_count;
+  }
+  const uint32_t* it = std::lower_bound(begin, end, name, [&](uint32_t child, std::wstring_view text) { return CompareFolded(KeyName(child), text) < 0; });
+  *found = it != end && CompareFolded(KeyName(*it), name) == 0;
+  return static_cast<size_t>(it - begin);
+}
+
+size_t VirtualHive::LowerValue(uint32_t key, std::wstring_view name, bool* found) const {
+  const KeyRecord& record = keys_[key];
+  const ValueRecord* begin = values_.data() + record.values;
+  const ValueRecord* end = begin + record.value_count;
+  if (begin == end || CompareFolded(Name(end[-1].name), name) < 0) {
+    *found = false;
+    return record.value_count;
+  }
+  const ValueRecord* it = std::lower_bound(begin, end, name, [&](const ValueRecord& value, std::wstring_view text) { return CompareFolded(Name(value.name), text) < 0; });
+  *found = it != end && CompareFolded(Name(it->name), name) == 0;
+  return static_cast<size_t>(it - begin);
+}
+
+void VirtualHive::ForgetCreatedPath() {
+  created_path_.clear();
+  created_keys_.clear();
+}
+
+void VirtualHive::MergeKey(uint32_t target, const VirtualHive& source, uint32_t key, std::vector<uint32_t>* remap) {
+  if (remap) {
+    (*remap)[key] = target;
+  }
+  for (uint32_t i = 0; i < source.ValueCount(key); ++i) {
+    VirtualHiveValue value = source.Value(key, i);
+    SetValue(target, value.name, value.type, value.data, value.size);
+  }
+  for (uint32_t i = 0; i < source.SubkeyCount(key); ++i) {
+    uint32_t child = source.Subkey(key, i);
+    MergeKey(CreateSubkey(target, source.KeyName(child)), source, child, remap);
+  }
+}
+
+} // namespace regkit
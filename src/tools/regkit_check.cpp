@@ -0,0 +1,90 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "registry/hive_check.h"
+
+namespace {
+
+constexpr int kExitClean = 0;
+constexpr int kExitIssues = 1;
+constexpr int kExitError = 2;
+
+std::string ToUtf8(const std::filesystem::path& path) {
+  std::u8string text = path.u8string();
+  return std::string(text.begin(), text.end());
+}
+
+std::string ToUtf8(const std::wstring& text) {
+  return ToUtf8(std::filesystem::path(text));
+}
+
+template <typename Char>
+int Run(int argc, Char** argv) {
+  unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::filesystem::path> paths;
+  for (int i = 1; i < argc; ++i) {
+    std::filesystem::path arg(argv[i]);
+    std::string text = ToUtf8(arg);
+    if ((text == "--threads" || text == "-j") && i + 1 < argc) {
+      threads = static_cast<unsigned int>(std::max(1l, std::strtol(ToUtf8(std::filesystem::path(argv[++i])).c_str(), nullptr, 10)));
+    } else if (text == "--help" || text == "-h") {
+      std::cout << "usage: regkit-check [--threads N] <hive>...\n";
+      return kExitClean;
+    } else {
+      paths.push_back(std::move(arg));
+    }
+  }
+  if (paths.empty()) {
+    std::cerr << "usage: regkit-check [--threads N] <hive>...\n";
+    return kExitError;
+  }
+
+  int status = kExitClean;
+  for (const auto& path : paths) {
+    regkit::HiveCheckReport report;
+    std::wstring error;
+    if (!regkit::CheckHiveFile(path, threads, nullptr, &report, &error)) {
+      regkit::WriteHiveCheckErrorJson(std::cout, ToUtf8(path), ToUtf8(error));
+      status = kExitError;
+      continue;
+    }
+    regkit::WriteHiveCheckJson(std::cout, ToUtf8(path), report);
+    if (!report.ok() && status == kExitClean) {
+      status = kExitIssues;
+    }
+  }
+  return status;
+}
+
+} // namespace
+
+#ifdef _WIN32
+int wmain(int argc, wchar_t** argv) {
+  return Run(argc, argv);
+}
+#else
+int main(int argc, char** argv) {
+  return Run(argc, argv);
+}
+#endif
@@ -0,0 +1,129 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "registry/compiled_regex.h"
+#include "test_support.h"
+
+using namespace regkit;
+
+namespace {
+
+uint32_t g_seed = 0x2545F491u;
+
+uint32_t Next() {
+  g_seed = g_seed * 1664525u + 1013904223u;
+  return g_seed >> 8;
+}
+
+std::wstring RandomText(size_t length) {
+  static const wchar_t kAlphabet[] = L"abcABCxyz019_ -.\\";
+  std::wstring text;
+  for (size_t i = 0; i < length; ++i) {
+    text.push_back(kAlphabet[Next() % (sizeof(kAlphabet) / sizeof(kAlphabet[0]) - 1)]);
+  }
+  return text;
+}
+
+bool SameAsStd(const std::wstring& pattern, bool match_case, const std::wstring& text) {
+  CompiledRegex compiled;
+  if (!compiled.Compile(pattern, match_case)) {
+    return false;
+  }
+  auto flags = std::regex_constants::ECMAScript;
+  if (!match_case) {
+    flags |= std::regex_constants::icase;
+  }
+  std::wregex regex(pattern, flags);
+
+  std::wsmatch expected;
+  RegexMatch actual;
+  bool found = std::regex_search(text, expected, regex);
+  if (compiled.Search(text, &actual) != found) {
+    return false;
+  }
+  if (found && (actual.start != static_cast<size_t>(expected.position(0)) || actual.length != static_cast<size_t>(expected.length(0)))) {
+    return false;
+  }
+  bool whole = std::regex_match(text, expected, regex);
+  if (compiled.MatchWhole(text, &actual) != whole) {
+    return false;
+  }
+  return !whole || (actual.start == 0 && actual.length == text.size());
+}
+
+} // namespace
+
+int main() {
+  const std::vector<std::wstring> patterns = {
+      L"abc",
+      L"a.c",
+      L"a|b|c",
+      L"ab|abc",
+      L"(ab|a)(bc|c)?",
+      L"a+",
+      L"a*?b",
+      L"a+?",
+      L"[a-c]+x",
+      L"[^abc]+",
+      L"\\d{2,3}",
+      L"\\w+\\s",
+      L"\\bab",
+      L"c\\B",
+      L"^a",
+      L"z$",
+      L"(?:ab){2}",
+      L"x{0,2}y",
+      L"[A-C_]{2}",
+      L"\\\\x",
+      L"\\.-",
+      L"(a|b)*c",
+      L"B[Cc]a",
+      L"a(b|c)*?c",
+  };
+  for (const auto& pattern : patterns) {
+    for (int round = 0; round < 200; ++round) {
+      std::wstring text = RandomText(Next() % 24);
+      for (bool match_case : {true, false}) {
+        if (!SameAsStd(pattern, match_case, text)) {
+          std::fprintf(stderr, "mismatch: /%ls/ %s on \"%ls\"\n", pattern.c_str(), match_case ? "case" : "nocase", text.c_str());
+          ++regkit::test::g_failures;
+        }
+      }
+    }
+    REGKIT_CHECK(SameAsStd(pattern, true, L""));
+    REGKIT_CHECK(SameAsStd(pattern, false, L"ABCABC"));
+  }
+
+  for (const wchar_t* pattern : {L"(a)\\1", L"a(?=b)", L"a(?!b)", L"(a*)*", L"(a|)+", L"(?<n>a)"}) {
+    CompiledRegex compiled;
+    REGKIT_CHECK(!compiled.Compile(pattern, true));
+    REGKIT_CHECK(!compiled.compiled());
+  }
+  for (const wchar_t* pattern : {L"(a)\\1", L"a(?=b)", L"(a*)*"}) {
+    bool accepted = true;
+    try {
+      std::wregex regex(pattern, std::regex_constants::ECMAScript);
+    } catch (const std::regex_error&) {
+      accepted = false;
+    }
+    REGKIT_CHECK(accepted);
+  }
+  return regkit::test::Finish("compiled_regex_test");
+}
@@ -0,0 +1,115 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+// Not registered with ctest. hex_bytes_bench uses the library's decoder
+// (SSE2 where available); hex_bytes_bench_scalar is the same source linked
+// against a build of hex_bytes.cpp with REGKIT_HEX_SCALAR defined.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "registry/hex_bytes.h"
+#include "registry/reg_file_tokenizer.h"
+
+using namespace regkit;
+
+namespace {
+
+#if !defined(REGKIT_HEX_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+constexpr const char* kPath = "sse2";
+#else
+constexpr const char* kPath = "scalar";
+#endif
+
+std::wstring BuildPayload(size_t values, size_t bytes_per_value) {
+  std::wstring text = L"Windows Registry Editor Version 5.00\r\n\r\n[HKEY_CURRENT_USER\\Software\\RegKitBench]\r\n";
+  wchar_t pair[8] = {};
+  for (size_t v = 0; v < values; ++v) {
+    text += L"\"Blob" + std::to_wstring(v) + L"\"=hex:";
+    for (size_t i = 0; i < bytes_per_value; ++i) {
+      swprintf(pair, 8, i + 1 < bytes_per_value ? L"%02x," : L"%02x", static_cast<unsigned>((v * 31 + i * 7) & 0xFF));
+      text += pair;
+      if (i % 25 == 24 && i + 1 < bytes_per_value) {
+        text += L"\\\r\n  ";
+      }
+    }
+    text += L"\r\n";
+  }
+  return text;
+}
+
+template <typename Body>
+double Measure(Body&& body) {
+  double best = 0.0;
+  for (int run = 0; run < 5; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    best = run == 0 ? seconds : std::min(best, seconds);
+  }
+  return best;
+}
+
+} // namespace
+
+int main() {
+  constexpr size_t kExpected = 4096u * 2048u;
+  std::wstring payload = BuildPayload(4096, 2048);
+  std::vector<std::wstring_view> hex;
+  RegFileTokenizer collect(payload);
+  RegFileToken token;
+  while (collect.Next(&token)) {
+    if (token.kind == RegFileTokenKind::kValue && token.data.starts_with(L"hex:")) {
+      hex.push_back(token.data.substr(4));
+    }
+  }
+
+  std::vector<uint8_t> data;
+  std::wstring scratch;
+  size_t parsed = 0;
+  double parse_seconds = Measure([&] {
+    parsed = 0;
+    RegFileTokenizer tokenizer(payload);
+    while (tokenizer.Next(&token)) {
+      uint32_t type = 0;
+      if (token.kind == RegFileTokenKind::kValue && ParseRegFileValueData(token.data, &type, &data, &scratch)) {
+        parsed += data.size();
+      }
+    }
+  });
+  size_t decoded = 0;
+  size_t hex_units = 0;
+  double hex_seconds = Measure([&] {
+    decoded = 0;
+    hex_units = 0;
+    for (std::wstring_view text : hex) {
+      if (ParseHexBytes(text, &data)) {
+        decoded += data.size();
+      }
+      hex_units += text.size();
+    }
+  });
+  if (parsed != kExpected || decoded != kExpected) {
+    std::fprintf(stderr, "hex_bytes_bench: decoded %zu/%zu bytes, expected %zu\n", parsed, decoded, kExpected);
+    return 1;
+  }
+  double reg_megabytes = payload.size() * sizeof(wchar_t) / (1024.0 * 1024.0);
+  double hex_megabytes = hex_units * sizeof(wchar_t) / (1024.0 * 1024.0);
+  std::printf("%s: .reg parse %.1f MB/s, hex decode %.1f MB/s\n", kPath, reg_megabytes / std::max(parse_seconds, 1e-9), hex_megabytes / std::max(hex_seconds, 1e-9));
+  return 0;
+}
@@ -0,0 +1,84 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "registry/hex_bytes.h"
+#include "test_support.h"
+
+using namespace regkit;
+
+namespace {
+
+bool ReferenceHexBytes(std::wstring_view text, std::vector<uint8_t>* out) {
+  out->clear();
+  int pending = -1;
+  for (wchar_t ch : text) {
+    int value = -1;
+    if (ch >= L'0' && ch <= L'9') {
+      value = ch - L'0';
+    } else if (ch >= L'a' && ch <= L'f') {
+      value = 10 + (ch - L'a');
+    } else if (ch >= L'A' && ch <= L'F') {
+      value = 10 + (ch - L'A');
+    }
+    if (value < 0) {
+      continue;
+    }
+    if (pending < 0) {
+      pending = value;
+    } else {
+      out->push_back(static_cast<uint8_t>((pending << 4) | value));
+      pending = -1;
+    }
+  }
+  return pending < 0;
+}
+
+} // namespace
+
+int main() {
+  const wchar_t kAlphabet[] = L"0123456789abcdefABCDEFgG,, \\\r\n\t:x/@`\x0130\x0660\xFF10\xFF21\x2030";
+  std::mt19937 rng(0x5EED);
+  std::uniform_int_distribution<size_t> pick(0, sizeof(kAlphabet) / sizeof(wchar_t) - 2);
+  std::uniform_int_distribution<size_t> length(0, 300);
+  std::vector<uint8_t> actual;
+  std::vector<uint8_t> expected;
+  for (int round = 0; round < 20000; ++round) {
+    std::wstring text(length(rng), L' ');
+    for (wchar_t& ch : text) {
+      ch = kAlphabet[pick(rng)];
+    }
+    bool ok = ParseHexBytes(text, &actual);
+    bool reference = ReferenceHexBytes(text, &expected);
+    REGKIT_CHECK(ok == reference);
+    REGKIT_CHECK(actual == expected);
+  }
+
+  std::wstring clean;
+  for (int i = 0; i < 64; ++i) {
+    wchar_t pair[4] = {};
+    swprintf(pair, 4, L"%02x,", i * 4);
+    clean += pair;
+  }
+  REGKIT_CHECK(ParseHexBytes(clean, &actual) && ReferenceHexBytes(clean, &expected) && actual == expected);
+  REGKIT_CHECK(ParseHexBytes(L"00112233445566778899aabbccddeeff", &actual) && actual.size() == 16 && actual[15] == 0xFF);
+  REGKIT_CHECK(!ParseHexBytes(L"0", &actual));
+  REGKIT_CHECK(ParseHexBytes(L"", &actual) && actual.empty());
+  return regkit::test::Finish("hex_bytes_test");
+}
@@ -0,0 +1,161 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/hive_carver.h"
+#include "registry/hive_reader.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+constexpr size_t kBaseBlockSize = 4096;
+
+uint32_t Read32(const uint8_t* data) {
+  uint32_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void FreeCell(std::vector<uint8_t>* image, uint32_t cell) {
+  uint8_t* header = image->data() + kBaseBlockSize + cell;
+  int32_t size = static_cast<int32_t>(Read32(header));
+  if (size < 0) {
+    size = -size;
+    memcpy(header, &size, sizeof(size));
+  }
+}
+
+uint32_t DataCell(const HiveReader& reader, const HiveValue& value) {
+  return Read32(reader.Cell(value.cell, nullptr) + 0x08);
+}
+
+const CarvedKey* FindCarvedKey(const HiveCarveResult& result, std::wstring_view name) {
+  for (const CarvedKey& key : result.keys) {
+    if (key.name == name) {
+      return &key;
+    }
+  }
+  return nullptr;
+}
+
+const CarvedValue* FindCarvedValue(const HiveCarveResult& result, const CarvedKey& key, std::wstring_view name) {
+  for (uint32_t index : key.values) {
+    if (result.values[index].name == name) {
+      return &result.values[index];
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+int main() {
+  std::vector<uint8_t> cell_data(100);
+  for (size_t i = 0; i < cell_data.size(); ++i) {
+    cell_data[i] = static_cast<uint8_t>(i * 7 + 1);
+  }
+  HiveImageBuilder builder;
+  uint32_t software = builder.AddKey(HiveImageBuilder::kRoot, "Software");
+  uint32_t vendor = builder.AddKey(software, "Vendor");
+  uint32_t gone = builder.AddKey(software, "Gone");
+  builder.AddKey(HiveImageBuilder::kRoot, "System");
+  builder.AddValue(vendor, "Live", 4, {1, 2, 3, 4});
+  builder.AddValue(vendor, "Dropped", 3, {5, 6, 7, 8, 9});
+  builder.AddValue(gone, "Resident", 4, {0x78, 0x56, 0x34, 0x12});
+  builder.AddValue(gone, "Cell", 3, cell_data);
+  builder.AddValue(gone, "Reused", 3, std::vector<uint8_t>(40, 0xAB));
+  builder.AddValue(gone, "", 1, {});
+  std::vector<uint8_t> image = builder.Build();
+
+  std::filesystem::path path = TempPath("carver.hiv");
+  REGKIT_CHECK(WriteBytes(path, image));
+  HiveReader reader;
+  std::wstring error;
+  REGKIT_CHECK(reader.Open(path, &error));
+  HiveCarveResult result;
+  REGKIT_CHECK(CarveHive(reader, 2, nullptr, &result));
+  REGKIT_CHECK(result.keys.empty() && result.values.empty() && result.security.empty());
+  REGKIT_CHECK(result.scanned_bytes < reader.bins_size());
+
+  HiveValue value;
+  std::vector<uint32_t> freed = {builder.KeyCell(gone)};
+  REGKIT_CHECK(IsLiveHiveCell(reader, builder.KeyCell(gone)));
+  REGKIT_CHECK(reader.FindValue(builder.KeyCell(gone), L"Resident", &value));
+  freed.push_back(value.cell);
+  REGKIT_CHECK(reader.FindValue(builder.KeyCell(gone), L"Cell", &value));
+  freed.push_back(value.cell);
+  freed.push_back(DataCell(reader, value));
+  REGKIT_CHECK(reader.FindValue(builder.KeyCell(gone), L"Reused", &value));
+  freed.push_back(value.cell);
+  REGKIT_CHECK(reader.FindValue(builder.KeyCell(gone), L"", &value));
+  freed.push_back(value.cell);
+  REGKIT_CHECK(reader.FindValue(builder.KeyCell(vendor), L"Dropped", &value));
+  freed.push_back(value.cell);
+  uint32_t dropped = value.cell;
+  reader.Close();
+  for (uint32_t cell : freed) {
+    FreeCell(&image, cell);
+  }
+  REGKIT_CHECK(WriteBytes(path, image));
+  REGKIT_CHECK(reader.Open(path, &error));
+  REGKIT_CHECK(!IsLiveHiveCell(reader, builder.KeyCell(gone)));
+  REGKIT_CHECK(IsLiveHiveCell(reader, builder.KeyCell(vendor)));
+
+  for (unsigned int threads : {1u, 2u, 8u}) {
+    REGKIT_CHECK(CarveHive(reader, threads, nullptr, &result));
+    REGKIT_CHECK(result.keys.size() == 1 && result.values.size() == 5);
+    const CarvedKey* key = FindCarvedKey(result, L"Gone");
+    REGKIT_CHECK(key != nullptr);
+    if (!key) {
+      continue;
+    }
+    REGKIT_CHECK(key->cell == builder.KeyCell(gone));
+    REGKIT_CHECK(key->parent == builder.KeyCell(software));
+    REGKIT_CHECK(key->value_count == 4 && key->values.size() == 4);
+    REGKIT_CHECK(key->last_write == 0x01D0000000000000ull + gone);
+
+    const CarvedValue* carved = FindCarvedValue(result, *key, L"Resident");
+    REGKIT_CHECK(carved && carved->type == 4 && carved->data_recovered && carved->data == std::vector<uint8_t>({0x78, 0x56, 0x34, 0x12}));
+    carved = FindCarvedValue(result, *key, L"Cell");
+    REGKIT_CHECK(carved && carved->data_recovered && carved->data == cell_data);
+    carved = FindCarvedValue(result, *key, L"Reused");
+    REGKIT_CHECK(carved && carved->data_size == 40 && !carved->data_recovered && carved->data.empty());
+    carved = FindCarvedValue(result, *key, L"");
+    REGKIT_CHECK(carved && carved->type == 1 && carved->data_recovered && carved->data_size == 0);
+
+    REGKIT_CHECK(result.orphan_values.size() == 1);
+    if (result.orphan_values.size() == 1) {
+      const CarvedValue& orphan = result.values[result.orphan_values[0]];
+      REGKIT_CHECK(orphan.cell == dropped && orphan.name == L"Dropped");
+    }
+    REGKIT_CHECK(std::is_sorted(result.values.begin(), result.values.end(), [](const CarvedValue& left, const CarvedValue& right) { return left.cell < right.cell; }));
+  }
+
+  std::atomic_bool cancel(true);
+  REGKIT_CHECK(!CarveHive(reader, 2, &cancel, &result));
+  reader.Close();
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  return Finish("hive_carver_test");
+}
@@ -0,0 +1,175 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/hive_check.h"
+#include "registry/hive_log.h"
+#include "registry/hive_reader.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+constexpr size_t kBaseBlockSize = 4096;
+
+uint32_t Read32(const std::vector<uint8_t>& image, size_t offset) {
+  uint32_t value = 0;
+  memcpy(&value, image.data() + offset, sizeof(value));
+  return value;
+}
+
+void Put32(std::vector<uint8_t>* image, size_t offset, uint32_t value) {
+  memcpy(image->data() + offset, &value, sizeof(value));
+}
+
+size_t Record(uint32_t cell) {
+  return kBaseBlockSize + cell + 4;
+}
+
+HiveCheckReport Check(const std::vector<uint8_t>& image, unsigned int threads = 2) {
+  HiveCheckReport report;
+  REGKIT_CHECK(CheckHiveImage(image.data(), image.size(), threads, nullptr, &report));
+  return report;
+}
+
+bool HasIssue(const HiveCheckReport& report, HiveIssueKind kind, const char* detail) {
+  for (const HiveIssue& issue : report.issues) {
+    if (issue.kind == kind && strcmp(issue.detail, detail) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+int main() {
+  HiveImageBuilder builder;
+  uint32_t software = builder.AddKey(HiveImageBuilder::kRoot, "Software");
+  uint32_t vendor = builder.AddKey(software, "Vendor");
+  builder.AddKey(software, "alpha");
+  builder.AddKey(HiveImageBuilder::kRoot, "System");
+  builder.AddValue(vendor, "Small", 4, {1, 2, 3, 4});
+  builder.AddValue(vendor, "Cell", 3, std::vector<uint8_t>(100, 7));
+  builder.AddValue(vendor, "Big", 3, std::vector<uint8_t>(40000, 9));
+  std::vector<uint8_t> image = builder.Build();
+
+  HiveCheckReport clean = Check(image, 1);
+  REGKIT_CHECK(clean.ok() && !clean.dirty);
+  REGKIT_CHECK(clean.hbin_count == 1 && clean.key_count == 5 && clean.value_count == 3 && clean.security_count == 1);
+  REGKIT_CHECK(clean.file_size == image.size() && clean.bins_size + kBaseBlockSize == image.size());
+  for (unsigned int threads : {2u, 3u, 16u}) {
+    HiveCheckReport report = Check(image, threads);
+    REGKIT_CHECK(report.ok() && report.cell_count == clean.cell_count && report.key_count == clean.key_count && report.value_count == clean.value_count);
+  }
+
+  std::vector<uint8_t> corrupt = image;
+  uint32_t primary = 7;
+  uint32_t secondary = 6;
+  memcpy(corrupt.data() + 0x04, &primary, sizeof(primary));
+  memcpy(corrupt.data() + 0x08, &secondary, sizeof(secondary));
+  Put32(&corrupt, kHiveBaseBlockChecksumOffset, HiveBaseBlockChecksum(corrupt.data()));
+  HiveCheckReport report = Check(corrupt);
+  REGKIT_CHECK(report.ok() && report.dirty);
+
+  corrupt = image;
+  corrupt[0x70] ^= 0x01;
+  report = Check(corrupt);
+  REGKIT_CHECK(report.issues.size() == 1 && HasIssue(report, HiveIssueKind::kBaseBlock, "base block checksum mismatch"));
+
+  corrupt = image;
+  Put32(&corrupt, 0x18, 9);
+  Put32(&corrupt, kHiveBaseBlockChecksumOffset, HiveBaseBlockChecksum(corrupt.data()));
+  REGKIT_CHECK(HasIssue(Check(corrupt), HiveIssueKind::kBaseBlock, "minor version is unsupported"));
+
+  report = Check(std::vector<uint8_t>(image.begin(), image.begin() + 100));
+  REGKIT_CHECK(HasIssue(report, HiveIssueKind::kBaseBlock, "file is smaller than a base block"));
+
+  corrupt = image;
+  memcpy(corrupt.data() + kBaseBlockSize, "xbin", 4);
+  report = Check(corrupt);
+  REGKIT_CHECK(HasIssue(report, HiveIssueKind::kHbinHeader, "hbin signature is missing"));
+  REGKIT_CHECK(HasIssue(report, HiveIssueKind::kBaseBlock, "root cell is not a key node"));
+  REGKIT_CHECK(report.hbin_count == 0 && report.cell_count == 0);
+
+  uint32_t vendor_cell = builder.KeyCell(vendor);
+  corrupt = image;
+  Put32(&corrupt, kBaseBlockSize + vendor_cell, Read32(image, kBaseBlockSize + vendor_cell) - 4);
+  report = Check(corrupt);
+  REGKIT_CHECK(HasIssue(report, HiveIssueKind::kCellSize, "cell size is invalid"));
+  REGKIT_CHECK(report.issues.front().offset <= kBaseBlockSize + vendor_cell);
+
+  uint32_t list = Read32(image, Record(builder.KeyCell(software)) + 0x1C);
+  REGKIT_CHECK(Read32(image, Record(list)) == 2u << 16 | 'l' | 'h' << 8);
+  corrupt = image;
+  for (size_t i = 0; i < 8; ++i) {
+    std::swap(corrupt[Record(list) + 4 + i], corrupt[Record(list) + 12 + i]);
+  }
+  report = Check(corrupt);
+  REGKIT_CHECK(report.issues.size() == 1 && HasIssue(report, HiveIssueKind::kSubkeyOrder, "subkeys are out of order"));
+
+  corrupt = image;
+  Put32(&corrupt, Record(list) + 8, Read32(image, Record(list) + 8) + 1);
+  REGKIT_CHECK(HasIssue(Check(corrupt), HiveIssueKind::kSubkeyList, "lh hash does not match the key name"));
+
+  corrupt = image;
+  Put32(&corrupt, Record(vendor_cell) + 0x10, builder.KeyCell(HiveImageBuilder::kRoot));
+  REGKIT_CHECK(HasIssue(Check(corrupt), HiveIssueKind::kSubkeyList, "subkey parent does not point back"));
+
+  corrupt = image;
+  Put32(&corrupt, Record(vendor_cell) + 0x14, 3);
+  REGKIT_CHECK(HasIssue(Check(corrupt), HiveIssueKind::kSubkeyList, "subkey count does not match the list"));
+
+  std::filesystem::path path = TempPath("check.hiv");
+  REGKIT_CHECK(WriteBytes(path, image));
+  HiveReader reader;
+  std::wstring error;
+  REGKIT_CHECK(reader.Open(path, &error));
+  HiveValue value;
+  REGKIT_CHECK(reader.FindValue(vendor_cell, L"Cell", &value));
+  uint32_t value_cell = value.cell;
+  reader.Close();
+  corrupt = image;
+  Put32(&corrupt, Record(value_cell) + 0x08, 0x7FFFFFF8);
+  report = Check(corrupt);
+  REGKIT_CHECK(report.issues.size() == 1 && HasIssue(report, HiveIssueKind::kValueData, "value data is not an allocated cell"));
+  REGKIT_CHECK(report.issues.front().cell == value_cell && report.issues.front().offset == kBaseBlockSize + value_cell);
+
+  REGKIT_CHECK(WriteBytes(path, corrupt));
+  REGKIT_CHECK(CheckHiveFile(path, 4, nullptr, &report, &error));
+  REGKIT_CHECK(!report.ok() && report.recovery == HiveRecoveryState::kClean);
+  std::ostringstream json;
+  WriteHiveCheckJson(json, "C:\\hives\\\"NTUSER\".DAT", report);
+  REGKIT_CHECK(json.str().find("\"source\":\"C:\\\\hives\\\\\\\"NTUSER\\\".DAT\",\"ok\":false,\"dirty\":false,\"recovery\":\"clean\"") != std::string::npos);
+  REGKIT_CHECK(json.str().find("\"cell\":" + std::to_string(value_cell) + ",\"check\":\"value_data\",\"detail\":\"value data is not an allocated cell\"") != std::string::npos);
+  json.str("");
+  WriteHiveCheckErrorJson(json, "a.dat", "not found");
+  REGKIT_CHECK(json.str() == "{\"source\":\"a.dat\",\"ok\":false,\"error\":\"not found\"}\n");
+
+  std::atomic_bool cancel(true);
+  REGKIT_CHECK(!CheckHiveImage(image.data(), image.size(), 2, &cancel, &report));
+  REGKIT_CHECK(!CheckHiveFile(path, 2, &cancel, &report, &error) && !error.empty());
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  return Finish("hive_check_test");
+}
@@ -0,0 +1,321 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "hive_fixture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "registry/hive_log.h"
+
+namespace regkit::test {
+
+namespace {
+
+constexpr uint32_t kNoCell = 0xFFFFFFFFu;
+constexpr uint32_t kBaseBlockSize = 4096;
+constexpr uint32_t kHbinHeaderSize = 32;
+constexpr uint32_t kPageSize = 4096;
+constexpr uint32_t kBigDataSegmentSize = 16344;
+constexpr uint64_t kLogEntrySeed = 0x82EF4D887A4E55C5ull;
+constexpr uint32_t kLogEntryHeaderSize = 40;
+
+void Write16(uint8_t* data, uint16_t value) {
+  memcpy(data, &value, sizeof(value));
+}
+
+void Write32(uint8_t* data, uint32_t value) {
+  memcpy(data, &value, sizeof(value));
+}
+
+void Write64(uint8_t* data, uint64_t value) {
+  memcpy(data, &value, sizeof(value));
+}
+
+uint32_t Read32(const uint8_t* data) {
+  uint32_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+std::string Upper(std::string_view text) {
+  std::string out(text);
+  for (char& ch : out) {
+    if (ch >= 'a' && ch <= 'z') {
+      ch = static_cast<char>(ch - 'a' + 'A');
+    }
+  }
+  return out;
+}
+
+class CellHeap {
+public:
+  CellHeap() : bins_(kHbinHeaderSize, 0) {}
+
+  uint32_t Allocate(uint32_t size) {
+    uint32_t cell_size = (size + 4 + 7) & ~7u;
+    uint32_t offset = static_cast<uint32_t>(bins_.size());
+    bins_.resize(bins_.size() + cell_size, 0);
+    Write32(bins_.data() + offset, static_cast<uint32_t>(-static_cast<int32_t>(cell_size)));
+    return offset;
+  }
+
+  uint8_t* Record(uint32_t cell) { return bins_.data() + cell + 4; }
+
+  std::vector<uint8_t> Finish() {
+    uint32_t used = static_cast<uint32_t>(bins_.size());
+    uint32_t hbin_size = (used + kPageSize - 1) / kPageSize * kPageSize;
+    bins_.resize(hbin_size, 0);
+    if (hbin_size > used) {
+      Write32(bins_.data() + used, hbin_size - used);
+    }
+    memcpy(bins_.data(), "hbin", 4);
+    Write32(bins_.data() + 4, 0);
+    Write32(bins_.data() + 8, hbin_size);
+    return std::move(bins_);
+  }
+
+private:
+  std::vector<uint8_t> bins_;
+};
+
+} // namespace
+
+HiveImageBuilder::HiveImageBuilder(uint32_t minor_version) : minor_version_(minor_version) {
+  keys_.push_back(Key{"ROOT", kNoCell, true, {}, {}});
+}
+
+uint32_t HiveImageBuilder::AddKey(uint32_t parent, std::string name) {
+  uint32_t index = static_cast<uint32_t>(keys_.size());
+  keys_.push_back(Key{std::move(name), parent, true, {}, {}});
+  keys_[parent].children.push_back(index);
+  return index;
+}
+
+uint32_t HiveImageBuilder::AddOrphanKey(uint32_t parent, std::string name) {
+  uint32_t index = static_cast<uint32_t>(keys_.size());
+  keys_.push_back(Key{std::move(name), parent, false, {}, {}});
+  return index;
+}
+
+void HiveImageBuilder::AddValue(uint32_t key, std::string name, uint32_t type, std::vector<uint8_t> data) {
+  keys_[key].values.push_back(Value{std::move(name), type, std::move(data)});
+}
+
+void HiveImageBuilder::SetValueData(uint32_t key, std::string_view name, std::vector<uint8_t> data) {
+  for (Value& value : keys_[key].values) {
+    if (value.name == name) {
+      value.data = std::move(data);
+    }
+  }
+}
+
+std::vector<uint8_t> HiveImageBuilder::Build(uint32_t sequence) const {
+  CellHeap heap;
+  const uint8_t descriptor[20] = {1, 0, 0x00, 0x80};
+  uint32_t sk = heap.Allocate(0x14 + sizeof(descriptor));
+  uint8_t* sk_record = heap.Record(sk);
+  memcpy(sk_record, "sk", 2);
+  Write32(sk_record + 0x04, sk);
+  Write32(sk_record + 0x08, sk);
+  Write32(sk_record + 0x0C, static_cast<uint32_t>(keys_.size()));
+  Write32(sk_record + 0x10, sizeof(descriptor));
+  memcpy(sk_record + 0x14, descriptor, sizeof(descriptor));
+
+  cells_.assign(keys_.size(), kNoCell);
+  for (size_t i = 0; i < keys_.size(); ++i) {
+    const Key& key = keys_[i];
+    uint32_t cell = heap.Allocate(0x4C + static_cast<uint32_t>(key.name.size()));
+    cells_[i] = cell;
+    uint8_t* nk = heap.Record(cell);
+    memcpy(nk, "nk", 2);
+    Write16(nk + 0x02, static_cast<uint16_t>(0x20 | (i == kRoot ? 0x04 : 0)));
+    Write64(nk + 0x04, 0x01D0000000000000ull + i);
+    Write32(nk + 0x10, i == kRoot ? kNoCell : cells_[key.parent]);
+    Write32(nk + 0x1C, kNoCell);
+    Write32(nk + 0x20, kNoCell);
+    Write32(nk + 0x28, kNoCell);
+    Write32(nk + 0x2C, sk);
+    Write32(nk + 0x30, kNoCell);
+    Write16(nk + 0x48, static_cast<uint16_t>(key.name.size()));
+    memcpy(nk + 0x4C, key.name.data(), key.name.size());
+  }
+
+  for (size_t i = 0; i < keys_.size(); ++i) {
+    const Key& key = keys_[i];
+    std::vector<uint32_t> children;
+    for (uint32_t child : key.children) {
+      if (keys_[child].listed) {
+        children.push_back(child);
+      }
+    }
+    std::sort(children.begin(), children.end(), [&](uint32_t left, uint32_t right) { return Upper(keys_[left].name) < Upper(keys_[right].name); });
+    if (!children.empty()) {
+      uint32_t list = heap.Allocate(4 + static_cast<uint32_t>(children.size()) * 8);
+      uint8_t* lh = heap.Record(list);
+      memcpy(lh, "lh", 2);
+      Write16(lh + 2, static_cast<uint16_t>(children.size()));
+      for (size_t c = 0; c < children.size(); ++c) {
+        uint32_t hash = 0;
+        for (char ch : Upper(keys_[children[c]].name)) {
+          hash = hash * 37 + static_cast<uint8_t>(ch);
+        }
+        Write32(lh + 4 + c * 8, cells_[children[c]]);
+        Write32(lh + 8 + c * 8, hash);
+      }
+      uint8_t* nk = heap.Record(cells_[i]);
+      Write32(nk + 0x14, static_cast<uint32_t>(children.size()));
+      Write32(nk + 0x1C, list);
+    }
+
+    if (key.values.empty()) {
+      continue;
+    }
+    std::vector<uint32_t> value_cells;
+    for (const Value& value : key.values) {
+      uint32_t vk_cell = heap.Allocate(0x14 + static_cast<uint32_t>(value.name.size()));
+      uint32_t size = static_cast<uint32_t>(value.data.size());
+      uint32_t data_field = 0;
+      uint32_t size_field = size;
+      if (size <= 4) {
+        memcpy(&data_field, value.data.data(), size);
+        size_field |= 0x80000000u;
+      } else if (minor_version_ >= 4 && size > kBigDataSegmentSize) {
+        uint32_t segments = (size + kBigDataSegmentSize - 1) / kBigDataSegmentSize;
+        uint32_t db = heap.Allocate(8);
+        uint32_t list = heap.Allocate(segments * 4);
+        for (uint32_t s = 0; s < segments; ++s) {
+          uint32_t length = std::min(kBigDataSegmentSize, size - s * kBigDataSegmentSize);
+          uint32_t segment = heap.Allocate(length);
+          memcpy(heap.Record(segment), value.data.data() + s * kBigDataSegmentSize, length);
+          Write32(heap.Record(list) + s * 4, segment);
+        }
+        uint8_t* header = heap.Record(db);
+        memcpy(header, "db", 2);
+        Write16(header + 2, static_cast<uint16_t>(segments));
+        Write32(header + 4, list);
+        data_field = db;
+      } else {
+        data_field = heap.Allocate(size);
+        memcpy(heap.Record(data_field), value.data.data(), size);
+      }
+      uint8_t* vk = heap.Record(vk_cell);
+      memcpy(vk, "vk", 2);
+      Write16(vk + 0x02, static_cast<uint16_t>(value.name.size()));
+      Write32(vk + 0x04, size_field);
+      Write32(vk + 0x08, data_field);
+      Write32(vk + 0x0C, value.type);
+      Write16(vk + 0x10, value.name.empty() ? 0 : 1);
+      memcpy(vk + 0x14, value.name.data(), value.name.size());
+      value_cells.push_back(vk_cell);
+    }
+    uint32_t list = heap.Allocate(static_cast<uint32_t>(value_cells.size()) * 4);
+    for (size_t v = 0; v < value_cells.size(); ++v) {
+      Write32(heap.Record(list) + v * 4, value_cells[v]);
+    }
+    uint8_t* nk = heap.Record(cells_[i]);
+    Write32(nk + 0x24, static_cast<uint32_t>(value_cells.size()));
+    Write32(nk + 0x28, list);
+  }
+
+  std::vector<uint8_t> bins = heap.Finish();
+  std::vector<uint8_t> image(kBaseBlockSize, 0);
+  uint8_t* base = image.data();
+  memcpy(base, "regf", 4);
+  Write32(base + 0x04, sequence);
+  Write32(base + 0x08, sequence);
+  Write32(base + 0x14, 1);
+  Write32(base + 0x18, minor_version_);
+  Write32(base + 0x20, 1);
+  Write32(base + 0x24, cells_[kRoot]);
+  Write32(base + 0x28, static_cast<uint32_t>(bins.size()));
+  Write32(base + 0x2C, 1);
+  Write32(base + kHiveBaseBlockChecksumOffset, HiveBaseBlockChecksum(base));
+  image.insert(image.end(), bins.begin(), bins.end());
+  return image;
+}
+
+std::vector<HiveLogPageImage> DirtyPages(const std::vector<uint8_t>& before, const std::vector<uint8_t>& after) {
+  std::vector<HiveLogPageImage> pages;
+  for (size_t offset = kBaseBlockSize; offset + kPageSize <= after.size(); offset += kPageSize) {
+    if (offset + kPageSize <= before.size() && memcmp(before.data() + offset, after.data() + offset, kPageSize) == 0) {
+      continue;
+    }
+    HiveLogPageImage page;
+    page.offset = static_cast<uint32_t>(offset - kBaseBlockSize);
+    page.data.assign(after.begin() + offset, after.begin() + offset + kPageSize);
+    pages.push_back(std::move(page));
+  }
+  return pages;
+}
+
+std::vector<uint8_t> BuildHiveLog(const std::vector<uint8_t>& hive, uint32_t sequence, const std::vector<HiveLogPageImage>& pages) {
+  std::vector<uint8_t> log(hive.begin(), hive.begin() + kHiveLogBaseBlockSize);
+  Write32(log.data() + 0x04, sequence);
+  Write32(log.data() + 0x08, sequence);
+  Write32(log.data() + 0x1C, 6);
+  Write32(log.data() + kHiveBaseBlockChecksumOffset, HiveBaseBlockChecksum(log.data()));
+
+  uint32_t data_size = 0;
+  for (const HiveLogPageImage& page : pages) {
+    data_size += static_cast<uint32_t>(page.data.size());
+  }
+  uint32_t entry_size = kLogEntryHeaderSize + static_cast<uint32_t>(pages.size()) * 8 + data_size;
+  entry_size = (entry_size + 511) & ~511u;
+  std::vector<uint8_t> entry(entry_size, 0);
+  memcpy(entry.data(), "HvLE", 4);
+  Write32(entry.data() + 0x04, entry_size);
+  Write32(entry.data() + 0x0C, sequence);
+  Write32(entry.data() + 0x10, Read32(hive.data() + 0x28));
+  Write32(entry.data() + 0x14, static_cast<uint32_t>(pages.size()));
+  uint32_t offset = kLogEntryHeaderSize + static_cast<uint32_t>(pages.size()) * 8;
+  for (size_t i = 0; i < pages.size(); ++i) {
+    Write32(entry.data() + kLogEntryHeaderSize + i * 8, pages[i].offset);
+    Write32(entry.data() + kLogEntryHeaderSize + i * 8 + 4, static_cast<uint32_t>(pages[i].data.size()));
+    memcpy(entry.data() + offset, pages[i].data.data(), pages[i].data.size());
+    offset += static_cast<uint32_t>(pages[i].data.size());
+  }
+  Write64(entry.data() + 0x18, Marvin32(entry.data() + kLogEntryHeaderSize, entry_size - kLogEntryHeaderSize, kLogEntrySeed));
+  Write64(entry.data() + 0x20, Marvin32(entry.data(), 32, kLogEntrySeed));
+  log.insert(log.end(), entry.begin(), entry.end());
+  return log;
+}
+
+bool WriteBytes(const std::filesystem::path& path, const std::vector<uint8_t>& data) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+  return static_cast<bool>(out);
+}
+
+bool ReadBytes(const std::filesystem::path& path, std::vector<uint8_t>* data) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  data->assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  return true;
+}
+
+std::filesystem::path TempPath(const char* name) {
+  std::error_code ec;
+  std::filesystem::path dir = std::filesystem::temp_directory_path(ec) / "regkit_tests";
+  std::filesystem::create_directories(dir, ec);
+  return dir / name;
+}
+
+} // namespace regkit::test
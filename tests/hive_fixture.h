@@ -0,0 +1,72 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace regkit::test {
+
+class HiveImageBuilder {
+public:
+  static constexpr uint32_t kRoot = 0;
+
+  explicit HiveImageBuilder(uint32_t minor_version = 5);
+
+  uint32_t AddKey(uint32_t parent, std::string name);
+  uint32_t AddOrphanKey(uint32_t parent, std::string name);
+  void AddValue(uint32_t key, std::string name, uint32_t type, std::vector<uint8_t> data);
+  void SetValueData(uint32_t key, std::string_view name, std::vector<uint8_t> data);
+
+  std::vector<uint8_t> Build(uint32_t sequence = 1) const;
+  uint32_t KeyCell(uint32_t key) const { return key < cells_.size() ? cells_[key] : 0xFFFFFFFFu; }
+
+private:
+  struct Value {
+    std::string name;
+    uint32_t type = 0;
+    std::vector<uint8_t> data;
+  };
+
+  struct Key {
+    std::string name;
+    uint32_t parent = 0;
+    bool listed = true;
+    std::vector<uint32_t> children;
+    std::vector<Value> values;
+  };
+
+  uint32_t minor_version_;
+  std::vector<Key> keys_;
+  mutable std::vector<uint32_t> cells_;
+};
+
+struct HiveLogPageImage {
+  uint32_t offset = 0;
+  std::vector<uint8_t> data;
+};
+
+std::vector<HiveLogPageImage> DirtyPages(const std::vector<uint8_t>& before, const std::vector<uint8_t>& after);
+std::vector<uint8_t> BuildHiveLog(const std::vector<uint8_t>& hive, uint32_t sequence, const std::vector<HiveLogPageImage>& pages);
+bool WriteBytes(const std::filesystem::path& path, const std::vector<uint8_t>& data);
+bool ReadBytes(const std::filesystem::path& path, std::vector<uint8_t>* data);
+std::filesystem::path TempPath(const char* name);
+
+} // namespace regkit::test
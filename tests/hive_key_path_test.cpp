@@ -0,0 +1,183 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/hive_check.h"
+#include "registry/hive_reader.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+constexpr size_t kBaseBlockSize = 4096;
+
+struct KeyPath {
+  std::wstring path;
+  uint32_t key = 0;
+};
+
+uint32_t Read32(const std::vector<uint8_t>& image, size_t offset) {
+  uint32_t value = 0;
+  memcpy(&value, image.data() + offset, sizeof(value));
+  return value;
+}
+
+size_t Record(uint32_t cell) {
+  return kBaseBlockSize + cell + 4;
+}
+
+size_t LeafEntry(const std::vector<uint8_t>& image, uint32_t list, uint32_t child) {
+  uint32_t count = Read32(image, Record(list)) >> 16;
+  for (uint32_t i = 0; i < count; ++i) {
+    if (Read32(image, Record(list) + 4 + i * 8) == child) {
+      return Record(list) + 4 + i * 8;
+    }
+  }
+  return 0;
+}
+
+void ToFastLeaf(std::vector<uint8_t>* image, uint32_t list) {
+  uint8_t* leaf = image->data() + Record(list);
+  uint32_t count = Read32(*image, Record(list)) >> 16;
+  leaf[1] = 'f';
+  for (uint32_t i = 0; i < count; ++i) {
+    uint8_t* entry = leaf + 4 + i * 8;
+    uint32_t child = Read32(*image, Record(list) + 4 + i * 8);
+    const uint8_t* nk = image->data() + Record(child);
+    uint32_t name_size = nk[0x48] | nk[0x49] << 8;
+    memset(entry + 4, 0, 4);
+    memcpy(entry + 4, nk + 0x4C, std::min<uint32_t>(name_size, 4));
+  }
+}
+
+bool Resolves(const HiveReader& reader, const HiveImageBuilder& builder, const std::vector<KeyPath>& paths) {
+  for (const KeyPath& entry : paths) {
+    uint32_t cell = HiveReader::kNoCell;
+    if (!reader.FindKey(entry.path, &cell) || cell != builder.KeyCell(entry.key)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Opens(HiveReader* reader, const std::filesystem::path& path, const std::vector<uint8_t>& image) {
+  reader->Close();
+  std::wstring error;
+  return WriteBytes(path, image) && reader->Open(path, &error);
+}
+
+} // namespace
+
+int main() {
+  HiveImageBuilder builder;
+  uint32_t software = builder.AddKey(HiveImageBuilder::kRoot, "Software");
+  std::vector<KeyPath> paths;
+  for (int i = 0; i < 300; ++i) {
+    std::string name = "Key" + std::to_string(1000 + i);
+    uint32_t key = builder.AddKey(software, name);
+    paths.push_back({L"software\\KEY" + std::to_wstring(1000 + i), key});
+  }
+  uint32_t af = builder.AddKey(software, "AF");
+  uint32_t bang = builder.AddKey(software, "B!");
+  uint32_t umlaut = builder.AddKey(software, "\xDC" "ber");
+  uint32_t vendor = builder.AddKey(software, "Vendor");
+  uint32_t deep = builder.AddKey(builder.AddKey(vendor, "Deep"), "Leaf");
+  paths.push_back({L"Software\\af", af});
+  paths.push_back({L"SOFTWARE\\b!", bang});
+  paths.push_back({L"Software\\\x00DC" L"BER", umlaut});
+  paths.push_back({L"Software\\Vendor\\Deep\\leaf", deep});
+  paths.push_back({L"\\Software\\\\vendor\\", vendor});
+  paths.push_back({L"", HiveImageBuilder::kRoot});
+  std::vector<uint8_t> image = builder.Build();
+  HiveCheckReport report;
+  REGKIT_CHECK(CheckHiveImage(image.data(), image.size(), 1, nullptr, &report) && report.ok());
+
+  std::filesystem::path path = TempPath("key_path.hiv");
+  HiveReader reader;
+  REGKIT_CHECK(Opens(&reader, path, image));
+  REGKIT_CHECK(Resolves(reader, builder, paths));
+  REGKIT_CHECK(Resolves(reader, builder, paths));
+  uint32_t cell = HiveReader::kNoCell;
+  REGKIT_CHECK(!reader.FindKey(L"Software\\Key999", &cell));
+  REGKIT_CHECK(!reader.FindKey(L"Software\\Key100", &cell));
+  REGKIT_CHECK(!reader.FindKey(L"Software\\Key10000", &cell));
+  REGKIT_CHECK(!reader.FindKey(L"Software\\Vendor\\Deep\\Leaf\\Missing", &cell));
+  REGKIT_CHECK(!reader.FindKey(L"Software\\Vendor\\Missing\\Leaf", &cell));
+  REGKIT_CHECK(!reader.FindSubkey(builder.KeyCell(software), L"", &cell));
+  REGKIT_CHECK(reader.FindSubkey(builder.KeyCell(vendor), L"DEEP", &cell) && reader.KeyName(cell).ToString() == L"Deep");
+
+  std::atomic_int mismatches(0);
+  {
+    HiveReader shared;
+    REGKIT_CHECK(Opens(&shared, path, image));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+      threads.emplace_back([&, t]() {
+        for (size_t round = 0; round < 4; ++round) {
+          for (size_t i = 0; i < paths.size(); ++i) {
+            const KeyPath& entry = paths[(i * 7 + t * 31 + round) % paths.size()];
+            uint32_t found = HiveReader::kNoCell;
+            if (!shared.FindKey(entry.path, &found) || found != builder.KeyCell(entry.key)) {
+              mismatches.fetch_add(1);
+            }
+          }
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+  REGKIT_CHECK(mismatches.load() == 0);
+
+  uint32_t list = Read32(image, Record(builder.KeyCell(software)) + 0x1C);
+  std::vector<uint8_t> corrupt = image;
+  size_t entry = LeafEntry(corrupt, list, builder.KeyCell(vendor));
+  REGKIT_CHECK(entry != 0);
+  corrupt[entry + 4] ^= 0x01;
+  entry = LeafEntry(corrupt, list, builder.KeyCell(umlaut));
+  REGKIT_CHECK(entry != 0);
+  corrupt[entry + 4] ^= 0x01;
+  REGKIT_CHECK(Opens(&reader, path, corrupt));
+  REGKIT_CHECK(!reader.FindKey(L"Software\\Vendor", &cell));
+  REGKIT_CHECK(reader.FindKey(L"Software\\\x00DC" L"ber", &cell) && cell == builder.KeyCell(umlaut));
+  REGKIT_CHECK(reader.FindKey(L"Software\\AF", &cell) && cell == builder.KeyCell(af));
+
+  corrupt = image;
+  ToFastLeaf(&corrupt, list);
+  REGKIT_CHECK(Opens(&reader, path, corrupt));
+  REGKIT_CHECK(Resolves(reader, builder, paths));
+  REGKIT_CHECK(!reader.FindKey(L"Software\\Key1", &cell));
+  REGKIT_CHECK(!reader.FindKey(L"Software\\Vendo", &cell));
+  entry = LeafEntry(corrupt, list, builder.KeyCell(vendor));
+  corrupt[entry + 6] = 'X';
+  REGKIT_CHECK(Opens(&reader, path, corrupt));
+  REGKIT_CHECK(!reader.FindKey(L"Software\\Vendor", &cell));
+  REGKIT_CHECK(reader.FindKey(L"Software\\Key1150", &cell) && cell == builder.KeyCell(paths[150].key));
+  reader.Close();
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  return Finish("hive_key_path_test");
+}
@@ -0,0 +1,139 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/hive_check.h"
+#include "registry/hive_log.h"
+#include "registry/hive_reader.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+void MarkDirty(std::vector<uint8_t>* image, uint32_t primary, uint32_t secondary) {
+  uint8_t* base = image->data();
+  memcpy(base + 0x04, &primary, sizeof(primary));
+  memcpy(base + 0x08, &secondary, sizeof(secondary));
+  uint32_t checksum = HiveBaseBlockChecksum(base);
+  memcpy(base + kHiveBaseBlockChecksumOffset, &checksum, sizeof(checksum));
+}
+
+bool SameBins(const HiveReader& reader, const std::vector<uint8_t>& image) {
+  return reader.bins_size() + 4096ull == image.size() && memcmp(reader.bins(), image.data() + 4096, reader.bins_size()) == 0;
+}
+
+void RemoveFiles(const std::filesystem::path& path) {
+  std::error_code ec;
+  for (const char* suffix : {"", ".LOG1", ".LOG2"}) {
+    std::filesystem::path file = path;
+    file += suffix;
+    std::filesystem::remove(file, ec);
+  }
+}
+
+} // namespace
+
+int main() {
+  HiveImageBuilder builder;
+  uint32_t software = builder.AddKey(HiveImageBuilder::kRoot, "Software");
+  uint32_t vendor = builder.AddKey(software, "Vendor");
+  builder.AddValue(vendor, "Counter", 4, {1, 0, 0, 0});
+  builder.AddValue(vendor, "Blob", 3, std::vector<uint8_t>(64, 0x11));
+  std::vector<uint8_t> before = builder.Build(5);
+
+  builder.SetValueData(vendor, "Blob", std::vector<uint8_t>(64, 0x22));
+  std::vector<uint8_t> middle = builder.Build(5);
+  builder.AddValue(vendor, "Grown", 3, std::vector<uint8_t>(12000, 0x33));
+  std::vector<uint8_t> after = builder.Build(6);
+  REGKIT_CHECK(after.size() > before.size());
+
+  std::filesystem::path path = TempPath("replay.hiv");
+  std::filesystem::path log1 = path;
+  log1 += ".LOG1";
+  std::filesystem::path log2 = path;
+  log2 += ".LOG2";
+  std::wstring error;
+
+  RemoveFiles(path);
+  REGKIT_CHECK(WriteBytes(path, before));
+  {
+    HiveReader reader;
+    REGKIT_CHECK(reader.Open(path, &error));
+    REGKIT_CHECK(reader.recovery_state() == HiveRecoveryState::kClean);
+  }
+
+  std::vector<uint8_t> dirty = before;
+  MarkDirty(&dirty, 6, 5);
+  REGKIT_CHECK(WriteBytes(path, dirty));
+  REGKIT_CHECK(WriteBytes(log1, BuildHiveLog(middle, 5, DirtyPages(before, middle))));
+  REGKIT_CHECK(WriteBytes(log2, BuildHiveLog(after, 6, DirtyPages(middle, after))));
+  {
+    HiveReader reader;
+    REGKIT_CHECK(reader.Open(path, &error));
+    REGKIT_CHECK(reader.recovery_state() == HiveRecoveryState::kReplayed);
+    REGKIT_CHECK(SameBins(reader, after));
+    REGKIT_CHECK(!IsHiveBaseBlockDirty(reader.base_block()));
+    uint32_t cell = HiveReader::kNoCell;
+    HiveValue value;
+    REGKIT_CHECK(reader.FindKey(L"Software\\Vendor", &cell));
+    REGKIT_CHECK(reader.FindValue(cell, L"Grown", &value) && value.data_size == 12000);
+
+    HiveCheckReport report;
+    REGKIT_CHECK(CheckHiveImage(reader.base_block(), 4096ull + reader.bins_size(), 1, nullptr, &report));
+    REGKIT_CHECK(report.ok());
+  }
+  {
+    HiveCheckReport report;
+    REGKIT_CHECK(CheckHiveFile(path, 1, nullptr, &report, &error));
+    REGKIT_CHECK(report.dirty);
+    REGKIT_CHECK(report.recovery == HiveRecoveryState::kReplayed);
+  }
+  {
+    MappedFile file;
+    REGKIT_CHECK(file.Open(path, &error));
+    REGKIT_CHECK(file.size() == dirty.size() && memcmp(file.data(), dirty.data(), dirty.size()) == 0);
+  }
+
+  std::filesystem::remove(log2);
+  MarkDirty(&dirty, 9, 8);
+  REGKIT_CHECK(WriteBytes(path, dirty));
+  {
+    HiveReader reader;
+    REGKIT_CHECK(reader.Open(path, &error));
+    REGKIT_CHECK(reader.recovery_state() == HiveRecoveryState::kReplayFailed);
+    REGKIT_CHECK(SameBins(reader, before));
+  }
+
+  std::filesystem::remove(log1);
+  {
+    HiveReader reader;
+    REGKIT_CHECK(reader.Open(path, &error));
+    REGKIT_CHECK(reader.recovery_state() == HiveRecoveryState::kDirtyNoLogs);
+    REGKIT_CHECK(SameBins(reader, before));
+    HiveCheckReport report;
+    REGKIT_CHECK(CheckHiveFile(path, 1, nullptr, &report, &error));
+    REGKIT_CHECK(report.recovery == HiveRecoveryState::kDirtyNoLogs);
+  }
+
+  RemoveFiles(path);
+  return Finish("hive_log_test");
+}
@@ -0,0 +1,109 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/hive_check.h"
+#include "registry/hive_reader.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+std::vector<uint8_t> Bytes(size_t size, uint8_t seed) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<uint8_t>(seed + i * 31);
+  }
+  return data;
+}
+
+std::vector<uint8_t> ReadValue(const HiveReader& reader, uint32_t key, std::wstring_view name) {
+  HiveValue value;
+  std::vector<uint8_t> scratch;
+  const uint8_t* data = nullptr;
+  uint32_t size = 0;
+  if (!reader.FindValue(key, name, &value) || !reader.ValueData(value, &scratch, &data, &size)) {
+    return {};
+  }
+  return std::vector<uint8_t>(data, data + size);
+}
+
+} // namespace
+
+int main() {
+  HiveImageBuilder builder;
+  uint32_t software = builder.AddKey(HiveImageBuilder::kRoot, "Software");
+  uint32_t vendor = builder.AddKey(software, "Vendor");
+  builder.AddKey(software, "alpha");
+  builder.AddKey(HiveImageBuilder::kRoot, "System");
+  builder.AddValue(vendor, "Small", 4, {1, 2, 3, 4});
+  builder.AddValue(vendor, "Cell", 3, Bytes(100, 7));
+  builder.AddValue(vendor, "Big", 3, Bytes(40000, 9));
+  builder.AddValue(vendor, "", 1, {'x', 0});
+  std::vector<uint8_t> image = builder.Build();
+
+  HiveCheckReport report;
+  REGKIT_CHECK(CheckHiveImage(image.data(), image.size(), 2, nullptr, &report));
+  REGKIT_CHECK(report.ok());
+  REGKIT_CHECK(!report.dirty);
+  REGKIT_CHECK(report.key_count == 5);
+  REGKIT_CHECK(report.value_count == 4);
+
+  std::filesystem::path path = TempPath("reader.hiv");
+  REGKIT_CHECK(WriteBytes(path, image));
+  HiveReader reader;
+  std::wstring error;
+  REGKIT_CHECK(reader.Open(path, &error));
+  REGKIT_CHECK(reader.root_cell() == builder.KeyCell(HiveImageBuilder::kRoot));
+
+  std::vector<std::wstring> names;
+  reader.EnumSubkeys(builder.KeyCell(software), [&](uint32_t child) {
+    names.push_back(reader.KeyName(child).ToString());
+    return true;
+  });
+  REGKIT_CHECK((names == std::vector<std::wstring>{L"alpha", L"Vendor"}));
+
+  uint32_t cell = HiveReader::kNoCell;
+  REGKIT_CHECK(reader.FindKey(L"SOFTWARE\\vendor", &cell));
+  REGKIT_CHECK(cell == builder.KeyCell(vendor));
+  REGKIT_CHECK(!reader.FindKey(L"Software\\Missing", &cell));
+
+  HiveKeyInfo info;
+  REGKIT_CHECK(reader.QueryKey(builder.KeyCell(vendor), &info));
+  REGKIT_CHECK(info.value_count == 4);
+  REGKIT_CHECK(info.subkey_count == 0);
+  REGKIT_CHECK(info.parent == builder.KeyCell(software));
+
+  REGKIT_CHECK((ReadValue(reader, cell, L"small") == std::vector<uint8_t>{1, 2, 3, 4}));
+  REGKIT_CHECK(ReadValue(reader, cell, L"Cell") == Bytes(100, 7));
+  REGKIT_CHECK(ReadValue(reader, cell, L"Big") == Bytes(40000, 9));
+  REGKIT_CHECK((ReadValue(reader, cell, L"") == std::vector<uint8_t>{'x', 0}));
+  reader.Close();
+
+  std::vector<uint8_t> truncated(image.begin(), image.begin() + 100);
+  REGKIT_CHECK(WriteBytes(path, truncated));
+  REGKIT_CHECK(!reader.Open(path, &error));
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  return Finish("hive_reader_test");
+}
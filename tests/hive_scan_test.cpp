@@ -0,0 +1,130 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/hive_reader.h"
+#include "registry/hive_scan.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+std::vector<std::wstring> ScanPaths(const HiveScanner& scanner) {
+  std::mutex mutex;
+  std::vector<std::wstring> paths;
+  scanner.Scan(4, nullptr, [&](const HiveScanKey& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    paths.emplace_back(key.path);
+    REGKIT_CHECK(key.lower_name.size() == key.name.length());
+    return true;
+  });
+  std::sort(paths.begin(), paths.end());
+  return paths;
+}
+
+} // namespace
+
+int main() {
+  HiveImageBuilder builder;
+  uint32_t software = builder.AddKey(HiveImageBuilder::kRoot, "Software");
+  uint32_t vendor = builder.AddKey(software, "Vendor");
+  builder.AddValue(vendor, "Path", 1, {'C', 0, 0, 0});
+  builder.AddValue(vendor, "Flags", 4, {1, 0, 0, 0});
+  builder.AddKey(HiveImageBuilder::kRoot, "System");
+  uint32_t orphan = builder.AddOrphanKey(HiveImageBuilder::kRoot, "Deleted");
+  builder.AddKey(orphan, "Inner");
+  builder.AddOrphanKey(software, "Stale");
+  std::vector<uint8_t> image = builder.Build();
+
+  std::filesystem::path path = TempPath("scan.hiv");
+  std::filesystem::path index_path = TempPath("scan.hiv.rkix");
+  REGKIT_CHECK(WriteBytes(path, image));
+  HiveReader reader;
+  std::wstring error;
+  std::error_code ec;
+  REGKIT_CHECK(reader.Open(path, &error));
+
+  HiveScanner scanner(reader);
+  REGKIT_CHECK(scanner.Index(4, nullptr));
+  REGKIT_CHECK(scanner.key_count() == 4);
+  REGKIT_CHECK(scanner.Select(reader.root_cell()) == 4);
+  std::vector<std::wstring> expected = {L"", L"Software", L"Software\\Vendor", L"System"};
+  REGKIT_CHECK(ScanPaths(scanner) == expected);
+  REGKIT_CHECK(scanner.Select(builder.KeyCell(orphan)) == 0);
+
+  REGKIT_CHECK(scanner.SaveIndex(index_path, path));
+  HiveScanner loaded(reader);
+  REGKIT_CHECK(loaded.LoadIndex(index_path, path));
+  REGKIT_CHECK(loaded.key_count() == 4);
+  REGKIT_CHECK(loaded.Select(builder.KeyCell(software)) == 2);
+  uint32_t cell = HiveReader::kNoCell;
+  REGKIT_CHECK(loaded.FindKey(L"SOFTWARE\\vendor", &cell) && cell == builder.KeyCell(vendor));
+  REGKIT_CHECK(loaded.FindKey(L"", &cell) && cell == reader.root_cell());
+  REGKIT_CHECK(!loaded.FindKey(L"Deleted", &cell));
+  REGKIT_CHECK(!loaded.FindKey(L"Software\\Stale", &cell));
+  loaded.Scan(1, nullptr, [&](const HiveScanKey& key) {
+    if (key.cell == builder.KeyCell(vendor)) {
+      REGKIT_CHECK(key.lower_name == u"vendor");
+      REGKIT_CHECK(key.values.size() == 2);
+      HiveValue value;
+      REGKIT_CHECK(reader.ReadValue(key.values[0], &value) && value.name.ToString() == L"Path");
+    }
+    return true;
+  });
+  reader.Close();
+
+  std::vector<uint8_t> sidecar;
+  REGKIT_CHECK(ReadBytes(index_path, &sidecar) && sidecar.size() > 64);
+  sidecar.back() ^= 1;
+  REGKIT_CHECK(WriteBytes(index_path, sidecar));
+  REGKIT_CHECK(reader.Open(path, &error));
+  REGKIT_CHECK(!HiveScanner(reader).LoadIndex(index_path, path));
+  sidecar.back() ^= 1;
+  REGKIT_CHECK(WriteBytes(index_path, sidecar));
+  auto shared = std::make_shared<HiveScanner>(reader);
+  REGKIT_CHECK(shared->LoadIndex(index_path, path));
+  HiveScanner view(reader);
+  REGKIT_CHECK(view.Attach(shared));
+  REGKIT_CHECK(view.Select(reader.root_cell()) == 4);
+  REGKIT_CHECK(view.FindKey(L"Software\\Vendor", nullptr));
+  HiveReader other;
+  REGKIT_CHECK(other.Open(path, &error));
+  REGKIT_CHECK(!HiveScanner(other).Attach(shared));
+  other.Close();
+  shared.reset();
+  reader.Close();
+
+  std::filesystem::file_time_type write_time = std::filesystem::last_write_time(path, ec);
+  std::vector<uint8_t> resequenced = builder.Build(2);
+  REGKIT_CHECK(resequenced.size() == image.size());
+  REGKIT_CHECK(WriteBytes(path, resequenced));
+  std::filesystem::last_write_time(path, write_time, ec);
+  REGKIT_CHECK(reader.Open(path, &error));
+  REGKIT_CHECK(!HiveScanner(reader).LoadIndex(index_path, path));
+  reader.Close();
+
+  std::filesystem::remove(path, ec);
+  std::filesystem::remove(index_path, ec);
+  return Finish("hive_scan_test");
+}
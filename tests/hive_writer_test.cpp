@@ -0,0 +1,144 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/hive_check.h"
+#include "registry/hive_reader.h"
+#include "registry/hive_writer.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+using HiveDump = std::map<std::wstring, std::vector<uint8_t>>;
+
+HiveDump Dump(const HiveReader& reader) {
+  HiveDump dump;
+  std::vector<uint8_t> scratch;
+  std::function<void(uint32_t, const std::wstring&)> walk = [&](uint32_t cell, const std::wstring& path) {
+    dump[path + L"\\"] = {};
+    reader.EnumValues(cell, [&](const HiveValue& value) {
+      const uint8_t* data = nullptr;
+      uint32_t size = 0;
+      std::vector<uint8_t> bytes;
+      if (reader.ValueData(value, &scratch, &data, &size)) {
+        bytes.assign(data, data + size);
+      }
+      bytes.push_back(static_cast<uint8_t>(value.type));
+      dump[path + L"@" + value.name.ToString()] = std::move(bytes);
+      return true;
+    });
+    reader.EnumSubkeys(cell, [&](uint32_t child) {
+      walk(child, path + L"\\" + reader.KeyName(child).ToString());
+      return true;
+    });
+  };
+  walk(reader.root_cell(), L"");
+  return dump;
+}
+
+} // namespace
+
+int main() {
+  HiveImageBuilder builder;
+  uint32_t software = builder.AddKey(HiveImageBuilder::kRoot, "Software");
+  uint32_t vendor = builder.AddKey(software, "Vendor");
+  for (int i = 0; i < 40; ++i) {
+    uint32_t key = builder.AddKey(vendor, "Key" + std::to_string(i));
+    builder.AddValue(key, "Index", 4, {static_cast<uint8_t>(i), 0, 0, 0});
+  }
+  builder.AddValue(vendor, "Text", 1, std::vector<uint8_t>(30, 'a'));
+  builder.AddValue(vendor, "Big", 3, std::vector<uint8_t>(50000, 0x5A));
+  builder.AddValue(vendor, "Empty", 3, {});
+  builder.AddOrphanKey(software, "Deleted");
+  std::vector<uint8_t> source = builder.Build();
+
+  std::filesystem::path path = TempPath("writer_source.hiv");
+  std::filesystem::path saved = TempPath("writer_saved.hiv");
+  REGKIT_CHECK(WriteBytes(path, source));
+  HiveReader reader;
+  std::wstring error;
+  REGKIT_CHECK(reader.Open(path, &error));
+
+  std::vector<uint8_t> image;
+  REGKIT_CHECK(BuildCompactHive(reader, &image, &error));
+  HiveCheckReport report;
+  REGKIT_CHECK(CheckHiveImage(image.data(), image.size(), 2, nullptr, &report));
+  REGKIT_CHECK(report.ok());
+  REGKIT_CHECK(!report.dirty);
+  REGKIT_CHECK(report.key_count == 43);
+
+  REGKIT_CHECK(WriteHiveImage(saved, image, &error));
+  HiveReader rebuilt;
+  REGKIT_CHECK(rebuilt.Open(saved, &error));
+  REGKIT_CHECK(Dump(rebuilt) == Dump(reader));
+  REGKIT_CHECK(Dump(reader).size() == 43 + 43);
+
+  std::vector<uint8_t> second;
+  REGKIT_CHECK(BuildCompactHive(rebuilt, &second, &error));
+  REGKIT_CHECK(second.size() == image.size());
+  rebuilt.Close();
+
+  uint32_t cell = HiveReader::kNoCell;
+  HiveValue text;
+  REGKIT_CHECK(reader.FindKey(L"Software\\Vendor", &cell));
+  REGKIT_CHECK(reader.FindValue(cell, L"Text", &text));
+  reader.Close();
+  std::vector<uint8_t> damaged = source;
+  uint32_t bad_cell = 0x7FFFFFF0u;
+  memcpy(damaged.data() + 4096 + text.cell + 4 + 0x08, &bad_cell, sizeof(bad_cell));
+  REGKIT_CHECK(WriteBytes(path, damaged));
+  REGKIT_CHECK(reader.Open(path, &error));
+  image.clear();
+  error.clear();
+  REGKIT_CHECK(!BuildCompactHive(reader, &image, &error));
+  REGKIT_CHECK(!error.empty());
+  reader.Close();
+
+  HiveImageBuilder legacy(3);
+  uint32_t legacy_key = legacy.AddKey(HiveImageBuilder::kRoot, "Legacy");
+  for (int i = 0; i < 5; ++i) {
+    legacy.AddKey(legacy_key, "Child" + std::to_string(i));
+  }
+  REGKIT_CHECK(WriteBytes(path, legacy.Build()));
+  REGKIT_CHECK(reader.Open(path, &error));
+  image.clear();
+  REGKIT_CHECK(BuildCompactHive(reader, &image, &error));
+  reader.Close();
+  uint32_t root = 0;
+  uint32_t list = 0;
+  memcpy(&root, image.data() + 0x24, sizeof(root));
+  memcpy(&list, image.data() + 4096 + root + 4 + 0x1C, sizeof(list));
+  REGKIT_CHECK(memcmp(image.data() + 4096 + list + 4, "lf", 2) == 0);
+  REGKIT_CHECK(WriteHiveImage(saved, image, &error));
+  REGKIT_CHECK(rebuilt.Open(saved, &error));
+  REGKIT_CHECK(rebuilt.minor_version() == 3);
+  REGKIT_CHECK(rebuilt.FindKey(L"Legacy\\Child3", &cell));
+  rebuilt.Close();
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  std::filesystem::remove(saved, ec);
+  return Finish("hive_writer_test");
+}
@@ -0,0 +1,58 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <filesystem>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/mapped_file.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+int main() {
+  constexpr uint64_t kWindow = 64 * 1024;
+  std::filesystem::path path = TempPath("mapped.bin");
+  REGKIT_CHECK(WriteBytes(path, std::vector<uint8_t>(kWindow * 4, 0x5A)));
+
+  MappedFile file;
+  REGKIT_CHECK(file.Open(path, nullptr));
+  REGKIT_CHECK(file.SetResidencyBudget(kWindow * 2, static_cast<uint32_t>(kWindow)));
+  file.Touch(0, 1);
+  file.Touch(kWindow, 1);
+  file.Touch(0, 1);
+  file.Touch(kWindow * 2, 1);
+  MappedFileStats stats = file.stats();
+  REGKIT_CHECK(stats.misses == 3);
+  REGKIT_CHECK(stats.evictions == 1);
+  REGKIT_CHECK(stats.resident_bytes == kWindow * 2);
+
+  file.Touch(0, 1);
+  REGKIT_CHECK(file.stats().misses == 3);
+  file.Touch(kWindow, 1);
+  REGKIT_CHECK(file.stats().misses == 4);
+
+  file.Touch(0, kWindow * 4);
+  stats = file.stats();
+  REGKIT_CHECK(stats.resident_bytes <= kWindow * 2);
+  REGKIT_CHECK(file.data()[kWindow * 3] == 0x5A);
+  file.Close();
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  return Finish("mapped_file_test");
+}
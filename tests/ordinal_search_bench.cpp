@@ -0,0 +1,156 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+// Not registered with ctest. No key-name corpus is committed because real
+// registry exports carry machine-specific data; pass a .reg export or a file
+// with one key name per line as the first argument, otherwise a synthetic
+// corpus of key-path-like names is generated.
+
+#include <algorithm>
+#include <chrono>
+#include <clocale>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "registry/ordinal_search.h"
+#include "registry/reg_file_tokenizer.h"
+
+using namespace regkit;
+
+namespace {
+
+std::vector<std::wstring> LoadCorpus(const char* path) {
+  std::ifstream file(path, std::ios::binary);
+  std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  std::wstring text;
+  bool utf16 = false;
+  std::vector<std::wstring> names;
+  if (bytes.empty() || !DecodeRegFileText(bytes.data(), bytes.size(), &text, &utf16)) {
+    return names;
+  }
+  size_t begin = 0;
+  while (begin < text.size()) {
+    size_t end = text.find(L'\n', begin);
+    if (end == std::wstring::npos) {
+      end = text.size();
+    }
+    std::wstring line = text.substr(begin, end - begin);
+    if (!line.empty() && line.back() == L'\r') {
+      line.pop_back();
+    }
+    if (line.size() > 2 && line.front() == L'[' && line.back() == L']') {
+      line = line.substr(1, line.size() - 2);
+    }
+    bool header = line.starts_with(L"Windows Registry Editor") || line.starts_with(L"REGEDIT4");
+    if (!line.empty() && !header && line.front() != L'"' && line.front() != L'@') {
+      names.push_back(std::move(line));
+    }
+    begin = end + 1;
+  }
+  return names;
+}
+
+std::vector<std::wstring> SyntheticCorpus() {
+  const wchar_t* const kParts[] = {L"SOFTWARE", L"Microsoft", L"Windows", L"CurrentVersion", L"Explorer", L"Classes", L"CLSID", L"Interface", L"TypeLib", L"Policies", L"Services", L"Parameters", L"Enum", L"Control", L"Wow6432Node", L"Shell", L"Extensions", L"Installer", L"UserData", L"Components"};
+  std::mt19937 rng(0x0D1A);
+  std::uniform_int_distribution<size_t> part(0, std::size(kParts) - 1);
+  std::uniform_int_distribution<int> depth(2, 7);
+  std::uniform_int_distribution<int> coin(0, 3);
+  std::vector<std::wstring> names;
+  names.reserve(400000);
+  for (size_t i = 0; i < 400000; ++i) {
+    std::wstring name = L"HKEY_LOCAL_MACHINE";
+    for (int level = depth(rng); level > 0; --level) {
+      name += L'\\';
+      if (coin(rng) == 0) {
+        wchar_t guid[40] = {};
+        swprintf(guid, 40, L"{%08X-%04X-%04X-%04X-%012X}", static_cast<unsigned>(rng()), static_cast<unsigned>(rng() & 0xFFFF), static_cast<unsigned>(rng() & 0xFFFF), static_cast<unsigned>(rng() & 0xFFFF), static_cast<unsigned>(rng()));
+        name += guid;
+      } else {
+        name += kParts[part(rng)];
+      }
+    }
+    names.push_back(std::move(name));
+  }
+  return names;
+}
+
+size_t ScalarFind(std::wstring_view text, std::wstring_view needle) {
+#ifdef _WIN32
+  int found = FindStringOrdinal(FIND_FROMSTART, text.data(), static_cast<int>(text.size()), needle.data(), static_cast<int>(needle.size()), TRUE);
+  return found < 0 ? std::wstring_view::npos : static_cast<size_t>(found);
+#else
+  for (size_t pos = 0; pos + needle.size() <= text.size(); ++pos) {
+    size_t i = 0;
+    while (i < needle.size() && UpcaseOrdinal(text[pos + i]) == UpcaseOrdinal(needle[i])) {
+      ++i;
+    }
+    if (i == needle.size()) {
+      return pos;
+    }
+  }
+  return std::wstring_view::npos;
+#endif
+}
+
+template <typename Find>
+double Measure(const std::vector<std::wstring>& corpus, size_t* hits, Find&& find) {
+  double best = 0.0;
+  for (int run = 0; run < 5; ++run) {
+    size_t count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& name : corpus) {
+      count += find(name) != std::wstring_view::npos;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    best = run == 0 ? seconds : std::min(best, seconds);
+    *hits = count;
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::setlocale(LC_ALL, "C.UTF-8");
+  std::vector<std::wstring> corpus = argc > 1 ? LoadCorpus(argv[1]) : SyntheticCorpus();
+  if (corpus.empty()) {
+    std::fprintf(stderr, "ordinal_search_bench: no key names in corpus\n");
+    return 1;
+  }
+  size_t units = 0;
+  for (const auto& name : corpus) {
+    units += name.size();
+  }
+  std::printf("corpus: %zu names, %.1f MB\n", corpus.size(), units * sizeof(wchar_t) / (1024.0 * 1024.0));
+
+  for (const wchar_t* needle : {L"currentversion", L"WOW6432NODE", L"a", L"{0000", L"NoSuchKeyName"}) {
+    OrdinalFinder finder(needle);
+    size_t finder_hits = 0;
+    size_t scalar_hits = 0;
+    double finder_seconds = Measure(corpus, &finder_hits, [&](const std::wstring& name) { return finder.Find(name); });
+    double scalar_seconds = Measure(corpus, &scalar_hits, [&](const std::wstring& name) { return ScalarFind(name, needle); });
+    std::printf("%-16ls finder %8.2f ms  scalar %8.2f ms  x%.2f  hits %zu%s\n", needle, finder_seconds * 1000.0, scalar_seconds * 1000.0, scalar_seconds / std::max(finder_seconds, 1e-9), finder_hits, finder_hits == scalar_hits ? "" : "  MISMATCH");
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <clocale>
+#include <random>
+#include <string>
+
+#include "registry/ordinal_search.h"
+#include "test_support.h"
+
+using namespace regkit;
+
+namespace {
+
+size_t ReferenceFind(std::wstring_view text, std::wstring_view needle) {
+  if (needle.empty()) {
+    return 0;
+  }
+  for (size_t pos = 0; pos + needle.size() <= text.size(); ++pos) {
+    size_t i = 0;
+    while (i < needle.size() && UpcaseOrdinal(text[pos + i]) == UpcaseOrdinal(needle[i])) {
+      ++i;
+    }
+    if (i == needle.size()) {
+      return pos;
+    }
+  }
+  return std::wstring_view::npos;
+}
+
+} // namespace
+
+int main() {
+  std::setlocale(LC_ALL, "C.UTF-8");
+  const wchar_t kAlphabet[] = L"aAbBkKsSiIzZ09_\\ .\x00E9\x00C9\x0131\x017F\x212A\x0430\x0410\xFF41\xFF21";
+  std::mt19937 rng(0xF1ED);
+  std::uniform_int_distribution<size_t> pick(0, sizeof(kAlphabet) / sizeof(wchar_t) - 2);
+  std::uniform_int_distribution<size_t> text_length(0, 96);
+  std::uniform_int_distribution<size_t> needle_length(0, 12);
+  std::uniform_int_distribution<int> coin(0, 3);
+  OrdinalFinder finder;
+  for (int round = 0; round < 50000; ++round) {
+    std::wstring text(text_length(rng), L' ');
+    for (wchar_t& ch : text) {
+      ch = kAlphabet[pick(rng)];
+    }
+    std::wstring needle(needle_length(rng), L' ');
+    if (coin(rng) != 0 && needle.size() <= text.size()) {
+      size_t start = std::uniform_int_distribution<size_t>(0, text.size() - needle.size())(rng);
+      needle = text.substr(start, needle.size());
+      for (wchar_t& ch : needle) {
+        if (coin(rng) == 0) {
+          ch = static_cast<wchar_t>(UpcaseOrdinal(ch));
+        }
+      }
+    } else {
+      for (wchar_t& ch : needle) {
+        ch = kAlphabet[pick(rng)];
+      }
+    }
+    finder.Reset(needle);
+    size_t expected = ReferenceFind(text, needle);
+    REGKIT_CHECK(finder.Find(text) == expected);
+    REGKIT_CHECK(FindOrdinalInsensitive(text, needle) == expected);
+    REGKIT_CHECK(finder.Contains(text) == (expected != std::wstring_view::npos));
+    bool equal = text.size() == needle.size() && expected == 0;
+    REGKIT_CHECK(finder.Equals(text) == equal);
+    REGKIT_CHECK(EqualsOrdinalInsensitive(text, needle) == equal);
+  }
+
+  REGKIT_CHECK(FindOrdinalInsensitive(L"HKLM\\Software\\Vendor", L"software") == 5);
+  REGKIT_CHECK(FindOrdinalInsensitive(L"short", L"much longer needle") == std::wstring_view::npos);
+  REGKIT_CHECK(FindOrdinalInsensitive(L"anything", L"") == 0);
+  return regkit::test::Finish("ordinal_search_test");
+}
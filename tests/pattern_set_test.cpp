@@ -0,0 +1,140 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+#include <clocale>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "registry/ordinal_search.h"
+#include "registry/pattern_set.h"
+#include "test_support.h"
+
+using namespace regkit;
+
+namespace {
+
+bool ReferenceFind(const std::vector<std::wstring>& patterns, bool match_case, std::wstring_view text, PatternHit* hit) {
+  bool found = false;
+  for (uint32_t i = 0; i < patterns.size(); ++i) {
+    if (patterns[i].empty()) {
+      continue;
+    }
+    size_t start = match_case ? text.find(patterns[i]) : FindOrdinalInsensitive(text, patterns[i]);
+    if (start != std::wstring_view::npos && (!found || start < hit->start)) {
+      found = true;
+      hit->start = start;
+      hit->length = patterns[i].size();
+      hit->pattern = i;
+    }
+  }
+  return found;
+}
+
+bool ReferenceMatchWhole(const std::vector<std::wstring>& patterns, bool match_case, std::wstring_view text, PatternHit* hit) {
+  for (uint32_t i = 0; i < patterns.size(); ++i) {
+    if (!text.empty() && (match_case ? text == patterns[i] : EqualsOrdinalInsensitive(text, patterns[i]))) {
+      hit->start = 0;
+      hit->length = text.size();
+      hit->pattern = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SameAsReference(const std::vector<std::wstring>& patterns, bool match_case, std::wstring_view text) {
+  PatternSet set;
+  if (!set.Build(patterns, match_case)) {
+    return false;
+  }
+  PatternHit actual;
+  PatternHit expected;
+  bool found = ReferenceFind(patterns, match_case, text, &expected);
+  if (set.Find(text, &actual) != found || (found && (actual.start != expected.start || actual.length != expected.length || actual.pattern != expected.pattern))) {
+    return false;
+  }
+  bool whole = ReferenceMatchWhole(patterns, match_case, text, &expected);
+  return set.MatchWhole(text, &actual) == whole && (!whole || (actual.length == text.size() && actual.pattern == expected.pattern));
+}
+
+} // namespace
+
+int main() {
+  std::setlocale(LC_ALL, "C.UTF-8");
+  const std::vector<std::wstring> classic = {L"he", L"she", L"his", L"hers"};
+  for (const wchar_t* text : {L"ushers", L"hers", L"she", L"ahishers", L"h", L"", L"HERS", L"sHe"}) {
+    REGKIT_CHECK(SameAsReference(classic, true, text));
+    REGKIT_CHECK(SameAsReference(classic, false, text));
+  }
+  PatternSet set;
+  PatternHit hit;
+  REGKIT_CHECK(set.Build({L"hers", L"he"}, true));
+  REGKIT_CHECK(set.Find(L"ushers", &hit) && hit.start == 2 && hit.pattern == 0 && hit.length == 4);
+  REGKIT_CHECK(set.Build({L"Run", L"RUN", L"run"}, false));
+  REGKIT_CHECK(set.Find(L"xrUn", &hit) && hit.start == 1 && hit.pattern == 0);
+  REGKIT_CHECK(set.MatchWhole(L"ruN", &hit) && hit.pattern == 0);
+  REGKIT_CHECK(set.Build({L"Run", L"RUN", L"run"}, true));
+  REGKIT_CHECK(set.Find(L"xRUN run", &hit) && hit.start == 1 && hit.pattern == 1);
+  REGKIT_CHECK(!set.MatchWhole(L"rUn", &hit));
+  REGKIT_CHECK(set.Build({L"\x00E9t\x00E9", L"\x0430\x0431"}, false));
+  REGKIT_CHECK(set.Find(L"--\x00C9T\x00C9", &hit) && hit.start == 2 && hit.pattern == 0);
+  REGKIT_CHECK(set.Find(L"\x0410\x0411", &hit) && hit.pattern == 1);
+  REGKIT_CHECK(!set.Build({L"", L""}, false));
+
+  const wchar_t kAlphabet[] = L"aAbBhHsSeErR\x00E9\x00C9\x0131\x017F\x212A\x0430\x0410k";
+  std::mt19937 rng(0xAC0A);
+  std::uniform_int_distribution<size_t> pick(0, sizeof(kAlphabet) / sizeof(wchar_t) - 2);
+  std::uniform_int_distribution<size_t> pattern_count(1, 6);
+  std::uniform_int_distribution<size_t> pattern_length(0, 4);
+  std::uniform_int_distribution<size_t> text_length(0, 24);
+  for (int round = 0; round < 20000; ++round) {
+    std::vector<std::wstring> patterns(pattern_count(rng));
+    for (auto& pattern : patterns) {
+      pattern.resize(pattern_length(rng));
+      for (wchar_t& ch : pattern) {
+        ch = kAlphabet[pick(rng)];
+      }
+    }
+    if (round % 3 == 0) {
+      std::wstring twin = patterns.front();
+      for (wchar_t& ch : twin) {
+        ch = UpcaseOrdinal(ch);
+      }
+      patterns.push_back(std::move(twin));
+    }
+    std::wstring text(text_length(rng), L' ');
+    for (wchar_t& ch : text) {
+      ch = kAlphabet[pick(rng)];
+    }
+    if (round % 4 == 0) {
+      text = patterns[rng() % patterns.size()];
+    }
+    bool any = false;
+    for (const auto& pattern : patterns) {
+      any = any || !pattern.empty();
+    }
+    if (!any) {
+      continue;
+    }
+    for (bool match_case : {true, false}) {
+      if (!SameAsReference(patterns, match_case, text)) {
+        std::fprintf(stderr, "mismatch on round %d (%s)\n", round, match_case ? "case" : "nocase");
+        ++regkit::test::g_failures;
+      }
+    }
+  }
+  return regkit::test::Finish("pattern_set_test");
+}
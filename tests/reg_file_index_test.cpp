@@ -0,0 +1,105 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/reg_file_index.h"
+#include "registry/reg_file_tokenizer.h"
+#include "registry/virtual_hive.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+constexpr char kRegFile[] =
+    "Windows Registry Editor Version 5.00\r\n"
+    "\r\n"
+    "[HKEY_CURRENT_USER\\Software\\Alpha]\r\n"
+    "\"Name\"=\"first\"\r\n"
+    "\"Count\"=dword:00000001\r\n"
+    "\r\n"
+    "[HKEY_CURRENT_USER\\Software\\Beta]\r\n"
+    "\"Data\"=hex:01,02,03\r\n"
+    "\r\n";
+
+bool WriteText(const std::filesystem::path& path, const std::string& text) {
+  return WriteBytes(path, std::vector<uint8_t>(text.begin(), text.end()));
+}
+
+std::unique_ptr<RegFileIndex> IndexFile(const std::filesystem::path& path, VirtualHive* hive) {
+  RegFileStamp stamp;
+  RegFileReader reader;
+  if (!StampRegFile(path, &stamp) || !reader.Open(path, nullptr)) {
+    return nullptr;
+  }
+  std::vector<RegFileSection> sections;
+  RegFileToken token;
+  RegFileRange range;
+  while (reader.NextSection(&token, &range)) {
+    if (token.kind != RegFileTokenKind::kKey) {
+      continue;
+    }
+    std::wstring_view key = token.key;
+    size_t slash = key.find(L'\\');
+    sections.push_back({hive->CreateKey(slash == std::wstring_view::npos ? std::wstring_view() : key.substr(slash + 1)), range});
+  }
+  return std::make_unique<RegFileIndex>(path, stamp, std::move(sections));
+}
+
+} // namespace
+
+int main() {
+  std::filesystem::path path = TempPath("index.reg");
+  REGKIT_CHECK(WriteText(path, kRegFile));
+
+  VirtualHive hive;
+  std::unique_ptr<RegFileIndex> index = IndexFile(path, &hive);
+  REGKIT_CHECK(index != nullptr);
+  uint32_t alpha = hive.FindKey(L"Software\\Alpha");
+  uint32_t beta = hive.FindKey(L"Software\\Beta");
+  REGKIT_CHECK(alpha != VirtualHive::kNoKey && beta != VirtualHive::kNoKey);
+
+  std::shared_ptr<const VirtualHive> values = index->Load(alpha);
+  REGKIT_CHECK(values && values->ValueCount(values->root()) == 2);
+  VirtualHiveValue value;
+  REGKIT_CHECK(values && values->FindValue(values->root(), L"count", &value) && value.size == 4);
+
+  REGKIT_CHECK(index->Adopt(alpha, &hive));
+  const uint8_t two[4] = {2, 0, 0, 0};
+  hive.SetValue(alpha, L"Count", 4, two, sizeof(two));
+  std::wstring error;
+  REGKIT_CHECK(RegFileIndex::Save(path, {{L"HKEY_CURRENT_USER", &hive, index.get()}}, &error));
+  std::shared_ptr<const VirtualHive> saved = index->Load(beta);
+  REGKIT_CHECK(saved && saved->ValueCount(saved->root()) == 1);
+
+  REGKIT_CHECK(WriteText(path, std::string(kRegFile) + "[HKEY_CURRENT_USER\\Software\\Gamma]\r\n\r\n"));
+  REGKIT_CHECK(!RegFileIndex::Save(path, {{L"HKEY_CURRENT_USER", &hive, index.get()}}, &error));
+  REGKIT_CHECK(!error.empty());
+  REGKIT_CHECK(!index->Adopt(beta, &hive));
+
+  VirtualHive fresh;
+  index = IndexFile(path, &fresh);
+  REGKIT_CHECK(index && index->Load(fresh.FindKey(L"Software\\Beta")) != nullptr);
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  return Finish("reg_file_index_test");
+}
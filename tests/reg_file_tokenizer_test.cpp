@@ -0,0 +1,216 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/reg_file_tokenizer.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+struct OwnedToken {
+  RegFileTokenKind kind = RegFileTokenKind::kKey;
+  std::wstring key;
+  std::wstring name;
+  std::wstring data;
+
+  bool operator==(const OwnedToken&) const = default;
+};
+
+OwnedToken Own(const RegFileToken& token) {
+  return {token.kind, std::wstring(token.key), std::wstring(token.name), std::wstring(token.data)};
+}
+
+std::wstring BuildText() {
+  std::wstring text = L"Windows Registry Editor Version 5.00\r\n\r\n";
+  for (int key = 0; text.size() < 5u * 1024 * 1024; ++key) {
+    std::wstring index = std::to_wstring(key);
+    switch (key % 4) {
+    case 0:
+      text += L"[HKEY_CURRENT_USER\\Software\\Key" + index + L"]\r\n";
+      break;
+    case 1:
+      text += L"  \t[HKEY_CURRENT_USER\\Software\\\x5B57\x4E00" + index + L"]\r\n";
+      break;
+    case 2:
+      text += L"; [HKEY_CURRENT_USER\\Commented" + index + L"]\r\n[-HKEY_CURRENT_USER\\Software\\Gone" + index + L"]\r\n\r\n[HKEY_CURRENT_USER\\Software\\Caf\x00E9" + index + L"]\r\n";
+      break;
+    default:
+      text += L"[HKEY_CURRENT_USER\\Software\\\x0A0D\x4E00\x5B0A" + index + L"]\n";
+      break;
+    }
+    text += L"\"Name\"=\"\x00E9t\x00E9 [" + index + L"] \x4E2D\x0A0D\x4E00\"\r\n";
+    text += L"\"Blob\"=hex:";
+    for (int line = 0; line < 40; ++line) {
+      text += L"00,11,22,33,44,55,66,77,88,99,aa,bb,cc,dd,ee,ff,00,11,22,33,44,55,66,77,88,\\\r\n  ";
+    }
+    text += L"01\r\n";
+    if (key % 5 == 0) {
+      text += L"\"Odd\"=hex:01,\\\r\n  [HKEY_CURRENT_USER\\NotAKey" + index + L"]\r\n";
+    }
+    if (key % 7 == 0) {
+      text += L"\"Gone\"=-\r\n@=\"default\"\r\n";
+    }
+    text += L"\r\n";
+  }
+  return text;
+}
+
+std::vector<uint8_t> EncodeUtf8(std::wstring_view text, bool bom) {
+  std::vector<uint8_t> out;
+  if (bom) {
+    out = {0xEF, 0xBB, 0xBF};
+  }
+  for (wchar_t ch : text) {
+    uint32_t code = static_cast<uint32_t>(ch);
+    if (code < 0x80) {
+      out.push_back(static_cast<uint8_t>(code));
+    } else if (code < 0x800) {
+      out.push_back(static_cast<uint8_t>(0xC0 | (code >> 6)));
+      out.push_back(static_cast<uint8_t>(0x80 | (code & 0x3F)));
+    } else {
+      out.push_back(static_cast<uint8_t>(0xE0 | (code >> 12)));
+      out.push_back(static_cast<uint8_t>(0x80 | ((code >> 6) & 0x3F)));
+      out.push_back(static_cast<uint8_t>(0x80 | (code & 0x3F)));
+    }
+  }
+  return out;
+}
+
+std::vector<uint8_t> EncodeUtf16(std::wstring_view text) {
+  std::vector<uint8_t> out = {0xFF, 0xFE};
+  for (wchar_t ch : text) {
+    out.push_back(static_cast<uint8_t>(ch & 0xFF));
+    out.push_back(static_cast<uint8_t>((ch >> 8) & 0xFF));
+  }
+  return out;
+}
+
+bool StraddlesContinuation(const std::vector<uint8_t>& bytes, size_t begin, bool utf16) {
+  size_t unit = utf16 ? 2 : 1;
+  size_t pos = begin + RegFileReader::kChunkBytes;
+  pos -= (pos - begin) % unit;
+  while (pos + unit <= bytes.size() && !(bytes[pos] == '\n' && (!utf16 || bytes[pos + 1] == 0))) {
+    pos += unit;
+  }
+  while (pos >= begin + unit && (bytes[pos - unit] == '\r' || bytes[pos - unit] == ' ' || bytes[pos - unit] == '\n')) {
+    pos -= unit;
+  }
+  return bytes[pos - unit] == '\\' && (!utf16 || bytes[pos - unit + 1] == 0);
+}
+
+std::vector<OwnedToken> Tokenize(std::wstring_view text) {
+  std::vector<OwnedToken> tokens;
+  RegFileTokenizer tokenizer(text);
+  RegFileToken token;
+  while (tokenizer.Next(&token)) {
+    tokens.push_back(Own(token));
+  }
+  return tokens;
+}
+
+std::vector<OwnedToken> ReadAll(RegFileReader* reader) {
+  std::vector<OwnedToken> tokens;
+  RegFileToken token;
+  while (reader->Next(&token)) {
+    tokens.push_back(Own(token));
+  }
+  return tokens;
+}
+
+void CheckFile(const std::filesystem::path& path, const std::vector<uint8_t>& bytes, const std::vector<OwnedToken>& expected, size_t begin, bool utf16) {
+  REGKIT_CHECK(bytes.size() > RegFileReader::kChunkBytes);
+  REGKIT_CHECK(StraddlesContinuation(bytes, begin, utf16));
+  REGKIT_CHECK(WriteBytes(path, bytes));
+
+  std::wstring decoded;
+  bool decoded_utf16 = false;
+  REGKIT_CHECK(DecodeRegFileText(bytes.data(), bytes.size(), &decoded, &decoded_utf16));
+  REGKIT_CHECK(decoded_utf16 == utf16);
+  REGKIT_CHECK(Tokenize(decoded) == expected);
+
+  RegFileReader reader;
+  REGKIT_CHECK(reader.Open(path, nullptr));
+  REGKIT_CHECK(reader.utf16() == utf16);
+  REGKIT_CHECK(ReadAll(&reader) == expected);
+
+  for (size_t count : {1u, 3u, 8u}) {
+    std::vector<RegFileRange> ranges = reader.SplitSections(count);
+    REGKIT_CHECK(ranges.size() == count);
+    REGKIT_CHECK(!ranges.empty() && ranges.front().begin == begin && ranges.back().end == bytes.size());
+    std::vector<OwnedToken> tokens;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      REGKIT_CHECK(i == 0 || ranges[i].begin == ranges[i - 1].end);
+      REGKIT_CHECK(reader.Seek(ranges[i]));
+      std::vector<OwnedToken> part = ReadAll(&reader);
+      REGKIT_CHECK(i == 0 || (!part.empty() && part.front().kind != RegFileTokenKind::kValue && part.front().kind != RegFileTokenKind::kDeleteValue));
+      tokens.insert(tokens.end(), part.begin(), part.end());
+    }
+    REGKIT_CHECK(tokens == expected);
+  }
+
+  REGKIT_CHECK(reader.Seek({begin, bytes.size()}));
+  std::vector<std::wstring> keys;
+  RegFileToken token;
+  RegFileRange section;
+  uint64_t last_end = begin;
+  while (reader.NextSection(&token, &section)) {
+    REGKIT_CHECK(section.begin >= last_end && section.end > section.begin);
+    last_end = section.end;
+    keys.emplace_back(token.key);
+  }
+  std::vector<std::wstring> expected_keys;
+  for (const auto& item : expected) {
+    if (item.kind == RegFileTokenKind::kKey || item.kind == RegFileTokenKind::kDeleteKey) {
+      expected_keys.push_back(item.key);
+    }
+  }
+  REGKIT_CHECK(keys == expected_keys);
+
+  REGKIT_CHECK(!reader.Seek({begin, bytes.size() + 2}));
+  REGKIT_CHECK(!reader.Seek({begin + 4, begin + 2}));
+  if (utf16) {
+    REGKIT_CHECK(!reader.Seek({begin + 1, bytes.size()}));
+  }
+  reader.Close();
+}
+
+} // namespace
+
+int main() {
+  std::wstring text = BuildText();
+  std::vector<OwnedToken> expected = Tokenize(text);
+  REGKIT_CHECK(expected.size() > 1000);
+  size_t odd = 0;
+  for (const auto& token : expected) {
+    odd += token.kind == RegFileTokenKind::kValue && token.name == L"Odd" && token.data.find(L"[HKEY_CURRENT_USER\\NotAKey") != std::wstring::npos;
+  }
+  REGKIT_CHECK(odd > 0);
+
+  std::filesystem::path path = TempPath("tokenizer.reg");
+  CheckFile(path, EncodeUtf16(text), expected, 2, true);
+  CheckFile(path, EncodeUtf8(text, false), expected, 0, false);
+  CheckFile(path, EncodeUtf8(text, true), expected, 3, false);
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  return Finish("reg_file_tokenizer_test");
+}
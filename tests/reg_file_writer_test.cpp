@@ -0,0 +1,207 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/reg_file_tokenizer.h"
+#include "registry/reg_file_writer.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+struct TestValue {
+  std::wstring name;
+  uint32_t type = 0;
+  std::vector<uint8_t> data;
+  uint32_t read_type = 0;
+};
+
+std::vector<uint8_t> Utf16(std::wstring_view text, bool terminate) {
+  std::vector<uint8_t> out;
+  for (wchar_t ch : text) {
+    uint32_t code = static_cast<uint32_t>(ch);
+    if (code > 0xFFFF) {
+      code -= 0x10000;
+      uint32_t high = 0xD800 + (code >> 10);
+      uint32_t low = 0xDC00 + (code & 0x3FF);
+      out.insert(out.end(), {static_cast<uint8_t>(high), static_cast<uint8_t>(high >> 8), static_cast<uint8_t>(low), static_cast<uint8_t>(low >> 8)});
+      continue;
+    }
+    out.push_back(static_cast<uint8_t>(code));
+    out.push_back(static_cast<uint8_t>(code >> 8));
+  }
+  if (terminate) {
+    out.push_back(0);
+    out.push_back(0);
+  }
+  return out;
+}
+
+std::vector<uint8_t> Bytes(size_t size) {
+  std::vector<uint8_t> out(size);
+  for (size_t i = 0; i < size; ++i) {
+    out[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+  return out;
+}
+
+std::vector<TestValue> Values() {
+  std::vector<TestValue> values = {
+      {L"", 1, Utf16(L"default", true), 1},
+      {L"Quo\"te\\Back\nslash\ttab\r", 1, Utf16(L"C:\\Path \"x\"\r\n\t\\", true), 1},
+      {L"Caf\x00E9 \x4E2D", 1, Utf16(L"\x00E9t\x00E9 \x4E2D\x6587", true), 1},
+      {L"Embedded", 1, Utf16(std::wstring(L"a\0b", 3), true), 1},
+      {L"Unterminated", 1, Utf16(L"odd", false), 1},
+      {L"Dword", 4, {0x78, 0x56, 0x34, 0x12}, 4},
+      {L"ShortDword", 4, {1, 2, 3}, 4},
+      {L"BigEndian", 5, {0, 0, 0, 1}, 5},
+      {L"Qword", 11, Bytes(8), 11},
+      {L"Expand", 2, Utf16(L"%SystemRoot%\\system32", true), 2},
+      {L"Multi", 7, Utf16(std::wstring(L"one\0two\0", 8), true), 7},
+      {L"None", 0, Bytes(5), 0},
+      {L"EmptyNone", 0, {}, 0},
+      {L"EmptyBinary", 3, {}, 3},
+      {L"ResourceList", 8, Bytes(40), 8},
+      {L"Link", 6, Utf16(L"\\Registry\\Machine", false), 3},
+      {L"Custom", 0x1234, Bytes(3), 3},
+  };
+  for (size_t size : {1u, 24u, 25u, 26u, 49u, 50u, 51u, 1000u}) {
+    values.push_back({L"Binary" + std::to_wstring(size), 3, Bytes(size), 3});
+  }
+  values.push_back({std::wstring(70, L'n'), 3, Bytes(60), 3});
+  values.push_back({std::wstring(90, L'n'), 7, Bytes(60), 7});
+  if constexpr (sizeof(wchar_t) == 4) {
+    values.push_back({L"Astral \U0001F600", 1, Utf16(L"\U0001F600", true), 1});
+  }
+  return values;
+}
+
+bool HexLinesWrapped(std::wstring_view text, size_t* full_lines) {
+  *full_lines = 0;
+  size_t begin = 0;
+  bool continued = false;
+  while (begin < text.size()) {
+    size_t end = text.find(L'\n', begin);
+    if (end == std::wstring_view::npos) {
+      end = text.size();
+    }
+    std::wstring_view line = text.substr(begin, end - begin);
+    if (!line.empty() && line.back() == L'\r') {
+      line.remove_suffix(1);
+    }
+    bool continues = !line.empty() && line.back() == L'\\';
+    if (continued) {
+      size_t pairs = (line.size() - (continues ? 1 : 0) + 1 - 2) / 3;
+      if (line.substr(0, 2) != L"  " || pairs > 25 || (continues && (pairs != 25 || line.size() != 2 + 25 * 3 + 1))) {
+        return false;
+      }
+      *full_lines += continues;
+    }
+    continued = continues;
+    begin = end + 1;
+  }
+  return true;
+}
+
+void CheckRoundTrip(const std::filesystem::path& path, bool framed, bool utf16) {
+  std::vector<TestValue> values = Values();
+  RegFileWriter writer;
+  std::wstring error;
+  if (framed) {
+    REGKIT_CHECK(writer.Open(path, &error));
+    writer.BeginKey(L"HKEY_CURRENT_USER\\Software\\RegKit");
+  } else {
+    REGKIT_CHECK(writer.OpenRaw(path, utf16, &error));
+    writer.BeginSection(L"HKEY_CURRENT_USER\\Software\\RegKit");
+  }
+  for (const auto& value : values) {
+    writer.WriteValue(value.name, value.type, value.data.data(), value.data.size());
+  }
+  writer.BeginKey(L"HKEY_CURRENT_USER\\Software\\RegKit\\Child \x00E9");
+  REGKIT_CHECK(writer.ok());
+  REGKIT_CHECK(writer.Close(&error));
+
+  std::vector<uint8_t> bytes;
+  REGKIT_CHECK(ReadBytes(path, &bytes));
+  REGKIT_CHECK(bytes.size() >= 2);
+  if (framed) {
+    REGKIT_CHECK(bytes[0] == 0xFF && bytes[1] == 0xFE);
+  } else if (!utf16) {
+    REGKIT_CHECK(bytes[0] == '[');
+    std::vector<uint8_t> e_acute = {0xC3, 0xA9};
+    REGKIT_CHECK(std::search(bytes.begin(), bytes.end(), e_acute.begin(), e_acute.end()) != bytes.end());
+  }
+  std::wstring text;
+  bool decoded_utf16 = false;
+  REGKIT_CHECK(DecodeRegFileText(bytes.data(), bytes.size(), &text, &decoded_utf16));
+  REGKIT_CHECK(decoded_utf16 == framed);
+  REGKIT_CHECK(!framed || text.starts_with(L"Windows Registry Editor Version 5.00\r\n"));
+  size_t full_lines = 0;
+  REGKIT_CHECK(HexLinesWrapped(text, &full_lines));
+  REGKIT_CHECK(full_lines > 40);
+
+  RegFileReader reader;
+  REGKIT_CHECK(reader.Open(path, &error));
+  RegFileToken token;
+  REGKIT_CHECK(reader.Next(&token) && token.kind == RegFileTokenKind::kKey && token.key == L"HKEY_CURRENT_USER\\Software\\RegKit");
+  std::wstring name;
+  std::wstring scratch;
+  std::vector<uint8_t> data;
+  for (const auto& value : values) {
+    REGKIT_CHECK(reader.Next(&token) && token.kind == RegFileTokenKind::kValue);
+    REGKIT_CHECK(UnescapeRegFileString(token.name, &name) && name == value.name);
+    REGKIT_CHECK(value.name.empty() == token.name.empty());
+    uint32_t type = 0;
+    REGKIT_CHECK(ParseRegFileValueData(token.data, &type, &data, &scratch));
+    REGKIT_CHECK(type == value.read_type);
+    std::vector<uint8_t> expected = value.data;
+    if (value.type == 1 && type == 1 && expected.size() >= 2 && token.data.front() == L'"' && (expected[expected.size() - 1] != 0 || expected[expected.size() - 2] != 0)) {
+      expected.push_back(0);
+      expected.push_back(0);
+    }
+    REGKIT_CHECK(data == expected);
+  }
+  REGKIT_CHECK(reader.Next(&token) && token.kind == RegFileTokenKind::kKey && token.key == L"HKEY_CURRENT_USER\\Software\\RegKit\\Child \x00E9");
+  REGKIT_CHECK(!reader.Next(&token));
+  reader.Close();
+}
+
+} // namespace
+
+int main() {
+  std::filesystem::path path = TempPath("writer.reg");
+  CheckRoundTrip(path, true, true);
+  CheckRoundTrip(path, false, false);
+
+  std::vector<uint8_t> data;
+  uint32_t type = 0;
+  REGKIT_CHECK(ParseRegFileValueData(L"hex(b):01,02,03,04,05,06,07,08", &type, &data, nullptr) && type == 11 && data.size() == 8);
+  REGKIT_CHECK(ParseRegFileValueData(L"HEX(2):41,00,00,00", &type, &data, nullptr) && type == 2 && data.size() == 4);
+  REGKIT_CHECK(ParseRegFileValueData(L"hex(6):41,00", &type, &data, nullptr) && type == 3);
+  REGKIT_CHECK(ParseRegFileValueData(L"dword:0000002a", &type, &data, nullptr) && type == 4 && data[0] == 0x2A);
+  REGKIT_CHECK(!ParseRegFileValueData(L"hex:0", &type, &data, nullptr));
+  REGKIT_CHECK(!ParseRegFileValueData(L"text", &type, &data, nullptr));
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  return Finish("reg_file_writer_test");
+}
@@ -0,0 +1,168 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/reg_snapshot.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+constexpr size_t kKeyRecordSize = 32;
+
+uint64_t Get64(const std::vector<uint8_t>& data, size_t offset) {
+  uint64_t value = 0;
+  memcpy(&value, data.data() + offset, sizeof(value));
+  return value;
+}
+
+void Put32(std::vector<uint8_t>* data, size_t offset, uint32_t value) {
+  memcpy(data->data() + offset, &value, sizeof(value));
+}
+
+bool Opens(const std::filesystem::path& path, const std::vector<uint8_t>& data) {
+  REGKIT_CHECK(WriteBytes(path, data));
+  RegSnapshot snapshot;
+  std::wstring error;
+  bool opened = snapshot.Open(path, &error);
+  return opened || error.empty();
+}
+
+std::vector<uint8_t> Bytes(const RegSnapshotValue& value) {
+  if (!value.data) {
+    return {};
+  }
+  return std::vector<uint8_t>(value.data, value.data + value.size);
+}
+
+} // namespace
+
+int main() {
+  std::filesystem::path path = TempPath("reg_snapshot_test.rksnap");
+  std::vector<uint8_t> small = {1, 2, 3, 4};
+  std::vector<uint8_t> exact = {1, 2, 3, 4, 5, 6, 7, 8};
+  std::vector<uint8_t> large(5000);
+  std::mt19937 rng(0x5A5A);
+  for (uint8_t& byte : large) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  std::wstring astral = L"Caf\x00E9";
+  astral.append(sizeof(wchar_t) == 2 ? std::wstring(L"\xD83D\xDE00") : std::wstring(1, static_cast<wchar_t>(0x1F600)));
+
+  RegSnapshotWriter writer;
+  std::wstring error;
+  REGKIT_CHECK(writer.Open(path, &error));
+  writer.BeginKey(L"HKEY_CURRENT_USER\\Software\\Zeta");
+  writer.SetLastWrite(0x01D9000000000001ull);
+  writer.WriteValue(L"Large", 3, large.data(), large.size());
+  writer.WriteValue(L"", 1, small.data(), small.size());
+  writer.BeginKey(L"HKEY_CURRENT_USER\\Software\\alpha");
+  writer.SetLastWrite(0x01D9000000000002ull);
+  writer.WriteValue(L"Exact", 3, exact.data(), exact.size());
+  writer.WriteValue(L"Empty", 3, nullptr, 0);
+  writer.BeginKey(L"HKEY_CURRENT_USER\\Software\\Mid\\" + astral);
+  writer.WriteValue(astral, 4, small.data(), small.size());
+  writer.BeginKey(L"HKEY_CURRENT_USER\\Software\\zeta");
+  writer.WriteValue(L"Later", 3, small.data(), 2);
+  writer.BeginKey(L"HKEY_LOCAL_MACHINE");
+  REGKIT_CHECK(writer.Close(&error));
+
+  RegSnapshot snapshot;
+  REGKIT_CHECK(snapshot.Open(path, &error));
+  REGKIT_CHECK(snapshot.KeyCount() == 8);
+  REGKIT_CHECK(snapshot.SubkeyCount(snapshot.root()) == 2);
+  REGKIT_CHECK(snapshot.KeyName(snapshot.Subkey(snapshot.root(), 0)).ToString() == L"HKEY_CURRENT_USER");
+  REGKIT_CHECK(snapshot.FindKey(snapshot.root(), L"Software\\Zeta") == RegSnapshot::kNoKey);
+  uint32_t software = snapshot.FindKey(snapshot.root(), L"hkey_current_user/SOFTWARE");
+  REGKIT_CHECK(software != RegSnapshot::kNoKey && snapshot.SubkeyCount(software) == 3);
+  REGKIT_CHECK(snapshot.KeyName(snapshot.Subkey(software, 0)).ToString() == L"alpha");
+  REGKIT_CHECK(snapshot.KeyName(snapshot.Subkey(software, 1)).ToString() == L"Mid");
+  REGKIT_CHECK(snapshot.KeyName(snapshot.Subkey(software, 2)).ToString() == L"Zeta");
+  REGKIT_CHECK(snapshot.FindSubkey(software, L"MID") == snapshot.Subkey(software, 1));
+  REGKIT_CHECK(snapshot.FindSubkey(software, L"Missing") == RegSnapshot::kNoKey);
+
+  uint32_t zeta = snapshot.FindKey(software, L"zeta");
+  REGKIT_CHECK(zeta == snapshot.FindKey(snapshot.root(), L"HKEY_CURRENT_USER\\Software\\ZETA"));
+  REGKIT_CHECK(snapshot.LastWrite(zeta) == 0x01D9000000000001ull);
+  REGKIT_CHECK(snapshot.ValueCount(zeta) == 3);
+  RegSnapshotValue value;
+  REGKIT_CHECK(snapshot.FindValue(zeta, L"large", &value) && value.type == 3 && Bytes(value) == large);
+  REGKIT_CHECK(snapshot.FindValue(zeta, L"", &value) && value.type == 1 && Bytes(value) == small);
+  REGKIT_CHECK(snapshot.FindValue(zeta, L"LATER", &value) && value.size == 2 && value.data[1] == 2);
+  REGKIT_CHECK(!snapshot.FindValue(zeta, L"Exact", nullptr));
+
+  uint32_t alpha = snapshot.FindKey(software, L"Alpha");
+  REGKIT_CHECK(snapshot.LastWrite(alpha) == 0x01D9000000000002ull);
+  REGKIT_CHECK(snapshot.FindValue(alpha, L"exact", &value) && Bytes(value) == exact);
+  REGKIT_CHECK(snapshot.FindValue(alpha, L"Empty", &value) && value.size == 0);
+  uint32_t leaf = snapshot.FindKey(software, L"Mid\\" + astral);
+  REGKIT_CHECK(leaf != RegSnapshot::kNoKey && snapshot.KeyName(leaf).ToString() == astral);
+  REGKIT_CHECK(snapshot.LastWrite(leaf) == 0 && snapshot.SubkeyCount(leaf) == 0);
+  REGKIT_CHECK(snapshot.FindValue(leaf, astral, &value) && value.type == 4 && value.name.ToString() == astral);
+  REGKIT_CHECK(snapshot.FindKey(snapshot.root(), L"HKEY_LOCAL_MACHINE") != RegSnapshot::kNoKey);
+  REGKIT_CHECK(snapshot.Subkey(software, 3) == RegSnapshot::kNoKey && snapshot.ValueCount(RegSnapshot::kNoKey) == 0);
+  snapshot.Close();
+
+  std::vector<uint8_t> image;
+  REGKIT_CHECK(ReadBytes(path, &image));
+  std::filesystem::path bad = TempPath("reg_snapshot_bad.rksnap");
+  REGKIT_CHECK(Opens(bad, image));
+  for (size_t size : {size_t(0), size_t(8), size_t(95), image.size() / 2, image.size() - 1}) {
+    REGKIT_CHECK(!Opens(bad, std::vector<uint8_t>(image.begin(), image.begin() + size)));
+  }
+  std::vector<uint8_t> corrupt = image;
+  corrupt[0] ^= 0xFF;
+  REGKIT_CHECK(!Opens(bad, corrupt));
+  corrupt = image;
+  Put32(&corrupt, 8, RegSnapshot::kVersion + 1);
+  REGKIT_CHECK(!Opens(bad, corrupt));
+  corrupt = image;
+  Put32(&corrupt, 12, 0);
+  REGKIT_CHECK(!Opens(bad, corrupt));
+  corrupt = image;
+  Put32(&corrupt, 12, 0x7FFFFFFF);
+  REGKIT_CHECK(!Opens(bad, corrupt));
+  uint64_t keys = Get64(image, 32);
+  corrupt = image;
+  Put32(&corrupt, static_cast<size_t>(keys) + 4, 1);
+  REGKIT_CHECK(!Opens(bad, corrupt));
+  for (size_t field = 32; field < 96; field += 8) {
+    corrupt = image;
+    Put32(&corrupt, field + 4, 0x40000000);
+    REGKIT_CHECK(!Opens(bad, corrupt));
+  }
+
+  corrupt = image;
+  Put32(&corrupt, static_cast<size_t>(keys) + zeta * kKeyRecordSize + 4, zeta);
+  Put32(&corrupt, static_cast<size_t>(keys) + alpha * kKeyRecordSize + 12, 0x7FFFFFFF);
+  REGKIT_CHECK(WriteBytes(bad, corrupt));
+  REGKIT_CHECK(snapshot.Open(bad, &error));
+  REGKIT_CHECK(snapshot.Subkey(software, 2) == RegSnapshot::kNoKey);
+  REGKIT_CHECK(snapshot.FindKey(software, L"Zeta") == RegSnapshot::kNoKey);
+  REGKIT_CHECK(snapshot.SubkeyCount(alpha) == 0);
+  snapshot.Close();
+
+  std::filesystem::remove(path);
+  std::filesystem::remove(bad);
+  return Finish("reg_snapshot_test");
+}
@@ -0,0 +1,144 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <clocale>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "hive_fixture.h"
+#include "registry/ordinal_search.h"
+#include "registry/trigram_index.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+struct IndexedKey {
+  std::wstring path;
+  std::wstring text;
+};
+
+bool Covers(const std::vector<uint32_t>& candidates, const std::vector<IndexedKey>& keys, std::wstring_view literal) {
+  for (uint32_t key = 0; key < keys.size(); ++key) {
+    if (FindOrdinalInsensitive(keys[key].text, literal) != std::wstring_view::npos && !std::binary_search(candidates.begin(), candidates.end(), key)) {
+      return false;
+    }
+  }
+  return std::is_sorted(candidates.begin(), candidates.end());
+}
+
+} // namespace
+
+int main() {
+  std::setlocale(LC_ALL, "C.UTF-8");
+  const wchar_t kAlphabet[] = L"abcKkSsIi_ \\.09\x00E9\x00C9\x0131\x0130\x017F\x212A\x0430\x0410\x4E2D\x4E8C\xFF41\xFF21";
+  std::mt19937 rng(0x7216);
+  std::uniform_int_distribution<size_t> pick(0, sizeof(kAlphabet) / sizeof(wchar_t) - 2);
+  std::uniform_int_distribution<size_t> length(3, 40);
+
+  std::vector<IndexedKey> keys;
+  TrigramIndexWriter writer;
+  std::vector<uint32_t> trigrams;
+  for (uint32_t i = 0; i < 600; ++i) {
+    IndexedKey key;
+    key.path = L"Software\\Key" + std::to_wstring(i);
+    if (i % 7 == 0) {
+      key.path += L"\\\x4E2D\x6587";
+    }
+    key.text = key.path + L"|";
+    if (i % 97 == 5) {
+      for (size_t c = 0; c < 20000; ++c) {
+        key.text.push_back(static_cast<wchar_t>(L'!' + rng() % 94));
+      }
+    } else {
+      for (size_t c = length(rng); c > 0; --c) {
+        key.text.push_back(kAlphabet[pick(rng)]);
+      }
+    }
+    trigrams.clear();
+    CollectTrigrams(key.text, &trigrams);
+    writer.AddKey(key.path, &trigrams);
+    keys.push_back(std::move(key));
+  }
+  REGKIT_CHECK(writer.key_count() == keys.size());
+
+  std::filesystem::path path = TempPath("trigram.rktri");
+  constexpr uint64_t kStamp = 0x01DC0000DEADBEEFull;
+  std::wstring error;
+  REGKIT_CHECK(writer.Save(path, kStamp, &error));
+
+  TrigramIndex index;
+  REGKIT_CHECK(index.Open(path, &error));
+  REGKIT_CHECK(index.stamp() == kStamp);
+  REGKIT_CHECK(index.key_count() == keys.size());
+  for (uint32_t key = 0; key < keys.size(); ++key) {
+    REGKIT_CHECK(index.KeyPath(key) == keys[key].path);
+  }
+  REGKIT_CHECK(index.KeyPath(static_cast<uint32_t>(keys.size())).empty());
+
+  std::vector<uint32_t> candidates;
+  std::uniform_int_distribution<int> coin(0, 2);
+  for (int round = 0; round < 1000; ++round) {
+    const IndexedKey& source = keys[rng() % keys.size()];
+    size_t size = std::uniform_int_distribution<size_t>(3, 8)(rng);
+    size_t start = std::uniform_int_distribution<size_t>(0, source.text.size() - size)(rng);
+    std::wstring literal = source.text.substr(start, size);
+    for (wchar_t& ch : literal) {
+      int flip = coin(rng);
+      if (flip == 1) {
+        ch = UpcaseOrdinal(ch);
+      } else if (flip == 2 && static_cast<uint32_t>(ch) < 0x80) {
+        ch = static_cast<wchar_t>(towlower(static_cast<wint_t>(ch)));
+      }
+    }
+    REGKIT_CHECK(index.Candidates(literal, &candidates));
+    REGKIT_CHECK(Covers(candidates, keys, literal));
+  }
+
+  for (const wchar_t* literal : {L"KEY1", L"software\\key", L"\x00C9\x00C9\x00C9", L"\x212A\x212A\x212A", L"kkk", L"\x4E2D\x6587", L"|\x4E8C\x4E2D", L"x\x4E2D\x6587"}) {
+    if (!index.Candidates(literal, &candidates)) {
+      REGKIT_CHECK(std::wstring_view(literal).size() < 3);
+      continue;
+    }
+    REGKIT_CHECK(Covers(candidates, keys, literal));
+  }
+  REGKIT_CHECK(!index.Candidates(L"ab", &candidates));
+  REGKIT_CHECK(index.Candidates(L"qqqqqq", &candidates));
+  for (uint32_t key = 0; key < keys.size(); ++key) {
+    bool always = keys[key].text.size() > 10000;
+    REGKIT_CHECK(std::binary_search(candidates.begin(), candidates.end(), key) == always);
+  }
+  index.Close();
+
+  std::vector<uint8_t> bytes;
+  REGKIT_CHECK(ReadBytes(path, &bytes));
+  std::vector<uint8_t> truncated(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(bytes.size() / 2));
+  REGKIT_CHECK(WriteBytes(path, truncated));
+  REGKIT_CHECK(!index.Open(path, &error));
+  std::vector<uint8_t> corrupt = bytes;
+  corrupt[0] ^= 0xFF;
+  REGKIT_CHECK(WriteBytes(path, corrupt));
+  REGKIT_CHECK(!index.Open(path, &error));
+  REGKIT_CHECK(!index.is_open());
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  return Finish("trigram_index_test");
+}
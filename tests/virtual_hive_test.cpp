@@ -0,0 +1,179 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "registry/virtual_hive.h"
+#include "test_support.h"
+
+using namespace regkit;
+
+namespace {
+
+using HiveDump = std::map<std::wstring, std::vector<uint8_t>>;
+
+void DumpKey(const VirtualHive& hive, uint32_t key, const std::wstring& path, HiveDump* dump) {
+  (*dump)[path + L"\\"] = {};
+  for (uint32_t i = 0; i < hive.ValueCount(key); ++i) {
+    VirtualHiveValue value = hive.Value(key, i);
+    std::vector<uint8_t> bytes(value.data, value.data + value.size);
+    bytes.push_back(static_cast<uint8_t>(value.type));
+    (*dump)[path + L"@" + std::wstring(value.name)] = std::move(bytes);
+  }
+  for (uint32_t i = 0; i < hive.SubkeyCount(key); ++i) {
+    uint32_t child = hive.Subkey(key, i);
+    DumpKey(hive, child, path + L"\\" + std::wstring(hive.KeyName(child)), dump);
+  }
+}
+
+HiveDump Dump(const VirtualHive& hive) {
+  HiveDump dump;
+  DumpKey(hive, hive.root(), L"", &dump);
+  return dump;
+}
+
+void Set(VirtualHive* hive, uint32_t key, std::wstring_view name, std::vector<uint8_t> data, uint32_t type = 3) {
+  hive->SetValue(key, name, type, data.data(), data.size());
+}
+
+std::vector<uint8_t> Data(const VirtualHive& hive, uint32_t key, std::wstring_view name) {
+  VirtualHiveValue value;
+  if (!hive.FindValue(key, name, &value)) {
+    return {0xEE};
+  }
+  return std::vector<uint8_t>(value.data, value.data + value.size);
+}
+
+} // namespace
+
+int main() {
+  VirtualHive hive;
+  REGKIT_CHECK(hive.KeyCount() == 1 && hive.KeyName(hive.root()).empty());
+  uint32_t c = hive.CreateKey(L"Software\\Vendor\\C");
+  uint32_t d = hive.CreateKey(L"software/VENDOR/d");
+  uint32_t vendor = hive.FindKey(L"SOFTWARE\\vendor");
+  REGKIT_CHECK(vendor != VirtualHive::kNoKey && hive.KeyCount() == 5);
+  REGKIT_CHECK(hive.FindKey(L"Software\\Vendor\\c") == c && hive.FindKey(L"Software/Vendor/D") == d);
+  REGKIT_CHECK(hive.FindKey(L"Software\\Missing") == VirtualHive::kNoKey);
+  REGKIT_CHECK(hive.FindKey(L"") == hive.root());
+  REGKIT_CHECK(hive.CreateKey(L"Software\\Vendor\\C") == c && hive.KeyCount() == 5);
+  REGKIT_CHECK(hive.CreateSubkey(vendor, L"b") != VirtualHive::kNoKey);
+  REGKIT_CHECK(hive.CreateSubkey(vendor, L"\x00E9") != VirtualHive::kNoKey);
+  REGKIT_CHECK(hive.SubkeyCount(vendor) == 4);
+  REGKIT_CHECK(hive.KeyName(hive.Subkey(vendor, 0)) == L"b" && hive.KeyName(hive.Subkey(vendor, 1)) == L"C" && hive.KeyName(hive.Subkey(vendor, 2)) == L"d");
+  REGKIT_CHECK(hive.FindSubkey(vendor, L"\x00E9") == hive.Subkey(vendor, 3));
+
+  Set(&hive, c, L"Value", {1, 2, 3, 4});
+  Set(&hive, c, L"alpha", {9});
+  Set(&hive, c, L"", {7}, 1);
+  REGKIT_CHECK(hive.ValueCount(c) == 3);
+  REGKIT_CHECK(hive.Value(c, 0).name.empty() && hive.Value(c, 1).name == L"alpha" && hive.Value(c, 2).name == L"Value");
+  Set(&hive, c, L"VALUE", {5, 6});
+  REGKIT_CHECK(hive.ValueCount(c) == 3 && Data(hive, c, L"value") == std::vector<uint8_t>({5, 6}));
+  Set(&hive, c, L"value", {1, 2, 3, 4, 5, 6, 7, 8, 9});
+  REGKIT_CHECK(Data(hive, c, L"Value").size() == 9 && Data(hive, c, L"alpha") == std::vector<uint8_t>({9}));
+  Set(&hive, c, L"Empty", {});
+  VirtualHiveValue empty;
+  REGKIT_CHECK(hive.FindValue(c, L"empty", &empty) && empty.size == 0 && empty.data == nullptr);
+
+  REGKIT_CHECK(!hive.RenameValue(c, L"alpha", L"value"));
+  REGKIT_CHECK(!hive.RenameValue(c, L"missing", L"other"));
+  REGKIT_CHECK(hive.RenameValue(c, L"alpha", L"ALPHA"));
+  REGKIT_CHECK(hive.FindValue(c, L"alpha", &empty) && empty.name == L"ALPHA");
+  REGKIT_CHECK(hive.RenameValue(c, L"ALPHA", L"zeta") && Data(hive, c, L"zeta") == std::vector<uint8_t>({9}));
+  REGKIT_CHECK(hive.Value(c, hive.ValueCount(c) - 1).name == L"zeta");
+  REGKIT_CHECK(hive.DeleteValue(c, L"ZETA") && !hive.DeleteValue(c, L"zeta") && hive.ValueCount(c) == 3);
+
+  REGKIT_CHECK(!hive.RenameSubkey(vendor, L"C", L"d"));
+  REGKIT_CHECK(hive.RenameSubkey(vendor, L"C", L"c"));
+  REGKIT_CHECK(hive.RenameSubkey(vendor, L"c", L"z") && hive.FindKey(L"Software\\Vendor\\Z") == c);
+  REGKIT_CHECK(hive.Subkey(vendor, 2) == c && hive.KeyName(c) == L"z");
+  REGKIT_CHECK(hive.CreateKey(L"Software\\Vendor\\z\\Deep") == hive.FindKey(L"Software\\Vendor\\Z\\deep"));
+  REGKIT_CHECK(hive.DeleteSubkey(vendor, L"Z") && !hive.DeleteSubkey(vendor, L"z"));
+  REGKIT_CHECK(hive.FindKey(L"Software\\Vendor\\z") == VirtualHive::kNoKey);
+  uint32_t recreated = hive.CreateKey(L"Software\\Vendor\\z\\Deep");
+  REGKIT_CHECK(recreated != VirtualHive::kNoKey && hive.ValueCount(hive.FindKey(L"Software\\Vendor\\z")) == 0);
+
+  VirtualHive other;
+  uint32_t other_vendor = other.CreateKey(L"SOFTWARE\\VENDOR");
+  Set(&other, other_vendor, L"Merged", {4, 4});
+  Set(&other, other.CreateKey(L"SOFTWARE\\VENDOR\\D"), L"FromOther", {8});
+  Set(&other, other.CreateKey(L"Other\\Branch"), L"Leaf", {1});
+  std::vector<uint32_t> remap;
+  hive.Merge(other, &remap);
+  REGKIT_CHECK(remap.size() == other.KeyCount());
+  REGKIT_CHECK(remap[other_vendor] == vendor);
+  REGKIT_CHECK(Data(hive, vendor, L"merged") == std::vector<uint8_t>({4, 4}));
+  REGKIT_CHECK(Data(hive, d, L"FromOther") == std::vector<uint8_t>({8}));
+  REGKIT_CHECK(hive.KeyName(hive.FindKey(L"Software")) == L"Software");
+  REGKIT_CHECK(hive.FindKey(L"Other\\Branch") == remap[other.FindKey(L"Other\\Branch")]);
+
+  HiveDump before = Dump(hive);
+  uint32_t stale = hive.KeyCount();
+  hive.Compact(&remap);
+  REGKIT_CHECK(Dump(hive) == before);
+  REGKIT_CHECK(remap.size() == stale && hive.KeyCount() < stale);
+  REGKIT_CHECK(remap[c] == VirtualHive::kNoKey);
+  REGKIT_CHECK(remap[vendor] == hive.FindKey(L"Software\\Vendor"));
+  REGKIT_CHECK(hive.CreateKey(L"Software\\Vendor\\d") == remap[d]);
+
+  std::mt19937 rng(0x1EAF);
+  const wchar_t* const kNames[] = {L"a", L"A", L"b", L"Key", L"KEY", L"\x00E9", L"z"};
+  auto name = [&]() { return std::wstring(kNames[rng() % std::size(kNames)]); };
+  VirtualHive random;
+  std::vector<std::wstring> paths = {L""};
+  for (int op = 0; op < 4000; ++op) {
+    const std::wstring& path = paths[rng() % paths.size()];
+    uint32_t key = random.FindKey(path);
+    if (key == VirtualHive::kNoKey) {
+      continue;
+    }
+    switch (rng() % 6) {
+    case 0:
+      if (path.size() < 24) {
+        std::wstring child = path.empty() ? name() : path + L"\\" + name();
+        random.CreateKey(child);
+        paths.push_back(child);
+      }
+      break;
+    case 1:
+      random.DeleteSubkey(key, name());
+      break;
+    case 2:
+      random.RenameSubkey(key, name(), name());
+      break;
+    case 3:
+      Set(&random, key, name(), std::vector<uint8_t>(rng() % 12, static_cast<uint8_t>(op)));
+      break;
+    case 4:
+      random.DeleteValue(key, name());
+      break;
+    default:
+      random.RenameValue(key, name(), name());
+      break;
+    }
+  }
+  HiveDump expected = Dump(random);
+  VirtualHive merged;
+  merged.Merge(random);
+  REGKIT_CHECK(Dump(merged) == expected);
+  random.Compact();
+  REGKIT_CHECK(Dump(random) == expected);
+  REGKIT_CHECK(random.KeyCount() == merged.KeyCount());
+  return regkit::test::Finish("virtual_hive_test");
+}
@@ -0,0 +1,101 @@
+// Copyright (C) 2026 Noverse (Nohuto)
+// This file is part of RegKit https://github.com/nohuto/regkit
+//
+// RegKit is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// RegKit is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with RegKit.  If not, see <https://www.gnu.org/licenses/>.
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "registry/work_stealing_scheduler.h"
+#include "test_support.h"
+
+using namespace regkit;
+using namespace regkit::test;
+
+namespace {
+
+struct Node {
+  uint32_t id = 0;
+  uint32_t fanout = 0;
+};
+
+constexpr uint32_t kTreeSize = 200000;
+
+bool VisitsTreeOnce(unsigned int workers, uint32_t fanout) {
+  WorkStealingScheduler<Node> scheduler(workers);
+  std::unique_ptr<std::atomic<uint8_t>[]> visits(new std::atomic<uint8_t>[kTreeSize]());
+  std::atomic<unsigned int> started(0);
+  std::atomic<uint32_t> bad_worker(0);
+  scheduler.Seed(Node{0, fanout});
+  scheduler.Run([&](unsigned int worker, Node& node, std::vector<Node>* children) {
+    if (worker >= scheduler.worker_count()) {
+      bad_worker.fetch_add(1);
+    }
+    visits[node.id].fetch_add(1);
+    for (uint32_t i = 1; i <= node.fanout; ++i) {
+      uint64_t child = static_cast<uint64_t>(node.id) * node.fanout + i;
+      if (child >= kTreeSize) {
+        break;
+      }
+      children->push_back(Node{static_cast<uint32_t>(child), node.fanout});
+    }
+  }, [&]() { started.fetch_add(1); });
+  bool ok = started.load() == scheduler.worker_count() && bad_worker.load() == 0 && scheduler.pending() == 0 && !scheduler.stopped();
+  for (uint32_t i = 0; i < kTreeSize; ++i) {
+    ok = ok && visits[i].load() == 1;
+  }
+  return ok;
+}
+
+} // namespace
+
+int main() {
+  REGKIT_CHECK(WorkStealingScheduler<Node>(0).worker_count() == 1);
+  for (unsigned int workers : {1u, 2u, 3u, 8u, 32u}) {
+    REGKIT_CHECK(VisitsTreeOnce(workers, 1));
+    REGKIT_CHECK(VisitsTreeOnce(workers, 4));
+    REGKIT_CHECK(VisitsTreeOnce(workers, kTreeSize));
+  }
+
+  WorkStealingScheduler<Node> empty(4);
+  std::atomic<uint32_t> calls(0);
+  empty.Run([&](unsigned int, Node&, std::vector<Node>*) { calls.fetch_add(1); });
+  REGKIT_CHECK(calls.load() == 0 && empty.pending() == 0);
+
+  WorkStealingScheduler<Node> seeded(3);
+  for (uint32_t i = 0; i < 10; ++i) {
+    seeded.Seed(Node{i, 0});
+  }
+  REGKIT_CHECK(seeded.pending() == 10);
+  seeded.Run([&](unsigned int, Node&, std::vector<Node>*) { calls.fetch_add(1); });
+  REGKIT_CHECK(calls.load() == 10 && seeded.pending() == 0);
+
+  for (unsigned int workers : {1u, 4u}) {
+    WorkStealingScheduler<Node> stopping(workers);
+    std::atomic<uint32_t> processed(0);
+    stopping.Seed(Node{0, 4});
+    stopping.Run([&](unsigned int, Node& node, std::vector<Node>* children) {
+      if (processed.fetch_add(1) + 1 == 1000) {
+        stopping.Stop();
+      }
+      for (uint32_t i = 1; i <= node.fanout; ++i) {
+        children->push_back(Node{node.id * 4 + i, node.fanout});
+      }
+    });
+    REGKIT_CHECK(stopping.stopped());
+    REGKIT_CHECK(processed.load() >= 1000 && processed.load() < 1000 + workers);
+  }
+  return Finish("work_stealing_scheduler_test");
+}